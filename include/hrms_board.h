@@ -11,7 +11,19 @@
 #ifndef HRMS_BOARD_H
 #define HRMS_BOARD_H
 
+#include <stdint.h>
+#include <stddef.h>
+
 void hrms_board_init(void);
 
+/**
+ * Fill a buffer with seed material unique to this chip and this boot:
+ * the 96-bit device ID, cycles since reset and ADC noise. Not uniform -
+ * run it through a PRF before use. Call after hrms_board_init().
+ * @param out Buffer for the seed
+ * @param len Bytes wanted
+ */
+void hrms_board_seed(uint8_t *out, size_t len);
+
 #endif // HRMS_BOARD_H
 
@@ -45,7 +45,7 @@ typedef struct {
 #define HRMS_COMM_QUEUE_LEN             5    // Was 10
 
 // Timing configuration
-#define HRMS_SENSOR_READ_INTERVAL_MS    100  // Was 200
+#define HRMS_SENSOR_READ_INTERVAL_MS    200
 #define HRMS_CONTROLLER_CYCLE_MS        20   // Was 10  
 #define HRMS_ACTUATOR_CYCLE_MS          50   // Was 10
 #define HRMS_COMM_CYCLE_MS              20   // Was 10
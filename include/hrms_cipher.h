@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+#ifndef HRMS_CIPHER_H
+#define HRMS_CIPHER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "hrms_config.h"
+
+/**
+ * @file hrms_cipher.h
+ * @brief Counter-mode keystream backends for frame encryption
+ *
+ * Each backend turns (key, nonce, frame counter) into up to
+ * HRMS_CIPHER_MAX_KEYSTREAM bytes of keystream:
+ *
+ *   ChaCha20    one 64-byte block, the frame counter as block counter
+ *   Speck64/128 8-byte blocks of (nonce word 0 ^ index, frame counter)
+ *   AES-128     16-byte blocks of nonce[0..7], counter, index (big-endian)
+ *
+ * Speck and AES use the first 16 key bytes. HRMS_CIPHER_BACKEND picks the
+ * backend behind hrms_cipher_init()/hrms_cipher_keystream(). With
+ * HRMS_CIPHER_BENCH set, every backend is built in so that
+ * hrms_cipher_benchmark() can compare them. The code size of each backend
+ * is that of its object file (`make cipher-size`, `make bench-host`).
+ */
+
+#define HRMS_CIPHER_KEY_SIZE        32
+#define HRMS_CIPHER_NONCE_SIZE      12
+#define HRMS_CIPHER_MAX_KEYSTREAM   64    // Bytes per frame counter
+#define HRMS_CIPHER_CTX_SIZE        192   // Largest backend context, bytes
+
+typedef struct {
+  const char *name;
+  uint16_t ctx_size;         // Key schedule and nonce, bytes of RAM
+  void (*init)(void *ctx, const uint8_t *key, const uint8_t *nonce);
+  void (*keystream)(const void *ctx, uint32_t counter, uint8_t *out, size_t len);
+  bool (*selftest)(void);    // Published test vector on the raw block function
+} hrms_cipher_backend_t;
+
+typedef struct {
+  const char *name;
+  uint16_t ram_bytes;        // Context size
+  bool selftest_ok;
+  uint32_t init_cycles;      // Key schedule
+  uint32_t frame_cycles;     // Keystream for one full frame payload
+  uint32_t cycles_per_byte_q8; // Over HRMS_CIPHER_BENCH_BYTES, Q8 fixed point
+} hrms_cipher_bench_t;
+
+#define HRMS_CIPHER_BENCH_BYTES     256
+
+// Key schedule and nonce of the configured backend
+typedef struct {
+  uint32_t words[HRMS_CIPHER_CTX_SIZE / 4];
+} hrms_cipher_ctx_t;
+
+extern const hrms_cipher_backend_t hrms_cipher_chacha20;
+extern const hrms_cipher_backend_t hrms_cipher_speck;
+extern const hrms_cipher_backend_t hrms_cipher_aes;
+
+/**
+ * Load key and nonce into a context of the configured backend
+ * @param ctx Context to set up
+ * @param key HRMS_CIPHER_KEY_SIZE bytes
+ * @param nonce HRMS_CIPHER_NONCE_SIZE bytes
+ */
+void hrms_cipher_init(hrms_cipher_ctx_t *ctx, const uint8_t *key, const uint8_t *nonce);
+
+/**
+ * Keystream of the configured backend for one frame counter
+ * @param ctx Context set up by hrms_cipher_init()
+ * @param counter Frame counter
+ * @param out Buffer for the keystream
+ * @param len Bytes wanted (up to HRMS_CIPHER_MAX_KEYSTREAM)
+ */
+void hrms_cipher_keystream(const hrms_cipher_ctx_t *ctx, uint32_t counter, uint8_t *out, size_t len);
+
+/**
+ * Get the configured backend
+ * @return Backend selected by HRMS_CIPHER_BACKEND
+ */
+const hrms_cipher_backend_t *hrms_cipher_active(void);
+
+/**
+ * Measure every backend built in with the DWT cycle counter
+ * Uses a scratch context; contexts in use are left untouched
+ * @param results Array for one entry per backend
+ * @param max Array length
+ * @return Number of backends measured
+ */
+size_t hrms_cipher_benchmark(hrms_cipher_bench_t *results, size_t max);
+
+/**
+ * Run the benchmark and print one line per backend on the debug UART
+ */
+void hrms_cipher_dump_benchmark(void);
+
+#endif /* HRMS_CIPHER_H */
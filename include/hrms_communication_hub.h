@@ -12,9 +12,16 @@
 
 
 #include "hrms_types.h"
+#include "hrms_reliable.h"
+#include "hrms_frag.h"
 #include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
+#include "FreeRTOS.h"
+#include "task.h"
+
+// Consumer of one received packet type; the packet is only valid during the call
+typedef void (*hrms_comm_rx_handler_t)(const hrms_comm_packet_t *packet);
 
 /**
  * @brief Initialize the communication hub and all enabled communication modules
@@ -22,7 +29,8 @@
 void hrms_communication_hub_init(void);
 
 /**
- * @brief Send raw data through the communication hub
+ * @brief Send raw data through the communication hub right away
+ * Bypasses the TX scheduler; used where the caller needs the ACK result
  * @param data Pointer to the data to send
  * @param len Length of data in bytes
  * @return true if data was sent successfully, false on error
@@ -38,6 +46,19 @@ bool hrms_communication_hub_send(const uint8_t *data, size_t len);
  */
 bool hrms_communication_hub_receive(uint8_t *data, size_t max_len, size_t *received_len);
 
+/**
+ * @brief Bind radio interrupt notifications to the communication hub task
+ * @param task Handle of the task that calls the hub TX/RX functions
+ */
+void hrms_communication_hub_set_task(TaskHandle_t task);
+
+/**
+ * @brief Sleep until a radio event or the timeout, whichever comes first
+ * @param timeout_ms Maximum time to wait
+ * @return true if received data is pending
+ */
+bool hrms_communication_hub_wait(uint32_t timeout_ms);
+
 /**
  * @brief Process communication hub (call periodically from task)
  * Handles transmission retries, timeouts, and module polling
@@ -45,11 +66,151 @@ bool hrms_communication_hub_receive(uint8_t *data, size_t max_len, size_t *recei
 void hrms_communication_hub_process(void);
 
 /**
- * @brief Get communication statistics
+ * @brief Route one decoded packet to the handler for its type
+ * Refreshes the link idle timer. ACK, config, telemetry, link, probe, sync,
+ * fragment and session packets are consumed by the hub; heartbeat, error and
+ * control packets go to the handler set with hrms_communication_hub_set_rx_handler()
+ * @param packet Decoded packet received from the peer
+ */
+void hrms_communication_hub_handle_packet(const hrms_comm_packet_t *packet);
+
+/**
+ * @brief Drain the radio RX FIFO, decode each frame and dispatch it
+ * Frames failing the length or CRC check are counted as dropped. Control
+ * and link frames are checked against the replay window and tag first and
+ * counted as rejected on failure, without being decoded; so are session
+ * frames whose tag does not check out.
+ * Call from the hub task after hrms_communication_hub_wait().
+ */
+void hrms_communication_hub_service_rx(void);
+
+/**
+ * @brief Register the consumer of heartbeat, error or control packets
+ * @param type Packet type
+ * @param handler Called from the hub task, or NULL to discard
+ * @return false if the hub consumes this type itself
+ */
+bool hrms_communication_hub_set_rx_handler(hrms_comm_packet_type_t type,
+                                           hrms_comm_rx_handler_t handler);
+
+/**
+ * @brief Queue a joystick sample for batched transmission (HRMS_JOYSTICK_BATCH)
+ * A frame goes out once HRMS_JOYSTICK_BATCH_SIZE samples are queued, once the
+ * oldest is HRMS_JOYSTICK_BATCH_FLUSH_MS old (see process), or on a gap
+ * @param sample Sample and the tick it was taken at
+ * @return false on invalid input
+ */
+bool hrms_communication_hub_push_sample(const hrms_joystick_sample_t *sample);
+
+/**
+ * @brief How long the hub task may sleep before the hub needs it again
+ * @param max_ms Upper bound (the task's normal cycle time)
+ * @return max_ms, or less if a queued batch reaches its flush deadline or
+ *         queued bulk frames get their tokens sooner
+ */
+uint32_t hrms_communication_hub_idle_ms(uint32_t max_ms);
+
+/**
+ * @brief Send queued frames in priority order (control > ack > heartbeat > bulk)
+ * Sends at most one bulk frame per call. Call once per hub task cycle.
+ */
+void hrms_communication_hub_service_tx(void);
+
+/**
+ * @brief Queue a heartbeat, replacing one not yet sent
+ * @return false if it could not be encoded
+ */
+bool hrms_communication_hub_send_heartbeat(void);
+
+/**
+ * @brief Send a config or telemetry payload with retransmission and ordering
+ * @param type HRMS_COMM_PACKET_CONFIG, _STATUS or _SENSOR_DATA
+ * @param dest_id Destination device ID
+ * @param payload Payload bytes
+ * @param len Payload length (up to HRMS_WIRE_MAX_PAYLOAD_SIZE)
+ * @return false if the type is not reliable or the window is full
+ */
+bool hrms_communication_hub_send_reliable(hrms_comm_packet_type_t type, uint8_t dest_id,
+                                          const uint8_t *payload, size_t len);
+
+/**
+ * @brief Register the consumer of in-order config/telemetry packets
+ * Config get/set requests are answered by the hub (see hrms_param.h);
+ * config replies and telemetry reach the handler.
+ * @param handler Called from the hub task, or NULL to discard
+ */
+void hrms_communication_hub_set_reliable_handler(hrms_reliable_deliver_t handler);
+
+/**
+ * @brief Send a message larger than one frame (config blob, table, log dump)
+ * Fragments stream through the radio TX FIFO from hrms_communication_hub_service_tx().
+ * @param kind Application message kind, passed to the receiver's handler
+ * @param dest_id Destination device ID
+ * @param data Message bytes; must stay valid while hrms_communication_hub_message_busy()
+ * @param len Message length (1 to HRMS_FRAG_MAX_MESSAGE)
+ * @return false if a message is still being sent or the input is invalid
+ */
+bool hrms_communication_hub_send_message(uint8_t kind, uint8_t dest_id,
+                                         const uint8_t *data, size_t len);
+
+/**
+ * @brief Check whether a message from hrms_communication_hub_send_message() is in flight
+ * @return true until it is delivered or has failed (see hrms_frag_get_stats())
+ */
+bool hrms_communication_hub_message_busy(void);
+
+/**
+ * @brief Register the receiver of reassembled messages
+ * @param handler Called from the hub task, or NULL to discard
+ */
+void hrms_communication_hub_set_message_handler(hrms_frag_deliver_t handler);
+
+/**
+ * @brief Scan the band and move the link to the quietest channel
+ * Blocks the hub task for the sweeps but sleeps through each channel's RX
+ * settle (see hrms_spectrum_get_stats() for sweep time).
+ * The peer is asked first; the channel only changes once it has ACKed.
+ * @param sweeps Number of full RPD sweeps
+ * @return true if the link is on the quietest channel
+ */
+bool hrms_communication_hub_select_channel(uint8_t sweeps);
+
+/**
+ * @brief Get communication statistics, latency figures included
  * @param stats Pointer to store statistics
  */
 void hrms_communication_hub_get_stats(hrms_comm_stats_t *stats);
 
+/**
+ * @brief Send a latency probe now (also sent every HRMS_LATENCY_PROBE_MS)
+ * Blocks until the radio ACKs or gives up, like hrms_communication_hub_send()
+ * @return true if the probe was delivered
+ */
+bool hrms_communication_hub_send_probe(void);
+
+/**
+ * @brief Queue a clock sync request (also queued every HRMS_TIMESYNC_PERIOD_MS)
+ * Goes out with the ACK class, ahead of heartbeats and bulk data; t1 is
+ * stamped when the scheduler hands it to the radio, not when it is queued.
+ * The reply updates the offset and skew estimate in hrms_timesync
+ * @param dest_id Node to synchronise with
+ * @return true if the request was queued
+ */
+bool hrms_communication_hub_send_sync(uint8_t dest_id);
+
+/**
+ * @brief Print packet counters, RTT/one-way latency and the RTT histogram on the debug UART
+ */
+void hrms_communication_hub_dump_stats(void);
+
+/**
+ * @brief Get statistics for one source of a star receiver
+ * @param source RX pipe of the transmitter (0 to HRMS_COMM_MAX_SOURCES-1)
+ * @param stats Pointer to store statistics
+ * @return true if the source index is valid
+ */
+bool hrms_communication_hub_get_source_stats(uint8_t source, hrms_comm_source_stats_t *stats);
+
 /**
  * @brief Create a simple heartbeat packet
  * @param packet Pointer to store the created packet
@@ -71,9 +232,10 @@ void hrms_communication_hub_set_checksum(hrms_comm_packet_t *packet);
 bool hrms_communication_hub_verify_checksum(const hrms_comm_packet_t *packet);
 
 /**
- * @brief Send joystick data as encrypted communication packet
+ * @brief Queue joystick data as encrypted communication packet
+ * Replaces a joystick frame still waiting; sent by hrms_communication_hub_service_tx()
  * @param comm_cmd Communication command from controller
- * @return true if transmission was successful, false otherwise
+ * @return true if the frame was queued, false otherwise
  */
 bool hrms_communication_hub_send_joystick_data(const hrms_comm_command_t *comm_cmd);
 
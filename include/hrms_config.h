@@ -34,21 +34,159 @@
 #define HRMS_NRF24_POWER_LEVEL          NRF24L01_POWER_0DBM
 #define HRMS_NRF24_DATA_RATE            NRF24L01_DATARATE_1MBPS
 
+// Ack-payload return channel (0: every send turns the radio around to RX).
+// The PTX end stays in TX mode and finds return data in the auto-ACKs; the
+// PRX end stays listening and loads its outgoing frames as ack payloads.
+// Both ends must enable it, with opposite roles.
+#define HRMS_NRF24_ACK_PAYLOAD          0
+#define HRMS_NRF24_ROLE_PTX             0     // Transmitter (controller)
+#define HRMS_NRF24_ROLE_PRX             1     // Receiver (base station)
+#define HRMS_NRF24_ROLE                 HRMS_NRF24_ROLE_PTX
+
+// Star network: the base station opens HRMS_NRF24_RX_PIPES pipes and each
+// transmitter sends on the pipe matching its node id (base station: 0)
+#ifndef HRMS_NRF24_RX_PIPES
+#define HRMS_NRF24_RX_PIPES             1     // 1-6
+#endif
+#define HRMS_NRF24_NODE_ID              0     // 0-5
+
+// Frequency hopping (single link only - not combined with a star receiver)
+#ifndef HRMS_NRF24_FREQ_HOP
+#define HRMS_NRF24_FREQ_HOP             0
+#endif
+#define HRMS_HOP_SEED                   0x48524D53  // Shared by both ends
+#define HRMS_HOP_CHANNELS               16
+#define HRMS_HOP_FIRST_CHANNEL          4
+#define HRMS_HOP_STEP                   5     // 4, 9, ... 79 (76 is rendezvous)
+#define HRMS_HOP_RESYNC_MS              100   // Receiver falls back to rendezvous
+#define HRMS_HOP_BLACKLIST_Q8           384   // >1.5 retransmits/frame average
+#define HRMS_HOP_BLACKLIST_MIN_SAMPLES  4
+#define HRMS_HOP_BLACKLIST_MAX          (HRMS_HOP_CHANNELS / 2)
+#define HRMS_HOP_PAROLE_MS              10000
+
+// RPD spectrum scan - boot sweeps pick the quietest channel (0 disables)
+#define HRMS_SPECTRUM_SAMPLES           8     // RPD reads per channel per sweep
+#define HRMS_SPECTRUM_BOOT_SWEEPS       0
+#define HRMS_SPECTRUM_OLED_VIEW         0     // Bar graph of each boot sweep
+
+// Read back the nRF24L01 register shadow after configure (debug builds)
+#define HRMS_NRF24_SHADOW_VERIFY        0
+
+// nRF24L01 SPI transport
+#define HRMS_NRF24_SPI_HW_DMA           0     // SPI2 peripheral, DMA for frames
+#define HRMS_NRF24_SPI_BITBANG          1     // GPIO bit-bang on the same pins
+#define HRMS_NRF24_SPI_SIM              2     // Simulated chip (hrms_nrf24l01_sim.h)
+#ifndef HRMS_NRF24_SPI_TRANSPORT
+#define HRMS_NRF24_SPI_TRANSPORT        HRMS_NRF24_SPI_HW_DMA
+#endif
+
+// Packet CRC engine - both compute CRC-32/MPEG-2, the wire carries the low 16 bits
+#define HRMS_CRC_HW                     0     // STM32 CRC peripheral
+#define HRMS_CRC_SW                     1     // 256-entry table (host builds)
+#ifndef HRMS_CRC_ENGINE
+#define HRMS_CRC_ENGINE                 HRMS_CRC_HW
+#endif
+
 // Communication timing
-#define HRMS_COMM_TX_INTERVAL_MS        500  // Was hardcoded
+#define HRMS_COMM_TX_INTERVAL_MS        500  // Default; HRMS_PARAM_TX_INTERVAL_MS at runtime
 #define HRMS_COMM_PACKET_TIMEOUT_MS     10   // Was hardcoded
 
+// Link-quality estimator (Q8 fixed point, 256 = 1.0)
+#define HRMS_LINK_MIN_FRAMES            16    // Frames between RF changes
+#define HRMS_LINK_LOSS_DOWN_Q8          26    // >10% loss: degrade
+#define HRMS_LINK_RETRY_DOWN_Q8         384   // >1.5 retransmits/frame: degrade
+#define HRMS_LINK_LOSS_UP_Q8            3     // <=1% loss: may go faster
+#define HRMS_LINK_RETRY_UP_Q8           32    // <=0.125 retransmits/frame
+#define HRMS_LINK_POWER_DOWN_RETRY_Q8   8     // Trim power only if nearly clean
+#define HRMS_LINK_FAIL_REVERT           4     // Consecutive MAX_RT before fallback
+#define HRMS_LINK_IDLE_REVERT_MS        3000  // No traffic before fallback
+
+// Reliable delivery (config/telemetry) - selective repeat, window < 128
+#define HRMS_RELIABLE_WINDOW            4     // Frames in flight / buffered
+#define HRMS_RELIABLE_RTO_MS            30    // Retransmit after no ACK
+#define HRMS_RELIABLE_MAX_RETRIES       5
+#define HRMS_RELIABLE_GAP_MS            (HRMS_RELIABLE_RTO_MS * (HRMS_RELIABLE_MAX_RETRIES + 1))
+
+// Joystick stream codec - both ends must agree
+#define HRMS_JOYSTICK_DELTA             1     // 0: fixed 5-byte samples
+#define HRMS_JOYSTICK_KEYFRAME_INTERVAL 8     // Frames between keyframes
+
+// Joystick batching: sample fast, send several samples per frame (needs DELTA)
+#define HRMS_JOYSTICK_BATCH             0
+#define HRMS_JOYSTICK_SAMPLE_HZ         200   // Up to 1000 (1 ms tick)
+#define HRMS_JOYSTICK_BATCH_SIZE        8     // Samples per frame (max 8)
+#define HRMS_JOYSTICK_BATCH_FLUSH_MS    20    // Max age of the oldest sample
+
+// Transmit scheduler: control > ack > heartbeat > bulk (config/telemetry)
+#define HRMS_TX_ACK_DEPTH               4
+#define HRMS_TX_BULK_DEPTH              (HRMS_RELIABLE_WINDOW + 2)
+#define HRMS_TX_BULK_RATE_BPS           1600  // Bulk token refill, bytes/s
+#define HRMS_TX_BULK_BURST              128   // Token bucket depth, bytes
+#define HRMS_HEARTBEAT_INTERVAL_MS      0     // Heartbeat after this much TX silence (0: off)
+#define HRMS_REMOTE_LINK_TIMEOUT_MS     1500  // Peer shown as alive this long after its last packet
+
+// Latency probes (the receiver always answers them)
+#define HRMS_LATENCY_PROBE_MS           0     // Probe period (0: off)
+#define HRMS_LATENCY_BUCKET_US          100   // RTT histogram resolution
+#define HRMS_LATENCY_OFFSET_WINDOW      4     // Probes searched for the fastest
+
+// Clock sync with the peer (the receiver always answers)
+#define HRMS_TIMESYNC_PERIOD_MS         0     // Exchange period (0: off)
+#define HRMS_TIMESYNC_BLOCK             4     // Exchanges per update, the fastest is used
+#define HRMS_TIMESYNC_STALE_MS          20000 // Estimate dropped without an update (< counter wrap / 2)
+
+// Control frame encryption: ChaCha20 counter mode with precomputed keystream
+// (0: ORION_Encrypt per frame) - both ends must agree
+#define HRMS_KEYSTREAM_CACHE            1
+#define HRMS_KEYSTREAM_DEPTH            4     // Blocks computed ahead (covers a batch flush)
+#define HRMS_KEYSTREAM_AUTH             1     // Poly1305 tag and replay window on every frame
+#define HRMS_KEYSTREAM_TAG_BYTES        4     // Tag bytes sent (truncated; the session frame has no room for more than 4)
+#define HRMS_KEYSTREAM_SESSION_MS       1000  // Session re-announced this often (peer reboot, loss)
+
+// Keystream cipher (hrms_cipher.h) - both ends must agree
+#define HRMS_CIPHER_CHACHA20            0
+#define HRMS_CIPHER_SPECK               1     // Speck64/128
+#define HRMS_CIPHER_AES                 2     // AES-128, byte-oriented software
+#ifndef HRMS_CIPHER_BACKEND
+#define HRMS_CIPHER_BACKEND             HRMS_CIPHER_CHACHA20
+#endif
+#ifndef HRMS_CIPHER_BENCH
+#define HRMS_CIPHER_BENCH               0     // Build all backends in for the benchmark
+#endif
+
+// Link key, shared by both ends: `make link-key` writes a random one to
+// include/hrms_link_key.h (kept out of git). The placeholder is public and
+// only the host tests may build with it.
+#ifdef __has_include
+#if __has_include("hrms_link_key.h")
+#include "hrms_link_key.h"
+#endif
+#endif
+#ifndef HRMS_KEYSTREAM_KEY
+#define HRMS_KEYSTREAM_KEY_PLACEHOLDER  1
+#define HRMS_KEYSTREAM_KEY              { 0x48, 0x45, 0x52, 0x4D, 0x45, 0x53, 0x2D, 0x4B, \
+                                          0x45, 0x59, 0x2D, 0x30, 0x30, 0x30, 0x30, 0x30, \
+                                          0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, \
+                                          0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x31 }
+#endif
+
+// Fragmentation of messages larger than one frame
+#define HRMS_FRAG_MAX_MESSAGE           1024  // Bytes (at most 255 fragments)
+#define HRMS_FRAG_POOL_SLOTS            2     // Messages reassembled at once
+#define HRMS_FRAG_TIMEOUT_MS            500   // Drop a message stalled this long
+#define HRMS_FRAG_RETRY_BUDGET          48    // Fragment resends per message
+
 // =============================================================================
 // SENSOR CONFIGURATION
 // =============================================================================
 
 // Joystick calibration
 #define HRMS_JOYSTICK_CENTER_VALUE      2048
-#define HRMS_JOYSTICK_DEADZONE          400   // Reduced from 600
+#define HRMS_JOYSTICK_DEADZONE          600   // Default; HRMS_PARAM_JOYSTICK_DEADZONE at runtime
 #define HRMS_JOYSTICK_UPDATE_THRESHOLD  50    // Reduced from 100
 
 // Sensor reading intervals
-#define HRMS_SENSOR_READ_INTERVAL_MS    100   // Faster than 200ms
+#define HRMS_SENSOR_READ_INTERVAL_MS    200   // Default; HRMS_PARAM_SAMPLE_INTERVAL_MS at runtime
 
 // =============================================================================
 // ACTUATOR CONFIGURATION
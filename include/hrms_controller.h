@@ -45,6 +45,13 @@ void hrms_controller_process_button(const hrms_button_event_t *event,
                                          hrms_actuator_command_t *command);
 
 
+/**
+ * Record a packet received from the remote peer (heartbeat, status, error).
+ * The link state shows on the OLED with the next sensor cycle.
+ */
+void hrms_controller_process_remote(const hrms_remote_event_t *event);
+
+
 // ESP32 communication removed - ready for new implementation
 
 
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+#ifndef HRMS_CRC_H
+#define HRMS_CRC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @file hrms_crc.h
+ * @brief CRC-32 engine: STM32F103 CRC peripheral or table-driven software
+ *
+ * Both paths compute CRC-32/MPEG-2 (poly 0x04C11DB7, init 0xFFFFFFFF,
+ * MSB first, no final XOR) over a byte stream, so a frame checked on the
+ * target and one checked on a host agree bit for bit. HRMS_CRC_ENGINE
+ * picks the path behind hrms_crc32().
+ */
+
+typedef struct {
+  uint32_t sum16_cycles;     // Previous 16-bit additive checksum
+  uint32_t sw_cycles;        // Table-driven CRC-32
+  uint32_t hw_cycles;        // CRC peripheral (0 if not enabled)
+  bool match;                // Software and peripheral results agree
+} hrms_crc_bench_t;
+
+/**
+ * Enable the CRC peripheral clock (no-op for the software engine)
+ */
+void hrms_crc_init(void);
+
+/**
+ * CRC-32 with the configured engine
+ * @param data Bytes to check
+ * @param len Number of bytes
+ * @return CRC-32/MPEG-2 of the bytes
+ */
+uint32_t hrms_crc32(const uint8_t *data, size_t len);
+
+/**
+ * CRC-32 with the 256-entry lookup table
+ * @param data Bytes to check
+ * @param len Number of bytes
+ * @return CRC-32/MPEG-2 of the bytes
+ */
+uint32_t hrms_crc32_sw(const uint8_t *data, size_t len);
+
+/**
+ * CRC-32 with the CRC peripheral (whole words), software for the tail
+ * @param data Bytes to check
+ * @param len Number of bytes
+ * @return CRC-32/MPEG-2 of the bytes
+ */
+uint32_t hrms_crc32_hw(const uint8_t *data, size_t len);
+
+/**
+ * Measure DWT cycles of the integrity checks over one frame
+ * @param data Frame bytes
+ * @param len Frame length
+ * @param result Pointer to store cycle counts
+ */
+void hrms_crc_benchmark(const uint8_t *data, size_t len, hrms_crc_bench_t *result);
+
+#endif /* HRMS_CRC_H */
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+#ifndef HRMS_FRAG_H
+#define HRMS_FRAG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "hrms_types.h"
+#include "hrms_packet_utils.h"
+#include "hrms_config.h"
+
+/**
+ * @file hrms_frag.h
+ * @brief Fragmentation and reassembly of messages larger than one frame
+ *
+ * A message of up to HRMS_FRAG_MAX_MESSAGE bytes is cut into numbered
+ * HRMS_COMM_PACKET_FRAGMENT frames. They are streamed back-to-back through
+ * the radio TX FIFO (pipelined, see hrms_nrf24_comm_enqueue()). A fragment
+ * the radio could not deliver is queued again, within
+ * HRMS_FRAG_RETRY_BUDGET resends per message. One message is in flight at
+ * a time, and the caller's buffer is not copied, so it must stay valid
+ * until hrms_frag_busy() returns false.
+ *
+ * The receiver collects fragments into one of HRMS_FRAG_POOL_SLOTS fixed
+ * buffers, keyed by source and message id. Duplicates are ignored. A
+ * message that sees no fragment for HRMS_FRAG_TIMEOUT_MS is dropped.
+ * Delivery relies on the radio's auto-ACK only: a message is complete
+ * once the peer radio has ACKed every fragment.
+ */
+
+// Fragment payload (HRMS_COMM_PACKET_FRAGMENT): header, then data
+#define HRMS_FRAG_HEADER_SIZE       4     // message id, kind, index, count
+#define HRMS_FRAG_DATA_SIZE         (HRMS_WIRE_MAX_PAYLOAD_SIZE - HRMS_FRAG_HEADER_SIZE)
+#define HRMS_FRAG_MAX_FRAGMENTS     ((HRMS_FRAG_MAX_MESSAGE + HRMS_FRAG_DATA_SIZE - 1) / HRMS_FRAG_DATA_SIZE)
+
+// Loads one frame into the TX FIFO without blocking, false if it is full
+typedef bool (*hrms_frag_enqueue_t)(const uint8_t *frame, size_t len, uint8_t tag);
+
+// Receives a complete message
+typedef void (*hrms_frag_deliver_t)(uint8_t source_id, uint8_t kind,
+                                    const uint8_t *data, size_t len);
+
+typedef struct {
+  uint32_t messages_sent;    // Messages with every fragment ACKed
+  uint32_t messages_failed;  // Out of resends or stalled
+  uint32_t fragments_sent;   // Fragments ACKed by the peer radio
+  uint32_t fragments_resent; // Fragments loaded again after a failure
+  uint32_t last_bytes_per_s; // Throughput of the last message sent
+  uint32_t messages_received;
+  uint32_t duplicates;       // Fragments already held
+  uint32_t timeouts;         // Incomplete messages dropped
+  uint32_t pool_full;        // Fragments of new messages with no free slot
+} hrms_frag_stats_t;
+
+/**
+ * Initialize sender and reassembly pool
+ * @param enqueue Non-blocking TX FIFO load (e.g. hrms_nrf24_comm_enqueue)
+ * @param deliver Called with each reassembled message
+ */
+void hrms_frag_init(hrms_frag_enqueue_t enqueue, hrms_frag_deliver_t deliver);
+
+/**
+ * Start sending a message
+ * @param kind Application message kind, passed to the receiver's deliver callback
+ * @param dest_id Destination device ID
+ * @param data Message bytes; must stay valid until hrms_frag_busy() is false
+ * @param len Message length (1 to HRMS_FRAG_MAX_MESSAGE)
+ * @param now_ms Current time in milliseconds
+ * @return false if a message is already in flight or the input is invalid
+ */
+bool hrms_frag_send(uint8_t kind, uint8_t dest_id, const uint8_t *data, size_t len,
+                    uint32_t now_ms);
+
+/**
+ * Check whether a message is still being sent
+ * @return true until every fragment is ACKed or the message failed
+ */
+bool hrms_frag_busy(void);
+
+/**
+ * Load as many pending fragments as the TX FIFO takes
+ * @param now_ms Current time in milliseconds
+ */
+void hrms_frag_pump(uint32_t now_ms);
+
+/**
+ * Pipelined TX completion (nrf24l01_tx_callback_t)
+ * @param tag Fragment index
+ * @param success true if the peer radio ACKed it
+ */
+void hrms_frag_on_tx_done(uint8_t tag, bool success);
+
+/**
+ * Feed a received HRMS_COMM_PACKET_FRAGMENT packet into reassembly
+ * @param packet Decoded packet
+ * @param now_ms Current time in milliseconds
+ */
+void hrms_frag_on_receive(const hrms_comm_packet_t *packet, uint32_t now_ms);
+
+/**
+ * Drop stale partial messages and give up on a stalled send
+ * @param now_ms Current time in milliseconds
+ */
+void hrms_frag_poll(uint32_t now_ms);
+
+/**
+ * Get fragmentation statistics
+ * @param stats Pointer to store statistics
+ */
+void hrms_frag_get_stats(hrms_frag_stats_t *stats);
+
+#endif /* HRMS_FRAG_H */
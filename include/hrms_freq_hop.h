@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+#ifndef HRMS_FREQ_HOP_H
+#define HRMS_FREQ_HOP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @file hrms_freq_hop.h
+ * @brief Frequency-hopping sequence with an automatic channel blacklist
+ *
+ * The hop set is HRMS_HOP_CHANNELS channels, spread HRMS_HOP_STEP apart
+ * and shuffled by a seed both ends share. The rendezvous channel
+ * (HRMS_NRF24_CHANNEL) is kept out of the set, so it stays free for
+ * resync.
+ *
+ * Only the transmitter keeps the blacklist. Each frame names the slot
+ * the link moves to next, so the receiver never needs to know which
+ * slots are skipped. A slot is blacklisted when its moving retransmit
+ * average stays above HRMS_HOP_BLACKLIST_Q8. It is paroled after
+ * HRMS_HOP_PAROLE_MS.
+ */
+
+typedef struct {
+  uint8_t blacklisted;        // Slots currently skipped
+  uint32_t blacklist_events;  // Times a slot was blacklisted
+  uint32_t hops;              // Delivered frames (one hop each)
+} hrms_freq_hop_stats_t;
+
+/**
+ * Build the hop sequence
+ * @param seed Shared seed; both ends must use the same value
+ */
+void hrms_freq_hop_init(uint32_t seed);
+
+/**
+ * RF channel of a hop slot
+ * @param slot Slot index (0 to HRMS_HOP_CHANNELS-1)
+ * @return RF channel
+ */
+uint8_t hrms_freq_hop_channel(uint8_t slot);
+
+/**
+ * Next usable slot after the given one, skipping blacklisted slots
+ * @param slot Current slot
+ * @param now_ms Current time in milliseconds (for parole)
+ * @return Next slot
+ */
+uint8_t hrms_freq_hop_next(uint8_t slot, uint32_t now_ms);
+
+/**
+ * Feed the outcome of a transmission on a slot into the blacklist
+ * @param slot Slot the frame was sent on
+ * @param delivered true if ACKed
+ * @param retransmits ARC_CNT of the frame
+ * @param now_ms Current time in milliseconds
+ */
+void hrms_freq_hop_report(uint8_t slot, bool delivered, uint8_t retransmits, uint32_t now_ms);
+
+/**
+ * Get hopping statistics
+ * @param stats Pointer to store statistics
+ */
+void hrms_freq_hop_get_stats(hrms_freq_hop_stats_t *stats);
+
+#endif /* HRMS_FREQ_HOP_H */
@@ -0,0 +1,243 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+#ifndef HRMS_KEYSTREAM_H
+#define HRMS_KEYSTREAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "hrms_packet_utils.h"
+#include "hrms_cipher.h"
+#include "hrms_poly1305.h"
+#include "hrms_config.h"
+
+/**
+ * @file hrms_keystream.h
+ * @brief Counter-mode frame encryption with precomputed keystream
+ *
+ * Every encrypted frame uses its own 32-bit counter. The keystream of the
+ * configured cipher backend for that counter (see hrms_cipher.h) is XORed
+ * with the plaintext. The low 16 bits of the counter go in front of the
+ * ciphertext, so the receiver can rebuild the full counter and decrypt
+ * frames that arrive out of order or after losses.
+ *
+ * A ring of HRMS_KEYSTREAM_DEPTH blocks for the next counters is filled by
+ * hrms_keystream_refill() while the hub is idle. Encrypting a frame is then
+ * a copy and an XOR. With the ring empty the block is computed on the spot
+ * (a miss), with the same output.
+ *
+ * With HRMS_KEYSTREAM_AUTH each frame also carries a Poly1305 tag,
+ * truncated to HRMS_KEYSTREAM_TAG_BYTES, over the caller's associated data
+ * (the wire header), the counter and the ciphertext. The one-time MAC key is
+ * the upper half of the frame's keystream block, so it comes out of the
+ * ring with the data keystream. The tag is updated chunk by chunk while the
+ * plaintext is XORed. The receiver keeps a 64-counter sliding window:
+ * replayed or stale counters are turned away before any cipher work, the
+ * tag is compared without early exit, and the window only moves for frames
+ * whose tag checks out.
+ *
+ * Sessions: the key is fixed per pair of devices, the nonce is not. Each
+ * end draws a fresh nonce from a boot seed, so no (key, nonce, counter) is
+ * ever used twice, and sends with its own nonce. A session frame announces
+ * it, tagged under the key: nonce, this end's challenge, and the peer's
+ * challenge echoed back. A peer session is taken only when it echoes the
+ * current challenge, which changes each time one is taken - a recorded
+ * announcement from an earlier session is refused. Until one is taken
+ * nothing decrypts.
+ *
+ * Each announcement also carries the sender's next counter (the anchor).
+ * Taking a session restarts the replay window there, so frames of a
+ * previous peer boot, or of this session from before our own reboot, are
+ * stale. A later announcement of the same session moves the window up to
+ * its anchor when it is ahead, so the 16-bit counter on each frame is
+ * rebuilt correctly after any gap in reception.
+ *
+ * Call from the hub task only.
+ */
+
+// Encrypted payload: counter (low 16 bits, little-endian), ciphertext, tag
+#define HRMS_KEYSTREAM_HEADER_SIZE  2
+#if HRMS_KEYSTREAM_AUTH
+#define HRMS_KEYSTREAM_TAG_SIZE     HRMS_KEYSTREAM_TAG_BYTES
+#else
+#define HRMS_KEYSTREAM_TAG_SIZE     0
+#endif
+#define HRMS_KEYSTREAM_OVERHEAD     (HRMS_KEYSTREAM_HEADER_SIZE + HRMS_KEYSTREAM_TAG_SIZE)
+#define HRMS_KEYSTREAM_MAX_DATA     (HRMS_WIRE_MAX_PAYLOAD_SIZE - HRMS_KEYSTREAM_OVERHEAD)
+#define HRMS_KEYSTREAM_KEY_SIZE     HRMS_CIPHER_KEY_SIZE
+#define HRMS_KEYSTREAM_SEED_SIZE    32    // Boot seed bytes (hrms_board_seed())
+
+// Session frame payload: nonce, own challenge, peer challenge echoed,
+// counter of the next frame sent, tag
+#define HRMS_KEYSTREAM_NONCE_BYTES  7     // Random part of the cipher nonce, rest zero
+#define HRMS_KEYSTREAM_SESSION_SIZE (HRMS_KEYSTREAM_NONCE_BYTES + 12 + HRMS_KEYSTREAM_TAG_SIZE)
+
+// Per counter: data keystream first, Poly1305 one-time key from byte 32
+#define HRMS_KEYSTREAM_MAC_KEY_OFFSET 32
+#if HRMS_KEYSTREAM_AUTH
+#define HRMS_KEYSTREAM_BLOCK_SIZE   (HRMS_KEYSTREAM_MAC_KEY_OFFSET + HRMS_POLY1305_KEY_SIZE)
+#else
+#define HRMS_KEYSTREAM_BLOCK_SIZE   HRMS_KEYSTREAM_MAX_DATA
+#endif
+
+// Outcome of hrms_keystream_session_receive()
+typedef enum {
+  HRMS_KEYSTREAM_SESSION_INVALID = 0, // Bad size or tag, or our own nonce reflected
+  HRMS_KEYSTREAM_SESSION_CURRENT,     // Peer session already in use
+  HRMS_KEYSTREAM_SESSION_CHALLENGE,   // Stale echo - announce so the peer gets our challenge
+  HRMS_KEYSTREAM_SESSION_NEW          // Peer session taken - announce so the peer can take ours
+} hrms_keystream_session_t;
+
+typedef struct {
+  uint32_t hits;             // Frames encrypted from the ring
+  uint32_t misses;           // Frames whose block was computed on the spot
+  uint32_t blocks_generated; // Blocks computed ahead by refill
+  uint32_t last_encrypt_cycles; // DWT cycles of the latest encryption
+  uint32_t replayed;         // Frames refused by the replay window
+  uint32_t auth_failed;      // Frames refused on a tag mismatch or without a session
+  uint32_t sessions;         // Peer sessions taken
+} hrms_keystream_stats_t;
+
+typedef struct {
+  uint32_t seal_cycles;      // Block computed for the frame, then XOR and tag (no cache)
+  uint32_t seal_cached_cycles; // XOR and tag against a ready block
+  uint32_t open_cycles;      // Block computed, tag checked, XOR (what decrypt does)
+  uint32_t open_cached_cycles; // Tag checked and XOR against a ready block
+  uint32_t refill_cycles;    // One block computed ahead
+  bool open_ok;              // The sealed frame opened again
+} hrms_keystream_bench_t;
+
+// Keystream for one counter
+typedef struct {
+  uint8_t bytes[HRMS_KEYSTREAM_BLOCK_SIZE];
+  uint32_t counter;
+} hrms_keystream_block_t;
+
+// One end of the link: its own session for sending, the peer's for receiving
+typedef struct {
+  uint8_t key[HRMS_KEYSTREAM_KEY_SIZE];
+  uint8_t nonce[HRMS_KEYSTREAM_NONCE_BYTES];
+  hrms_cipher_ctx_t tx_ctx;
+  hrms_keystream_block_t ring[HRMS_KEYSTREAM_DEPTH];
+  uint8_t ring_head;
+  uint8_t ring_count;
+  uint32_t tx_counter;       // Counter of the next frame sent
+  uint32_t challenge;        // The peer must echo this to start a session
+  uint32_t challenges_used;
+  uint32_t peer_challenge;   // Echoed in our announcements
+
+  uint8_t peer_nonce[HRMS_KEYSTREAM_NONCE_BYTES];
+  hrms_cipher_ctx_t rx_ctx;
+  bool peer_ready;
+  uint32_t rx_highest;       // Bit n of rx_window: counter rx_highest - n accepted
+  uint32_t rx_window[2];
+
+  hrms_keystream_stats_t stats;
+} hrms_keystream_t;
+
+/**
+ * Start a new session: nonce and challenge from the seed, counters at zero,
+ * ring empty, no peer session
+ * @param ks Keystream state
+ * @param key HRMS_KEYSTREAM_KEY_SIZE bytes, shared with the peer
+ * @param seed HRMS_KEYSTREAM_SEED_SIZE bytes unique to this boot
+ */
+void hrms_keystream_init(hrms_keystream_t *ks, const uint8_t *key, const uint8_t *seed);
+
+/**
+ * Compute blocks for the next counters into free ring slots
+ * @param ks Keystream state
+ * @param max_blocks Upper bound on blocks computed by this call
+ * @return Number of blocks computed
+ */
+uint8_t hrms_keystream_refill(hrms_keystream_t *ks, uint8_t max_blocks);
+
+/**
+ * Check whether the ring holds a block for the next frame
+ * @param ks Keystream state
+ * @return true if the next hrms_keystream_encrypt() is a hit
+ */
+bool hrms_keystream_ready(const hrms_keystream_t *ks);
+
+/**
+ * Encrypt and tag one frame payload with the next counter
+ * @param ks Keystream state
+ * @param ad Associated data, authenticated but not sent here (may be NULL if ad_len is 0)
+ * @param ad_len Associated data length
+ * @param plaintext Bytes to encrypt
+ * @param len Length (up to HRMS_KEYSTREAM_MAX_DATA)
+ * @param out Buffer for counter header, ciphertext and tag
+ * @param max_len Buffer size
+ * @return Bytes written (len + HRMS_KEYSTREAM_OVERHEAD), 0 on invalid input
+ */
+size_t hrms_keystream_encrypt(hrms_keystream_t *ks, const uint8_t *ad, size_t ad_len,
+                              const uint8_t *plaintext, size_t len,
+                              uint8_t *out, size_t max_len);
+
+/**
+ * Check and decrypt a payload the peer built with hrms_keystream_encrypt()
+ * @param ks Keystream state
+ * @param ad Associated data, as passed to the sender
+ * @param ad_len Associated data length
+ * @param payload Counter header, ciphertext and tag
+ * @param len Payload length
+ * @param out Buffer for the plaintext
+ * @param max_len Buffer size
+ * @param counter Receives the rebuilt 32-bit counter (may be NULL)
+ * @return Plaintext length, 0 on invalid input, no session, replay or tag mismatch
+ */
+size_t hrms_keystream_decrypt(hrms_keystream_t *ks, const uint8_t *ad, size_t ad_len,
+                              const uint8_t *payload, size_t len,
+                              uint8_t *out, size_t max_len, uint32_t *counter);
+
+/**
+ * Build the session frame payload announcing this end's session
+ * @param ks Keystream state
+ * @param ad Associated data (the wire header, final payload size included)
+ * @param ad_len Associated data length
+ * @param out Buffer for HRMS_KEYSTREAM_SESSION_SIZE bytes
+ * @param max_len Buffer size
+ * @return Bytes written, 0 on invalid input
+ */
+size_t hrms_keystream_session_build(hrms_keystream_t *ks, const uint8_t *ad, size_t ad_len,
+                                    uint8_t *out, size_t max_len);
+
+/**
+ * Check a session frame from the peer and take its session if it answers
+ * the current challenge
+ * @param ks Keystream state
+ * @param ad Associated data, as passed to the sender
+ * @param ad_len Associated data length
+ * @param payload Session frame payload
+ * @param len Payload length
+ * @return What happened, see hrms_keystream_session_t
+ */
+hrms_keystream_session_t hrms_keystream_session_receive(hrms_keystream_t *ks,
+                                                        const uint8_t *ad, size_t ad_len,
+                                                        const uint8_t *payload, size_t len);
+
+/**
+ * Get keystream statistics
+ * @param ks Keystream state
+ * @param stats Pointer to store statistics
+ */
+void hrms_keystream_get_stats(const hrms_keystream_t *ks, hrms_keystream_stats_t *stats);
+
+/**
+ * Measure DWT cycles of sealing and opening one frame, with the keystream
+ * block computed for the frame and ready in advance
+ * Uses a scratch counter; the ring and counters are left untouched
+ * @param ks Keystream state
+ * @param len Payload length to encrypt (up to HRMS_KEYSTREAM_MAX_DATA)
+ * @param result Pointer to store cycle counts
+ */
+void hrms_keystream_benchmark(const hrms_keystream_t *ks, size_t len, hrms_keystream_bench_t *result);
+
+#endif /* HRMS_KEYSTREAM_H */
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+#ifndef HRMS_LATENCY_H
+#define HRMS_LATENCY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @file hrms_latency.h
+ * @brief Radio round-trip probes, RTT histogram and peer clock offset
+ *
+ * The transmitter sends a HRMS_COMM_PACKET_PROBE request stamped with its
+ * DWT cycle counter (t1). The receiver stamps the arrival (t2) and its
+ * reply (t3) with its own counter and echoes all three. On arrival of the
+ * reply (t4):
+ *
+ *   rtt    = (t4 - t1) - (t3 - t2)      receiver turnaround removed
+ *   offset = t2 - t1 - rtt / 2          receiver clock minus ours
+ *
+ * RTTs go into a histogram of HRMS_LATENCY_BUCKET_US buckets. The offset
+ * is taken from the fastest of the last HRMS_LATENCY_OFFSET_WINDOW probes,
+ * since queueing only ever adds delay to one leg.
+ *
+ * The reply also names the last control frame the receiver got and when
+ * it got it. With the offset, that gives the one-way latency from the
+ * stick sample to the receiver. The accuracy is bounded by the 1 ms tick
+ * of the sample timestamp and by crystal drift over the offset window.
+ * Both ends count cycles at SystemCoreClock.
+ */
+
+// Probe packet payload (HRMS_COMM_PACKET_PROBE), all fields little-endian
+#define HRMS_LATENCY_OP_REQUEST     0x01
+#define HRMS_LATENCY_OP_REPLY       0x02
+#define HRMS_LATENCY_REQUEST_SIZE   5     // op, t1
+#define HRMS_LATENCY_REPLY_SIZE     13    // op, t1, t2, t3
+#define HRMS_LATENCY_REPLY_CTRL_SIZE 18   // ... control packet_id, its arrival time
+
+typedef struct {
+  uint32_t probes;           // Requests sent
+  uint32_t replies;          // Matching replies received
+  uint32_t rtt_min_us;
+  uint32_t rtt_median_us;    // Histogram bucket upper edge
+  uint32_t rtt_p99_us;       // Histogram bucket upper edge
+  uint32_t rtt_max_us;
+  bool offset_valid;
+  uint32_t offset_cycles;    // Peer cycle counter minus ours (modulo 2^32)
+  uint32_t one_way_samples;  // Control frames with a one-way measurement
+  uint32_t one_way_us;       // Latest one-way latency
+  uint32_t one_way_max_us;
+} hrms_latency_stats_t;
+
+/**
+ * Clear the histogram, offset estimate and control frame history
+ */
+void hrms_latency_init(void);
+
+/**
+ * Build a probe request stamped with the current cycle count
+ * @param payload Buffer for the payload
+ * @param max_len Buffer size
+ * @return Payload length, 0 if the buffer is too small
+ */
+size_t hrms_latency_make_request(uint8_t *payload, size_t max_len);
+
+/**
+ * Build the reply to a peer's probe request (receiver side)
+ * @param request Request payload
+ * @param len Request length
+ * @param rx_cycles Cycle count when the request arrived
+ * @param payload Buffer for the reply
+ * @param max_len Buffer size
+ * @return Reply length, 0 if the request is malformed or the buffer too small
+ */
+size_t hrms_latency_make_reply(const uint8_t *request, size_t len, uint32_t rx_cycles,
+                               uint8_t *payload, size_t max_len);
+
+/**
+ * Account a probe reply (transmitter side)
+ * @param payload Reply payload
+ * @param len Reply length
+ * @param rx_cycles Cycle count when the reply arrived
+ * @return true if it answered the outstanding probe
+ */
+bool hrms_latency_on_reply(const uint8_t *payload, size_t len, uint32_t rx_cycles);
+
+/**
+ * Remember when the sample in a control frame was taken (transmitter side)
+ * @param packet_id Frame packet_id
+ * @param sample_cycles Cycle count at which its (first) sample was taken
+ */
+void hrms_latency_on_control_tx(uint8_t packet_id, uint32_t sample_cycles);
+
+/**
+ * Remember the latest control frame arrival for the next reply (receiver side)
+ * @param packet_id Frame packet_id
+ * @param rx_cycles Cycle count when it arrived
+ */
+void hrms_latency_on_control_rx(uint8_t packet_id, uint32_t rx_cycles);
+
+/**
+ * Get latency statistics
+ * @param stats Pointer to store statistics
+ */
+void hrms_latency_get_stats(hrms_latency_stats_t *stats);
+
+/**
+ * Print the statistics and the RTT histogram on the debug UART
+ */
+void hrms_latency_dump(void);
+
+#endif /* HRMS_LATENCY_H */
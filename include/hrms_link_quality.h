@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+#ifndef HRMS_LINK_QUALITY_H
+#define HRMS_LINK_QUALITY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hrms_nrf24l01.h"
+
+/**
+ * @file hrms_link_quality.h
+ * @brief Radio link-quality estimator and adaptive data rate / TX power
+ *
+ * Keeps moving averages (Q8 fixed point, 256 = 1.0) of frame loss and
+ * retransmits per frame. From those it walks a rate ladder
+ * 2 Mbps <-> 1 Mbps <-> 250 kbps and trims TX power on a strong link.
+ *
+ * Power is local and applied directly. A data-rate change must be agreed
+ * with the receiver: the transmitter sends a HRMS_COMM_PACKET_LINK switch
+ * request at the current rate, and both ends switch once it is ACKed.
+ * With HRMS_KEYSTREAM_CACHE the request is sealed like a control frame;
+ * the receiver drops one that fails the tag or replay check.
+ * If that goes wrong, both ends fall back to the rendezvous rate and
+ * channel (the boot defaults). The transmitter does so after HRMS_LINK_FAIL_REVERT
+ * consecutive failures; either end does so after HRMS_LINK_IDLE_REVERT_MS
+ * without traffic.
+ */
+
+// Link packet payload (HRMS_COMM_PACKET_LINK)
+#define HRMS_LINK_OP_SWITCH_RATE    0x01
+#define HRMS_LINK_OP_SWITCH_CHANNEL 0x02
+#define HRMS_LINK_SWITCH_SIZE       2     // op, datarate or channel
+
+// RF settings chosen by the estimator
+typedef struct {
+  nrf24l01_datarate_t datarate;
+  nrf24l01_power_t power;
+  uint8_t channel;
+} hrms_link_rf_t;
+
+// Decision returned by hrms_link_quality_evaluate()
+typedef enum {
+  HRMS_LINK_KEEP = 0,        // Nothing to do
+  HRMS_LINK_APPLY_LOCAL,     // Apply directly (power change or rendezvous fallback)
+  HRMS_LINK_APPLY_COORDINATED // Rate change - send a switch request first
+} hrms_link_decision_t;
+
+typedef struct {
+  uint16_t loss_q8;          // Moving frame loss ratio (256 = every frame lost)
+  uint16_t retries_q8;       // Moving retransmits per frame (Q8)
+  uint32_t frames;           // Frames observed since init
+  uint32_t rate_switches;    // Committed data-rate changes
+  hrms_link_rf_t rf;         // Settings currently in use
+} hrms_link_quality_stats_t;
+
+/**
+ * Initialize the estimator
+ * @param rendezvous Boot RF settings; its data rate and channel are the fallback
+ */
+void hrms_link_quality_init(const hrms_link_rf_t *rendezvous);
+
+/**
+ * Record the outcome of one transmitted frame
+ * @param delivered true if the frame was ACKed (TX_DS), false on MAX_RT
+ * @param retransmits ARC_CNT from OBSERVE_TX for this frame
+ * @param now_ms Current time in milliseconds
+ */
+void hrms_link_quality_on_tx(bool delivered, uint8_t retransmits, uint32_t now_ms);
+
+/**
+ * Record a valid frame received from the peer (keeps the idle timer fresh)
+ * @param now_ms Current time in milliseconds
+ */
+void hrms_link_quality_on_rx(uint32_t now_ms);
+
+/**
+ * Decide whether the RF settings should change
+ * @param next Filled with the proposed settings when the result is not KEEP
+ * @param now_ms Current time in milliseconds
+ * @return Decision and how it must be applied
+ */
+hrms_link_decision_t hrms_link_quality_evaluate(hrms_link_rf_t *next, uint32_t now_ms);
+
+/**
+ * Record that new RF settings are now in use and restart the estimate
+ * @param rf Settings applied to the radio
+ * @param now_ms Current time in milliseconds
+ */
+void hrms_link_quality_commit(const hrms_link_rf_t *rf, uint32_t now_ms);
+
+/**
+ * Get estimator statistics
+ * @param stats Pointer to store statistics
+ */
+void hrms_link_quality_get_stats(hrms_link_quality_stats_t *stats);
+
+#endif /* HRMS_LINK_QUALITY_H */
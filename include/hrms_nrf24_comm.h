@@ -13,6 +13,9 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "hrms_nrf24l01.h"
 
 /**
  * @file hrms_nrf24_comm.h
@@ -30,12 +33,57 @@ bool hrms_nrf24_comm_init(void);
 
 /**
  * Send data via nRF24L01
+ * In the ack-payload PRX role the data is loaded to ride the next auto-ACK
+ * on the pipe that received last, and true only means it was loaded.
  * @param data Pointer to data to send
  * @param len Length of data in bytes
  * @return true if send successful, false otherwise
  */
 bool hrms_nrf24_comm_send(const uint8_t *data, size_t len);
 
+/**
+ * Change data rate and TX power on the fly (link adaptation)
+ * @param datarate New air data rate
+ * @param power New TX power level
+ */
+void hrms_nrf24_comm_set_rf(nrf24l01_datarate_t datarate, nrf24l01_power_t power);
+
+/**
+ * Move the link to another RF channel (ignored while frequency hopping)
+ * @param channel RF channel (0-125)
+ */
+void hrms_nrf24_comm_set_channel(uint8_t channel);
+
+/**
+ * Queue data in the radio TX FIFO without blocking (pipelined bursts)
+ * Not available in the ack-payload PRX role, which never leaves RX mode.
+ * @param data Pointer to data to send
+ * @param len Length of data in bytes (max 32)
+ * @param tag Caller tag reported to the TX callback on completion
+ * @return true if queued, false if the FIFO is full
+ */
+bool hrms_nrf24_comm_enqueue(const uint8_t *data, size_t len, uint8_t tag);
+
+/**
+ * Check whether pipelined payloads are still in the TX FIFO
+ * @return true while a burst is in flight (hrms_nrf24_comm_send() refuses then)
+ */
+bool hrms_nrf24_comm_tx_busy(void);
+
+/**
+ * Register the completion callback for pipelined sends
+ * @param callback Called from hrms_nrf24_comm_process() once per payload
+ */
+void hrms_nrf24_comm_set_tx_callback(nrf24l01_tx_callback_t callback);
+
+/**
+ * Queue data to return with the next auto-ACK (receiver role, ack-payload mode)
+ * @param data Pointer to data to return
+ * @param len Length of data in bytes (max 32)
+ * @return true if the payload was loaded into the TX FIFO
+ */
+bool hrms_nrf24_comm_set_ack_payload(const uint8_t *data, size_t len);
+
 /**
  * Receive data via nRF24L01
  * @param data Buffer to store received data
@@ -45,6 +93,37 @@ bool hrms_nrf24_comm_send(const uint8_t *data, size_t len);
  */
 bool hrms_nrf24_comm_receive(uint8_t *data, size_t max_len, size_t *received_len);
 
+/**
+ * Receive data and report the RX pipe (star source) it arrived on
+ * @param data Buffer to store received data
+ * @param max_len Maximum buffer size
+ * @param received_len Pointer to store actual received length
+ * @param pipe Set to the RX pipe (0-5); may be NULL
+ * @return true if data received, false otherwise
+ */
+bool hrms_nrf24_comm_receive_from(uint8_t *data, size_t max_len, size_t *received_len,
+                                  uint8_t *pipe);
+
+/**
+ * Get when the payload just received reached the radio (RX IRQ edge)
+ * @param cycles Set to the DWT cycle count
+ * @return false if there was no edge for it (drained behind another payload)
+ */
+bool hrms_nrf24_comm_rx_stamp(uint32_t *cycles);
+
+/**
+ * Route radio IRQ events to the task that owns the radio
+ * @param task Communication hub task handle
+ */
+void hrms_nrf24_comm_set_task(TaskHandle_t task);
+
+/**
+ * Block until the radio raises an interrupt or the timeout expires
+ * @param timeout_ms Maximum time to wait
+ * @return true if RX data is pending
+ */
+bool hrms_nrf24_comm_wait(uint32_t timeout_ms);
+
 /**
  * Process nRF24L01 periodic tasks
  * Should be called regularly from communication hub task
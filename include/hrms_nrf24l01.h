@@ -12,6 +12,8 @@
 
 
 #include "hrms_types.h"
+#include "FreeRTOS.h"
+#include "task.h"
 #include <stdbool.h>
 #include <stdint.h>
 
@@ -19,6 +21,9 @@
 #define NRF24L01_MAX_PAYLOAD_SIZE 32
 #define NRF24L01_ADDR_WIDTH 5
 #define NRF24L01_MAX_CHANNEL 125
+#define NRF24L01_TX_FIFO_DEPTH 3
+#define NRF24L01_TX_PIPELINE_DEPTH 2  // Pipelined payloads in flight (one on air, one behind)
+#define NRF24L01_RX_PIPES 6
 
 // nRF24L01 Register Map
 #define NRF24L01_REG_CONFIG         0x00
@@ -45,6 +50,8 @@
 #define NRF24L01_REG_RX_PW_P4       0x15
 #define NRF24L01_REG_RX_PW_P5       0x16
 #define NRF24L01_REG_FIFO_STATUS    0x17
+#define NRF24L01_REG_DYNPD          0x1C
+#define NRF24L01_REG_FEATURE        0x1D
 
 // nRF24L01 Commands
 #define NRF24L01_CMD_R_REGISTER     0x00
@@ -54,6 +61,9 @@
 #define NRF24L01_CMD_FLUSH_TX       0xE1
 #define NRF24L01_CMD_FLUSH_RX       0xE2
 #define NRF24L01_CMD_REUSE_TX_PL    0xE3
+#define NRF24L01_CMD_ACTIVATE       0x50  // nRF24L01 (non-plus): unlock FEATURE/DYNPD
+#define NRF24L01_CMD_R_RX_PL_WID    0x60
+#define NRF24L01_CMD_W_ACK_PAYLOAD  0xA8  // | pipe number
 #define NRF24L01_CMD_NOP            0xFF
 
 // Status register bits
@@ -62,11 +72,35 @@
 #define NRF24L01_STATUS_MAX_RT      0x10
 #define NRF24L01_STATUS_RX_P_NO     0x0E
 #define NRF24L01_STATUS_TX_FULL     0x01
+#define NRF24L01_STATUS_RX_P_NO_EMPTY 0x0E  // RX_P_NO value when RX FIFO is empty
+
+// OBSERVE_TX register fields
+#define NRF24L01_OBSERVE_PLOS_CNT   0xF0  // Lost packets (reset by RF_CH write)
+#define NRF24L01_OBSERVE_ARC_CNT    0x0F  // Retransmits of the last packet
+
+// RPD register: received power above -64 dBm on the current channel
+#define NRF24L01_RPD_DETECTED       0x01
+
+// FIFO_STATUS register bits
+#define NRF24L01_FIFO_TX_FULL       0x20
+#define NRF24L01_FIFO_TX_EMPTY      0x10
+#define NRF24L01_FIFO_RX_FULL       0x02
+#define NRF24L01_FIFO_RX_EMPTY      0x01
+
+// FEATURE register bits
+#define NRF24L01_FEATURE_EN_DPL     0x04
+#define NRF24L01_FEATURE_EN_ACK_PAY 0x02
+#define NRF24L01_FEATURE_EN_DYN_ACK 0x01
 
 // Config register bits
 #define NRF24L01_CONFIG_PWR_UP      0x02
 #define NRF24L01_CONFIG_PRIM_RX     0x01
 
+// Task notification bit set by the IRQ pin (PB10) interrupt
+#define HRMS_NRF24L01_NOTIFY_IRQ    (1UL << 0)
+// Task notification bit set by the TIM2 one-shot when a scanned channel has settled
+#define HRMS_NRF24L01_NOTIFY_SCAN   (1UL << 1)
+
 // Power and data rate options
 typedef enum {
   NRF24L01_POWER_0DBM = 0,
@@ -90,8 +124,31 @@ typedef struct {
   bool auto_ack;                        // Enable auto-acknowledgment
   uint8_t retries;                      // Number of retries (0-15)
   uint8_t retry_delay;                  // Retry delay (0-15, in 250us steps)
+  bool dynamic_payload;                 // Variable-length payloads (DPL) on pipe 0
+  bool ack_payload;                     // Return data piggybacked on auto-ACK (needs auto_ack + DPL)
+  uint8_t rx_pipes;                     // Pipes to open (1-6, 0 = 1); pipe n listens on
+                                        // hrms_nrf24l01_pipe_address(address, n)
 } nrf24l01_config_t;
 
+// Single-payload TX state machine (hrms_nrf24l01_send_async)
+typedef enum {
+  NRF24L01_TX_IDLE = 0,
+  NRF24L01_TX_LOAD,       // Payload in the FIFO, waiting for the radio to settle
+  NRF24L01_TX_PULSE,      // CE high; the one-shot timer ends the pulse
+  NRF24L01_TX_WAIT_ACK,   // On air until TX_DS or MAX_RT
+  NRF24L01_TX_DONE,       // IRQ seen, result not collected yet
+  NRF24L01_TX_STATE_COUNT
+} nrf24l01_tx_state_t;
+
+typedef struct {
+  uint32_t time_us[NRF24L01_TX_STATE_COUNT]; // Time spent in each state
+  uint32_t frames;                           // Sends completed (either result)
+} nrf24l01_tx_timing_t;
+
+// Completion callback for pipelined payloads, called in FIFO order from
+// hrms_nrf24l01_process_tx() (task context)
+typedef void (*nrf24l01_tx_callback_t)(uint8_t tag, bool success);
+
 /**
  * @brief Initialize nRF24L01 module
  * @return true if initialization successful, false otherwise
@@ -105,6 +162,56 @@ bool hrms_nrf24l01_init(void);
  */
 bool hrms_nrf24l01_configure(const nrf24l01_config_t *config);
 
+/**
+ * @brief Change data rate and TX power without a full reconfigure
+ * @param datarate New air data rate (the peer must match)
+ * @param power New TX power level
+ */
+void hrms_nrf24l01_set_rf(nrf24l01_datarate_t datarate, nrf24l01_power_t power);
+
+/**
+ * @brief Change RF channel without a full reconfigure
+ * @param channel RF channel (0-125); also resets PLOS_CNT
+ */
+void hrms_nrf24l01_set_channel(uint8_t channel);
+
+/**
+ * @brief Read OBSERVE_TX (PLOS_CNT | ARC_CNT) for the last transmission
+ * @return Raw OBSERVE_TX register value
+ */
+uint8_t hrms_nrf24l01_get_observe_tx(void);
+
+/**
+ * @brief Sweep channels 0-125 in RX mode and sample the RPD register
+ * @param hits Array of NRF24L01_MAX_CHANNEL+1 entries, filled with the
+ *             number of samples per channel that saw a carrier
+ * @param samples RPD reads per channel
+ * @return Sweep time in microseconds, 0 if a transmission is in progress
+ *
+ * Each channel costs the 170us RX/AGC settle plus the reads. Once the
+ * scheduler runs, the calling task sleeps through the settle on a TIM2
+ * one-shot (HRMS_NRF24L01_NOTIFY_SCAN) and only the reads use the CPU.
+ * Before that, or with TIM2 busy, it busy-waits.
+ * The previous channel and RX/TX mode are restored afterwards.
+ */
+uint32_t hrms_nrf24l01_scan(uint8_t *hits, uint8_t samples);
+
+/**
+ * @brief Deliver IRQ pin events to a task as notifications
+ * @param task Task that runs the radio (NULL falls back to STATUS polling)
+ *
+ * The interrupt only sets HRMS_NRF24L01_NOTIFY_IRQ; STATUS is decoded in
+ * task context because SPI cannot be used from the ISR.
+ */
+void hrms_nrf24l01_set_irq_task(TaskHandle_t task);
+
+/**
+ * @brief Block the IRQ task until the radio asserts IRQ
+ * @param timeout_ms Maximum time to wait
+ * @return STATUS interrupt flags (RX_DR/TX_DS/MAX_RT) pending after the wait
+ */
+uint8_t hrms_nrf24l01_wait_irq(uint32_t timeout_ms);
+
 /**
  * @brief Send data packet
  * @param data Pointer to data to send
@@ -113,6 +220,103 @@ bool hrms_nrf24l01_configure(const nrf24l01_config_t *config);
  */
 bool hrms_nrf24l01_send(const uint8_t *data, uint8_t length);
 
+/**
+ * @brief Start sending one payload and return immediately
+ * @param data Pointer to data to send
+ * @param length Length of data (max 32 bytes)
+ * @return true if started, false if a send or burst is in progress
+ *
+ * Mode settle, power-up and CE pulse waits run on the one-shot timer, so
+ * the caller is free until TX_DS/MAX_RT raises IRQ. Collect the outcome
+ * with hrms_nrf24l01_send_result().
+ */
+bool hrms_nrf24l01_send_async(const uint8_t *data, uint8_t length);
+
+/**
+ * @brief Collect the outcome of hrms_nrf24l01_send_async()
+ * @param success Set to true if the payload was ACKed
+ * @return true if the send finished (state back to IDLE), false if still running
+ */
+bool hrms_nrf24l01_send_result(bool *success);
+
+/**
+ * @brief Abandon a running send and flush its payload
+ */
+void hrms_nrf24l01_send_abort(void);
+
+/**
+ * @brief Current state of the single-payload TX state machine
+ */
+nrf24l01_tx_state_t hrms_nrf24l01_tx_state(void);
+
+/**
+ * @brief Get time spent per TX state since init
+ * @param timing Pointer to store the timing counters
+ */
+void hrms_nrf24l01_get_tx_timing(nrf24l01_tx_timing_t *timing);
+
+/**
+ * @brief Take the cycle count of the latest RX interrupt edge
+ * Free of task wake-up delay, unlike a timestamp taken when the payload is
+ * read. Cleared once taken, so payloads drained behind the first get none.
+ * @param cycles Set to the DWT cycle count (may be NULL)
+ * @return false if no RX edge was seen since the last call
+ */
+bool hrms_nrf24l01_take_rx_stamp(uint32_t *cycles);
+
+/**
+ * @brief Load a payload into the TX FIFO without waiting for it to be sent
+ * @param data Pointer to data to send
+ * @param length Length of data (max 32 bytes)
+ * @param tag Caller tag reported back through the TX callback
+ * @return true if queued, false if NRF24L01_TX_PIPELINE_DEPTH payloads are
+ *         already in flight or input is invalid
+ *
+ * CE stays high while payloads are pending, so queued payloads go out
+ * back-to-back at the air data rate. Two in flight are enough to keep the
+ * radio busy and keep the completion flags unambiguous. Do not mix with
+ * hrms_nrf24l01_send().
+ */
+bool hrms_nrf24l01_enqueue(const uint8_t *data, uint8_t length, uint8_t tag);
+
+/**
+ * @brief Retire completed pipelined payloads and report them
+ *
+ * Call after an IRQ wake-up or periodically. A payload that hits MAX_RT
+ * stalls the FIFO, so the FIFO is flushed: payloads ACKed before it are
+ * reported as sent, it and the ones queued behind it as failed.
+ */
+void hrms_nrf24l01_process_tx(void);
+
+/**
+ * @brief Number of pipelined payloads still in flight (0-NRF24L01_TX_PIPELINE_DEPTH)
+ */
+uint8_t hrms_nrf24l01_tx_pending(void);
+
+/**
+ * @brief Set the pipelined TX completion callback
+ * @param callback Function called once per enqueued payload (NULL to disable)
+ */
+void hrms_nrf24l01_set_tx_callback(nrf24l01_tx_callback_t callback);
+
+/**
+ * @brief Queue a payload to be returned with the next auto-ACK on a pipe
+ * @param pipe RX pipe number (0-5)
+ * @param data Pointer to data to return
+ * @param length Length of data (max 32 bytes)
+ * @return true if the payload was loaded, false otherwise
+ *
+ * Receiver side of ack-payload mode; the transmitter finds the data in its
+ * RX FIFO together with TX_DS and reads it with hrms_nrf24l01_receive().
+ */
+bool hrms_nrf24l01_write_ack_payload(uint8_t pipe, const uint8_t *data, uint8_t length);
+
+/**
+ * @brief Acknowledge that a loaded ack payload went out (receiver side)
+ * @return true if TX_DS was set; it is cleared so the IRQ line can fall again
+ */
+bool hrms_nrf24l01_ack_payload_sent(void);
+
 /**
  * @brief Check if data is available to receive
  * @return true if data is available, false otherwise
@@ -127,6 +331,27 @@ bool hrms_nrf24l01_available(void);
  */
 uint8_t hrms_nrf24l01_receive(uint8_t *data, uint8_t max_length);
 
+/**
+ * @brief Receive data packet and report the pipe it arrived on
+ * @param data Pointer to buffer to store received data
+ * @param max_length Maximum length of buffer
+ * @param pipe Set to the RX pipe (0-5) of the payload; may be NULL
+ * @return Number of bytes received, 0 if no data available
+ */
+uint8_t hrms_nrf24l01_receive_from(uint8_t *data, uint8_t max_length, uint8_t *pipe);
+
+/**
+ * @brief Derive the address of an RX pipe from a base address
+ * @param base Base address (LSByte first); pipe 0 uses it unchanged
+ * @param pipe Pipe number (0-5)
+ * @param address Receives the 5-byte pipe address
+ *
+ * Pipes 1-5 must share their upper four bytes, so only the LSByte varies
+ * (base[0] + pipe). A transmitter that is node n of a star uses pipe n's
+ * address as both TX_ADDR and RX_ADDR_P0.
+ */
+void hrms_nrf24l01_pipe_address(const uint8_t *base, uint8_t pipe, uint8_t *address);
+
 /**
  * @brief Set module to receive mode
  */
@@ -164,6 +389,16 @@ void hrms_nrf24l01_power_down(void);
  */
 void hrms_nrf24l01_power_up(void);
 
+/**
+ * @brief Compare the driver's register shadow against the chip
+ * @return true if every cached register matches; mismatches are resynced
+ *
+ * Single-byte writable registers are cached so mode switches are
+ * write-only and redundant writes are skipped. Use this in debug builds
+ * (HRMS_NRF24_SHADOW_VERIFY) to catch a chip reset behind the driver's back.
+ */
+bool hrms_nrf24l01_verify_shadow(void);
+
 /**
  * @brief Perform self-test with LED feedback
  * @return true if all tests pass, false otherwise
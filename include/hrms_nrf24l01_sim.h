@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+#ifndef HRMS_NRF24L01_SIM_H
+#define HRMS_NRF24L01_SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @file hrms_nrf24l01_sim.h
+ * @brief Register-level nRF24L01+ simulator with radios sharing a virtual ether
+ *
+ * Selected with HRMS_NRF24_SPI_TRANSPORT == HRMS_NRF24_SPI_SIM. The driver
+ * then talks to simulated radio HRMS_NRF24_SIM_LOCAL instead of SPI2. The
+ * other radios are driven through the same command interface by the
+ * caller, e.g. a host harness acting as the receiver, or as the six
+ * transmitters of a star around a local base station.
+ *
+ * The model covers:
+ * - the register file, 3-deep TX/RX FIFOs and STATUS/FIFO_STATUS/OBSERVE_TX
+ * - dynamic payloads, ack payloads and NOACK payloads
+ * - auto-ACK with ARD/ARC retransmit timing
+ * - air time per data rate, and the IRQ line
+ *
+ * Frames only reach radios on the same channel, data rate and address.
+ * Overlapping frames from different transmitters do not collide.
+ * The ether drops frames (data and ACK) with the configured probability,
+ * plus any per-channel loss, and adds a fixed latency. RPD reports a
+ * carrier while another radio transmits on the channel, and for the
+ * channel's loss share of the time (an interferer).
+ *
+ * The simulator has no thread. Pending air events run lazily up to the
+ * current time on every call. Time comes from the clock callback, or from
+ * hrms_nrf24_sim_advance() if no callback is installed. A host harness
+ * typically backs both hrms_delay_us() and the clock with one virtual
+ * counter, so the driver's polling waits move simulated time forward.
+ */
+
+#define HRMS_NRF24_SIM_RADIOS       7     // Base station plus a full six-pipe star
+#define HRMS_NRF24_SIM_LOCAL        0     // Radio driven by hrms_nrf24l01.c
+#define HRMS_NRF24_SIM_PEER         1     // First of the other radios
+
+// Shared medium parameters
+typedef struct {
+  uint16_t loss_permille;    // Probability of losing any frame (0-1000)
+  uint32_t latency_us;       // Extra propagation/processing delay per frame
+  uint32_t seed;             // Loss generator seed (0 picks a fixed default)
+} hrms_nrf24_sim_ether_t;
+
+typedef struct {
+  uint32_t frames_on_air;    // Data frames transmitted, retransmits included
+  uint32_t frames_lost;      // Data frames dropped by the ether
+  uint32_t acks_lost;        // ACKs dropped by the ether
+  uint32_t delivered;        // Payloads acknowledged (or sent NOACK)
+  uint32_t max_rt;           // Payloads that ran out of retransmits
+  uint32_t air_time_us;      // Total data + ACK air time
+  uint32_t latency_sum_us;   // Sum of TX FIFO write -> TX_DS latencies
+  uint32_t latency_max_us;   // Worst TX FIFO write -> TX_DS latency
+} hrms_nrf24_sim_stats_t;
+
+/**
+ * Reset all radios to chip power-on values and set the ether
+ * @param ether Medium parameters, or NULL for a lossless, zero-latency ether
+ */
+void hrms_nrf24_sim_init(const hrms_nrf24_sim_ether_t *ether);
+
+/**
+ * Change medium parameters without resetting the radios
+ * @param ether Medium parameters
+ */
+void hrms_nrf24_sim_set_ether(const hrms_nrf24_sim_ether_t *ether);
+
+/**
+ * Add loss on one RF channel on top of the ether loss (interferer model)
+ * @param channel RF channel (0-125)
+ * @param loss_permille Probability of losing a frame on that channel (0-1000)
+ */
+void hrms_nrf24_sim_set_channel_loss(uint8_t channel, uint16_t loss_permille);
+
+/**
+ * Install the time source
+ * @param now_us Returns the current time in microseconds, or NULL to use
+ *               the internal counter moved by hrms_nrf24_sim_advance()
+ */
+void hrms_nrf24_sim_set_clock(uint32_t (*now_us)(void));
+
+/**
+ * Move the internal clock forward and run due air events
+ * @param us Microseconds to advance
+ */
+void hrms_nrf24_sim_advance(uint32_t us);
+
+/**
+ * Current simulated time
+ * @return Microseconds from the clock callback or the internal counter
+ */
+uint32_t hrms_nrf24_sim_now(void);
+
+/**
+ * Execute one SPI command on a simulated radio
+ * @param radio Radio index (0 to HRMS_NRF24_SIM_RADIOS-1)
+ * @param cmd Command byte
+ * @param tx Data bytes following the command, or NULL
+ * @param rx Buffer for the bytes shifted back, or NULL
+ * @param length Number of data bytes
+ * @return STATUS register, as shifted out with the command byte
+ */
+uint8_t hrms_nrf24_sim_command(uint8_t radio, uint8_t cmd, const uint8_t *tx,
+                               uint8_t *rx, uint8_t length);
+
+/**
+ * Drive the CE pin of a simulated radio
+ * @param radio Radio index
+ * @param level true for high
+ */
+void hrms_nrf24_sim_set_ce(uint8_t radio, bool level);
+
+/**
+ * Read the IRQ pin of a simulated radio
+ * @param radio Radio index
+ * @return true if IRQ is asserted (pin low)
+ */
+bool hrms_nrf24_sim_irq(uint8_t radio);
+
+/**
+ * Get ether statistics
+ * @param stats Pointer to store statistics
+ */
+void hrms_nrf24_sim_get_stats(hrms_nrf24_sim_stats_t *stats);
+
+#endif /* HRMS_NRF24L01_SIM_H */
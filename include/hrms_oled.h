@@ -16,6 +16,7 @@ void hrms_oled_draw_char(uint8_t x, uint8_t page, char c);
 void hrms_oled_draw_text(uint8_t x, uint8_t page, const char *str);
 void hrms_oled_invert(void);
 void hrms_oled_draw_progress_bar(uint8_t percent);
+void hrms_oled_draw_bar_graph(const uint8_t *percent, uint8_t count);
 void hrms_oled_scroll_horizontal(const char *text, uint8_t speed);
 void hrms_oled_scroll_text(const char *text, uint8_t speed_ms);
 void hrms_oled_blink(uint8_t times, uint16_t delay_ms);
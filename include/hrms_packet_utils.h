@@ -12,6 +12,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "hrms_types.h"
 
 /**
@@ -20,8 +21,62 @@
  * 
  * This module provides utilities for creating, validating, and managing
  * communication packets, separated from the communication hub logic.
+ *
+ * On-air wire format (all multi-byte fields little-endian):
+ *
+ *   offset  size  field
+ *   0       1     packet_type
+ *   1       1     packet_id
+ *   2       1     source_id
+ *   3       1     dest_id
+ *   4       1     payload_size (0..HRMS_WIRE_MAX_PAYLOAD_SIZE)
+ *   5       2     timestamp (low 16 bits of the sender tick)
+ *   7       n     payload
+ *   7+n     2     low 16 bits of CRC-32/MPEG-2 over bytes 0..7+n-1
+ *
+ * A frame never exceeds one 32-byte nRF24L01 payload and does not depend
+ * on the in-memory layout of hrms_comm_packet_t.
  */
 
+#define HRMS_WIRE_MAX_FRAME_SIZE    32
+#define HRMS_WIRE_HEADER_SIZE       7
+#define HRMS_WIRE_CHECKSUM_SIZE     2
+#define HRMS_WIRE_MAX_PAYLOAD_SIZE  (HRMS_WIRE_MAX_FRAME_SIZE - HRMS_WIRE_HEADER_SIZE - HRMS_WIRE_CHECKSUM_SIZE)
+
+// Typed payload: joystick sample (x int16, y int16, buttons bitfield)
+#define HRMS_WIRE_JOYSTICK_SIZE     5
+#define HRMS_WIRE_BUTTON_PRESSED    0x01
+
+/*
+ * Typed payload: joystick delta batch
+ *
+ *   header   1     keyframe flag | (count-1) << 4 | keyframe id
+ *   per sample     varint zigzag(dx), varint (zigzag(dy) << 1 | button)
+ *
+ * Sample 0 is a delta against the keyframe named by the id; each later
+ * sample is a delta against the one before it. In a keyframe frame,
+ * sample 0 is absolute and becomes that keyframe. The sender only
+ * uses a keyframe once the radio has ACKed it, so every delta frame
+ * decodes on its own even when frames in between were lost.
+ */
+#define HRMS_WIRE_JOYSTICK_KEYFRAME     0x80
+#define HRMS_WIRE_JOYSTICK_COUNT_SHIFT  4
+#define HRMS_WIRE_JOYSTICK_COUNT_MASK   0x70
+#define HRMS_WIRE_JOYSTICK_ID_MASK      0x0F
+#define HRMS_WIRE_JOYSTICK_MAX_BATCH    8
+#define HRMS_WIRE_JOYSTICK_DELTA_MAX    (1 + HRMS_WIRE_JOYSTICK_MAX_BATCH * 6)  // Worst case
+
+// Delta codec state, one per direction
+typedef struct {
+  hrms_joystick_data_t reference;    // Keyframe the deltas are taken against
+  uint8_t reference_id;
+  bool reference_valid;
+  hrms_joystick_data_t pending;      // Sender: keyframe sent, not yet ACKed
+  uint8_t pending_id;
+  bool pending_valid;
+  uint8_t frames_since_keyframe;
+} hrms_joystick_codec_t;
+
 /**
  * Create a heartbeat packet
  * @param packet Pointer to packet structure to fill
@@ -30,7 +85,7 @@
 void hrms_packet_create_heartbeat(hrms_comm_packet_t *packet, uint8_t source_id);
 
 /**
- * Set checksum for a packet
+ * Set checksum for a packet (the wire CRC of its header and payload)
  * @param packet Pointer to packet to set checksum for
  */
 void hrms_packet_set_checksum(hrms_comm_packet_t *packet);
@@ -42,6 +97,97 @@ void hrms_packet_set_checksum(hrms_comm_packet_t *packet);
  */
 bool hrms_packet_verify_checksum(const hrms_comm_packet_t *packet);
 
+/**
+ * Encode a packet into its on-air wire format
+ * @param packet Packet to encode (payload_size must fit HRMS_WIRE_MAX_PAYLOAD_SIZE)
+ * @param buf Output buffer
+ * @param buf_len Size of output buffer
+ * @return Number of bytes written, 0 on error
+ */
+size_t hrms_packet_encode(const hrms_comm_packet_t *packet, uint8_t *buf, size_t buf_len);
+
+/**
+ * Write the HRMS_WIRE_HEADER_SIZE header bytes a packet will have on air
+ * (e.g. as authenticated data before the payload is final)
+ * @param packet Packet with every header field set, payload_size included
+ * @param buf Output buffer of at least HRMS_WIRE_HEADER_SIZE bytes
+ */
+void hrms_packet_encode_header(const hrms_comm_packet_t *packet, uint8_t *buf);
+
+/**
+ * Decode and verify a wire frame
+ * @param buf Received frame (may carry trailing padding)
+ * @param len Number of bytes received
+ * @param packet Packet to fill; checksum holds the verified wire checksum
+ * @return true if the frame is well-formed and its checksum matches
+ */
+bool hrms_packet_decode(const uint8_t *buf, size_t len, hrms_comm_packet_t *packet);
+
+/**
+ * Encode a joystick sample as a typed payload
+ * @param data Joystick sample
+ * @param buf Output buffer (at least HRMS_WIRE_JOYSTICK_SIZE bytes)
+ * @param buf_len Size of output buffer
+ * @return Number of bytes written, 0 on error
+ */
+size_t hrms_packet_encode_joystick(const hrms_joystick_data_t *data, uint8_t *buf, size_t buf_len);
+
+/**
+ * Decode a joystick typed payload
+ * @param buf Payload bytes
+ * @param len Payload length
+ * @param data Joystick sample to fill
+ * @return true on success, false if the payload is too short
+ */
+bool hrms_packet_decode_joystick(const uint8_t *buf, size_t len, hrms_joystick_data_t *data);
+
+/*
+ * Typed payload: joystick batch = period_ms (1 byte) + delta batch.
+ * The packet timestamp is the time of sample 0; sample i was taken
+ * i * period_ms later.
+ */
+#define HRMS_WIRE_JOYSTICK_BATCH_HEADER 1
+
+/**
+ * Reset a joystick delta codec (forces a keyframe / waits for one)
+ * @param codec Codec state
+ */
+void hrms_joystick_codec_init(hrms_joystick_codec_t *codec);
+
+/**
+ * Encode joystick samples as a delta batch
+ * @param codec Sender codec state
+ * @param samples Samples, oldest first
+ * @param count Number of samples (1 to HRMS_WIRE_JOYSTICK_MAX_BATCH)
+ * @param buf Output buffer
+ * @param buf_len Size of output buffer
+ * @return Number of bytes written, 0 on error or if the batch does not fit
+ */
+size_t hrms_packet_encode_joystick_delta(hrms_joystick_codec_t *codec,
+                                         const hrms_joystick_data_t *samples, uint8_t count,
+                                         uint8_t *buf, size_t buf_len);
+
+/**
+ * Report whether the last encoded batch reached the peer (once per frame sent)
+ * @param codec Sender codec state
+ * @param delivered true if the radio ACKed the frame
+ */
+void hrms_joystick_codec_on_ack(hrms_joystick_codec_t *codec, bool delivered);
+
+/**
+ * Decode a delta batch
+ * @param codec Receiver codec state
+ * @param buf Payload bytes
+ * @param len Payload length
+ * @param samples Output samples, oldest first
+ * @param max_samples Capacity of samples
+ * @param count Number of samples decoded
+ * @return false if malformed or its keyframe is unknown (frame is dropped)
+ */
+bool hrms_packet_decode_joystick_delta(hrms_joystick_codec_t *codec, const uint8_t *buf, size_t len,
+                                       hrms_joystick_data_t *samples, uint8_t max_samples,
+                                       uint8_t *count);
+
 /**
  * Get next packet ID
  * @return Next sequential packet ID
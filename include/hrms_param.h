@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+#ifndef HRMS_PARAM_H
+#define HRMS_PARAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @file hrms_param.h
+ * @brief Runtime parameter registry and its get/set protocol
+ *
+ * Tunables that can change on a running link. Each parameter has a fixed
+ * id, a type, a range and a default taken from hrms_config.h. Owners read
+ * the current value where they use it, so a new value takes effect on the
+ * owner's next cycle. A value is a 32-bit word, so a read from another task
+ * never sees half an update. Owners that must act at once (the radio
+ * channel) register a hook that applies the value and may refuse it.
+ *
+ * The peer reads and writes parameters with HRMS_COMM_PACKET_CONFIG, sent
+ * reliably. The payload is op, sequence, then TLVs of id, length and a
+ * little-endian value:
+ *
+ *   GET    id 0, id 0, ...            no TLV at all: every parameter
+ *   SET    id len value, ...
+ *   REPLY  id len value, ...          value after the request
+ *
+ * A REPLY echoes the sequence. An unknown id, or a SET with the wrong
+ * length, out of range or refused by the hook, comes back with
+ * HRMS_PARAM_TLV_ERROR in the id and the current value (none if unknown).
+ * TLVs that do not fit the reply are left out.
+ */
+
+// HRMS_COMM_PACKET_CONFIG payload
+#define HRMS_PARAM_OP_GET           0x01
+#define HRMS_PARAM_OP_SET           0x02
+#define HRMS_PARAM_OP_REPLY         0x03
+#define HRMS_PARAM_HEADER_SIZE      2     // op, sequence
+#define HRMS_PARAM_TLV_HEADER_SIZE  2     // id, length
+#define HRMS_PARAM_TLV_ERROR        0x80  // In a reply id: request not applied
+
+// Wire ids - append only, both ends must agree
+typedef enum {
+  HRMS_PARAM_JOYSTICK_DEADZONE = 0, // ADC counts around center read as zero
+  HRMS_PARAM_TX_INTERVAL_MS,        // Min gap between joystick control frames
+  HRMS_PARAM_RADIO_CHANNEL,         // RF channel (moves both ends)
+  HRMS_PARAM_SAMPLE_INTERVAL_MS,    // Joystick sample period
+  HRMS_PARAM_COUNT
+} hrms_param_id_t;
+
+// Value type = its size on the wire
+typedef enum {
+  HRMS_PARAM_U8 = 1,
+  HRMS_PARAM_U16 = 2,
+  HRMS_PARAM_U32 = 4
+} hrms_param_type_t;
+
+// Applies a new value; false refuses it and keeps the old one
+typedef bool (*hrms_param_hook_t)(uint32_t value);
+
+typedef struct {
+  uint8_t id;                // Parameter id, HRMS_PARAM_TLV_ERROR stripped
+  bool error;                // HRMS_PARAM_TLV_ERROR was set
+  uint8_t len;               // Value length (0 for a GET)
+  uint32_t value;
+} hrms_param_tlv_t;
+
+/**
+ * Load every parameter with its default and drop all hooks
+ */
+void hrms_param_init(void);
+
+/**
+ * Get the current value of a parameter
+ * @param id Parameter
+ * @return Value, 0 for an unknown id
+ */
+uint32_t hrms_param_get(hrms_param_id_t id);
+
+/**
+ * Check the range, run the hook and store the value
+ * Call from the hub task for parameters with a hook
+ * @param id Parameter
+ * @param value New value
+ * @return false if the id is unknown, the value out of range or refused
+ */
+bool hrms_param_set(hrms_param_id_t id, uint32_t value);
+
+/**
+ * Record a value the owner changed by itself (no range check, no hook)
+ * @param id Parameter
+ * @param value Value now in effect
+ */
+void hrms_param_update(hrms_param_id_t id, uint32_t value);
+
+/**
+ * Register the hook that applies a parameter
+ * @param id Parameter
+ * @param hook Called by hrms_param_set() before the value is stored, or NULL
+ */
+void hrms_param_set_hook(hrms_param_id_t id, hrms_param_hook_t hook);
+
+/**
+ * Run a GET or SET request and build the reply
+ * @param request Request payload
+ * @param len Request length
+ * @param reply Buffer for the reply payload
+ * @param max_len Buffer size
+ * @return Reply length, 0 if the payload is not a request
+ */
+size_t hrms_param_handle(const uint8_t *request, size_t len, uint8_t *reply, size_t max_len);
+
+/**
+ * Build a request (requesting side)
+ * @param op HRMS_PARAM_OP_GET or HRMS_PARAM_OP_SET
+ * @param seq Sequence, echoed in the reply
+ * @param ids Parameters (may be NULL if count is 0)
+ * @param values Values for a SET, ignored for a GET
+ * @param count Number of parameters
+ * @param buf Buffer for the payload
+ * @param max_len Buffer size
+ * @return Payload length, 0 on unknown id or if the buffer is too small
+ */
+size_t hrms_param_make_request(uint8_t op, uint8_t seq, const hrms_param_id_t *ids,
+                               const uint32_t *values, uint8_t count,
+                               uint8_t *buf, size_t max_len);
+
+/**
+ * Read the next TLV of a payload
+ * @param payload Payload, header included
+ * @param len Payload length
+ * @param offset Start at HRMS_PARAM_HEADER_SIZE; advanced past the TLV
+ * @param tlv Receives the TLV
+ * @return false at the end of the payload or on a truncated TLV
+ */
+bool hrms_param_next_tlv(const uint8_t *payload, size_t len, size_t *offset,
+                         hrms_param_tlv_t *tlv);
+
+#endif /* HRMS_PARAM_H */
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+#ifndef HRMS_POLY1305_H
+#define HRMS_POLY1305_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @file hrms_poly1305.h
+ * @brief Poly1305 one-time authenticator (RFC 8439), 26-bit limbs
+ *
+ * Input is fed in pieces of any size as it is produced. The 32-byte key
+ * must never authenticate two messages; hrms_keystream takes a fresh one
+ * from each frame's keystream. The 32x32->64 multiplies map onto UMULL,
+ * so no libgcc helper is needed on Cortex-M3.
+ */
+
+#define HRMS_POLY1305_KEY_SIZE  32
+#define HRMS_POLY1305_TAG_SIZE  16
+
+typedef struct {
+  uint32_t r[5];
+  uint32_t h[5];
+  uint32_t pad[4];
+  uint8_t buffer[16];
+  uint8_t leftover;
+} hrms_poly1305_t;
+
+/**
+ * Start a tag
+ * @param st State
+ * @param key HRMS_POLY1305_KEY_SIZE one-time key bytes
+ */
+void hrms_poly1305_init(hrms_poly1305_t *st, const uint8_t *key);
+
+/**
+ * Feed message bytes
+ * @param st State
+ * @param data Bytes
+ * @param len Number of bytes
+ */
+void hrms_poly1305_update(hrms_poly1305_t *st, const uint8_t *data, size_t len);
+
+/**
+ * Finish the tag; the state must be initialized again before reuse
+ * @param st State
+ * @param tag HRMS_POLY1305_TAG_SIZE bytes out
+ */
+void hrms_poly1305_finish(hrms_poly1305_t *st, uint8_t *tag);
+
+/**
+ * Check the RFC 8439 section 2.5.2 test vector
+ * @return true if the tag matches
+ */
+bool hrms_poly1305_selftest(void);
+
+#endif /* HRMS_POLY1305_H */
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+#ifndef HRMS_RELIABLE_H
+#define HRMS_RELIABLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "hrms_types.h"
+
+/**
+ * @file hrms_reliable.h
+ * @brief Selective-repeat sliding window for config and telemetry packets
+ *
+ * Sequence numbers are 32-bit and increase monotonically; the wire carries
+ * the low 8 bits in packet_id. The receiver widens them against its own
+ * window, which works because HRMS_RELIABLE_WINDOW is well below 128.
+ *
+ * Every data frame is ACKed with HRMS_COMM_PACKET_ACK, payload
+ * {acked seq, next expected seq}. The sender retransmits unACKed frames
+ * after HRMS_RELIABLE_RTO_MS, and gives a frame up after
+ * HRMS_RELIABLE_MAX_RETRIES. The receiver drops duplicates and delivers
+ * in order. A gap left by a frame the sender gave up on is skipped
+ * after HRMS_RELIABLE_GAP_MS. A frame ahead of the window slides it
+ * forward. A frame far behind it means the peer restarted, and the
+ * window resyncs to that frame.
+ *
+ * Control frames (joystick) do not go through here.
+ */
+
+// ACK payload (HRMS_COMM_PACKET_ACK)
+#define HRMS_RELIABLE_ACK_SIZE      2     // acked seq, next expected seq
+
+// Sends or queues one encoded wire frame; the result is advisory, the RTO covers loss
+typedef bool (*hrms_reliable_tx_t)(const uint8_t *frame, size_t len);
+
+// Receives packets in sequence order, duplicates removed
+typedef void (*hrms_reliable_deliver_t)(const hrms_comm_packet_t *packet);
+
+typedef struct {
+  uint32_t sent;             // New frames sent
+  uint32_t retransmits;      // Frames sent again after the RTO
+  uint32_t acked;            // Frames confirmed by the peer
+  uint32_t failed;           // Frames given up after HRMS_RELIABLE_MAX_RETRIES
+  uint32_t delivered;        // Frames passed to the deliver callback
+  uint32_t duplicates;       // Received frames already seen
+  uint32_t gaps_skipped;     // Missing frames the receiver stopped waiting for
+  uint32_t resyncs;          // Peer restarts detected
+} hrms_reliable_stats_t;
+
+/**
+ * Initialize both window ends
+ * @param tx Frame transmit function (e.g. hrms_communication_hub_send)
+ * @param deliver Callback for in-order received packets, or NULL
+ */
+void hrms_reliable_init(hrms_reliable_tx_t tx, hrms_reliable_deliver_t deliver);
+
+/**
+ * Whether packets of a type travel through the window
+ * @param type Packet type
+ * @return true for config, status and sensor (telemetry) packets
+ */
+bool hrms_reliable_carries(hrms_comm_packet_type_t type);
+
+/**
+ * Assign the next sequence number and send a packet
+ * @param packet Packet to send; packet_id is overwritten with the sequence
+ * @param now_ms Current time in milliseconds
+ * @return false if the window is full or the packet does not fit a frame
+ */
+bool hrms_reliable_send(hrms_comm_packet_t *packet, uint32_t now_ms);
+
+/**
+ * Handle a received data packet: ACK it, drop duplicates, deliver in order
+ * @param packet Decoded packet of a reliable type
+ * @param now_ms Current time in milliseconds
+ */
+void hrms_reliable_on_receive(const hrms_comm_packet_t *packet, uint32_t now_ms);
+
+/**
+ * Handle a received HRMS_COMM_PACKET_ACK
+ * @param packet Decoded ACK packet
+ */
+void hrms_reliable_on_ack(const hrms_comm_packet_t *packet);
+
+/**
+ * Retransmit timed-out frames and skip stale receive gaps
+ * @param now_ms Current time in milliseconds
+ */
+void hrms_reliable_poll(uint32_t now_ms);
+
+/**
+ * Number of frames sent but not yet ACKed
+ * @return Frames in flight
+ */
+uint8_t hrms_reliable_in_flight(void);
+
+/**
+ * Get transport statistics
+ * @param stats Pointer to store statistics
+ */
+void hrms_reliable_get_stats(hrms_reliable_stats_t *stats);
+
+#endif /* HRMS_RELIABLE_H */
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+#ifndef HRMS_SPECTRUM_H
+#define HRMS_SPECTRUM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hrms_nrf24l01.h"
+
+/**
+ * @file hrms_spectrum.h
+ * @brief 2.4 GHz occupancy histogram built from nRF24L01 RPD sweeps
+ *
+ * Each sweep visits channels 0-125 and reads RPD HRMS_SPECTRUM_SAMPLES
+ * times per channel. The histogram sums the hits over all sweeps since
+ * the last reset. The quietest channel is scored against its neighbours
+ * too, because a 2 Mbps link occupies 2 MHz.
+ */
+
+#define HRMS_SPECTRUM_CHANNELS (NRF24L01_MAX_CHANNEL + 1)
+
+typedef struct {
+  uint32_t sweeps;           // Sweeps since init
+  uint32_t last_sweep_us;    // Duration of the last sweep
+  uint32_t max_sweep_us;     // Longest sweep
+} hrms_spectrum_stats_t;
+
+/**
+ * Clear the histogram
+ */
+void hrms_spectrum_reset(void);
+
+/**
+ * Run sweeps and add them to the histogram
+ * Blocks the caller for about 21 ms per sweep, sleeping through the RX settles
+ * @param sweeps Number of full 0-125 sweeps
+ * @return false if the radio was busy transmitting
+ */
+bool hrms_spectrum_scan(uint8_t sweeps);
+
+/**
+ * Share of samples that saw a carrier on a channel
+ * @param channel RF channel (0-125)
+ * @return Occupancy in percent
+ */
+uint8_t hrms_spectrum_occupancy(uint8_t channel);
+
+/**
+ * Least congested channel in a range
+ * @param first Lowest candidate channel
+ * @param last Highest candidate channel
+ * @return Quietest channel, counting half of each neighbour's occupancy
+ */
+uint8_t hrms_spectrum_quietest(uint8_t first, uint8_t last);
+
+/**
+ * Get scan statistics
+ * @param stats Pointer to store statistics
+ */
+void hrms_spectrum_get_stats(hrms_spectrum_stats_t *stats);
+
+#endif /* HRMS_SPECTRUM_H */
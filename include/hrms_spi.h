@@ -85,4 +85,40 @@ void hrms_spi1_set_speed(hrms_spi_speed_t speed);
  */
 void hrms_spi1_deinit(void);
 
+/**
+ * Transfers shorter than this are clocked by polling; DMA setup costs
+ * more than it saves for one or two register bytes.
+ */
+#define HRMS_SPI2_DMA_MIN_LEN 4
+
+/**
+ * Initialize SPI2 peripheral (PB13=SCK, PB14=MISO, PB15=MOSI) and its
+ * DMA1 channels (CH4=RX, CH5=TX). NSS is left to the caller.
+ *
+ * @return 0 on success, -1 on error
+ */
+int hrms_spi2_init(void);
+
+/**
+ * Send and receive a byte via SPI2
+ *
+ * @param data Byte to send
+ * @return Received byte
+ */
+uint8_t hrms_spi2_transfer(uint8_t data);
+
+/**
+ * Full-duplex multi-byte transfer via SPI2
+ *
+ * Uses DMA for len >= HRMS_SPI2_DMA_MIN_LEN. Once the scheduler is running
+ * the calling task blocks on a semaphore given by the DMA RX complete
+ * interrupt; before that the DMA flag is polled.
+ *
+ * @param tx_data Bytes to send, or NULL to clock out 0xFF
+ * @param rx_data Receive buffer, or NULL to discard received bytes
+ * @param len Number of bytes to transfer
+ * @return 0 on success, -1 on error
+ */
+int hrms_spi2_transfer_buffer(const uint8_t *tx_data, uint8_t *rx_data, size_t len);
+
 #endif /* HRMS_SPI_H */
\ No newline at end of file
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+#ifndef HRMS_TIMER_H
+#define HRMS_TIMER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @file hrms_timer.h
+ * @brief Microsecond one-shot timer (TIM2) and DWT cycle timestamps
+ *
+ * The one-shot has a single client at a time. Its callback runs in the
+ * TIM2 interrupt, so it must be short and may only use FromISR APIs.
+ */
+
+typedef void (*hrms_timer_callback_t)(void);
+
+/**
+ * Initialize TIM2 as a 1 MHz one-pulse timer with update interrupt
+ * @return 0 on success, -1 on error
+ */
+int hrms_timer_init(void);
+
+/**
+ * Call a function from the TIM2 interrupt after a delay
+ * @param us Delay in microseconds (1-65535)
+ * @param callback Function to call
+ * @return true if armed, false if the timer is busy or the delay is invalid
+ */
+bool hrms_timer_oneshot_us(uint16_t us, hrms_timer_callback_t callback);
+
+/**
+ * Stop a pending one-shot without calling its callback
+ */
+void hrms_timer_cancel(void);
+
+/**
+ * Read the free-running DWT cycle counter
+ * @return Current CPU cycle count
+ */
+uint32_t hrms_timer_cycles(void);
+
+/**
+ * Convert a cycle count difference to microseconds
+ * @param cycles Cycle count difference
+ * @return Microseconds
+ */
+uint32_t hrms_timer_cycles_to_us(uint32_t cycles);
+
+/**
+ * Convert microseconds to a cycle count difference
+ * @param us Microseconds
+ * @return Cycles
+ */
+uint32_t hrms_timer_us_to_cycles(uint32_t us);
+
+#endif /* HRMS_TIMER_H */
@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+#ifndef HRMS_TIMESYNC_H
+#define HRMS_TIMESYNC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @file hrms_timesync.h
+ * @brief Two-way clock sync with the peer: offset and drift of its DWT counter
+ *
+ * One end sends a HRMS_COMM_PACKET_SYNC request stamped t1 just before it is
+ * loaded into the radio. The peer stamps the RX interrupt edge (t2), and
+ * the reply just before loading it (t3). The reply arrives at t4 (RX edge):
+ *
+ *   rtt    = (t4 - t1) - (t3 - t2)
+ *   offset = t2 - (t1 + rtt / 2)        peer clock minus ours
+ *
+ * The next request carries t1 and t4 of the previous exchange, so the peer
+ * gets the same four stamps and runs the same estimator. Both ends then
+ * hold the offset; the answering end just sees it negated.
+ *
+ * Exchanges come in blocks of HRMS_TIMESYNC_BLOCK. The fastest of a block
+ * (least queueing and retransmission) becomes the new anchor. The change of
+ * offset between anchors gives the skew (crystal drift), which is smoothed
+ * and used to carry the offset forward between updates. Without an update
+ * for HRMS_TIMESYNC_STALE_MS the estimate is dropped; the starting end queues
+ * a request every HRMS_TIMESYNC_PERIOD_MS (off by default) whether the link
+ * is up or not.
+ *
+ * Each stamp also has the sender's tick count beside it, so a peer tick
+ * (the packet timestamp) maps to our clock. That mapping is only good to
+ * the 1 ms tick. Everything runs in 32-bit arithmetic apart from 32x32
+ * multiplies.
+ *
+ * State is per instance and reads the cycle counter through the clock
+ * given to hrms_timesync_init(), so two ends can run side by side on a
+ * host clock each.
+ */
+
+// Sync packet payload (HRMS_COMM_PACKET_SYNC), all fields little-endian
+#define HRMS_TIMESYNC_OP_REQUEST        0x01
+#define HRMS_TIMESYNC_OP_REPLY          0x02
+#define HRMS_TIMESYNC_REQUEST_SIZE      9     // op, t1, tick at t1
+#define HRMS_TIMESYNC_REQUEST_PREV_SIZE 17    // ... previous t1, previous t4
+#define HRMS_TIMESYNC_REPLY_SIZE        17    // op, t1, t2, t3, tick at t3
+
+typedef struct {
+  bool valid;
+  uint32_t offset_cycles;    // Peer cycle counter minus ours, now (modulo 2^32)
+  int32_t skew_ppb;          // Peer clock rate minus ours, parts per billion
+  uint32_t delay_us;         // One-way radio delay of the latest anchor
+  uint32_t exchanges;        // Complete exchanges, either end starting
+  uint32_t updates;          // Anchors taken (one per block)
+  uint32_t rejected;         // Exchanges with stamps that cannot be right
+} hrms_timesync_stats_t;
+
+// Cycle counter the stamps are taken from (hrms_timer_cycles on target)
+typedef uint32_t (*hrms_timesync_clock_t)(void);
+
+// One exchange as seen from this end
+typedef struct {
+  uint32_t local;            // Our cycle count the offset refers to
+  uint32_t offset;           // Peer minus ours
+  uint32_t rtt;              // Round trip, turnaround removed
+} hrms_timesync_sample_t;
+
+typedef struct {
+  hrms_timesync_clock_t clock;
+
+  // Starting end
+  uint32_t request_t1;
+  bool request_outstanding;
+  uint32_t prev_t1;
+  uint32_t prev_t4;
+  bool prev_valid;
+
+  // Answering end: the reply we sent last, until the next request completes it
+  uint32_t answer_t1;
+  uint32_t answer_t2;
+  uint32_t answer_t3;
+  bool answer_valid;
+
+  // Latest peer (tick, cycle count) pair, in the peer's clock
+  uint32_t peer_ref_tick;
+  uint32_t peer_ref_cycles;
+  bool peer_ref_valid;
+
+  // Estimator
+  hrms_timesync_sample_t block_best;
+  uint8_t block_count;
+  hrms_timesync_sample_t anchor;
+  bool anchor_valid;
+  int32_t skew_q32;          // Peer rate minus ours, 2^-32 per cycle
+  bool skew_valid;
+
+  hrms_timesync_stats_t stats;
+} hrms_timesync_t;
+
+/**
+ * Drop the estimate and any exchange in progress
+ * @param ts Sync state
+ * @param clock Cycle counter to stamp with, NULL for hrms_timer_cycles()
+ */
+void hrms_timesync_init(hrms_timesync_t *ts, hrms_timesync_clock_t clock);
+
+/**
+ * Build a request stamped with the current cycle count (starting end)
+ * @param ts Sync state
+ * @param tick Tick count at this moment
+ * @param payload Buffer for the payload
+ * @param max_len Buffer size
+ * @return Payload length, 0 if the buffer is too small
+ */
+size_t hrms_timesync_make_request(hrms_timesync_t *ts, uint32_t tick, uint8_t *payload,
+                                  size_t max_len);
+
+/**
+ * Build the reply to a peer's request (answering end)
+ * The previous exchange the request reports is fed to the estimator.
+ * @param ts Sync state
+ * @param request Request payload
+ * @param len Request length
+ * @param rx_cycles Cycle count when the request arrived
+ * @param tick Tick count at this moment
+ * @param payload Buffer for the reply
+ * @param max_len Buffer size
+ * @return Reply length, 0 if the request is malformed or the buffer too small
+ */
+size_t hrms_timesync_make_reply(hrms_timesync_t *ts, const uint8_t *request, size_t len,
+                                uint32_t rx_cycles, uint32_t tick,
+                                uint8_t *payload, size_t max_len);
+
+/**
+ * Account a reply (starting end)
+ * @param ts Sync state
+ * @param payload Reply payload
+ * @param len Reply length
+ * @param rx_cycles Cycle count when the reply arrived
+ * @return true if it answered the outstanding request
+ */
+bool hrms_timesync_on_reply(hrms_timesync_t *ts, const uint8_t *payload, size_t len,
+                            uint32_t rx_cycles);
+
+/**
+ * Convert one of our cycle counts to the peer's clock
+ * @param ts Sync state
+ * @param local_cycles Our cycle count
+ * @param peer_cycles Set to the peer's cycle count at that moment
+ * @return false without a current estimate
+ */
+bool hrms_timesync_to_peer(hrms_timesync_t *ts, uint32_t local_cycles, uint32_t *peer_cycles);
+
+/**
+ * Convert a peer cycle count to our clock
+ * @param ts Sync state
+ * @param peer_cycles Peer cycle count
+ * @param local_cycles Set to our cycle count at that moment
+ * @return false without a current estimate
+ */
+bool hrms_timesync_to_local(hrms_timesync_t *ts, uint32_t peer_cycles, uint32_t *local_cycles);
+
+/**
+ * Convert the low 16 bits of a peer tick count (packet timestamp) to our clock
+ * @param ts Sync state
+ * @param peer_tick Peer tick, within 29 s of its latest sync stamp
+ * @param local_cycles Set to our cycle count at that tick (+-1 ms)
+ * @return false without a current estimate
+ */
+bool hrms_timesync_peer_tick_to_local(hrms_timesync_t *ts, uint16_t peer_tick,
+                                      uint32_t *local_cycles);
+
+/**
+ * Get sync statistics
+ * @param ts Sync state
+ * @param stats Pointer to store statistics
+ */
+void hrms_timesync_get_stats(hrms_timesync_t *ts, hrms_timesync_stats_t *stats);
+
+/**
+ * Print the estimate on the debug UART
+ * @param ts Sync state
+ */
+void hrms_timesync_dump(hrms_timesync_t *ts);
+
+#endif /* HRMS_TIMESYNC_H */
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+#ifndef HRMS_TX_SCHED_H
+#define HRMS_TX_SCHED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @file hrms_tx_sched.h
+ * @brief Priority-classed transmit queue for encoded wire frames
+ *
+ * Frames wait in one queue per class. They are popped in strict priority
+ * order: control > ack > heartbeat > bulk.
+ *
+ * - Control and heartbeat hold a single frame each. A newer frame replaces
+ *   the waiting one in place, because only the latest stick position or
+ *   liveness beacon matters.
+ * - Ack and bulk are FIFOs. A push to a full FIFO is refused; the reliable
+ *   layer retransmits on its RTO anyway.
+ * - Bulk (config/telemetry) is also metered by a token bucket that refills
+ *   at HRMS_TX_BULK_RATE_BPS up to HRMS_TX_BULK_BURST bytes. A bulk frame
+ *   may only go when the bucket holds its length in tokens.
+ *
+ * The module only orders frames. The caller sends what it pops.
+ */
+
+typedef enum {
+  HRMS_TX_CLASS_CONTROL = 0,   // Joystick / control commands (latest wins)
+  HRMS_TX_CLASS_ACK,           // Reliable-layer ACKs
+  HRMS_TX_CLASS_HEARTBEAT,     // Liveness beacons (latest wins)
+  HRMS_TX_CLASS_BULK,          // Config and telemetry, rate limited
+  HRMS_TX_CLASS_COUNT
+} hrms_tx_class_t;
+
+typedef struct {
+  uint32_t queued[HRMS_TX_CLASS_COUNT];   // Frames accepted per class
+  uint32_t sent[HRMS_TX_CLASS_COUNT];     // Frames popped per class
+  uint32_t replaced;         // Control/heartbeat frames overwritten before sending
+  uint32_t dropped;          // Pushes refused by a full ack/bulk FIFO
+  uint32_t throttled;        // Pops where bulk waited for tokens
+} hrms_tx_sched_stats_t;
+
+/**
+ * Empty all queues and fill the token bucket
+ * @param now_ms Current time in milliseconds
+ */
+void hrms_tx_sched_init(uint32_t now_ms);
+
+/**
+ * Queue one encoded frame
+ * @param cls Traffic class
+ * @param frame Wire frame
+ * @param len Frame length (max HRMS_WIRE_MAX_FRAME_SIZE)
+ * @param tag Caller tag returned with the frame by hrms_tx_sched_pop()
+ * @return false on invalid input or a full FIFO
+ */
+bool hrms_tx_sched_push(hrms_tx_class_t cls, const uint8_t *frame, size_t len, uint8_t tag);
+
+/**
+ * Take the highest-priority frame that may go now
+ * @param now_ms Current time in milliseconds
+ * @param frame Buffer of at least HRMS_WIRE_MAX_FRAME_SIZE bytes
+ * @param len Set to the frame length
+ * @param cls Set to the frame's class; may be NULL
+ * @param tag Set to the frame's tag; may be NULL
+ * @return false if nothing is queued or only bulk is queued and out of tokens
+ */
+bool hrms_tx_sched_pop(uint32_t now_ms, uint8_t *frame, size_t *len,
+                       hrms_tx_class_t *cls, uint8_t *tag);
+
+/**
+ * Check whether a class has a frame waiting
+ * @param cls Traffic class
+ * @return true if at least one frame is queued
+ */
+bool hrms_tx_sched_pending(hrms_tx_class_t cls);
+
+/**
+ * Time until hrms_tx_sched_pop() would return a frame
+ * @param now_ms Current time in milliseconds
+ * @param max_ms Upper bound (returned when nothing is queued)
+ * @return 0 if a frame may go now, else the wait for bulk tokens, capped at max_ms
+ */
+uint32_t hrms_tx_sched_next_ms(uint32_t now_ms, uint32_t max_ms);
+
+/**
+ * Get scheduler statistics
+ * @param stats Pointer to store statistics
+ */
+void hrms_tx_sched_get_stats(hrms_tx_sched_stats_t *stats);
+
+#endif /* HRMS_TX_SCHED_H */
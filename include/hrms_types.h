@@ -36,7 +36,13 @@ typedef enum {
   HRMS_COMM_PACKET_STATUS,
   HRMS_COMM_PACKET_CONFIG,
   HRMS_COMM_PACKET_ACK,
-  HRMS_COMM_PACKET_ERROR
+  HRMS_COMM_PACKET_ERROR,
+  HRMS_COMM_PACKET_LINK,
+  HRMS_COMM_PACKET_PROBE,
+  HRMS_COMM_PACKET_FRAGMENT,
+  HRMS_COMM_PACKET_SYNC,
+  HRMS_COMM_PACKET_SESSION,
+  HRMS_COMM_PACKET_TYPE_COUNT
 } hrms_comm_packet_type_t;
 
 // Communication directions
@@ -54,7 +60,7 @@ typedef struct {
   uint8_t dest_id;                             // Destination device ID
   uint8_t payload_size;                        // Size of payload (0-32)
   uint8_t payload[HRMS_COMM_MAX_PAYLOAD_SIZE]; // Actual data
-  uint16_t checksum;                           // Simple checksum for error detection
+  uint16_t checksum;                           // Truncated CRC-32 of the wire frame
   uint32_t timestamp;                          // When packet was created/received
 } hrms_comm_packet_t;
 
@@ -71,10 +77,36 @@ typedef struct {
   uint32_t packets_sent;
   uint32_t packets_received;
   uint32_t packets_failed;
+  uint32_t packets_dropped;  // Received frames failing length/CRC checks
+  uint32_t packets_rejected; // Control/link/session frames refused as replayed or forged
+  uint32_t packets_unhandled; // Valid packets with no handler for their type
   uint32_t last_rx_timestamp;
   uint32_t last_tx_timestamp;
+  uint32_t rtt_min_us;       // Probe round trip, receiver turnaround removed
+  uint32_t rtt_median_us;
+  uint32_t rtt_p99_us;
+  uint32_t rtt_max_us;
+  uint32_t one_way_us;       // Last control frame: sample taken -> received
+  uint32_t sample_age_us;    // Same, measured by the receiver on the synced clock
 } hrms_comm_stats_t;
 
+// Received packet forwarded by the communication hub to the controller
+typedef struct {
+  hrms_comm_packet_type_t type;  // HEARTBEAT, STATUS or ERROR
+  uint8_t source_id;
+  uint8_t code;                  // First payload byte (status/error code), 0 if none
+  uint32_t timestamp;            // Tick (ms) the packet arrived
+} hrms_remote_event_t;
+
+// Per-source statistics (one source per RX pipe on a star receiver)
+#define HRMS_COMM_MAX_SOURCES 6
+
+typedef struct {
+  uint32_t packets_received;
+  uint32_t bytes_received;
+  uint32_t last_rx_timestamp;
+} hrms_comm_source_stats_t;
+
 //==============================================================================
 // SENSORS
 //==============================================================================
@@ -105,6 +137,12 @@ typedef struct {
   bool button_pressed; // true if SW button is pressed
 } hrms_joystick_data_t;
 
+// Joystick sample as queued for batched transmission
+typedef struct {
+  hrms_joystick_data_t data;
+  uint32_t timestamp;  // Tick (ms) the sample was taken
+} hrms_joystick_sample_t;
+
 typedef struct {
   hrms_imu_data_t imu;
   hrms_joystick_data_t joystick;
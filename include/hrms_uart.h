@@ -16,6 +16,8 @@
 void hrms_uart_init(void);
 void hrms_uart_send_u8(uint8_t val);
 void hrms_uart_send_u32(uint32_t val);
+void hrms_uart_send_str(const char *str);
+void hrms_uart_send_dec(uint32_t val);
 
 #endif // HRMS_UART_H
 
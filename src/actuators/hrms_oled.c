@@ -135,6 +135,21 @@ void hrms_oled_draw_text(uint8_t x, uint8_t page, const char *str) {
     }
 }
 
+// Vertical bars over the full width, one value (0-100%) per bar
+void hrms_oled_draw_bar_graph(const uint8_t *percent, uint8_t count) {
+    if (!percent || count == 0 || !initialized) return;
+    
+    for (int x = 0; x < OLED_WIDTH; x++) {
+        uint8_t value = percent[(x * count) / OLED_WIDTH];
+        if (value > 100) value = 100;
+        
+        int height = (value * OLED_HEIGHT + 99) / 100;
+        for (int y = OLED_HEIGHT - height; y < OLED_HEIGHT; y++) {
+            hrms_oled_draw_pixel(x, y, 1);
+        }
+    }
+}
+
 // Ultra-simple apply function
 void hrms_oled_apply(const hrms_oled_command_t *data) {
     if (!data || !initialized) return;
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+#include "hrms_cipher.h"
+#include "hrms_packet_utils.h"
+#include "hrms_timer.h"
+#include "hrms_uart.h"
+#include "libc_stubs.h"
+
+// Frame payload as measured by frame_cycles
+#define CIPHER_FRAME_BYTES  HRMS_WIRE_MAX_PAYLOAD_SIZE
+
+// Backends built into this image, configured one first
+static const hrms_cipher_backend_t *const backends[] = {
+#if HRMS_CIPHER_BACKEND == HRMS_CIPHER_CHACHA20 || HRMS_CIPHER_BENCH
+  &hrms_cipher_chacha20,
+#endif
+#if HRMS_CIPHER_BACKEND == HRMS_CIPHER_SPECK || HRMS_CIPHER_BENCH
+  &hrms_cipher_speck,
+#endif
+#if HRMS_CIPHER_BACKEND == HRMS_CIPHER_AES || HRMS_CIPHER_BENCH
+  &hrms_cipher_aes,
+#endif
+};
+
+#if HRMS_CIPHER_BACKEND == HRMS_CIPHER_CHACHA20
+#define CIPHER_ACTIVE (&hrms_cipher_chacha20)
+#elif HRMS_CIPHER_BACKEND == HRMS_CIPHER_SPECK
+#define CIPHER_ACTIVE (&hrms_cipher_speck)
+#elif HRMS_CIPHER_BACKEND == HRMS_CIPHER_AES
+#define CIPHER_ACTIVE (&hrms_cipher_aes)
+#else
+#error "Unknown HRMS_CIPHER_BACKEND"
+#endif
+
+#define CIPHER_BACKEND_COUNT (sizeof(backends) / sizeof(backends[0]))
+
+void hrms_cipher_init(hrms_cipher_ctx_t *ctx, const uint8_t *key, const uint8_t *nonce) {
+  CIPHER_ACTIVE->init(ctx->words, key, nonce);
+}
+
+void hrms_cipher_keystream(const hrms_cipher_ctx_t *ctx, uint32_t counter, uint8_t *out, size_t len) {
+  CIPHER_ACTIVE->keystream(ctx->words, counter, out, len);
+}
+
+const hrms_cipher_backend_t *hrms_cipher_active(void) {
+  return CIPHER_ACTIVE;
+}
+
+size_t hrms_cipher_benchmark(hrms_cipher_bench_t *results, size_t max) {
+  if (!results) {
+    return 0;
+  }
+
+  uint32_t scratch[HRMS_CIPHER_CTX_SIZE / 4];
+  uint8_t key[HRMS_CIPHER_KEY_SIZE];
+  uint8_t nonce[HRMS_CIPHER_NONCE_SIZE];
+  uint8_t out[HRMS_CIPHER_MAX_KEYSTREAM];
+  memset(key, 0xA5, sizeof(key));
+  memset(nonce, 0x3C, sizeof(nonce));
+
+  size_t count = 0;
+  for (size_t i = 0; i < CIPHER_BACKEND_COUNT && count < max; i++) {
+    const hrms_cipher_backend_t *backend = backends[i];
+    hrms_cipher_bench_t *result = &results[count++];
+
+    result->name = backend->name;
+    result->ram_bytes = backend->ctx_size;
+    result->selftest_ok = backend->selftest();
+
+    uint32_t start = hrms_timer_cycles();
+    backend->init(scratch, key, nonce);
+    result->init_cycles = hrms_timer_cycles() - start;
+
+    start = hrms_timer_cycles();
+    backend->keystream(scratch, 0, out, CIPHER_FRAME_BYTES);
+    result->frame_cycles = hrms_timer_cycles() - start;
+
+    // Whole keystream blocks, so block-size differences don't skew the rate
+    start = hrms_timer_cycles();
+    for (uint32_t c = 0; c < HRMS_CIPHER_BENCH_BYTES / HRMS_CIPHER_MAX_KEYSTREAM; c++) {
+      backend->keystream(scratch, c, out, HRMS_CIPHER_MAX_KEYSTREAM);
+    }
+    uint32_t cycles = hrms_timer_cycles() - start;
+    result->cycles_per_byte_q8 = (cycles << 8) / HRMS_CIPHER_BENCH_BYTES;
+  }
+
+  return count;
+}
+
+void hrms_cipher_dump_benchmark(void) {
+  hrms_cipher_bench_t results[CIPHER_BACKEND_COUNT];
+  size_t count = hrms_cipher_benchmark(results, CIPHER_BACKEND_COUNT);
+
+  hrms_uart_send_str("cipher  cyc/B  frame  init  ram  kat\r\n");
+  for (size_t i = 0; i < count; i++) {
+    const hrms_cipher_bench_t *r = &results[i];
+    hrms_uart_send_str(r->name);
+    hrms_uart_send_str("  ");
+    hrms_uart_send_dec(r->cycles_per_byte_q8 >> 8);
+    hrms_uart_send_str(".");
+    hrms_uart_send_dec(((r->cycles_per_byte_q8 & 0xFF) * 10) >> 8);
+    hrms_uart_send_str("  ");
+    hrms_uart_send_dec(r->frame_cycles);
+    hrms_uart_send_str("  ");
+    hrms_uart_send_dec(r->init_cycles);
+    hrms_uart_send_str("  ");
+    hrms_uart_send_dec(r->ram_bytes);
+    hrms_uart_send_str(r->selftest_ok ? "  ok\r\n" : "  FAIL\r\n");
+  }
+}
@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+#include "hrms_cipher.h"
+#include "libc_stubs.h"
+
+#if HRMS_CIPHER_BACKEND == HRMS_CIPHER_AES || HRMS_CIPHER_BENCH
+
+#define AES_ROUNDS      10
+#define AES_BLOCK_SIZE  16
+#define AES_XTIME(b)    ((uint8_t)(((b) << 1) ^ (((b) & 0x80) ? 0x1B : 0x00)))
+
+// AES-128: expanded key, nonce bytes 0..7 for the block input
+typedef struct {
+  uint8_t round_keys[AES_BLOCK_SIZE * (AES_ROUNDS + 1)];
+  uint8_t nonce[8];
+} aes_ctx_t;
+
+typedef char aes_ctx_fits[(sizeof(aes_ctx_t) <= HRMS_CIPHER_CTX_SIZE) ? 1 : -1];
+
+// Byte-oriented: 256-byte S-box in flash, no T-tables (4 kB each)
+static const uint8_t aes_sbox[256] = {
+  0x63, 0x7C, 0x77, 0x7B, 0xF2, 0x6B, 0x6F, 0xC5, 0x30, 0x01, 0x67, 0x2B, 0xFE, 0xD7, 0xAB, 0x76,
+  0xCA, 0x82, 0xC9, 0x7D, 0xFA, 0x59, 0x47, 0xF0, 0xAD, 0xD4, 0xA2, 0xAF, 0x9C, 0xA4, 0x72, 0xC0,
+  0xB7, 0xFD, 0x93, 0x26, 0x36, 0x3F, 0xF7, 0xCC, 0x34, 0xA5, 0xE5, 0xF1, 0x71, 0xD8, 0x31, 0x15,
+  0x04, 0xC7, 0x23, 0xC3, 0x18, 0x96, 0x05, 0x9A, 0x07, 0x12, 0x80, 0xE2, 0xEB, 0x27, 0xB2, 0x75,
+  0x09, 0x83, 0x2C, 0x1A, 0x1B, 0x6E, 0x5A, 0xA0, 0x52, 0x3B, 0xD6, 0xB3, 0x29, 0xE3, 0x2F, 0x84,
+  0x53, 0xD1, 0x00, 0xED, 0x20, 0xFC, 0xB1, 0x5B, 0x6A, 0xCB, 0xBE, 0x39, 0x4A, 0x4C, 0x58, 0xCF,
+  0xD0, 0xEF, 0xAA, 0xFB, 0x43, 0x4D, 0x33, 0x85, 0x45, 0xF9, 0x02, 0x7F, 0x50, 0x3C, 0x9F, 0xA8,
+  0x51, 0xA3, 0x40, 0x8F, 0x92, 0x9D, 0x38, 0xF5, 0xBC, 0xB6, 0xDA, 0x21, 0x10, 0xFF, 0xF3, 0xD2,
+  0xCD, 0x0C, 0x13, 0xEC, 0x5F, 0x97, 0x44, 0x17, 0xC4, 0xA7, 0x7E, 0x3D, 0x64, 0x5D, 0x19, 0x73,
+  0x60, 0x81, 0x4F, 0xDC, 0x22, 0x2A, 0x90, 0x88, 0x46, 0xEE, 0xB8, 0x14, 0xDE, 0x5E, 0x0B, 0xDB,
+  0xE0, 0x32, 0x3A, 0x0A, 0x49, 0x06, 0x24, 0x5C, 0xC2, 0xD3, 0xAC, 0x62, 0x91, 0x95, 0xE4, 0x79,
+  0xE7, 0xC8, 0x37, 0x6D, 0x8D, 0xD5, 0x4E, 0xA9, 0x6C, 0x56, 0xF4, 0xEA, 0x65, 0x7A, 0xAE, 0x08,
+  0xBA, 0x78, 0x25, 0x2E, 0x1C, 0xA6, 0xB4, 0xC6, 0xE8, 0xDD, 0x74, 0x1F, 0x4B, 0xBD, 0x8B, 0x8A,
+  0x70, 0x3E, 0xB5, 0x66, 0x48, 0x03, 0xF6, 0x0E, 0x61, 0x35, 0x57, 0xB9, 0x86, 0xC1, 0x1D, 0x9E,
+  0xE1, 0xF8, 0x98, 0x11, 0x69, 0xD9, 0x8E, 0x94, 0x9B, 0x1E, 0x87, 0xE9, 0xCE, 0x55, 0x28, 0xDF,
+  0x8C, 0xA1, 0x89, 0x0D, 0xBF, 0xE6, 0x42, 0x68, 0x41, 0x99, 0x2D, 0x0F, 0xB0, 0x54, 0xBB, 0x16,
+};
+
+static void aes_expand(uint8_t *round_keys, const uint8_t *key);
+static void aes_encrypt(const uint8_t *round_keys, uint8_t *block);
+
+static void aes_init(void *ctx, const uint8_t *key, const uint8_t *nonce) {
+  aes_ctx_t *c = (aes_ctx_t *)ctx;
+  aes_expand(c->round_keys, key);
+  memcpy(c->nonce, nonce, sizeof(c->nonce));
+}
+
+static void aes_keystream(const void *ctx, uint32_t counter, uint8_t *out, size_t len) {
+  const aes_ctx_t *c = (const aes_ctx_t *)ctx;
+
+  for (uint32_t index = 0; len > 0; index++) {
+    uint8_t block[AES_BLOCK_SIZE];
+    memcpy(block, c->nonce, sizeof(c->nonce));
+    for (uint8_t i = 0; i < 4; i++) {
+      block[8 + i] = (uint8_t)(counter >> (24 - 8 * i));
+      block[12 + i] = (uint8_t)(index >> (24 - 8 * i));
+    }
+    aes_encrypt(c->round_keys, block);
+
+    size_t n = (len < sizeof(block)) ? len : sizeof(block);
+    memcpy(out, block, n);
+    out += n;
+    len -= n;
+  }
+}
+
+// FIPS-197 appendix C.1
+static bool aes_selftest(void) {
+  static const uint8_t expected[AES_BLOCK_SIZE] = {
+    0x69, 0xC4, 0xE0, 0xD8, 0x6A, 0x7B, 0x04, 0x30,
+    0xD8, 0xCD, 0xB7, 0x80, 0x70, 0xB4, 0xC5, 0x5A
+  };
+
+  uint8_t key[AES_BLOCK_SIZE];
+  uint8_t block[AES_BLOCK_SIZE];
+  for (uint8_t i = 0; i < AES_BLOCK_SIZE; i++) {
+    key[i] = i;
+    block[i] = (uint8_t)(i * 0x11);
+  }
+
+  uint8_t round_keys[AES_BLOCK_SIZE * (AES_ROUNDS + 1)];
+  aes_expand(round_keys, key);
+  aes_encrypt(round_keys, block);
+
+  for (uint8_t i = 0; i < AES_BLOCK_SIZE; i++) {
+    if (block[i] != expected[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+const hrms_cipher_backend_t hrms_cipher_aes = {
+  "aes128", sizeof(aes_ctx_t), aes_init, aes_keystream, aes_selftest
+};
+
+static void aes_expand(uint8_t *round_keys, const uint8_t *key) {
+  uint8_t rcon = 0x01;
+
+  memcpy(round_keys, key, AES_BLOCK_SIZE);
+
+  for (uint8_t i = 4; i < 4 * (AES_ROUNDS + 1); i++) {
+    uint8_t t[4];
+    memcpy(t, &round_keys[(i - 1) * 4], 4);
+
+    if (i % 4 == 0) {
+      // RotWord, SubWord, Rcon
+      uint8_t first = t[0];
+      t[0] = aes_sbox[t[1]] ^ rcon;
+      t[1] = aes_sbox[t[2]];
+      t[2] = aes_sbox[t[3]];
+      t[3] = aes_sbox[first];
+      rcon = AES_XTIME(rcon);
+    }
+
+    for (uint8_t j = 0; j < 4; j++) {
+      round_keys[i * 4 + j] = round_keys[(i - 4) * 4 + j] ^ t[j];
+    }
+  }
+}
+
+// State is column-major, as the block bytes come
+static void aes_encrypt(const uint8_t *round_keys, uint8_t *block) {
+  for (uint8_t i = 0; i < AES_BLOCK_SIZE; i++) {
+    block[i] ^= round_keys[i];
+  }
+
+  for (uint8_t round = 1; round <= AES_ROUNDS; round++) {
+    uint8_t s[AES_BLOCK_SIZE];
+
+    // SubBytes and ShiftRows together: row r moves left by r columns
+    for (uint8_t col = 0; col < 4; col++) {
+      for (uint8_t row = 0; row < 4; row++) {
+        s[col * 4 + row] = aes_sbox[block[((col + row) % 4) * 4 + row]];
+      }
+    }
+
+    if (round < AES_ROUNDS) {
+      for (uint8_t col = 0; col < 4; col++) {
+        uint8_t *c = &s[col * 4];
+        uint8_t all = c[0] ^ c[1] ^ c[2] ^ c[3];
+        uint8_t first = c[0];
+        c[0] ^= all ^ AES_XTIME((uint8_t)(c[0] ^ c[1]));
+        c[1] ^= all ^ AES_XTIME((uint8_t)(c[1] ^ c[2]));
+        c[2] ^= all ^ AES_XTIME((uint8_t)(c[2] ^ c[3]));
+        c[3] ^= all ^ AES_XTIME((uint8_t)(c[3] ^ first));
+      }
+    }
+
+    const uint8_t *k = &round_keys[round * AES_BLOCK_SIZE];
+    for (uint8_t i = 0; i < AES_BLOCK_SIZE; i++) {
+      block[i] = s[i] ^ k[i];
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+#include "hrms_cipher.h"
+#include "libc_stubs.h"
+
+#if HRMS_CIPHER_BACKEND == HRMS_CIPHER_CHACHA20 || HRMS_CIPHER_BENCH
+
+#define CHACHA_ROTL(v, n) (((v) << (n)) | ((v) >> (32 - (n))))
+
+#define CHACHA_QUARTER(a, b, c, d)                \
+  do {                                            \
+    a += b; d ^= a; d = CHACHA_ROTL(d, 16);       \
+    c += d; b ^= c; b = CHACHA_ROTL(b, 12);       \
+    a += b; d ^= a; d = CHACHA_ROTL(d, 8);        \
+    c += d; b ^= c; b = CHACHA_ROTL(b, 7);        \
+  } while (0)
+
+// Block input: constants, key, block counter (word 12), nonce
+typedef struct {
+  uint32_t state[16];
+} chacha_ctx_t;
+
+typedef char chacha_ctx_fits[(sizeof(chacha_ctx_t) <= HRMS_CIPHER_CTX_SIZE) ? 1 : -1];
+
+static uint32_t chacha_get_u32(const uint8_t *buf);
+static void chacha_block(const uint32_t *state, uint32_t counter, uint8_t *out, size_t len);
+
+static void chacha_init(void *ctx, const uint8_t *key, const uint8_t *nonce) {
+  chacha_ctx_t *c = (chacha_ctx_t *)ctx;
+
+  // "expand 32-byte k"
+  c->state[0] = 0x61707865;
+  c->state[1] = 0x3320646E;
+  c->state[2] = 0x79622D32;
+  c->state[3] = 0x6B206574;
+  for (uint8_t i = 0; i < 8; i++) {
+    c->state[4 + i] = chacha_get_u32(&key[i * 4]);
+  }
+  c->state[12] = 0;
+  for (uint8_t i = 0; i < 3; i++) {
+    c->state[13 + i] = chacha_get_u32(&nonce[i * 4]);
+  }
+}
+
+static void chacha_keystream(const void *ctx, uint32_t counter, uint8_t *out, size_t len) {
+  chacha_block(((const chacha_ctx_t *)ctx)->state, counter, out, len);
+}
+
+// RFC 8439 section 2.3.2
+static bool chacha_selftest(void) {
+  static const uint8_t nonce[HRMS_CIPHER_NONCE_SIZE] = {
+    0x00, 0x00, 0x00, 0x09, 0x00, 0x00, 0x00, 0x4A, 0x00, 0x00, 0x00, 0x00
+  };
+  static const uint8_t expected[8] = { 0x10, 0xF1, 0xE7, 0xE4, 0xD1, 0x3B, 0x59, 0x15 };
+
+  uint8_t key[HRMS_CIPHER_KEY_SIZE];
+  for (uint8_t i = 0; i < sizeof(key); i++) {
+    key[i] = i;
+  }
+
+  chacha_ctx_t ctx;
+  uint8_t out[sizeof(expected)];
+  chacha_init(&ctx, key, nonce);
+  chacha_block(ctx.state, 1, out, sizeof(out));
+
+  for (uint8_t i = 0; i < sizeof(expected); i++) {
+    if (out[i] != expected[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+const hrms_cipher_backend_t hrms_cipher_chacha20 = {
+  "chacha20", sizeof(chacha_ctx_t), chacha_init, chacha_keystream, chacha_selftest
+};
+
+static uint32_t chacha_get_u32(const uint8_t *buf) {
+  return (uint32_t)buf[0] | ((uint32_t)buf[1] << 8) |
+         ((uint32_t)buf[2] << 16) | ((uint32_t)buf[3] << 24);
+}
+
+// First `len` bytes of the block for `counter`
+static void chacha_block(const uint32_t *state, uint32_t counter, uint8_t *out, size_t len) {
+  uint32_t x[16];
+
+  memcpy(x, state, sizeof(x));
+  x[12] = counter;
+
+  for (uint8_t i = 0; i < 10; i++) {
+    CHACHA_QUARTER(x[0], x[4], x[8],  x[12]);
+    CHACHA_QUARTER(x[1], x[5], x[9],  x[13]);
+    CHACHA_QUARTER(x[2], x[6], x[10], x[14]);
+    CHACHA_QUARTER(x[3], x[7], x[11], x[15]);
+    CHACHA_QUARTER(x[0], x[5], x[10], x[15]);
+    CHACHA_QUARTER(x[1], x[6], x[11], x[12]);
+    CHACHA_QUARTER(x[2], x[7], x[8],  x[13]);
+    CHACHA_QUARTER(x[3], x[4], x[9],  x[14]);
+  }
+
+  for (size_t i = 0; i < len; i++) {
+    uint32_t word = x[i / 4] + ((i / 4 == 12) ? counter : state[i / 4]);
+    out[i] = (uint8_t)(word >> (8 * (i % 4)));
+  }
+}
+
+#endif
@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+#include "hrms_cipher.h"
+#include "libc_stubs.h"
+
+#if HRMS_CIPHER_BACKEND == HRMS_CIPHER_SPECK || HRMS_CIPHER_BENCH
+
+#define SPECK_ROUNDS  27
+#define SPECK_ROR(v, n) (((v) >> (n)) | ((v) << (32 - (n))))
+#define SPECK_ROL(v, n) (((v) << (n)) | ((v) >> (32 - (n))))
+
+// Speck64/128: expanded round keys, nonce word 0 for the block input
+typedef struct {
+  uint32_t round_keys[SPECK_ROUNDS];
+  uint32_t nonce;
+} speck_ctx_t;
+
+typedef char speck_ctx_fits[(sizeof(speck_ctx_t) <= HRMS_CIPHER_CTX_SIZE) ? 1 : -1];
+
+static uint32_t speck_get_u32(const uint8_t *buf);
+static void speck_expand(uint32_t *round_keys, const uint8_t *key);
+static void speck_encrypt(const uint32_t *round_keys, uint32_t *x, uint32_t *y);
+
+static void speck_init(void *ctx, const uint8_t *key, const uint8_t *nonce) {
+  speck_ctx_t *c = (speck_ctx_t *)ctx;
+  speck_expand(c->round_keys, key);
+  c->nonce = speck_get_u32(nonce);
+}
+
+static void speck_keystream(const void *ctx, uint32_t counter, uint8_t *out, size_t len) {
+  const speck_ctx_t *c = (const speck_ctx_t *)ctx;
+
+  for (uint32_t index = 0; len > 0; index++) {
+    uint32_t x = c->nonce ^ index;
+    uint32_t y = counter;
+    speck_encrypt(c->round_keys, &x, &y);
+
+    uint8_t block[8];
+    for (uint8_t i = 0; i < 4; i++) {
+      block[i] = (uint8_t)(x >> (8 * i));
+      block[4 + i] = (uint8_t)(y >> (8 * i));
+    }
+
+    size_t n = (len < sizeof(block)) ? len : sizeof(block);
+    memcpy(out, block, n);
+    out += n;
+    len -= n;
+  }
+}
+
+// Speck64/128 vector from the Simon and Speck paper (appendix C)
+static bool speck_selftest(void) {
+  static const uint8_t key[16] = {
+    0x00, 0x01, 0x02, 0x03, 0x08, 0x09, 0x0A, 0x0B,
+    0x10, 0x11, 0x12, 0x13, 0x18, 0x19, 0x1A, 0x1B
+  };
+
+  uint32_t round_keys[SPECK_ROUNDS];
+  uint32_t x = 0x3B726574;
+  uint32_t y = 0x7475432D;
+  speck_expand(round_keys, key);
+  speck_encrypt(round_keys, &x, &y);
+
+  return x == 0x8C6FA548 && y == 0x454E028B;
+}
+
+const hrms_cipher_backend_t hrms_cipher_speck = {
+  "speck64", sizeof(speck_ctx_t), speck_init, speck_keystream, speck_selftest
+};
+
+static uint32_t speck_get_u32(const uint8_t *buf) {
+  return (uint32_t)buf[0] | ((uint32_t)buf[1] << 8) |
+         ((uint32_t)buf[2] << 16) | ((uint32_t)buf[3] << 24);
+}
+
+// Key words k0, l0, l1, l2 from the first 16 key bytes, little-endian
+static void speck_expand(uint32_t *round_keys, const uint8_t *key) {
+  uint32_t l[3];
+  uint32_t k = speck_get_u32(&key[0]);
+  for (uint8_t i = 0; i < 3; i++) {
+    l[i] = speck_get_u32(&key[4 + i * 4]);
+  }
+
+  for (uint8_t i = 0; i < SPECK_ROUNDS; i++) {
+    round_keys[i] = k;
+    uint32_t next = (k + SPECK_ROR(l[i % 3], 8)) ^ i;
+    k = SPECK_ROL(k, 3) ^ next;
+    l[i % 3] = next;
+  }
+}
+
+static void speck_encrypt(const uint32_t *round_keys, uint32_t *x, uint32_t *y) {
+  uint32_t a = *x;
+  uint32_t b = *y;
+
+  for (uint8_t i = 0; i < SPECK_ROUNDS; i++) {
+    a = (SPECK_ROR(a, 8) + b) ^ round_keys[i];
+    b = SPECK_ROL(b, 3) ^ a;
+  }
+
+  *x = a;
+  *y = b;
+}
+
+#endif
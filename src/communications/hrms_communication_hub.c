@@ -10,25 +10,184 @@
 #include "hrms_communication_hub.h"
 #include "hrms_nrf24_comm.h"
 #include "hrms_packet_utils.h"
+#include "hrms_link_quality.h"
+#include "hrms_spectrum.h"
+#include "hrms_reliable.h"
+#include "hrms_tx_sched.h"
+#include "hrms_latency.h"
+#include "hrms_timesync.h"
+#include "hrms_frag.h"
+#include "hrms_keystream.h"
+#include "hrms_param.h"
+#include "hrms_timer.h"
+#include "hrms_uart.h"
+#include "hrms_oled.h"
+#include "hrms_config.h"
 #include "hrms_types.h"
 #include "ORION_Config.h"
+#if !HRMS_KEYSTREAM_CACHE
 #include "orion.h"
+#endif
+#include "hrms_board.h"
 #include "FreeRTOS.h"
 #include "task.h"
 #include "libc_stubs.h"
 
+// Scheduler tags: what to do once a queued frame has been sent
+#define COMM_HUB_TAG_NONE       0
+#define COMM_HUB_TAG_JOYSTICK   1     // Report the outcome to the joystick codec
+#define COMM_HUB_TAG_SYNC       2     // Placeholder: the sync request is built as it leaves
+
+// Largest control payload before encryption
+#if HRMS_KEYSTREAM_CACHE
+#define COMM_HUB_CONTROL_MAX_PLAINTEXT  HRMS_KEYSTREAM_MAX_DATA
+#else
+#define COMM_HUB_CONTROL_MAX_PLAINTEXT  HRMS_WIRE_MAX_PAYLOAD_SIZE
+#endif
+
 // Communication hub statistics
 static hrms_comm_stats_t comm_stats = {0};
+static hrms_comm_source_stats_t source_stats[HRMS_COMM_MAX_SOURCES];
+static hrms_reliable_deliver_t reliable_handler = NULL;
+static hrms_frag_deliver_t message_handler = NULL;
+static uint32_t last_rx_cycles = 0;   // Arrival of the frame being handled
+static hrms_timesync_t timesync;
+#if HRMS_KEYSTREAM_CACHE
+#if defined(HRMS_KEYSTREAM_KEY_PLACEHOLDER) && !defined(HRMS_KEYSTREAM_PLACEHOLDER_OK)
+#error "No link key provisioned - run make link-key (HRMS_KEYSTREAM_KEY is a public placeholder)"
+#endif
+static hrms_keystream_t keystream;
+static bool session_due = false;      // Announce our session on the next process()
+static uint32_t last_session_ms = 0;
+#endif
+#if HRMS_JOYSTICK_DELTA
+static hrms_joystick_codec_t joystick_codec;
+#endif
+#if HRMS_JOYSTICK_BATCH
+#if !HRMS_JOYSTICK_DELTA
+#error "HRMS_JOYSTICK_BATCH needs HRMS_JOYSTICK_DELTA"
+#endif
+// Consecutive samples waiting for the next frame, oldest first
+static hrms_joystick_sample_t batch_samples[HRMS_JOYSTICK_BATCH_SIZE];
+static uint8_t batch_count = 0;
+static uint8_t batch_period_ms = 0;   // Sample period when the batch started
+#endif
+#if HRMS_HEARTBEAT_INTERVAL_MS > 0
+static uint32_t last_heartbeat_ms = 0;
+#endif
+#if HRMS_LATENCY_PROBE_MS > 0
+static uint32_t last_probe_ms = 0;
+#endif
+#if HRMS_TIMESYNC_PERIOD_MS > 0
+static uint32_t last_sync_ms = 0;
+#endif
+
+static void comm_hub_adapt_link(void);
+static bool comm_hub_send_link_switch(uint8_t op, uint8_t value);
+static bool comm_hub_switch_channel(uint8_t channel);
+static bool comm_hub_apply_channel(uint32_t channel);
+static bool comm_hub_move_to_quietest(void);
+static void comm_hub_deliver_reliable(const hrms_comm_packet_t *packet);
+static bool comm_hub_answer_config(const hrms_comm_packet_t *packet);
+static void comm_hub_deliver_message(uint8_t source_id, uint8_t kind,
+                                     const uint8_t *data, size_t len);
+static bool comm_hub_queue_frame(const uint8_t *frame, size_t len);
+static size_t comm_hub_build_frame(hrms_comm_packet_type_t type, uint8_t dest_id,
+                                   const uint8_t *payload, size_t len, uint8_t *frame);
+static size_t comm_hub_build_sync(uint8_t dest_id, uint8_t *frame);
+static bool comm_hub_send_direct(hrms_comm_packet_type_t type, uint8_t dest_id,
+                                 const uint8_t *payload, size_t len);
+static void comm_hub_note_control_sent(const uint8_t *frame);
+
+// Receive dispatch: one handler per packet type, called from the hub task
+typedef void (*comm_hub_rx_fn_t)(const hrms_comm_packet_t *packet, uint32_t now_ms);
+
+static void comm_hub_rx_link(const hrms_comm_packet_t *packet, uint32_t now_ms);
+static void comm_hub_rx_ack(const hrms_comm_packet_t *packet, uint32_t now_ms);
+static void comm_hub_rx_reliable(const hrms_comm_packet_t *packet, uint32_t now_ms);
+static void comm_hub_rx_probe(const hrms_comm_packet_t *packet, uint32_t now_ms);
+static void comm_hub_rx_sync(const hrms_comm_packet_t *packet, uint32_t now_ms);
+static void comm_hub_rx_session(const hrms_comm_packet_t *packet, uint32_t now_ms);
+static void comm_hub_rx_fragment(const hrms_comm_packet_t *packet, uint32_t now_ms);
+static void comm_hub_rx_control(const hrms_comm_packet_t *packet, uint32_t now_ms);
+static void comm_hub_rx_app(const hrms_comm_packet_t *packet, uint32_t now_ms);
+
+static const comm_hub_rx_fn_t rx_dispatch[HRMS_COMM_PACKET_TYPE_COUNT] = {
+  [HRMS_COMM_PACKET_NONE]        = NULL,
+  [HRMS_COMM_PACKET_HEARTBEAT]   = comm_hub_rx_app,
+  [HRMS_COMM_PACKET_SENSOR_DATA] = comm_hub_rx_reliable,
+  [HRMS_COMM_PACKET_CONTROL_CMD] = comm_hub_rx_control,
+  [HRMS_COMM_PACKET_STATUS]      = comm_hub_rx_reliable,
+  [HRMS_COMM_PACKET_CONFIG]      = comm_hub_rx_reliable,
+  [HRMS_COMM_PACKET_ACK]         = comm_hub_rx_ack,
+  [HRMS_COMM_PACKET_ERROR]       = comm_hub_rx_app,
+  [HRMS_COMM_PACKET_LINK]        = comm_hub_rx_link,
+  [HRMS_COMM_PACKET_PROBE]       = comm_hub_rx_probe,
+  [HRMS_COMM_PACKET_FRAGMENT]    = comm_hub_rx_fragment,
+  [HRMS_COMM_PACKET_SYNC]        = comm_hub_rx_sync,
+  [HRMS_COMM_PACKET_SESSION]     = comm_hub_rx_session,
+};
+
+// Application handlers for the types routed to comm_hub_rx_app
+static hrms_comm_rx_handler_t rx_app_handlers[HRMS_COMM_PACKET_TYPE_COUNT];
+
+static bool comm_hub_send_control(hrms_comm_packet_type_t type, uint8_t dest_id, uint32_t timestamp,
+                                  const uint8_t *plaintext, size_t len);
+#if HRMS_KEYSTREAM_CACHE
+static bool comm_hub_seal(hrms_comm_packet_t *packet, const uint8_t *plaintext, size_t len);
+static bool comm_hub_send_session(void);
+#endif
+#if HRMS_JOYSTICK_BATCH
+static void comm_hub_flush_batch(void);
+#endif
+#if HRMS_SPECTRUM_OLED_VIEW
+static void comm_hub_show_spectrum(void);
+#endif
 
 void hrms_communication_hub_init(void) {
   // Initialize statistics
   memset(&comm_stats, 0, sizeof(comm_stats));
+  memset(source_stats, 0, sizeof(source_stats));
+#if HRMS_JOYSTICK_DELTA
+  hrms_joystick_codec_init(&joystick_codec);
+#endif
+  hrms_latency_init();
+  hrms_timesync_init(&timesync, hrms_timer_cycles);
   
+#if HRMS_KEYSTREAM_CACHE
+  // Key shared by the pair, nonce fresh every boot - announced by process()
+  static const uint8_t key[HRMS_KEYSTREAM_KEY_SIZE] = HRMS_KEYSTREAM_KEY;
+  uint8_t seed[HRMS_KEYSTREAM_SEED_SIZE];
+  hrms_board_seed(seed, sizeof(seed));
+  hrms_keystream_init(&keystream, key, seed);
+  hrms_keystream_refill(&keystream, HRMS_KEYSTREAM_DEPTH);
+  session_due = true;
+#else
   // Initialize ORION encryption system
   ORION_Init();
+#endif
   
   // Initialize communication modules (following sensor/actuator pattern)
   hrms_nrf24_comm_init();
+  hrms_tx_sched_init(xTaskGetTickCount());
+  hrms_reliable_init(comm_hub_queue_frame, comm_hub_deliver_reliable);
+  hrms_frag_init(hrms_nrf24_comm_enqueue, comm_hub_deliver_message);
+  hrms_nrf24_comm_set_tx_callback(hrms_frag_on_tx_done);
+  
+  // A channel set by the peer moves both ends, like a spectrum move
+  hrms_param_set_hook(HRMS_PARAM_RADIO_CHANNEL, comm_hub_apply_channel);
+  
+#if HRMS_SPECTRUM_BOOT_SWEEPS > 0
+  // Scheduler not running yet - nothing else draws on the OLED
+  hrms_spectrum_reset();
+  for (uint8_t i = 0; i < HRMS_SPECTRUM_BOOT_SWEEPS; i++) {
+    hrms_spectrum_scan(1);
+#if HRMS_SPECTRUM_OLED_VIEW
+    comm_hub_show_spectrum();
+#endif
+  }
+  comm_hub_move_to_quietest();
+#endif
 }
 
 bool hrms_communication_hub_send(const uint8_t *data, size_t len) {
@@ -58,25 +217,288 @@ bool hrms_communication_hub_receive(uint8_t *data, size_t max_len, size_t *recei
   *received_len = 0;
   
   // Check nRF24L01 for received data
-  bool received = hrms_nrf24_comm_receive(data, max_len, received_len);
+  uint8_t pipe = 0;
+  bool received = hrms_nrf24_comm_receive_from(data, max_len, received_len, &pipe);
   
   if (received) {
+    // IRQ edge where there is one; the read time includes the task wake-up
+    if (!hrms_nrf24_comm_rx_stamp(&last_rx_cycles)) {
+      last_rx_cycles = hrms_timer_cycles();
+    }
+    uint32_t now = xTaskGetTickCount();
     comm_stats.packets_received++;
-    comm_stats.last_rx_timestamp = xTaskGetTickCount();
+    comm_stats.last_rx_timestamp = now;
+    
+    // Each RX pipe is one transmitter of the star
+    if (pipe < HRMS_COMM_MAX_SOURCES) {
+      source_stats[pipe].packets_received++;
+      source_stats[pipe].bytes_received += *received_len;
+      source_stats[pipe].last_rx_timestamp = now;
+    }
   }
   
   return received;
 }
 
+void hrms_communication_hub_set_task(TaskHandle_t task) {
+  hrms_nrf24_comm_set_task(task);
+}
+
+bool hrms_communication_hub_wait(uint32_t timeout_ms) {
+  return hrms_nrf24_comm_wait(timeout_ms);
+}
+
 void hrms_communication_hub_process(void) {
   // Process nRF24L01 communication module
   hrms_nrf24_comm_process();
+  
+#if HRMS_JOYSTICK_BATCH
+  // Flush deadline bounds the latency of the oldest queued sample
+  if (batch_count > 0 &&
+      (xTaskGetTickCount() - batch_samples[0].timestamp) >= HRMS_JOYSTICK_BATCH_FLUSH_MS) {
+    comm_hub_flush_batch();
+  }
+#endif
+  
+  // Retransmit unACKed config/telemetry frames
+  hrms_reliable_poll(xTaskGetTickCount());
+  
+  // Expire partial messages, finish or give up the one being sent
+  hrms_frag_poll(xTaskGetTickCount());
+  
+#if HRMS_HEARTBEAT_INTERVAL_MS > 0
+  // Only a silent link needs a beacon; any frame sent proves liveness
+  uint32_t now = xTaskGetTickCount();
+  if ((now - comm_stats.last_tx_timestamp) >= HRMS_HEARTBEAT_INTERVAL_MS &&
+      (now - last_heartbeat_ms) >= HRMS_HEARTBEAT_INTERVAL_MS) {
+    last_heartbeat_ms = now;
+    hrms_communication_hub_send_heartbeat();
+  }
+#endif
+  
+#if HRMS_LATENCY_PROBE_MS > 0
+  if ((xTaskGetTickCount() - last_probe_ms) >= HRMS_LATENCY_PROBE_MS) {
+    last_probe_ms = xTaskGetTickCount();
+    hrms_communication_hub_send_probe();
+  }
+#endif
+  
+#if HRMS_TIMESYNC_PERIOD_MS > 0
+  if ((xTaskGetTickCount() - last_sync_ms) >= HRMS_TIMESYNC_PERIOD_MS) {
+    last_sync_ms = xTaskGetTickCount();
+    hrms_communication_hub_send_sync(0x02); // Remote receiver ID
+  }
+#endif
+  
+#if HRMS_KEYSTREAM_CACHE
+  // At boot, when the peer asks, and periodically for a peer that rebooted
+  if (session_due || (xTaskGetTickCount() - last_session_ms) >= HRMS_KEYSTREAM_SESSION_MS) {
+    session_due = !comm_hub_send_session();
+    last_session_ms = xTaskGetTickCount();
+  }
+#endif
+  
+  // Adapt data rate / TX power to the measured link quality
+  comm_hub_adapt_link();
+  
+#if HRMS_KEYSTREAM_CACHE
+  // Off the critical path: the next control frames only need an XOR
+  hrms_keystream_refill(&keystream, HRMS_KEYSTREAM_DEPTH);
+#endif
+}
+
+void hrms_communication_hub_handle_packet(const hrms_comm_packet_t *packet) {
+  if (!packet) {
+    return;
+  }
+  
+  uint32_t now = xTaskGetTickCount();
+  hrms_link_quality_on_rx(now);
+  
+  comm_hub_rx_fn_t handler = NULL;
+  if ((uint32_t)packet->packet_type < HRMS_COMM_PACKET_TYPE_COUNT) {
+    handler = rx_dispatch[packet->packet_type];
+  }
+  
+  if (handler) {
+    handler(packet, now);
+  } else {
+    comm_stats.packets_unhandled++;
+  }
+}
+
+void hrms_communication_hub_service_rx(void) {
+  uint8_t frame[HRMS_WIRE_MAX_FRAME_SIZE];
+  size_t frame_len = 0;
+  hrms_comm_packet_t packet;
+  
+  // One IRQ edge may cover several payloads - drain the RX FIFO
+  while (hrms_communication_hub_receive(frame, sizeof(frame), &frame_len)) {
+#if HRMS_KEYSTREAM_CACHE
+    // Forged, replayed or stale control and link frames go before any decoding
+    uint8_t plaintext[HRMS_KEYSTREAM_MAX_DATA];
+    size_t plaintext_len = 0;
+    bool sealed = frame_len > 0 && (frame[0] == HRMS_COMM_PACKET_CONTROL_CMD ||
+                                    frame[0] == HRMS_COMM_PACKET_LINK);
+    if (sealed) {
+      if (frame_len < HRMS_WIRE_HEADER_SIZE || frame[4] > frame_len - HRMS_WIRE_HEADER_SIZE) {
+        comm_stats.packets_dropped++;
+        continue;
+      }
+      plaintext_len = hrms_keystream_decrypt(&keystream, frame, HRMS_WIRE_HEADER_SIZE,
+                                             &frame[HRMS_WIRE_HEADER_SIZE], frame[4],
+                                             plaintext, sizeof(plaintext), NULL);
+      if (plaintext_len == 0) {
+        comm_stats.packets_rejected++;
+        continue;
+      }
+    }
+#endif
+    
+    // Decoding checks length and CRC; handlers only ever see this one copy
+    if (!hrms_packet_decode(frame, frame_len, &packet)) {
+      comm_stats.packets_dropped++;
+      continue;
+    }
+#if HRMS_KEYSTREAM_CACHE
+    if (sealed) {
+      memcpy(packet.payload, plaintext, plaintext_len);
+      packet.payload_size = (uint8_t)plaintext_len;
+    }
+#endif
+    hrms_communication_hub_handle_packet(&packet);
+  }
+}
+
+bool hrms_communication_hub_set_rx_handler(hrms_comm_packet_type_t type,
+                                           hrms_comm_rx_handler_t handler) {
+  // Types the hub consumes itself cannot be taken over
+  if ((uint32_t)type >= HRMS_COMM_PACKET_TYPE_COUNT ||
+      (rx_dispatch[type] != comm_hub_rx_app && rx_dispatch[type] != comm_hub_rx_control)) {
+    return false;
+  }
+  
+  rx_app_handlers[type] = handler;
+  return true;
+}
+
+bool hrms_communication_hub_send_reliable(hrms_comm_packet_type_t type, uint8_t dest_id,
+                                          const uint8_t *payload, size_t len) {
+  if (!hrms_reliable_carries(type) || (len > 0 && !payload) ||
+      len > HRMS_WIRE_MAX_PAYLOAD_SIZE) {
+    return false;
+  }
+  
+  hrms_comm_packet_t packet;
+  memset(&packet, 0, sizeof(packet));
+  
+  uint32_t now = xTaskGetTickCount();
+  packet.packet_type = type;
+  packet.source_id = 0x01; // Hermes controller ID
+  packet.dest_id = dest_id;
+  packet.timestamp = now;
+  packet.payload_size = (uint8_t)len;
+  if (len > 0) {
+    memcpy(packet.payload, payload, len);
+  }
+  
+  // packet_id becomes the window sequence number
+  return hrms_reliable_send(&packet, now);
+}
+
+void hrms_communication_hub_set_reliable_handler(hrms_reliable_deliver_t handler) {
+  reliable_handler = handler;
+}
+
+bool hrms_communication_hub_send_message(uint8_t kind, uint8_t dest_id,
+                                         const uint8_t *data, size_t len) {
+  return hrms_frag_send(kind, dest_id, data, len, xTaskGetTickCount());
+}
+
+bool hrms_communication_hub_message_busy(void) {
+  return hrms_frag_busy();
+}
+
+void hrms_communication_hub_set_message_handler(hrms_frag_deliver_t handler) {
+  message_handler = handler;
+}
+
+bool hrms_communication_hub_select_channel(uint8_t sweeps) {
+  hrms_spectrum_reset();
+  if (!hrms_spectrum_scan(sweeps)) {
+    return false;
+  }
+  
+  return comm_hub_move_to_quietest();
 }
 
 void hrms_communication_hub_get_stats(hrms_comm_stats_t *stats) {
-  if (stats) {
-    memcpy(stats, &comm_stats, sizeof(hrms_comm_stats_t));
+  if (!stats) {
+    return;
   }
+  
+  hrms_latency_stats_t latency;
+  hrms_latency_get_stats(&latency);
+  comm_stats.rtt_min_us = latency.rtt_min_us;
+  comm_stats.rtt_median_us = latency.rtt_median_us;
+  comm_stats.rtt_p99_us = latency.rtt_p99_us;
+  comm_stats.rtt_max_us = latency.rtt_max_us;
+  comm_stats.one_way_us = latency.one_way_us;
+  
+  memcpy(stats, &comm_stats, sizeof(hrms_comm_stats_t));
+}
+
+bool hrms_communication_hub_send_probe(void) {
+  uint8_t payload[HRMS_LATENCY_REQUEST_SIZE];
+  size_t len = hrms_latency_make_request(payload, sizeof(payload));
+  
+  return len > 0 && comm_hub_send_direct(HRMS_COMM_PACKET_PROBE, 0x02, payload, len); // Remote receiver ID
+}
+
+bool hrms_communication_hub_send_sync(uint8_t dest_id) {
+  // Queued behind control frames as the destination only; t1 is stamped when it is popped
+  return hrms_tx_sched_push(HRMS_TX_CLASS_ACK, &dest_id, 1, COMM_HUB_TAG_SYNC);
+}
+
+void hrms_communication_hub_dump_stats(void) {
+  hrms_uart_send_str("tx ");
+  hrms_uart_send_dec(comm_stats.packets_sent);
+  hrms_uart_send_str(" failed ");
+  hrms_uart_send_dec(comm_stats.packets_failed);
+  hrms_uart_send_str(" rx ");
+  hrms_uart_send_dec(comm_stats.packets_received);
+  hrms_uart_send_str("\r\n");
+  
+  hrms_latency_dump();
+  hrms_timesync_dump(&timesync);
+  hrms_uart_send_str("sample age us ");
+  hrms_uart_send_dec(comm_stats.sample_age_us);
+  hrms_uart_send_str("\r\n");
+  
+#if HRMS_KEYSTREAM_CACHE
+  hrms_keystream_stats_t ks;
+  hrms_keystream_get_stats(&keystream, &ks);
+  hrms_uart_send_str("keystream hit/miss ");
+  hrms_uart_send_dec(ks.hits);
+  hrms_uart_send_str("/");
+  hrms_uart_send_dec(ks.misses);
+  hrms_uart_send_str(" last cycles ");
+  hrms_uart_send_dec(ks.last_encrypt_cycles);
+  hrms_uart_send_str(" replayed ");
+  hrms_uart_send_dec(ks.replayed);
+  hrms_uart_send_str(" bad tag ");
+  hrms_uart_send_dec(ks.auth_failed);
+  hrms_uart_send_str("\r\n");
+#endif
+}
+
+bool hrms_communication_hub_get_source_stats(uint8_t source, hrms_comm_source_stats_t *stats) {
+  if (!stats || source >= HRMS_COMM_MAX_SOURCES) {
+    return false;
+  }
+  
+  memcpy(stats, &source_stats[source], sizeof(hrms_comm_source_stats_t));
+  return true;
 }
 
 // Wrapper functions for packet utilities (for backward compatibility)
@@ -97,37 +519,587 @@ bool hrms_communication_hub_send_joystick_data(const hrms_comm_command_t *comm_c
     return false;
   }
   
+  // Serialize joystick data as a typed payload (independent of struct layout)
+#if HRMS_JOYSTICK_DELTA
+  uint8_t plaintext[HRMS_WIRE_JOYSTICK_DELTA_MAX];
+  size_t plaintext_len = hrms_packet_encode_joystick_delta(&joystick_codec, &comm_cmd->joystick_data, 1,
+                                                           plaintext, sizeof(plaintext));
+#else
+  uint8_t plaintext[HRMS_WIRE_JOYSTICK_SIZE];
+  size_t plaintext_len = hrms_packet_encode_joystick(&comm_cmd->joystick_data,
+                                                     plaintext, sizeof(plaintext));
+#endif
+  if (plaintext_len == 0) {
+    return false;
+  }
+  
+  return comm_hub_send_control(comm_cmd->packet_type, comm_cmd->dest_id,
+                               xTaskGetTickCount(), plaintext, plaintext_len);
+}
+
+#if HRMS_JOYSTICK_BATCH
+bool hrms_communication_hub_push_sample(const hrms_joystick_sample_t *sample) {
+  if (!sample) {
+    return false;
+  }
+  
+  // Frames carry one period, so a missed sample or a new period starts a new frame
+  if (batch_count > 0) {
+    uint32_t expected = batch_samples[batch_count - 1].timestamp + batch_period_ms;
+    if (sample->timestamp != expected) {
+      comm_hub_flush_batch();
+    }
+  }
+  
+  if (batch_count == 0) {
+    batch_period_ms = (uint8_t)hrms_param_get(HRMS_PARAM_SAMPLE_INTERVAL_MS);
+  }
+  batch_samples[batch_count++] = *sample;
+  if (batch_count >= HRMS_JOYSTICK_BATCH_SIZE) {
+    comm_hub_flush_batch();
+  }
+  
+  return true;
+}
+#endif
+
+uint32_t hrms_communication_hub_idle_ms(uint32_t max_ms) {
+  uint32_t now = xTaskGetTickCount();
+  
+  // Queued frames wait for bulk tokens, or for a fragment burst to drain
+  // (its TX_DS interrupt wakes the task)
+  if (!hrms_nrf24_comm_tx_busy()) {
+    max_ms = hrms_tx_sched_next_ms(now, max_ms);
+  }
+  
+#if HRMS_JOYSTICK_BATCH
+  if (batch_count > 0) {
+    uint32_t age = now - batch_samples[0].timestamp;
+    uint32_t left = (age < HRMS_JOYSTICK_BATCH_FLUSH_MS) ? (HRMS_JOYSTICK_BATCH_FLUSH_MS - age) : 0;
+    return (left < max_ms) ? left : max_ms;
+  }
+#endif
+  return max_ms;
+}
+
+void hrms_communication_hub_service_tx(void) {
+  uint8_t frame[HRMS_WIRE_MAX_FRAME_SIZE];
+  size_t len = 0;
+  hrms_tx_class_t cls;
+  uint8_t tag;
+  uint32_t now = xTaskGetTickCount();
+  
+  // Fragments stream through the FIFO; let them drain rather than interleave
+  while (!hrms_nrf24_comm_tx_busy() && hrms_tx_sched_pop(now, frame, &len, &cls, &tag)) {
+    // Time spent in the queue must not count as flight time
+    if (tag == COMM_HUB_TAG_SYNC) {
+      len = comm_hub_build_sync(frame[0], frame);
+      if (len == 0) {
+        continue;
+      }
+    }
+    
+    bool success = hrms_communication_hub_send(frame, len);
+    
+    if (success && tag == COMM_HUB_TAG_JOYSTICK) {
+      comm_hub_note_control_sent(frame);
+    }
+    
+#if HRMS_JOYSTICK_DELTA
+    if (tag == COMM_HUB_TAG_JOYSTICK) {
+      // A keyframe becomes the delta reference only once the radio ACKed it
+      hrms_joystick_codec_on_ack(&joystick_codec, success);
+    }
+#else
+    (void)success;
+    (void)tag;
+#endif
+    
+    // One bulk frame per call, so it delays the next stick position by one frame at most
+    if (cls == HRMS_TX_CLASS_BULK) {
+      break;
+    }
+  }
+  
+  // Top up the FIFO with fragments only when nothing queued may go now,
+  // so a waiting control frame holds the stream back by one burst at most
+  if (hrms_tx_sched_next_ms(now, 1) > 0) {
+    hrms_frag_pump(now);
+  }
+}
+
+bool hrms_communication_hub_send_heartbeat(void) {
+  hrms_comm_packet_t packet;
+  hrms_packet_create_heartbeat(&packet, 0x01); // Hermes controller ID
+  
+  uint8_t frame[HRMS_WIRE_MAX_FRAME_SIZE];
+  size_t frame_len = hrms_packet_encode(&packet, frame, sizeof(frame));
+  if (frame_len == 0) {
+    return false;
+  }
+  
+  return hrms_tx_sched_push(HRMS_TX_CLASS_HEARTBEAT, frame, frame_len, COMM_HUB_TAG_NONE);
+}
+
+static void comm_hub_adapt_link(void) {
+  hrms_link_rf_t next;
+  uint32_t now = xTaskGetTickCount();
+  
+  switch (hrms_link_quality_evaluate(&next, now)) {
+    case HRMS_LINK_APPLY_LOCAL: {
+      hrms_link_quality_stats_t link;
+      hrms_link_quality_get_stats(&link);
+      
+      hrms_nrf24_comm_set_rf(next.datarate, next.power);
+      if (next.channel != link.rf.channel) {
+        hrms_nrf24_comm_set_channel(next.channel);
+        hrms_param_update(HRMS_PARAM_RADIO_CHANNEL, next.channel);
+      }
+      hrms_link_quality_commit(&next, now);
+      break;
+    }
+      
+    case HRMS_LINK_APPLY_COORDINATED:
+      // Switch only once the peer has ACKed the request at the current rate
+      if (comm_hub_send_link_switch(HRMS_LINK_OP_SWITCH_RATE, (uint8_t)next.datarate)) {
+        hrms_nrf24_comm_set_rf(next.datarate, next.power);
+        hrms_link_quality_commit(&next, now);
+      }
+      break;
+      
+    default:
+      break;
+  }
+}
+
+static bool comm_hub_send_link_switch(uint8_t op, uint8_t value) {
   hrms_comm_packet_t packet;
   memset(&packet, 0, sizeof(packet));
   
   uint32_t now = xTaskGetTickCount();
-  packet.packet_id = (uint8_t)(now % 255) + 1;
-  packet.packet_type = comm_cmd->packet_type;
+  packet.packet_id = hrms_packet_get_next_id();
+  packet.packet_type = HRMS_COMM_PACKET_LINK;
   packet.source_id = 0x01; // Hermes controller ID
-  packet.dest_id = comm_cmd->dest_id;
+  packet.dest_id = 0x00;
   packet.timestamp = now;
   
-  // Prepare joystick data for encryption
-  uint8_t plaintext[sizeof(hrms_joystick_data_t)];
-  memcpy(plaintext, &comm_cmd->joystick_data, sizeof(hrms_joystick_data_t));
+  // A forged switch would take the receiver off the link - sealed like sticks
+  uint8_t request[HRMS_LINK_SWITCH_SIZE] = { op, value };
+#if HRMS_KEYSTREAM_CACHE
+  if (!comm_hub_seal(&packet, request, sizeof(request))) {
+    return false;
+  }
+#else
+  packet.payload_size = sizeof(request);
+  memcpy(packet.payload, request, sizeof(request));
+#endif
+  
+  uint8_t frame[HRMS_WIRE_MAX_FRAME_SIZE];
+  size_t frame_len = hrms_packet_encode(&packet, frame, sizeof(frame));
+  if (frame_len == 0) {
+    return false;
+  }
+  
+  return hrms_communication_hub_send(frame, frame_len);
+}
+
+// Peer asked for a new rate/channel - it was ACKed at the old one, switch now
+static void comm_hub_rx_link(const hrms_comm_packet_t *packet, uint32_t now_ms) {
+  if (packet->payload_size < HRMS_LINK_SWITCH_SIZE) {
+    return;
+  }
+  
+  hrms_link_quality_stats_t link;
+  hrms_link_quality_get_stats(&link);
+  hrms_link_rf_t rf = link.rf;
+  
+  switch (packet->payload[0]) {
+    case HRMS_LINK_OP_SWITCH_RATE:
+      if (packet->payload[1] > NRF24L01_DATARATE_250KBPS) {
+        return;
+      }
+      rf.datarate = (nrf24l01_datarate_t)packet->payload[1];
+      hrms_nrf24_comm_set_rf(rf.datarate, rf.power);
+      break;
+      
+    case HRMS_LINK_OP_SWITCH_CHANNEL:
+      if (packet->payload[1] > NRF24L01_MAX_CHANNEL) {
+        return;
+      }
+      rf.channel = packet->payload[1];
+      hrms_nrf24_comm_set_channel(rf.channel);
+      hrms_param_update(HRMS_PARAM_RADIO_CHANNEL, rf.channel);
+      break;
+      
+    default:
+      return;
+  }
+  
+  hrms_link_quality_commit(&rf, now_ms);
+}
+
+static void comm_hub_rx_ack(const hrms_comm_packet_t *packet, uint32_t now_ms) {
+  (void)now_ms;
+  hrms_reliable_on_ack(packet);
+}
+
+// Config/telemetry go through the window; the deliver callback gets them in order
+static void comm_hub_rx_reliable(const hrms_comm_packet_t *packet, uint32_t now_ms) {
+  hrms_reliable_on_receive(packet, now_ms);
+}
+
+static void comm_hub_rx_fragment(const hrms_comm_packet_t *packet, uint32_t now_ms) {
+  hrms_frag_on_receive(packet, now_ms);
+}
+
+static void comm_hub_rx_control(const hrms_comm_packet_t *packet, uint32_t now_ms) {
+  hrms_latency_on_control_rx(packet->packet_id, last_rx_cycles);
+  
+  // Sample to arrival on one clock; negative within the 1 ms tick reads as 0
+  uint32_t sampled;
+  if (hrms_timesync_peer_tick_to_local(&timesync, (uint16_t)packet->timestamp, &sampled)) {
+    int32_t age = (int32_t)(last_rx_cycles - sampled);
+    comm_stats.sample_age_us = (age > 0) ? hrms_timer_cycles_to_us((uint32_t)age) : 0;
+  }
+  comm_hub_rx_app(packet, now_ms);
+}
+
+static void comm_hub_rx_app(const hrms_comm_packet_t *packet, uint32_t now_ms) {
+  (void)now_ms;
+  hrms_comm_rx_handler_t handler = rx_app_handlers[packet->packet_type];
+  if (handler) {
+    handler(packet);
+  } else {
+    comm_stats.packets_unhandled++;
+  }
+}
+
+static size_t comm_hub_build_frame(hrms_comm_packet_type_t type, uint8_t dest_id,
+                                   const uint8_t *payload, size_t len, uint8_t *frame) {
+  hrms_comm_packet_t packet;
+  memset(&packet, 0, sizeof(packet));
+  
+  packet.packet_id = hrms_packet_get_next_id();
+  packet.packet_type = type;
+  packet.source_id = 0x01; // Hermes controller ID
+  packet.dest_id = dest_id;
+  packet.timestamp = xTaskGetTickCount();
+  packet.payload_size = (uint8_t)len;
+  memcpy(packet.payload, payload, len);
+  
+  return hrms_packet_encode(&packet, frame, HRMS_WIRE_MAX_FRAME_SIZE);
+}
+
+// The one request per queued sync: t1 is stamped last, just before the frame is encoded
+static size_t comm_hub_build_sync(uint8_t dest_id, uint8_t *frame) {
+  uint8_t payload[HRMS_TIMESYNC_REQUEST_PREV_SIZE];
+  size_t len = hrms_timesync_make_request(&timesync, xTaskGetTickCount(), payload,
+                                          sizeof(payload));
+  if (len == 0) {
+    return 0;
+  }
+  
+  return comm_hub_build_frame(HRMS_COMM_PACKET_SYNC, dest_id, payload, len, frame);
+}
+
+// Probes and sync replies bypass the scheduler so the timestamps bracket the radio time only
+static bool comm_hub_send_direct(hrms_comm_packet_type_t type, uint8_t dest_id,
+                                 const uint8_t *payload, size_t len) {
+  uint8_t frame[HRMS_WIRE_MAX_FRAME_SIZE];
+  size_t frame_len = comm_hub_build_frame(type, dest_id, payload, len, frame);
+  if (frame_len == 0) {
+    return false;
+  }
+  
+  return hrms_communication_hub_send(frame, frame_len);
+}
+
+static void comm_hub_rx_probe(const hrms_comm_packet_t *packet, uint32_t now_ms) {
+  (void)now_ms;
+  if (packet->payload_size == 0) {
+    return;
+  }
   
-  // Encrypt the joystick data using ORION
+  if (packet->payload[0] == HRMS_LATENCY_OP_REQUEST) {
+    uint8_t reply[HRMS_LATENCY_REPLY_CTRL_SIZE];
+    size_t len = hrms_latency_make_reply(packet->payload, packet->payload_size,
+                                         last_rx_cycles, reply, sizeof(reply));
+    if (len > 0) {
+      comm_hub_send_direct(HRMS_COMM_PACKET_PROBE, packet->source_id, reply, len);
+    }
+  } else {
+    hrms_latency_on_reply(packet->payload, packet->payload_size, last_rx_cycles);
+  }
+}
+
+// Answered at once: the peer's turnaround (t3 - t2) is stamped, not assumed
+static void comm_hub_rx_sync(const hrms_comm_packet_t *packet, uint32_t now_ms) {
+  (void)now_ms;
+  if (packet->payload_size == 0) {
+    return;
+  }
+  
+  if (packet->payload[0] == HRMS_TIMESYNC_OP_REQUEST) {
+    uint8_t reply[HRMS_TIMESYNC_REPLY_SIZE];
+    size_t len = hrms_timesync_make_reply(&timesync, packet->payload, packet->payload_size,
+                                          last_rx_cycles, xTaskGetTickCount(),
+                                          reply, sizeof(reply));
+    if (len > 0) {
+      comm_hub_send_direct(HRMS_COMM_PACKET_SYNC, packet->source_id, reply, len);
+    }
+  } else {
+    hrms_timesync_on_reply(&timesync, packet->payload, packet->payload_size, last_rx_cycles);
+  }
+}
+
+// A new peer session or a stale echo is answered with our own announcement
+static void comm_hub_rx_session(const hrms_comm_packet_t *packet, uint32_t now_ms) {
+  (void)now_ms;
+#if HRMS_KEYSTREAM_CACHE
+  uint8_t header[HRMS_WIRE_HEADER_SIZE];
+  hrms_packet_encode_header(packet, header);
+  
+  switch (hrms_keystream_session_receive(&keystream, header, sizeof(header),
+                                         packet->payload, packet->payload_size)) {
+    case HRMS_KEYSTREAM_SESSION_NEW:
+    case HRMS_KEYSTREAM_SESSION_CHALLENGE:
+      session_due = true;
+      break;
+    case HRMS_KEYSTREAM_SESSION_INVALID:
+      comm_stats.packets_rejected++;
+      break;
+    default:
+      break;
+  }
+#else
+  (void)packet;
+#endif
+}
+
+// Wire timestamp is the low 16 bits of the tick the (first) sample was taken at
+static void comm_hub_note_control_sent(const uint8_t *frame) {
+  uint16_t sample_tick = (uint16_t)(frame[5] | (frame[6] << 8));
+  uint16_t age_ms = (uint16_t)((uint16_t)xTaskGetTickCount() - sample_tick);
+  
+  hrms_latency_on_control_tx(frame[1], hrms_timer_cycles() - hrms_timer_us_to_cycles(age_ms * 1000U));
+}
+
+static void comm_hub_deliver_message(uint8_t source_id, uint8_t kind,
+                                     const uint8_t *data, size_t len) {
+  if (message_handler) {
+    message_handler(source_id, kind, data, len);
+  }
+}
+
+static void comm_hub_deliver_reliable(const hrms_comm_packet_t *packet) {
+  // Parameter requests are answered here; replies and telemetry go on
+  if (packet->packet_type == HRMS_COMM_PACKET_CONFIG && comm_hub_answer_config(packet)) {
+    return;
+  }
+  
+  if (reliable_handler) {
+    reliable_handler(packet);
+  }
+}
+
+// Encrypt a control payload into one frame for the control class - no retransmission
+static bool comm_hub_send_control(hrms_comm_packet_type_t type, uint8_t dest_id, uint32_t timestamp,
+                                  const uint8_t *plaintext, size_t len) {
+  hrms_comm_packet_t packet;
+  memset(&packet, 0, sizeof(packet));
+  
+  packet.packet_id = hrms_packet_get_next_id();
+  packet.packet_type = type;
+  packet.source_id = 0x01; // Hermes controller ID
+  packet.dest_id = dest_id;
+  packet.timestamp = timestamp;
+  
+  // Always encrypt - no plaintext fallback
+#if HRMS_KEYSTREAM_CACHE
+  if (!comm_hub_seal(&packet, plaintext, len)) {
+    return false;
+  }
+#else
+  // Encrypt the payload using ORION
   uint8_t encrypted_data[HRMS_COMM_MAX_PAYLOAD_SIZE];
   size_t encrypted_len = 0;
   
-  // Always encrypt - no plaintext fallback
-  if (ORION_Encrypt(plaintext, sizeof(hrms_joystick_data_t), encrypted_data, &encrypted_len) == 0) {
-    packet.payload_size = (uint8_t)encrypted_len;
-    if (encrypted_len <= HRMS_COMM_MAX_PAYLOAD_SIZE) {
-      memcpy(packet.payload, encrypted_data, encrypted_len);
+  if (ORION_Encrypt(plaintext, len, encrypted_data, &encrypted_len) != 0 ||
+      encrypted_len > HRMS_WIRE_MAX_PAYLOAD_SIZE) {
+    // Encryption failed or does not fit one radio frame - abort transmission
+    return false;
+  }
+  packet.payload_size = (uint8_t)encrypted_len;
+  memcpy(packet.payload, encrypted_data, encrypted_len);
+#endif
+  
+  // Encode into the compact wire format (one radio payload)
+  uint8_t frame[HRMS_WIRE_MAX_FRAME_SIZE];
+  size_t frame_len = hrms_packet_encode(&packet, frame, sizeof(frame));
+  if (frame_len == 0) {
+    return false;
+  }
+  
+  // Replaces a control frame still waiting, which is stale by now
+  return hrms_tx_sched_push(HRMS_TX_CLASS_CONTROL, frame, frame_len, COMM_HUB_TAG_JOYSTICK);
+}
+
+#if HRMS_KEYSTREAM_CACHE
+// Encrypt and tag plaintext into packet->payload; header fields must be final
+static bool comm_hub_seal(hrms_comm_packet_t *packet, const uint8_t *plaintext, size_t len) {
+  if (len > HRMS_KEYSTREAM_MAX_DATA) {
+    return false;
+  }
+  
+  // The tag covers the wire header too, so the sealed size goes in first
+  uint8_t header[HRMS_WIRE_HEADER_SIZE];
+  packet->payload_size = (uint8_t)(len + HRMS_KEYSTREAM_OVERHEAD);
+  hrms_packet_encode_header(packet, header);
+  
+  // Keystream and MAC key were computed while idle - this is an XOR and a tag
+  return hrms_keystream_encrypt(&keystream, header, sizeof(header), plaintext, len,
+                                packet->payload, HRMS_WIRE_MAX_PAYLOAD_SIZE) == packet->payload_size;
+}
+
+// Our nonce and challenge, with the peer's challenge echoed; not encrypted
+static bool comm_hub_send_session(void) {
+  hrms_comm_packet_t packet;
+  uint8_t header[HRMS_WIRE_HEADER_SIZE];
+  uint8_t frame[HRMS_WIRE_MAX_FRAME_SIZE];
+  
+  memset(&packet, 0, sizeof(packet));
+  packet.packet_id = hrms_packet_get_next_id();
+  packet.packet_type = HRMS_COMM_PACKET_SESSION;
+  packet.source_id = 0x01; // Hermes controller ID
+  packet.dest_id = 0x02;   // Remote receiver ID
+  packet.payload_size = HRMS_KEYSTREAM_SESSION_SIZE;
+  packet.timestamp = xTaskGetTickCount();
+  hrms_packet_encode_header(&packet, header);
+  
+  if (hrms_keystream_session_build(&keystream, header, sizeof(header), packet.payload,
+                                   sizeof(packet.payload)) != HRMS_KEYSTREAM_SESSION_SIZE) {
+    return false;
+  }
+  size_t len = hrms_packet_encode(&packet, frame, sizeof(frame));
+  return len > 0 && hrms_tx_sched_push(HRMS_TX_CLASS_ACK, frame, len, COMM_HUB_TAG_NONE);
+}
+#endif
+
+// Reliable-layer frames: ACKs ahead of heartbeats, data as rate-limited bulk
+static bool comm_hub_queue_frame(const uint8_t *frame, size_t len) {
+  if (!frame || len == 0) {
+    return false;
+  }
+  
+  hrms_tx_class_t cls = (frame[0] == HRMS_COMM_PACKET_ACK) ? HRMS_TX_CLASS_ACK
+                                                           : HRMS_TX_CLASS_BULK;
+  return hrms_tx_sched_push(cls, frame, len, COMM_HUB_TAG_NONE);
+}
+
+#if HRMS_JOYSTICK_BATCH
+// Send everything queued, as few frames as the payload budget allows
+static void comm_hub_flush_batch(void) {
+  uint8_t sent = 0;
+  
+  while (sent < batch_count) {
+    hrms_joystick_data_t samples[HRMS_JOYSTICK_BATCH_SIZE];
+    uint8_t count = batch_count - sent;
+    for (uint8_t i = 0; i < count; i++) {
+      samples[i] = batch_samples[sent + i].data;
     }
-  } else {
-    // Encryption failed - abort transmission for security
+    
+    // Large deltas may not fit - retry with fewer samples
+    uint8_t plaintext[COMM_HUB_CONTROL_MAX_PLAINTEXT];
+    size_t len = 0;
+    for (; count > 0; count--) {
+      len = hrms_packet_encode_joystick_delta(&joystick_codec, samples, count,
+                                              &plaintext[HRMS_WIRE_JOYSTICK_BATCH_HEADER],
+                                              sizeof(plaintext) - HRMS_WIRE_JOYSTICK_BATCH_HEADER);
+      if (len > 0) {
+        break;
+      }
+    }
+    if (count == 0) {
+      break;
+    }
+    plaintext[0] = batch_period_ms;
+    
+    // Samples are realtime - a lost frame is not sent again
+    comm_hub_send_control(HRMS_COMM_PACKET_CONTROL_CMD, 0x02, // Remote receiver ID
+                          batch_samples[sent].timestamp,
+                          plaintext, len + HRMS_WIRE_JOYSTICK_BATCH_HEADER);
+    sent += count;
+    
+    // More to go: send this frame before the next one replaces it in the control slot
+    if (sent < batch_count) {
+      hrms_communication_hub_service_tx();
+    }
+  }
+  
+  batch_count = 0;
+}
+#endif
+
+static bool comm_hub_move_to_quietest(void) {
+#if HRMS_NRF24_FREQ_HOP
+  return false; // The hop sequence owns the channel
+#else
+  return comm_hub_switch_channel(hrms_spectrum_quietest(0, NRF24L01_MAX_CHANNEL));
+#endif
+}
+
+static bool comm_hub_switch_channel(uint8_t channel) {
+#if HRMS_NRF24_FREQ_HOP
+  (void)channel;
+  return false; // The hop sequence owns the channel
+#else
+  hrms_link_quality_stats_t link;
+  hrms_link_quality_get_stats(&link);
+  
+  hrms_link_rf_t next = link.rf;
+  next.channel = channel;
+  if (next.channel == link.rf.channel) {
+    return true;
+  }
+  
+  // Same handshake as a rate change: move only once the peer has ACKed
+  if (!comm_hub_send_link_switch(HRMS_LINK_OP_SWITCH_CHANNEL, next.channel)) {
+    return false;
+  }
+  hrms_nrf24_comm_set_channel(next.channel);
+  hrms_link_quality_commit(&next, xTaskGetTickCount());
+  hrms_param_update(HRMS_PARAM_RADIO_CHANNEL, next.channel);
+  return true;
+#endif
+}
+
+// Runs from hrms_param_set() - false leaves the registry on the old channel
+static bool comm_hub_apply_channel(uint32_t channel) {
+  return comm_hub_switch_channel((uint8_t)channel);
+}
+
+// Get/set from the peer; the reply goes back through the same window
+static bool comm_hub_answer_config(const hrms_comm_packet_t *packet) {
+  uint8_t reply[HRMS_WIRE_MAX_PAYLOAD_SIZE];
+  size_t len = hrms_param_handle(packet->payload, packet->payload_size, reply, sizeof(reply));
+  if (len == 0) {
     return false;
   }
   
-  hrms_communication_hub_set_checksum(&packet);
+  // Window full: values are applied, the peer can read them back with a GET
+  hrms_communication_hub_send_reliable(HRMS_COMM_PACKET_CONFIG, packet->source_id, reply, len);
+  return true;
+}
+
+#if HRMS_SPECTRUM_OLED_VIEW
+static void comm_hub_show_spectrum(void) {
+  uint8_t bars[HRMS_SPECTRUM_CHANNELS];
+  for (uint8_t ch = 0; ch < HRMS_SPECTRUM_CHANNELS; ch++) {
+    bars[ch] = hrms_spectrum_occupancy(ch);
+  }
   
-  // Send the packet as raw data through the communication hub
-  return hrms_communication_hub_send((uint8_t*)&packet, sizeof(packet));
-}
\ No newline at end of file
+  hrms_oled_clear();
+  hrms_oled_draw_bar_graph(bars, HRMS_SPECTRUM_CHANNELS);
+  hrms_oled_flush();
+}
+#endif
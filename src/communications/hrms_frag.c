@@ -0,0 +1,331 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+#include "hrms_frag.h"
+#include "libc_stubs.h"
+
+#if HRMS_FRAG_MAX_FRAGMENTS > 255
+#error "HRMS_FRAG_MAX_MESSAGE needs more than 255 fragments"
+#endif
+
+#define FRAG_BITMAP_BYTES ((HRMS_FRAG_MAX_FRAGMENTS + 7) / 8)
+
+// Reassembly buffer for one incoming message
+typedef struct {
+  uint8_t data[HRMS_FRAG_MAX_MESSAGE];
+  uint8_t have[FRAG_BITMAP_BYTES];
+  uint32_t last_ms;
+  uint16_t len;              // Known once the last fragment arrived
+  uint8_t source_id;
+  uint8_t msg_id;
+  uint8_t kind;
+  uint8_t count;
+  uint8_t received;
+  bool in_use;
+} frag_slot_t;
+
+static hrms_frag_enqueue_t frag_enqueue = NULL;
+static hrms_frag_deliver_t frag_deliver = NULL;
+
+// Sender: one message at a time, fragments tracked by index
+static const uint8_t *tx_data = NULL;
+static size_t tx_len = 0;
+static uint8_t tx_msg_id = 0;
+static uint8_t tx_kind = 0;
+static uint8_t tx_dest = 0;
+static uint8_t tx_count = 0;
+static uint8_t tx_next = 0;        // Next fragment never loaded
+static uint8_t tx_acked_count = 0;
+static uint8_t tx_acked[FRAG_BITMAP_BYTES];
+static uint8_t tx_resend[FRAG_BITMAP_BYTES];
+static uint16_t tx_retries = 0;
+static uint32_t tx_start_ms = 0;
+static uint32_t tx_progress_ms = 0;   // Last fragment ACK
+static uint32_t tx_now_ms = 0;        // Time of the latest pump/poll
+static bool tx_active = false;
+
+static frag_slot_t pool[HRMS_FRAG_POOL_SLOTS];
+static uint8_t last_source_id = 0;   // Last message delivered, to drop late duplicates
+static uint8_t last_msg_id = 0;
+static bool last_valid = false;
+static hrms_frag_stats_t frag_stats;
+
+static bool frag_bit(const uint8_t *bitmap, uint8_t index);
+static void frag_set_bit(uint8_t *bitmap, uint8_t index, bool value);
+static bool frag_load(uint8_t index);
+static bool frag_next_resend(uint8_t *index);
+static void frag_tx_finish(uint32_t now_ms, bool delivered);
+static frag_slot_t *frag_slot_for(uint8_t source_id, uint8_t msg_id, uint32_t now_ms);
+
+void hrms_frag_init(hrms_frag_enqueue_t enqueue, hrms_frag_deliver_t deliver) {
+  frag_enqueue = enqueue;
+  frag_deliver = deliver;
+
+  tx_active = false;
+  tx_data = NULL;
+  memset(pool, 0, sizeof(pool));
+  last_valid = false;
+  memset(&frag_stats, 0, sizeof(frag_stats));
+}
+
+bool hrms_frag_send(uint8_t kind, uint8_t dest_id, const uint8_t *data, size_t len,
+                    uint32_t now_ms) {
+  if (tx_active || !frag_enqueue || !data || len == 0 || len > HRMS_FRAG_MAX_MESSAGE) {
+    return false;
+  }
+
+  tx_data = data;
+  tx_len = len;
+  tx_msg_id++;
+  tx_kind = kind;
+  tx_dest = dest_id;
+  tx_count = (uint8_t)((len + HRMS_FRAG_DATA_SIZE - 1) / HRMS_FRAG_DATA_SIZE);
+  tx_next = 0;
+  tx_acked_count = 0;
+  memset(tx_acked, 0, sizeof(tx_acked));
+  memset(tx_resend, 0, sizeof(tx_resend));
+  tx_retries = 0;
+  tx_start_ms = now_ms;
+  tx_progress_ms = now_ms;
+  tx_active = true;
+
+  hrms_frag_pump(now_ms);
+  return true;
+}
+
+bool hrms_frag_busy(void) {
+  return tx_active;
+}
+
+void hrms_frag_pump(uint32_t now_ms) {
+  tx_now_ms = now_ms;
+  if (!tx_active) {
+    return;
+  }
+
+  if (tx_acked_count == tx_count) {
+    frag_tx_finish(now_ms, true);
+    return;
+  }
+
+  // Failed fragments first, then new ones, until the FIFO is full
+  for (;;) {
+    uint8_t index;
+    if (frag_next_resend(&index)) {
+      if (!frag_load(index)) {
+        return;
+      }
+      frag_set_bit(tx_resend, index, false);
+      frag_stats.fragments_resent++;
+    } else if (tx_next < tx_count) {
+      if (!frag_load(tx_next)) {
+        return;
+      }
+      tx_next++;
+    } else {
+      return;
+    }
+  }
+}
+
+void hrms_frag_on_tx_done(uint8_t tag, bool success) {
+  if (!tx_active || tag >= tx_count || frag_bit(tx_acked, tag)) {
+    return;
+  }
+
+  if (success) {
+    frag_set_bit(tx_acked, tag, true);
+    tx_acked_count++;
+    tx_progress_ms = tx_now_ms;
+    frag_stats.fragments_sent++;
+  } else if (tx_retries < HRMS_FRAG_RETRY_BUDGET) {
+    // A MAX_RT flushes the whole burst, so the ones behind it come back too
+    frag_set_bit(tx_resend, tag, true);
+    tx_retries++;
+  } else {
+    tx_retries = HRMS_FRAG_RETRY_BUDGET + 1;   // Failed; reported by the next pump/poll
+  }
+}
+
+void hrms_frag_on_receive(const hrms_comm_packet_t *packet, uint32_t now_ms) {
+  if (!packet || packet->payload_size <= HRMS_FRAG_HEADER_SIZE) {
+    return;
+  }
+
+  uint8_t msg_id = packet->payload[0];
+  uint8_t kind = packet->payload[1];
+  uint8_t index = packet->payload[2];
+  uint8_t count = packet->payload[3];
+  size_t len = packet->payload_size - HRMS_FRAG_HEADER_SIZE;
+
+  // Only the last fragment may be short
+  if (count == 0 || count > HRMS_FRAG_MAX_FRAGMENTS || index >= count ||
+      (index < count - 1 && len != HRMS_FRAG_DATA_SIZE) ||
+      (size_t)index * HRMS_FRAG_DATA_SIZE + len > HRMS_FRAG_MAX_MESSAGE) {
+    return;
+  }
+
+  // Auto-ACK lost on the last fragment: the sender repeats it after delivery
+  if (last_valid && packet->source_id == last_source_id && msg_id == last_msg_id) {
+    frag_stats.duplicates++;
+    return;
+  }
+
+  frag_slot_t *slot = frag_slot_for(packet->source_id, msg_id, now_ms);
+  if (!slot) {
+    frag_stats.pool_full++;
+    return;
+  }
+
+  if (slot->received == 0) {
+    slot->kind = kind;
+    slot->count = count;
+  } else if (slot->count != count || slot->kind != kind) {
+    return;   // Id reused for another message while this one was pending
+  }
+
+  if (frag_bit(slot->have, index)) {
+    frag_stats.duplicates++;
+    return;
+  }
+
+  memcpy(&slot->data[(size_t)index * HRMS_FRAG_DATA_SIZE], &packet->payload[HRMS_FRAG_HEADER_SIZE], len);
+  frag_set_bit(slot->have, index, true);
+  slot->received++;
+  slot->last_ms = now_ms;
+  if (index == count - 1) {
+    slot->len = (uint16_t)((size_t)index * HRMS_FRAG_DATA_SIZE + len);
+  }
+
+  if (slot->received == slot->count) {
+    last_source_id = slot->source_id;
+    last_msg_id = slot->msg_id;
+    last_valid = true;
+    frag_stats.messages_received++;
+    if (frag_deliver) {
+      frag_deliver(slot->source_id, slot->kind, slot->data, slot->len);
+    }
+    slot->in_use = false;
+  }
+}
+
+void hrms_frag_poll(uint32_t now_ms) {
+  tx_now_ms = now_ms;
+
+  for (uint8_t i = 0; i < HRMS_FRAG_POOL_SLOTS; i++) {
+    if (pool[i].in_use && (now_ms - pool[i].last_ms) >= HRMS_FRAG_TIMEOUT_MS) {
+      pool[i].in_use = false;
+      frag_stats.timeouts++;
+    }
+  }
+
+  if (!tx_active) {
+    return;
+  }
+  if (tx_acked_count == tx_count) {
+    frag_tx_finish(now_ms, true);
+  } else if (tx_retries > HRMS_FRAG_RETRY_BUDGET ||
+             (now_ms - tx_progress_ms) >= HRMS_FRAG_TIMEOUT_MS) {
+    frag_tx_finish(now_ms, false);
+  }
+}
+
+void hrms_frag_get_stats(hrms_frag_stats_t *stats) {
+  if (stats) {
+    memcpy(stats, &frag_stats, sizeof(hrms_frag_stats_t));
+  }
+}
+
+static bool frag_bit(const uint8_t *bitmap, uint8_t index) {
+  return (bitmap[index / 8] & (1U << (index % 8))) != 0;
+}
+
+static void frag_set_bit(uint8_t *bitmap, uint8_t index, bool value) {
+  if (value) {
+    bitmap[index / 8] |= (uint8_t)(1U << (index % 8));
+  } else {
+    bitmap[index / 8] &= (uint8_t)~(1U << (index % 8));
+  }
+}
+
+// Build fragment `index` and hand it to the TX FIFO, tagged with its index
+static bool frag_load(uint8_t index) {
+  size_t offset = (size_t)index * HRMS_FRAG_DATA_SIZE;
+  size_t len = tx_len - offset;
+  if (len > HRMS_FRAG_DATA_SIZE) {
+    len = HRMS_FRAG_DATA_SIZE;
+  }
+
+  hrms_comm_packet_t packet;
+  memset(&packet, 0, sizeof(packet));
+  packet.packet_id = hrms_packet_get_next_id();
+  packet.packet_type = HRMS_COMM_PACKET_FRAGMENT;
+  packet.source_id = 0x01; // Hermes controller ID
+  packet.dest_id = tx_dest;
+  packet.timestamp = tx_start_ms;
+  packet.payload_size = (uint8_t)(HRMS_FRAG_HEADER_SIZE + len);
+  packet.payload[0] = tx_msg_id;
+  packet.payload[1] = tx_kind;
+  packet.payload[2] = index;
+  packet.payload[3] = tx_count;
+  memcpy(&packet.payload[HRMS_FRAG_HEADER_SIZE], &tx_data[offset], len);
+
+  uint8_t frame[HRMS_WIRE_MAX_FRAME_SIZE];
+  size_t frame_len = hrms_packet_encode(&packet, frame, sizeof(frame));
+  return frame_len > 0 && frag_enqueue(frame, frame_len, index);
+}
+
+static bool frag_next_resend(uint8_t *index) {
+  for (uint8_t i = 0; i < tx_next; i++) {
+    if (frag_bit(tx_resend, i)) {
+      *index = i;
+      return true;
+    }
+  }
+  return false;
+}
+
+static void frag_tx_finish(uint32_t now_ms, bool delivered) {
+  if (delivered) {
+    uint32_t elapsed = now_ms - tx_start_ms;
+    frag_stats.messages_sent++;
+    frag_stats.last_bytes_per_s = (uint32_t)(tx_len * 1000U / (elapsed ? elapsed : 1));
+  } else {
+    frag_stats.messages_failed++;
+  }
+
+  tx_active = false;
+  tx_data = NULL;
+}
+
+// Slot already collecting this message, else a free one
+static frag_slot_t *frag_slot_for(uint8_t source_id, uint8_t msg_id, uint32_t now_ms) {
+  frag_slot_t *free_slot = NULL;
+
+  for (uint8_t i = 0; i < HRMS_FRAG_POOL_SLOTS; i++) {
+    frag_slot_t *slot = &pool[i];
+    if (slot->in_use && slot->source_id == source_id && slot->msg_id == msg_id) {
+      return slot;
+    }
+    if (!slot->in_use && !free_slot) {
+      free_slot = slot;
+    }
+  }
+
+  if (free_slot) {
+    memset(free_slot->have, 0, sizeof(free_slot->have));
+    free_slot->source_id = source_id;
+    free_slot->msg_id = msg_id;
+    free_slot->received = 0;
+    free_slot->len = 0;
+    free_slot->last_ms = now_ms;
+    free_slot->in_use = true;
+  }
+  return free_slot;
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+#include "hrms_freq_hop.h"
+#include "hrms_config.h"
+#include "libc_stubs.h"
+
+#define HOP_Q8_ONE 256
+
+static uint8_t hop_channels[HRMS_HOP_CHANNELS];
+static int32_t slot_retries_q8[HRMS_HOP_CHANNELS];
+static uint8_t slot_samples[HRMS_HOP_CHANNELS];
+static bool slot_blacklisted[HRMS_HOP_CHANNELS];
+static uint32_t slot_blacklisted_at[HRMS_HOP_CHANNELS];
+static hrms_freq_hop_stats_t hop_stats;
+
+static uint32_t hop_random(uint32_t *state);
+
+void hrms_freq_hop_init(uint32_t seed) {
+  memset(slot_retries_q8, 0, sizeof(slot_retries_q8));
+  memset(slot_samples, 0, sizeof(slot_samples));
+  memset(slot_blacklisted, 0, sizeof(slot_blacklisted));
+  memset(&hop_stats, 0, sizeof(hop_stats));
+
+  // Evenly spread channels, stepping over the rendezvous channel
+  uint8_t channel = HRMS_HOP_FIRST_CHANNEL;
+  for (uint8_t i = 0; i < HRMS_HOP_CHANNELS; i++) {
+    if (channel == HRMS_NRF24_CHANNEL) {
+      channel++;
+    }
+    hop_channels[i] = channel;
+    channel += HRMS_HOP_STEP;
+  }
+
+  // Fisher-Yates shuffle - identical on both ends for the same seed
+  uint32_t state = seed ? seed : 1;
+  for (uint8_t i = HRMS_HOP_CHANNELS - 1; i > 0; i--) {
+    uint8_t j = (uint8_t)(hop_random(&state) % (i + 1));
+    uint8_t tmp = hop_channels[i];
+    hop_channels[i] = hop_channels[j];
+    hop_channels[j] = tmp;
+  }
+}
+
+uint8_t hrms_freq_hop_channel(uint8_t slot) {
+  return hop_channels[slot % HRMS_HOP_CHANNELS];
+}
+
+uint8_t hrms_freq_hop_next(uint8_t slot, uint32_t now_ms) {
+  uint8_t next = slot;
+
+  for (uint8_t i = 0; i < HRMS_HOP_CHANNELS; i++) {
+    next = (next + 1) % HRMS_HOP_CHANNELS;
+
+    // Parole: give the channel another chance at half the threshold
+    if (slot_blacklisted[next] &&
+        (now_ms - slot_blacklisted_at[next]) >= HRMS_HOP_PAROLE_MS) {
+      slot_blacklisted[next] = false;
+      slot_retries_q8[next] = HRMS_HOP_BLACKLIST_Q8 / 2;
+      slot_samples[next] = 0;
+      hop_stats.blacklisted--;
+    }
+
+    if (!slot_blacklisted[next]) {
+      return next;
+    }
+  }
+
+  return (slot + 1) % HRMS_HOP_CHANNELS; // Everything blacklisted - keep hopping
+}
+
+void hrms_freq_hop_report(uint8_t slot, bool delivered, uint8_t retransmits, uint32_t now_ms) {
+  if (slot >= HRMS_HOP_CHANNELS) {
+    return;
+  }
+
+  if (delivered) {
+    hop_stats.hops++;
+  }
+
+  // A lost frame counts as one more retransmit than the radio was allowed
+  int32_t sample = (int32_t)(delivered ? retransmits : retransmits + 1) * HOP_Q8_ONE;
+  slot_retries_q8[slot] += (sample - slot_retries_q8[slot]) / 8;
+  if (slot_samples[slot] < 0xFF) {
+    slot_samples[slot]++;
+  }
+
+  if (!slot_blacklisted[slot] &&
+      slot_samples[slot] >= HRMS_HOP_BLACKLIST_MIN_SAMPLES &&
+      slot_retries_q8[slot] > HRMS_HOP_BLACKLIST_Q8 &&
+      hop_stats.blacklisted < HRMS_HOP_BLACKLIST_MAX) {
+    slot_blacklisted[slot] = true;
+    slot_blacklisted_at[slot] = now_ms;
+    hop_stats.blacklisted++;
+    hop_stats.blacklist_events++;
+  }
+}
+
+void hrms_freq_hop_get_stats(hrms_freq_hop_stats_t *stats) {
+  if (stats) {
+    memcpy(stats, &hop_stats, sizeof(hrms_freq_hop_stats_t));
+  }
+}
+
+// xorshift32
+static uint32_t hop_random(uint32_t *state) {
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *state = x;
+  return x;
+}
@@ -0,0 +1,468 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+#include "hrms_keystream.h"
+#include "hrms_poly1305.h"
+#include "hrms_timer.h"
+#include "libc_stubs.h"
+
+#if HRMS_KEYSTREAM_BLOCK_SIZE > HRMS_CIPHER_MAX_KEYSTREAM || HRMS_KEYSTREAM_MAX_DATA > HRMS_KEYSTREAM_MAC_KEY_OFFSET
+#error "A frame needs more keystream than one cipher counter gives"
+#endif
+#if HRMS_KEYSTREAM_AUTH && (HRMS_KEYSTREAM_TAG_BYTES < 4 || HRMS_KEYSTREAM_TAG_BYTES > HRMS_POLY1305_TAG_SIZE)
+#error "HRMS_KEYSTREAM_TAG_BYTES must be between 4 and 16"
+#endif
+#if HRMS_KEYSTREAM_SESSION_SIZE > HRMS_WIRE_MAX_PAYLOAD_SIZE
+#error "Session frame does not fit one radio frame"
+#endif
+
+#define KS_WINDOW_BITS      64
+
+// Counters no frame reaches: session tags, and challenges from this end's session
+#define KS_SESSION_COUNTER   0xFFFFFFFEU
+#define KS_CHALLENGE_COUNTER 0xFFFF0000U
+
+// Session payload layout
+#define KS_SESSION_CHALLENGE HRMS_KEYSTREAM_NONCE_BYTES
+#define KS_SESSION_ECHO      (KS_SESSION_CHALLENGE + 4)
+#define KS_SESSION_ANCHOR    (KS_SESSION_ECHO + 4)
+#define KS_SESSION_TAG       (KS_SESSION_ANCHOR + 4)
+
+static size_t ks_seal(const uint8_t *keystream, uint32_t counter, const uint8_t *ad, size_t ad_len,
+                      const uint8_t *plaintext, size_t len, uint8_t *out);
+static bool ks_open(const uint8_t *keystream, const uint8_t *ad, size_t ad_len,
+                    const uint8_t *payload, size_t data_len, uint8_t *out);
+static void ks_full_nonce(const uint8_t *nonce_bytes, uint8_t *nonce);
+static uint32_t ks_next_challenge(hrms_keystream_t *ks);
+#if HRMS_KEYSTREAM_AUTH
+static void ks_session_tag(const hrms_cipher_ctx_t *ctx, const uint8_t *ad, size_t ad_len,
+                           const uint8_t *payload, uint8_t *tag);
+static bool ks_tag_equal(const uint8_t *a, const uint8_t *b);
+#endif
+static uint32_t ks_rebuild_counter(const hrms_keystream_t *ks, uint16_t low);
+static bool ks_window_fresh(const hrms_keystream_t *ks, uint32_t counter);
+static void ks_window_accept(hrms_keystream_t *ks, uint32_t counter);
+static void ks_window_skip(hrms_keystream_t *ks, uint32_t anchor);
+static bool ks_nonce_equal(const uint8_t *a, const uint8_t *b);
+static void ks_put32(uint8_t *buf, uint32_t value);
+static uint32_t ks_get32(const uint8_t *buf);
+static void ks_xor(const uint8_t *in, const uint8_t *keystream, uint8_t *out, size_t len);
+
+void hrms_keystream_init(hrms_keystream_t *ks, const uint8_t *key, const uint8_t *seed) {
+  if (!ks || !key || !seed) {
+    return;
+  }
+
+  memset(ks, 0, sizeof(*ks));
+  memcpy(ks->key, key, sizeof(ks->key));
+
+  // The cipher as a PRF keyed by the seed evens out the raw seed material
+  uint8_t nonce[HRMS_CIPHER_NONCE_SIZE];
+  uint8_t block[HRMS_KEYSTREAM_NONCE_BYTES];
+  memset(nonce, 0, sizeof(nonce));
+  hrms_cipher_init(&ks->rx_ctx, seed, nonce);
+  hrms_cipher_keystream(&ks->rx_ctx, 0, block, sizeof(block));
+  memcpy(ks->nonce, block, sizeof(ks->nonce));
+
+  ks_full_nonce(ks->nonce, nonce);
+  hrms_cipher_init(&ks->tx_ctx, ks->key, nonce);
+  memset(&ks->rx_ctx, 0, sizeof(ks->rx_ctx));
+  ks->challenge = ks_next_challenge(ks);
+}
+
+uint8_t hrms_keystream_refill(hrms_keystream_t *ks, uint8_t max_blocks) {
+  uint8_t generated = 0;
+
+  while (generated < max_blocks && ks->ring_count < HRMS_KEYSTREAM_DEPTH) {
+    hrms_keystream_block_t *entry = &ks->ring[(ks->ring_head + ks->ring_count) % HRMS_KEYSTREAM_DEPTH];
+    entry->counter = ks->tx_counter + ks->ring_count;
+    hrms_cipher_keystream(&ks->tx_ctx, entry->counter, entry->bytes, sizeof(entry->bytes));
+    ks->ring_count++;
+    generated++;
+  }
+
+  ks->stats.blocks_generated += generated;
+  return generated;
+}
+
+bool hrms_keystream_ready(const hrms_keystream_t *ks) {
+  return ks->ring_count > 0;
+}
+
+size_t hrms_keystream_encrypt(hrms_keystream_t *ks, const uint8_t *ad, size_t ad_len,
+                              const uint8_t *plaintext, size_t len,
+                              uint8_t *out, size_t max_len) {
+  if ((!ad && ad_len > 0) || !plaintext || !out || len > HRMS_KEYSTREAM_MAX_DATA ||
+      max_len < len + HRMS_KEYSTREAM_OVERHEAD) {
+    return 0;
+  }
+
+  uint32_t start = hrms_timer_cycles();
+  size_t written;
+
+  if (ks->ring_count > 0) {
+    // Ring entries always follow tx_counter - the head is this frame's block
+    written = ks_seal(ks->ring[ks->ring_head].bytes, ks->tx_counter, ad, ad_len, plaintext, len, out);
+    ks->ring_head = (uint8_t)((ks->ring_head + 1) % HRMS_KEYSTREAM_DEPTH);
+    ks->ring_count--;
+    ks->stats.hits++;
+  } else {
+    uint8_t keystream[HRMS_KEYSTREAM_BLOCK_SIZE];
+    hrms_cipher_keystream(&ks->tx_ctx, ks->tx_counter, keystream, sizeof(keystream));
+    written = ks_seal(keystream, ks->tx_counter, ad, ad_len, plaintext, len, out);
+    ks->stats.misses++;
+  }
+
+  ks->tx_counter++;
+  ks->stats.last_encrypt_cycles = hrms_timer_cycles() - start;
+
+  return written;
+}
+
+size_t hrms_keystream_decrypt(hrms_keystream_t *ks, const uint8_t *ad, size_t ad_len,
+                              const uint8_t *payload, size_t len,
+                              uint8_t *out, size_t max_len, uint32_t *counter) {
+  if ((!ad && ad_len > 0) || !payload || !out || len < HRMS_KEYSTREAM_OVERHEAD ||
+      len - HRMS_KEYSTREAM_OVERHEAD > HRMS_KEYSTREAM_MAX_DATA ||
+      max_len < len - HRMS_KEYSTREAM_OVERHEAD) {
+    return 0;
+  }
+
+  // No peer nonce yet - nothing to decrypt with
+  if (!ks->peer_ready) {
+    ks->stats.auth_failed++;
+    return 0;
+  }
+
+  size_t data_len = len - HRMS_KEYSTREAM_OVERHEAD;
+  uint32_t full = ks_rebuild_counter(ks, (uint16_t)(payload[0] | (payload[1] << 8)));
+
+  // Replayed and stale frames cost a few instructions, no cipher work
+  if (!ks_window_fresh(ks, full)) {
+    ks->stats.replayed++;
+    return 0;
+  }
+
+  uint8_t keystream[HRMS_KEYSTREAM_BLOCK_SIZE];
+  hrms_cipher_keystream(&ks->rx_ctx, full, keystream, sizeof(keystream));
+
+  if (!ks_open(keystream, ad, ad_len, payload, data_len, out)) {
+    ks->stats.auth_failed++;
+    return 0;
+  }
+  ks_window_accept(ks, full);
+
+  if (counter) {
+    *counter = full;
+  }
+  return data_len;
+}
+
+size_t hrms_keystream_session_build(hrms_keystream_t *ks, const uint8_t *ad, size_t ad_len,
+                                    uint8_t *out, size_t max_len) {
+  if (!ks || (!ad && ad_len > 0) || !out || max_len < HRMS_KEYSTREAM_SESSION_SIZE) {
+    return 0;
+  }
+
+  memcpy(out, ks->nonce, HRMS_KEYSTREAM_NONCE_BYTES);
+  ks_put32(&out[KS_SESSION_CHALLENGE], ks->challenge);
+  ks_put32(&out[KS_SESSION_ECHO], ks->peer_challenge);
+  ks_put32(&out[KS_SESSION_ANCHOR], ks->tx_counter);
+#if HRMS_KEYSTREAM_AUTH
+  ks_session_tag(&ks->tx_ctx, ad, ad_len, out, &out[KS_SESSION_TAG]);
+#else
+  (void)ad;
+  (void)ad_len;
+#endif
+
+  return HRMS_KEYSTREAM_SESSION_SIZE;
+}
+
+hrms_keystream_session_t hrms_keystream_session_receive(hrms_keystream_t *ks,
+                                                        const uint8_t *ad, size_t ad_len,
+                                                        const uint8_t *payload, size_t len) {
+  if (!ks || (!ad && ad_len > 0) || !payload || len != HRMS_KEYSTREAM_SESSION_SIZE) {
+    return HRMS_KEYSTREAM_SESSION_INVALID;
+  }
+
+  // Our own announcement sent back would let our frames be replayed to us
+  if (ks_nonce_equal(payload, ks->nonce)) {
+    return HRMS_KEYSTREAM_SESSION_INVALID;
+  }
+
+  // Only a key holder can announce; checked on a scratch context so a forgery
+  // leaves the session in use alone
+  uint8_t nonce[HRMS_CIPHER_NONCE_SIZE];
+  hrms_cipher_ctx_t ctx;
+  ks_full_nonce(payload, nonce);
+  hrms_cipher_init(&ctx, ks->key, nonce);
+#if HRMS_KEYSTREAM_AUTH
+  uint8_t tag[HRMS_KEYSTREAM_TAG_SIZE];
+  ks_session_tag(&ctx, ad, ad_len, payload, tag);
+  if (!ks_tag_equal(tag, &payload[KS_SESSION_TAG])) {
+    ks->stats.auth_failed++;
+    return HRMS_KEYSTREAM_SESSION_INVALID;
+  }
+#else
+  (void)ad;
+  (void)ad_len;
+#endif
+
+  ks->peer_challenge = ks_get32(&payload[KS_SESSION_CHALLENGE]);
+  uint32_t anchor = ks_get32(&payload[KS_SESSION_ANCHOR]);
+
+  // Only ever forward: an old announcement played back changes nothing
+  if (ks->peer_ready && ks_nonce_equal(payload, ks->peer_nonce)) {
+    if ((int32_t)(anchor - 1U - ks->rx_highest) > 0) {
+      ks_window_skip(ks, anchor);
+    }
+    return HRMS_KEYSTREAM_SESSION_CURRENT;
+  }
+  if (ks_get32(&payload[KS_SESSION_ECHO]) != ks->challenge) {
+    return HRMS_KEYSTREAM_SESSION_CHALLENGE;
+  }
+
+  // New peer session: the window starts over at the announced counter
+  memcpy(ks->peer_nonce, payload, HRMS_KEYSTREAM_NONCE_BYTES);
+  memcpy(&ks->rx_ctx, &ctx, sizeof(ctx));
+  ks->peer_ready = true;
+  ks_window_skip(ks, anchor);
+  ks->challenge = ks_next_challenge(ks);
+  ks->stats.sessions++;
+
+  return HRMS_KEYSTREAM_SESSION_NEW;
+}
+
+void hrms_keystream_get_stats(const hrms_keystream_t *ks, hrms_keystream_stats_t *stats) {
+  if (ks && stats) {
+    memcpy(stats, &ks->stats, sizeof(hrms_keystream_stats_t));
+  }
+}
+
+void hrms_keystream_benchmark(const hrms_keystream_t *ks, size_t len, hrms_keystream_bench_t *result) {
+  if (!ks || !result || len > HRMS_KEYSTREAM_MAX_DATA) {
+    return;
+  }
+
+  static const uint8_t ad[HRMS_WIRE_HEADER_SIZE] = { 0 };
+  uint8_t plaintext[HRMS_KEYSTREAM_MAX_DATA];
+  uint8_t keystream[HRMS_KEYSTREAM_BLOCK_SIZE];
+  uint8_t out[HRMS_WIRE_MAX_PAYLOAD_SIZE];
+  memset(plaintext, 0x5A, sizeof(plaintext));
+
+  // Counter far from any real frame, so no keystream is reused on air
+  uint32_t scratch = 0xFFFFFFFFU;
+
+  // Block computed on the critical path, as on a ring miss
+  uint32_t start = hrms_timer_cycles();
+  hrms_cipher_keystream(&ks->tx_ctx, scratch, keystream, sizeof(keystream));
+  ks_seal(keystream, scratch, ad, sizeof(ad), plaintext, len, out);
+  result->seal_cycles = hrms_timer_cycles() - start;
+
+  // Block taken from the ring
+  start = hrms_timer_cycles();
+  ks_seal(keystream, scratch, ad, sizeof(ad), plaintext, len, out);
+  result->seal_cached_cycles = hrms_timer_cycles() - start;
+
+  // Receiving end of the same frame, block computed per frame as in decrypt
+  start = hrms_timer_cycles();
+  hrms_cipher_keystream(&ks->tx_ctx, scratch, keystream, sizeof(keystream));
+  result->open_ok = ks_open(keystream, ad, sizeof(ad), out, len, plaintext);
+  result->open_cycles = hrms_timer_cycles() - start;
+
+  // And with the block ready
+  start = hrms_timer_cycles();
+  result->open_ok = ks_open(keystream, ad, sizeof(ad), out, len, plaintext) && result->open_ok;
+  result->open_cached_cycles = hrms_timer_cycles() - start;
+
+  start = hrms_timer_cycles();
+  hrms_cipher_keystream(&ks->tx_ctx, scratch, keystream, sizeof(keystream));
+  result->refill_cycles = hrms_timer_cycles() - start;
+}
+
+// Counter header, ciphertext, tag; each ciphertext chunk goes to the MAC as it is made
+static size_t ks_seal(const uint8_t *keystream, uint32_t counter, const uint8_t *ad, size_t ad_len,
+                      const uint8_t *plaintext, size_t len, uint8_t *out) {
+  out[0] = (uint8_t)(counter & 0xFF);
+  out[1] = (uint8_t)((counter >> 8) & 0xFF);
+
+#if HRMS_KEYSTREAM_AUTH
+  hrms_poly1305_t mac;
+  hrms_poly1305_init(&mac, &keystream[HRMS_KEYSTREAM_MAC_KEY_OFFSET]);
+  hrms_poly1305_update(&mac, ad, ad_len);
+  hrms_poly1305_update(&mac, out, HRMS_KEYSTREAM_HEADER_SIZE);
+#else
+  (void)ad;
+  (void)ad_len;
+#endif
+
+  uint8_t *ciphertext = &out[HRMS_KEYSTREAM_HEADER_SIZE];
+  for (size_t offset = 0; offset < len; offset += 16) {
+    size_t chunk = (len - offset < 16) ? len - offset : 16;
+    ks_xor(&plaintext[offset], &keystream[offset], &ciphertext[offset], chunk);
+#if HRMS_KEYSTREAM_AUTH
+    hrms_poly1305_update(&mac, &ciphertext[offset], chunk);
+#endif
+  }
+
+#if HRMS_KEYSTREAM_AUTH
+  uint8_t tag[HRMS_POLY1305_TAG_SIZE];
+  hrms_poly1305_finish(&mac, tag);
+  memcpy(&ciphertext[len], tag, HRMS_KEYSTREAM_TAG_SIZE);
+#endif
+
+  return len + HRMS_KEYSTREAM_OVERHEAD;
+}
+
+// Check the tag, then XOR; out is untouched on a mismatch
+static bool ks_open(const uint8_t *keystream, const uint8_t *ad, size_t ad_len,
+                    const uint8_t *payload, size_t data_len, uint8_t *out) {
+#if HRMS_KEYSTREAM_AUTH
+  hrms_poly1305_t mac;
+  uint8_t tag[HRMS_POLY1305_TAG_SIZE];
+  hrms_poly1305_init(&mac, &keystream[HRMS_KEYSTREAM_MAC_KEY_OFFSET]);
+  hrms_poly1305_update(&mac, ad, ad_len);
+  hrms_poly1305_update(&mac, payload, HRMS_KEYSTREAM_HEADER_SIZE + data_len);
+  hrms_poly1305_finish(&mac, tag);
+
+  if (!ks_tag_equal(tag, &payload[HRMS_KEYSTREAM_HEADER_SIZE + data_len])) {
+    return false;
+  }
+#else
+  (void)ad;
+  (void)ad_len;
+#endif
+
+  ks_xor(&payload[HRMS_KEYSTREAM_HEADER_SIZE], keystream, out, data_len);
+  return true;
+}
+
+// Cipher nonce: the announced random bytes, zero-padded
+static void ks_full_nonce(const uint8_t *nonce_bytes, uint8_t *nonce) {
+  memset(nonce, 0, HRMS_CIPHER_NONCE_SIZE);
+  memcpy(nonce, nonce_bytes, HRMS_KEYSTREAM_NONCE_BYTES);
+}
+
+// Unpredictable and never repeated: keystream of our own session, never 0
+// (what a peer that has heard nothing echoes)
+static uint32_t ks_next_challenge(hrms_keystream_t *ks) {
+  uint8_t block[4];
+  hrms_cipher_keystream(&ks->tx_ctx, KS_CHALLENGE_COUNTER + ks->challenges_used, block, sizeof(block));
+  ks->challenges_used++;
+  uint32_t challenge = ks_get32(block);
+  return challenge ? challenge : 1U;
+}
+
+#if HRMS_KEYSTREAM_AUTH
+// Tag over the header and the announcement, keyed from the announced session
+static void ks_session_tag(const hrms_cipher_ctx_t *ctx, const uint8_t *ad, size_t ad_len,
+                           const uint8_t *payload, uint8_t *tag) {
+  uint8_t mac_key[HRMS_POLY1305_KEY_SIZE];
+  uint8_t full[HRMS_POLY1305_TAG_SIZE];
+  uint8_t block[HRMS_KEYSTREAM_BLOCK_SIZE];
+  hrms_poly1305_t mac;
+
+  hrms_cipher_keystream(ctx, KS_SESSION_COUNTER, block, sizeof(block));
+  memcpy(mac_key, &block[HRMS_KEYSTREAM_MAC_KEY_OFFSET], sizeof(mac_key));
+  hrms_poly1305_init(&mac, mac_key);
+  hrms_poly1305_update(&mac, ad, ad_len);
+  hrms_poly1305_update(&mac, payload, KS_SESSION_TAG);
+  hrms_poly1305_finish(&mac, full);
+  memcpy(tag, full, HRMS_KEYSTREAM_TAG_SIZE);
+}
+#endif
+
+// Full counter = the one nearest the highest accepted with these low 16 bits.
+// Right while the peer sends fewer than 32768 frames between two of ours
+// getting through; the anchor in each announcement catches up a longer gap.
+static uint32_t ks_rebuild_counter(const hrms_keystream_t *ks, uint16_t low) {
+  int16_t delta = (int16_t)(low - (uint16_t)ks->rx_highest);
+  return ks->rx_highest + (uint32_t)(int32_t)delta;
+}
+
+// A compare and one bit test whatever the counter - no search over past frames
+static bool ks_window_fresh(const hrms_keystream_t *ks, uint32_t counter) {
+  if ((int32_t)(counter - ks->rx_highest) > 0) {
+    return true;
+  }
+
+  uint32_t age = ks->rx_highest - counter;
+  if (age >= KS_WINDOW_BITS) {
+    return false;
+  }
+  return ((ks->rx_window[age / 32] >> (age % 32)) & 1U) == 0;
+}
+
+static void ks_window_accept(hrms_keystream_t *ks, uint32_t counter) {
+  uint32_t shift = counter - ks->rx_highest;
+  if ((int32_t)shift > 0) {
+    // Slide by whole words then bits - no 64-bit shift helper on Cortex-M3
+    if (shift >= KS_WINDOW_BITS) {
+      ks->rx_window[1] = 0;
+      ks->rx_window[0] = 0;
+    } else if (shift >= 32) {
+      ks->rx_window[1] = ks->rx_window[0] << (shift - 32);
+      ks->rx_window[0] = 0;
+    } else {
+      ks->rx_window[1] = (ks->rx_window[1] << shift) | (ks->rx_window[0] >> (32 - shift));
+      ks->rx_window[0] <<= shift;
+    }
+    ks->rx_highest = counter;
+    ks->rx_window[0] |= 1U;
+  } else {
+    uint32_t age = ks->rx_highest - counter;
+    ks->rx_window[age / 32] |= 1U << (age % 32);
+  }
+}
+
+// Everything below the anchor was sent before the announcement, and on this
+// in-order link has arrived or is lost - count it as seen
+static void ks_window_skip(hrms_keystream_t *ks, uint32_t anchor) {
+  ks->rx_highest = anchor - 1U;
+  ks->rx_window[0] = 0xFFFFFFFFU;
+  ks->rx_window[1] = 0xFFFFFFFFU;
+}
+
+#if HRMS_KEYSTREAM_AUTH
+// No early exit - timing does not tell how many tag bytes matched
+static bool ks_tag_equal(const uint8_t *a, const uint8_t *b) {
+  uint8_t diff = 0;
+  for (uint8_t i = 0; i < HRMS_KEYSTREAM_TAG_SIZE; i++) {
+    diff |= a[i] ^ b[i];
+  }
+  return diff == 0;
+}
+#endif
+
+static bool ks_nonce_equal(const uint8_t *a, const uint8_t *b) {
+  for (uint8_t i = 0; i < HRMS_KEYSTREAM_NONCE_BYTES; i++) {
+    if (a[i] != b[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void ks_put32(uint8_t *buf, uint32_t value) {
+  buf[0] = (uint8_t)value;
+  buf[1] = (uint8_t)(value >> 8);
+  buf[2] = (uint8_t)(value >> 16);
+  buf[3] = (uint8_t)(value >> 24);
+}
+
+static uint32_t ks_get32(const uint8_t *buf) {
+  return (uint32_t)buf[0] | ((uint32_t)buf[1] << 8) | ((uint32_t)buf[2] << 16) |
+         ((uint32_t)buf[3] << 24);
+}
+
+static void ks_xor(const uint8_t *in, const uint8_t *keystream, uint8_t *out, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    out[i] = in[i] ^ keystream[i];
+  }
+}
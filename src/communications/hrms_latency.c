@@ -0,0 +1,312 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+#include "hrms_latency.h"
+#include "hrms_timer.h"
+#include "hrms_uart.h"
+#include "hrms_config.h"
+#include "libc_stubs.h"
+
+#define LAT_BUCKETS           64    // Last bucket also takes everything slower
+#define LAT_CONTROL_HISTORY   8     // Control frames remembered for one-way matching
+#define LAT_ONE_WAY_LIMIT_US  1000000U
+
+typedef struct {
+  uint32_t rtt_cycles;
+  uint32_t offset_cycles;
+} lat_offset_sample_t;
+
+typedef struct {
+  uint32_t sample_cycles;
+  uint8_t packet_id;
+  bool valid;
+} lat_control_t;
+
+// Transmitter side
+static uint32_t probe_t1 = 0;
+static bool probe_outstanding = false;
+static uint16_t histogram[LAT_BUCKETS];
+static uint32_t histogram_total = 0;
+static lat_offset_sample_t offset_samples[HRMS_LATENCY_OFFSET_WINDOW];
+static uint8_t offset_next = 0;
+static uint8_t offset_count = 0;
+static lat_control_t control_history[LAT_CONTROL_HISTORY];
+static uint8_t control_next = 0;
+static uint8_t last_one_way_id = 0;
+static bool last_one_way_valid = false;
+
+// Receiver side
+static uint32_t control_rx_cycles = 0;
+static uint8_t control_rx_id = 0;
+static bool control_rx_valid = false;
+
+static hrms_latency_stats_t lat_stats;
+
+static void lat_put_u32(uint8_t *buf, uint32_t value);
+static uint32_t lat_get_u32(const uint8_t *buf);
+static void lat_record_rtt(uint32_t rtt_us);
+static void lat_record_offset(uint32_t rtt_cycles, uint32_t offset_cycles);
+static void lat_record_one_way(uint8_t packet_id, uint32_t rx_cycles);
+static uint32_t lat_percentile(uint8_t percent);
+
+void hrms_latency_init(void) {
+  probe_outstanding = false;
+  memset(histogram, 0, sizeof(histogram));
+  histogram_total = 0;
+  offset_next = 0;
+  offset_count = 0;
+  memset(control_history, 0, sizeof(control_history));
+  control_next = 0;
+  last_one_way_valid = false;
+  control_rx_valid = false;
+  memset(&lat_stats, 0, sizeof(lat_stats));
+}
+
+size_t hrms_latency_make_request(uint8_t *payload, size_t max_len) {
+  if (!payload || max_len < HRMS_LATENCY_REQUEST_SIZE) {
+    return 0;
+  }
+
+  // A lost probe is simply replaced by the next one
+  probe_t1 = hrms_timer_cycles();
+  probe_outstanding = true;
+  lat_stats.probes++;
+
+  payload[0] = HRMS_LATENCY_OP_REQUEST;
+  lat_put_u32(&payload[1], probe_t1);
+
+  return HRMS_LATENCY_REQUEST_SIZE;
+}
+
+size_t hrms_latency_make_reply(const uint8_t *request, size_t len, uint32_t rx_cycles,
+                               uint8_t *payload, size_t max_len) {
+  if (!request || !payload || len < HRMS_LATENCY_REQUEST_SIZE ||
+      request[0] != HRMS_LATENCY_OP_REQUEST || max_len < HRMS_LATENCY_REPLY_CTRL_SIZE) {
+    return 0;
+  }
+
+  payload[0] = HRMS_LATENCY_OP_REPLY;
+  memcpy(&payload[1], &request[1], 4);          // t1 echoed as is
+  lat_put_u32(&payload[5], rx_cycles);          // t2
+
+  size_t reply_len = HRMS_LATENCY_REPLY_SIZE;
+  if (control_rx_valid) {
+    payload[13] = control_rx_id;
+    lat_put_u32(&payload[14], control_rx_cycles);
+    reply_len = HRMS_LATENCY_REPLY_CTRL_SIZE;
+  }
+
+  // t3 last, as close to the send as possible
+  lat_put_u32(&payload[9], hrms_timer_cycles());
+
+  return reply_len;
+}
+
+bool hrms_latency_on_reply(const uint8_t *payload, size_t len, uint32_t rx_cycles) {
+  if (!payload || len < HRMS_LATENCY_REPLY_SIZE || payload[0] != HRMS_LATENCY_OP_REPLY ||
+      !probe_outstanding || lat_get_u32(&payload[1]) != probe_t1) {
+    return false;
+  }
+
+  probe_outstanding = false;
+  lat_stats.replies++;
+
+  uint32_t t2 = lat_get_u32(&payload[5]);
+  uint32_t t3 = lat_get_u32(&payload[9]);
+  uint32_t turnaround = t3 - t2;
+  uint32_t total = rx_cycles - probe_t1;
+  if (turnaround > total) {
+    return true;   // Peer clock not counting at our rate - no usable sample
+  }
+
+  uint32_t rtt_cycles = total - turnaround;
+  lat_record_rtt(hrms_timer_cycles_to_us(rtt_cycles));
+  lat_record_offset(rtt_cycles, t2 - probe_t1 - rtt_cycles / 2);
+
+  if (len >= HRMS_LATENCY_REPLY_CTRL_SIZE) {
+    lat_record_one_way(payload[13], lat_get_u32(&payload[14]));
+  }
+
+  return true;
+}
+
+void hrms_latency_on_control_tx(uint8_t packet_id, uint32_t sample_cycles) {
+  lat_control_t *entry = &control_history[control_next];
+  entry->packet_id = packet_id;
+  entry->sample_cycles = sample_cycles;
+  entry->valid = true;
+  control_next = (uint8_t)((control_next + 1) % LAT_CONTROL_HISTORY);
+}
+
+void hrms_latency_on_control_rx(uint8_t packet_id, uint32_t rx_cycles) {
+  control_rx_id = packet_id;
+  control_rx_cycles = rx_cycles;
+  control_rx_valid = true;
+}
+
+void hrms_latency_get_stats(hrms_latency_stats_t *stats) {
+  if (!stats) {
+    return;
+  }
+
+  lat_stats.rtt_median_us = lat_percentile(50);
+  lat_stats.rtt_p99_us = lat_percentile(99);
+  memcpy(stats, &lat_stats, sizeof(hrms_latency_stats_t));
+}
+
+void hrms_latency_dump(void) {
+  hrms_latency_stats_t stats;
+  hrms_latency_get_stats(&stats);
+
+  hrms_uart_send_str("rtt us min/p50/p99/max ");
+  hrms_uart_send_dec(stats.rtt_min_us);
+  hrms_uart_send_str("/");
+  hrms_uart_send_dec(stats.rtt_median_us);
+  hrms_uart_send_str("/");
+  hrms_uart_send_dec(stats.rtt_p99_us);
+  hrms_uart_send_str("/");
+  hrms_uart_send_dec(stats.rtt_max_us);
+  hrms_uart_send_str(" probes ");
+  hrms_uart_send_dec(stats.replies);
+  hrms_uart_send_str("/");
+  hrms_uart_send_dec(stats.probes);
+  hrms_uart_send_str("\r\none-way us last/max ");
+  hrms_uart_send_dec(stats.one_way_us);
+  hrms_uart_send_str("/");
+  hrms_uart_send_dec(stats.one_way_max_us);
+  hrms_uart_send_str(" n ");
+  hrms_uart_send_dec(stats.one_way_samples);
+  hrms_uart_send_str("\r\n");
+
+  // Non-empty buckets as "<=upper_us: count"
+  for (uint8_t i = 0; i < LAT_BUCKETS; i++) {
+    if (histogram[i] == 0) {
+      continue;
+    }
+    hrms_uart_send_str(i == LAT_BUCKETS - 1 ? ">" : "<=");
+    hrms_uart_send_dec((uint32_t)(i == LAT_BUCKETS - 1 ? i : i + 1) * HRMS_LATENCY_BUCKET_US);
+    hrms_uart_send_str(": ");
+    hrms_uart_send_dec(histogram[i]);
+    hrms_uart_send_str("\r\n");
+  }
+}
+
+static void lat_put_u32(uint8_t *buf, uint32_t value) {
+  buf[0] = (uint8_t)(value & 0xFF);
+  buf[1] = (uint8_t)((value >> 8) & 0xFF);
+  buf[2] = (uint8_t)((value >> 16) & 0xFF);
+  buf[3] = (uint8_t)((value >> 24) & 0xFF);
+}
+
+static uint32_t lat_get_u32(const uint8_t *buf) {
+  return (uint32_t)buf[0] | ((uint32_t)buf[1] << 8) |
+         ((uint32_t)buf[2] << 16) | ((uint32_t)buf[3] << 24);
+}
+
+static void lat_record_rtt(uint32_t rtt_us) {
+  uint32_t bucket = rtt_us / HRMS_LATENCY_BUCKET_US;
+  if (bucket >= LAT_BUCKETS) {
+    bucket = LAT_BUCKETS - 1;
+  }
+
+  // Halve everything on saturation - keeps the shape, favours recent samples
+  if (histogram[bucket] == 0xFFFF) {
+    histogram_total = 0;
+    for (uint8_t i = 0; i < LAT_BUCKETS; i++) {
+      histogram[i] /= 2;
+      histogram_total += histogram[i];
+    }
+  }
+  histogram[bucket]++;
+  histogram_total++;
+
+  if (lat_stats.replies == 1 || rtt_us < lat_stats.rtt_min_us) {
+    lat_stats.rtt_min_us = rtt_us;
+  }
+  if (rtt_us > lat_stats.rtt_max_us) {
+    lat_stats.rtt_max_us = rtt_us;
+  }
+}
+
+// Offset from the fastest recent probe: least queueing, least asymmetry
+static void lat_record_offset(uint32_t rtt_cycles, uint32_t offset_cycles) {
+  offset_samples[offset_next].rtt_cycles = rtt_cycles;
+  offset_samples[offset_next].offset_cycles = offset_cycles;
+  offset_next = (uint8_t)((offset_next + 1) % HRMS_LATENCY_OFFSET_WINDOW);
+  if (offset_count < HRMS_LATENCY_OFFSET_WINDOW) {
+    offset_count++;
+  }
+
+  const lat_offset_sample_t *best = &offset_samples[0];
+  for (uint8_t i = 1; i < offset_count; i++) {
+    if (offset_samples[i].rtt_cycles < best->rtt_cycles) {
+      best = &offset_samples[i];
+    }
+  }
+
+  lat_stats.offset_cycles = best->offset_cycles;
+  lat_stats.offset_valid = true;
+}
+
+static void lat_record_one_way(uint8_t packet_id, uint32_t rx_cycles) {
+  // The peer repeats its last control frame until a new one arrives
+  if (!lat_stats.offset_valid || (last_one_way_valid && packet_id == last_one_way_id)) {
+    return;
+  }
+
+  for (uint8_t i = 0; i < LAT_CONTROL_HISTORY; i++) {
+    const lat_control_t *entry = &control_history[i];
+    if (!entry->valid || entry->packet_id != packet_id) {
+      continue;
+    }
+
+    // Arrival in our clock minus sample time; offset error can make it "negative"
+    uint32_t one_way_us = hrms_timer_cycles_to_us(rx_cycles - lat_stats.offset_cycles -
+                                                  entry->sample_cycles);
+    if (one_way_us >= LAT_ONE_WAY_LIMIT_US) {
+      return;
+    }
+
+    last_one_way_id = packet_id;
+    last_one_way_valid = true;
+    lat_stats.one_way_samples++;
+    lat_stats.one_way_us = one_way_us;
+    if (one_way_us > lat_stats.one_way_max_us) {
+      lat_stats.one_way_max_us = one_way_us;
+    }
+    return;
+  }
+}
+
+// Upper edge of the bucket holding the percentile, clamped to the extremes seen
+static uint32_t lat_percentile(uint8_t percent) {
+  if (histogram_total == 0) {
+    return 0;
+  }
+
+  uint32_t target = (histogram_total * percent + 99) / 100;
+  uint32_t seen = 0;
+  uint32_t value = lat_stats.rtt_max_us;
+
+  for (uint8_t i = 0; i < LAT_BUCKETS - 1; i++) {
+    seen += histogram[i];
+    if (seen >= target) {
+      value = (uint32_t)(i + 1) * HRMS_LATENCY_BUCKET_US;
+      break;
+    }
+  }
+
+  if (value > lat_stats.rtt_max_us) {
+    value = lat_stats.rtt_max_us;
+  }
+  if (value < lat_stats.rtt_min_us) {
+    value = lat_stats.rtt_min_us;
+  }
+  return value;
+}
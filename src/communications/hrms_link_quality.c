@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+#include "hrms_link_quality.h"
+#include "hrms_config.h"
+#include "libc_stubs.h"
+
+#define LINK_Q8_ONE 256
+
+static hrms_link_rf_t rendezvous_rf;
+static hrms_link_rf_t current_rf;
+static int32_t loss_q8 = 0;
+static int32_t retries_q8 = 0;
+static uint32_t frames_total = 0;
+static uint32_t frames_since_commit = 0;
+static uint32_t rate_switches = 0;
+static uint8_t consecutive_failures = 0;
+static uint32_t last_activity_ms = 0;
+
+static int32_t link_ewma(int32_t average, int32_t sample);
+static bool link_rate_slower(nrf24l01_datarate_t rate, nrf24l01_datarate_t *slower);
+static bool link_rate_faster(nrf24l01_datarate_t rate, nrf24l01_datarate_t *faster);
+
+void hrms_link_quality_init(const hrms_link_rf_t *rendezvous) {
+  if (!rendezvous) {
+    return;
+  }
+
+  rendezvous_rf = *rendezvous;
+  current_rf = *rendezvous;
+  loss_q8 = 0;
+  retries_q8 = 0;
+  frames_total = 0;
+  frames_since_commit = 0;
+  rate_switches = 0;
+  consecutive_failures = 0;
+  last_activity_ms = 0;
+}
+
+void hrms_link_quality_on_tx(bool delivered, uint8_t retransmits, uint32_t now_ms) {
+  loss_q8 = link_ewma(loss_q8, delivered ? 0 : LINK_Q8_ONE);
+  retries_q8 = link_ewma(retries_q8, (int32_t)retransmits * LINK_Q8_ONE);
+
+  frames_total++;
+  frames_since_commit++;
+
+  if (delivered) {
+    consecutive_failures = 0;
+    last_activity_ms = now_ms;
+  } else if (consecutive_failures < 0xFF) {
+    consecutive_failures++;
+  }
+}
+
+void hrms_link_quality_on_rx(uint32_t now_ms) {
+  last_activity_ms = now_ms;
+}
+
+hrms_link_decision_t hrms_link_quality_evaluate(hrms_link_rf_t *next, uint32_t now_ms) {
+  if (!next) {
+    return HRMS_LINK_KEEP;
+  }
+
+  *next = current_rf;
+
+  // Fallback: lost the peer at a negotiated rate/channel - meet again at rendezvous
+  if ((current_rf.datarate != rendezvous_rf.datarate ||
+       current_rf.channel != rendezvous_rf.channel) &&
+      (consecutive_failures >= HRMS_LINK_FAIL_REVERT ||
+       (now_ms - last_activity_ms) >= HRMS_LINK_IDLE_REVERT_MS)) {
+    next->datarate = rendezvous_rf.datarate;
+    next->channel = rendezvous_rf.channel;
+    next->power = NRF24L01_POWER_0DBM;
+    return HRMS_LINK_APPLY_LOCAL;
+  }
+
+  if (frames_since_commit < HRMS_LINK_MIN_FRAMES) {
+    return HRMS_LINK_KEEP;
+  }
+
+  // Weak link: restore power first, then trade rate for sensitivity
+  if (loss_q8 > HRMS_LINK_LOSS_DOWN_Q8 || retries_q8 > HRMS_LINK_RETRY_DOWN_Q8) {
+    if (current_rf.power != NRF24L01_POWER_0DBM) {
+      next->power = (nrf24l01_power_t)(current_rf.power - 1);
+      return HRMS_LINK_APPLY_LOCAL;
+    }
+    if (link_rate_slower(current_rf.datarate, &next->datarate)) {
+      return HRMS_LINK_APPLY_COORDINATED;
+    }
+    return HRMS_LINK_KEEP;
+  }
+
+  // Strong link: go faster for latency, then save power at the top rate
+  if (loss_q8 <= HRMS_LINK_LOSS_UP_Q8 && retries_q8 <= HRMS_LINK_RETRY_UP_Q8) {
+    if (link_rate_faster(current_rf.datarate, &next->datarate)) {
+      return HRMS_LINK_APPLY_COORDINATED;
+    }
+    if (retries_q8 <= HRMS_LINK_POWER_DOWN_RETRY_Q8 &&
+        current_rf.power != NRF24L01_POWER_NEG18DBM) {
+      next->power = (nrf24l01_power_t)(current_rf.power + 1);
+      return HRMS_LINK_APPLY_LOCAL;
+    }
+  }
+
+  return HRMS_LINK_KEEP;
+}
+
+void hrms_link_quality_commit(const hrms_link_rf_t *rf, uint32_t now_ms) {
+  if (!rf) {
+    return;
+  }
+
+  if (rf->datarate != current_rf.datarate) {
+    rate_switches++;
+  }
+  if (rf->datarate != current_rf.datarate || rf->channel != current_rf.channel) {
+    // Old averages describe a different modulation or band - start over
+    loss_q8 = 0;
+    retries_q8 = 0;
+  }
+
+  current_rf = *rf;
+  frames_since_commit = 0;
+  consecutive_failures = 0;
+  last_activity_ms = now_ms;
+}
+
+void hrms_link_quality_get_stats(hrms_link_quality_stats_t *stats) {
+  if (!stats) {
+    return;
+  }
+
+  stats->loss_q8 = (uint16_t)loss_q8;
+  stats->retries_q8 = (uint16_t)retries_q8;
+  stats->frames = frames_total;
+  stats->rate_switches = rate_switches;
+  stats->rf = current_rf;
+}
+
+// Exponential moving average with weight 1/8 on the new sample, rounded
+// away from zero so it settles on the sample instead of up to 7 short of it
+static int32_t link_ewma(int32_t average, int32_t sample) {
+  int32_t delta = sample - average;
+  if (delta > 0) {
+    delta += 7;
+  } else if (delta < 0) {
+    delta -= 7;
+  }
+  return average + delta / 8;
+}
+
+// Ladder: 2 Mbps (fast) -> 1 Mbps -> 250 kbps (robust)
+static bool link_rate_slower(nrf24l01_datarate_t rate, nrf24l01_datarate_t *slower) {
+  switch (rate) {
+    case NRF24L01_DATARATE_2MBPS:   *slower = NRF24L01_DATARATE_1MBPS;   return true;
+    case NRF24L01_DATARATE_1MBPS:   *slower = NRF24L01_DATARATE_250KBPS; return true;
+    default:                        return false;
+  }
+}
+
+static bool link_rate_faster(nrf24l01_datarate_t rate, nrf24l01_datarate_t *faster) {
+  switch (rate) {
+    case NRF24L01_DATARATE_250KBPS: *faster = NRF24L01_DATARATE_1MBPS;   return true;
+    case NRF24L01_DATARATE_1MBPS:   *faster = NRF24L01_DATARATE_2MBPS;   return true;
+    default:                        return false;
+  }
+}
@@ -11,6 +11,32 @@
 #include "hrms_nrf24l01.h"
 #include "hrms_gpio.h"
 #include "hrms_pins.h"
+#include "hrms_link_quality.h"
+#include "hrms_freq_hop.h"
+#include "hrms_config.h"
+#include "libc_stubs.h"
+
+// Ack-payload mode: the PTX never listens, the PRX never leaves RX
+#define NRF24_COMM_ACK_PTX  (HRMS_NRF24_ACK_PAYLOAD && HRMS_NRF24_ROLE == HRMS_NRF24_ROLE_PTX)
+#define NRF24_COMM_ACK_PRX  (HRMS_NRF24_ACK_PAYLOAD && HRMS_NRF24_ROLE == HRMS_NRF24_ROLE_PRX)
+
+static bool nrf24_comm_radio_send(const uint8_t *data, size_t len);
+
+static bool burst_active = false;   // Pipelined payloads went out since the last listen
+#if NRF24_COMM_ACK_PRX
+static uint8_t reply_pipe = 0;      // Pipe of the last frame - the next ACK goes there
+#endif
+
+#if HRMS_NRF24_FREQ_HOP
+#define HOP_RENDEZVOUS 0xFF   // hop_slot value: parked on HRMS_NRF24_CHANNEL
+
+static uint8_t hop_slot = HOP_RENDEZVOUS;   // Slot both ends agree on
+static uint32_t hop_last_rx_ms = 0;
+
+static bool nrf24_comm_hop_send(const uint8_t *data, size_t len, uint8_t *retransmits);
+static void nrf24_comm_hop_to(uint8_t slot);
+static uint8_t nrf24_comm_hop_channel(uint8_t slot);
+#endif
 
 // nRF24 communication module following sensor/actuator pattern
 bool hrms_nrf24_comm_init(void) {
@@ -32,14 +58,38 @@ bool hrms_nrf24_comm_init(void) {
     .channel = 76,                    // 2.476 GHz
     .power = NRF24L01_POWER_0DBM,     // Maximum power
     .datarate = NRF24L01_DATARATE_1MBPS,
-    .address = {0xE7, 0xE7, 0xE7, 0xE7, 0xE7}, // Default address
+    .address = {0xE7, 0xE7, 0xE7, 0xE7, 0xE7}, // Default (base) address
     .auto_ack = true,
     .retries = 3,
-    .retry_delay = 5                  // 1.25ms
+    .retry_delay = 5,                 // 1.25ms
+    .dynamic_payload = HRMS_NRF24_ACK_PAYLOAD,
+    .ack_payload = HRMS_NRF24_ACK_PAYLOAD,
+    .rx_pipes = HRMS_NRF24_RX_PIPES
   };
   
+  // Star node: talk on the pipe that belongs to this node id
+  uint8_t base_address[NRF24L01_ADDR_WIDTH];
+  memcpy(base_address, config.address, NRF24L01_ADDR_WIDTH);
+  hrms_nrf24l01_pipe_address(base_address, HRMS_NRF24_NODE_ID, config.address);
+  
   hrms_nrf24l01_configure(&config);
+  
+  // Boot settings double as the rendezvous point for rate/channel fallback
+  hrms_link_rf_t rendezvous = { config.datarate, config.power, config.channel };
+  hrms_link_quality_init(&rendezvous);
+  
+#if HRMS_NRF24_FREQ_HOP
+  // Both ends start parked on the rendezvous channel
+  hrms_freq_hop_init(HRMS_HOP_SEED);
+  hop_slot = HOP_RENDEZVOUS;
+#endif
+  
+#if NRF24_COMM_ACK_PTX
+  // Stay in PTX - return data arrives with the auto-ACKs
+  hrms_nrf24l01_stop_listening();
+#else
   hrms_nrf24l01_start_listening();   // Start in receive mode
+#endif
   
   return true;
 }
@@ -49,27 +99,125 @@ bool hrms_nrf24_comm_send(const uint8_t *data, size_t len) {
     return false;
   }
   
-  // Send via nRF24L01
-  hrms_nrf24l01_stop_listening();
-  bool success = hrms_nrf24l01_send(data, len);
-  hrms_nrf24l01_start_listening();
+  // A pending burst is not a radio failure - keep it out of the link estimate
+  if (hrms_nrf24l01_tx_pending()) {
+    return false;
+  }
+  
+#if NRF24_COMM_ACK_PRX
+  // Goes out with the ACK of the peer's next frame; no retry count to report
+  if (len > NRF24L01_MAX_PAYLOAD_SIZE) {
+    return false;
+  }
+  return hrms_nrf24l01_write_ack_payload(reply_pipe, data, (uint8_t)len);
+#endif
+  
+#if HRMS_NRF24_FREQ_HOP
+  uint8_t retransmits = 0;
+  bool success = nrf24_comm_hop_send(data, len, &retransmits);
+#else
+  bool success = nrf24_comm_radio_send(data, len);
+  
+  // ARC_CNT still holds the retransmit count of this frame
+  uint8_t retransmits = hrms_nrf24l01_get_observe_tx() & NRF24L01_OBSERVE_ARC_CNT;
+#endif
+  hrms_link_quality_on_tx(success, retransmits, xTaskGetTickCount());
   
   return success;
 }
 
+void hrms_nrf24_comm_set_rf(nrf24l01_datarate_t datarate, nrf24l01_power_t power) {
+  hrms_nrf24l01_set_rf(datarate, power);
+}
+
+void hrms_nrf24_comm_set_channel(uint8_t channel) {
+#if HRMS_NRF24_FREQ_HOP
+  (void)channel; // The hop sequence owns RF_CH
+#else
+  hrms_nrf24l01_set_channel(channel);
+#endif
+}
+
+bool hrms_nrf24_comm_enqueue(const uint8_t *data, size_t len, uint8_t tag) {
+  if (!data || len == 0 || len > NRF24L01_MAX_PAYLOAD_SIZE || NRF24_COMM_ACK_PRX) {
+    return false;
+  }
+  
+#if HRMS_NRF24_FREQ_HOP
+  // Bursts stay on the agreed slot; the header still tells the peer where
+  if (len > NRF24L01_MAX_PAYLOAD_SIZE - 1 || hop_slot == HOP_RENDEZVOUS) {
+    return false;
+  }
+  uint8_t frame[NRF24L01_MAX_PAYLOAD_SIZE];
+  frame[0] = hop_slot;
+  memcpy(&frame[1], data, len);
+  bool queued = hrms_nrf24l01_enqueue(frame, (uint8_t)(len + 1), tag);
+#else
+  bool queued = hrms_nrf24l01_enqueue(data, (uint8_t)len, tag);
+#endif
+  
+  if (queued) {
+    burst_active = true;
+  }
+  return queued;
+}
+
+bool hrms_nrf24_comm_tx_busy(void) {
+  return hrms_nrf24l01_tx_pending() > 0;
+}
+
+void hrms_nrf24_comm_set_tx_callback(nrf24l01_tx_callback_t callback) {
+  hrms_nrf24l01_set_tx_callback(callback);
+}
+
+bool hrms_nrf24_comm_set_ack_payload(const uint8_t *data, size_t len) {
+  if (!data || len == 0 || len > NRF24L01_MAX_PAYLOAD_SIZE) {
+    return false;
+  }
+  
+  return hrms_nrf24l01_write_ack_payload(0, data, (uint8_t)len);
+}
+
 bool hrms_nrf24_comm_receive(uint8_t *data, size_t max_len, size_t *received_len) {
+  return hrms_nrf24_comm_receive_from(data, max_len, received_len, NULL);
+}
+
+bool hrms_nrf24_comm_receive_from(uint8_t *data, size_t max_len, size_t *received_len,
+                                  uint8_t *pipe) {
   if (!data || !received_len || max_len == 0) {
     return false;
   }
   
   *received_len = 0;
   
-  if (!hrms_nrf24l01_available()) {
-    return false;
+  if (max_len > NRF24L01_MAX_PAYLOAD_SIZE) {
+    max_len = NRF24L01_MAX_PAYLOAD_SIZE;
   }
   
-  uint8_t bytes_received = hrms_nrf24l01_receive(data, max_len);
+  uint8_t rx_pipe = 0;
+  uint8_t bytes_received = hrms_nrf24l01_receive_from(data, (uint8_t)max_len, &rx_pipe);
+  
+#if HRMS_NRF24_FREQ_HOP
+  // Receiver: every frame names the slot to hop to (PTX ack payloads carry none)
+  if (bytes_received > 0 && hrms_nrf24l01_is_listening()) {
+    if (bytes_received < 2 || data[0] >= HRMS_HOP_CHANNELS) {
+      return false;
+    }
+    nrf24_comm_hop_to(data[0]);
+    bytes_received--;
+    for (uint8_t i = 0; i < bytes_received; i++) {
+      data[i] = data[i + 1];
+    }
+  }
+#endif
+  
   if (bytes_received > 0) {
+#if NRF24_COMM_ACK_PRX
+    reply_pipe = rx_pipe;
+#endif
+    if (pipe) {
+      *pipe = rx_pipe;
+    }
     *received_len = bytes_received;
     return true;
   }
@@ -77,7 +225,108 @@ bool hrms_nrf24_comm_receive(uint8_t *data, size_t max_len, size_t *received_len
   return false;
 }
 
+bool hrms_nrf24_comm_rx_stamp(uint32_t *cycles) {
+  return hrms_nrf24l01_take_rx_stamp(cycles);
+}
+
+void hrms_nrf24_comm_set_task(TaskHandle_t task) {
+  hrms_nrf24l01_set_irq_task(task);
+}
+
+bool hrms_nrf24_comm_wait(uint32_t timeout_ms) {
+  return (hrms_nrf24l01_wait_irq(timeout_ms) & NRF24L01_STATUS_RX_DR) != 0;
+}
+
 void hrms_nrf24_comm_process(void) {
   // Periodic processing for nRF24L01
-  hrms_nrf24l01_clear_interrupts();
+  // Interrupt flags are cleared by the paths that consume them (send/receive)
+  hrms_nrf24l01_process_tx();
+  
+  if (burst_active && !hrms_nrf24l01_tx_pending()) {
+    burst_active = false;
+#if !NRF24_COMM_ACK_PTX
+    // Enqueue left PRX for the burst - listen again now that it drained
+    hrms_nrf24l01_start_listening();
+#endif
+  }
+  
+#if NRF24_COMM_ACK_PRX
+  // TX_DS of a sent ack payload would hold IRQ low and hide the next RX_DR
+  hrms_nrf24l01_ack_payload_sent();
+#endif
+  
+#if HRMS_NRF24_FREQ_HOP
+  // Receiver lost the hop sequence - wait on rendezvous for the transmitter
+  if (hrms_nrf24l01_is_listening() && hop_slot != HOP_RENDEZVOUS &&
+      (xTaskGetTickCount() - hop_last_rx_ms) >= HRMS_HOP_RESYNC_MS) {
+    nrf24_comm_hop_to(HOP_RENDEZVOUS);
+  }
+#endif
+}
+
+static bool nrf24_comm_radio_send(const uint8_t *data, size_t len) {
+#if NRF24_COMM_ACK_PTX
+  // No TX/RX turnaround: any ack payload lands in the RX FIFO with TX_DS
+  return hrms_nrf24l01_send(data, len);
+#else
+  // Send via nRF24L01
+  hrms_nrf24l01_stop_listening();
+  bool success = hrms_nrf24l01_send(data, len);
+  hrms_nrf24l01_start_listening();
+  
+  return success;
+#endif
+}
+
+#if HRMS_NRF24_FREQ_HOP
+// Try the agreed slot, then the next slot (the peer hopped but our ACK was
+// lost), then rendezvous (the peer timed out). Frame = next slot + data.
+static bool nrf24_comm_hop_send(const uint8_t *data, size_t len, uint8_t *retransmits) {
+  if (len > NRF24L01_MAX_PAYLOAD_SIZE - 1) {
+    return false;
+  }
+  
+  uint32_t now = xTaskGetTickCount();
+  uint8_t from = (hop_slot == HOP_RENDEZVOUS) ? (HRMS_HOP_CHANNELS - 1) : hop_slot;
+  uint8_t next = hrms_freq_hop_next(from, now);
+  
+  uint8_t frame[NRF24L01_MAX_PAYLOAD_SIZE];
+  frame[0] = next;
+  memcpy(&frame[1], data, len);
+  
+  const uint8_t attempts[] = { hop_slot, next, HOP_RENDEZVOUS };
+  for (uint8_t i = 0; i < sizeof(attempts); i++) {
+    if (i == 2 && hop_slot == HOP_RENDEZVOUS) {
+      break; // Already tried
+    }
+    
+    hrms_nrf24l01_set_channel(nrf24_comm_hop_channel(attempts[i]));
+    bool success = nrf24_comm_radio_send(frame, len + 1);
+    *retransmits = hrms_nrf24l01_get_observe_tx() & NRF24L01_OBSERVE_ARC_CNT;
+    
+    // Only the agreed slot says something about the channel itself
+    if (i == 0 && hop_slot != HOP_RENDEZVOUS) {
+      hrms_freq_hop_report(hop_slot, success, *retransmits, now);
+    }
+    
+    if (success) {
+      // The ACK proves the peer is in step - keep process() off rendezvous
+      hop_slot = next;
+      hop_last_rx_ms = now;
+      return true;
+    }
+  }
+  
+  return false;
+}
+
+static void nrf24_comm_hop_to(uint8_t slot) {
+  hop_slot = slot;
+  hop_last_rx_ms = xTaskGetTickCount();
+  hrms_nrf24l01_set_channel(nrf24_comm_hop_channel(slot));
+}
+
+static uint8_t nrf24_comm_hop_channel(uint8_t slot) {
+  return (slot == HOP_RENDEZVOUS) ? HRMS_NRF24_CHANNEL : hrms_freq_hop_channel(slot);
 }
+#endif
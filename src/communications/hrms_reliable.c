@@ -0,0 +1,271 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+#include "hrms_reliable.h"
+#include "hrms_packet_utils.h"
+#include "hrms_config.h"
+#include "libc_stubs.h"
+
+#define REL_WINDOW HRMS_RELIABLE_WINDOW
+
+// Sender side: encoded frames kept until ACKed or given up
+typedef struct {
+  uint8_t frame[HRMS_WIRE_MAX_FRAME_SIZE];
+  uint8_t len;
+  uint32_t seq;
+  uint32_t sent_ms;
+  uint8_t retries;
+  bool in_use;
+} rel_tx_slot_t;
+
+// Receiver side: frames that arrived ahead of a missing one
+typedef struct {
+  hrms_comm_packet_t packet;
+  uint32_t received_ms;
+  bool valid;
+} rel_rx_slot_t;
+
+static hrms_reliable_tx_t rel_tx = NULL;
+static hrms_reliable_deliver_t rel_deliver = NULL;
+
+static rel_tx_slot_t tx_slots[REL_WINDOW];
+static uint32_t tx_base = 0;   // Oldest unACKed sequence
+static uint32_t tx_next = 0;   // Next sequence to assign
+
+static rel_rx_slot_t rx_slots[REL_WINDOW];
+static uint32_t rx_next = 0;   // Next sequence to deliver
+
+static hrms_reliable_stats_t rel_stats;
+
+static uint32_t rel_widen(uint8_t seq, uint32_t reference);
+static void rel_tx_ack(uint32_t seq);
+static void rel_tx_slide(void);
+static void rel_rx_deliver(rel_rx_slot_t *slot);
+static void rel_rx_drain(void);
+static void rel_rx_skip_to(uint32_t seq);
+static void rel_send_ack(const hrms_comm_packet_t *packet, uint32_t seq, uint32_t now_ms);
+
+void hrms_reliable_init(hrms_reliable_tx_t tx, hrms_reliable_deliver_t deliver) {
+  rel_tx = tx;
+  rel_deliver = deliver;
+
+  memset(tx_slots, 0, sizeof(tx_slots));
+  memset(rx_slots, 0, sizeof(rx_slots));
+  memset(&rel_stats, 0, sizeof(rel_stats));
+  tx_base = 0;
+  tx_next = 0;
+  rx_next = 0;
+}
+
+bool hrms_reliable_carries(hrms_comm_packet_type_t type) {
+  switch (type) {
+    case HRMS_COMM_PACKET_CONFIG:
+    case HRMS_COMM_PACKET_STATUS:
+    case HRMS_COMM_PACKET_SENSOR_DATA:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool hrms_reliable_send(hrms_comm_packet_t *packet, uint32_t now_ms) {
+  if (!packet || !rel_tx || (tx_next - tx_base) >= REL_WINDOW) {
+    return false;
+  }
+
+  rel_tx_slot_t *slot = &tx_slots[tx_next % REL_WINDOW];
+  packet->packet_id = (uint8_t)tx_next;
+
+  size_t len = hrms_packet_encode(packet, slot->frame, sizeof(slot->frame));
+  if (len == 0) {
+    return false;
+  }
+
+  slot->len = (uint8_t)len;
+  slot->seq = tx_next;
+  slot->sent_ms = now_ms;
+  slot->retries = 0;
+  slot->in_use = true;
+  tx_next++;
+  rel_stats.sent++;
+
+  // The radio result does not matter here - only the peer's ACK does
+  rel_tx(slot->frame, slot->len);
+  return true;
+}
+
+void hrms_reliable_on_receive(const hrms_comm_packet_t *packet, uint32_t now_ms) {
+  if (!packet) {
+    return;
+  }
+
+  uint32_t seq = rel_widen(packet->packet_id, rx_next);
+  int32_t ahead = (int32_t)(seq - rx_next);
+
+  if (ahead < -REL_WINDOW) {
+    // Too old to be a retransmit - the sender started over
+    memset(rx_slots, 0, sizeof(rx_slots));
+    rx_next = seq;
+    rel_stats.resyncs++;
+  } else if (ahead < 0) {
+    // Delivered already; our ACK was lost, so repeat it
+    rel_stats.duplicates++;
+    rel_send_ack(packet, seq, now_ms);
+    return;
+  } else if (ahead >= REL_WINDOW) {
+    // Sender moved on past frames it gave up - make room
+    rel_rx_skip_to(seq - REL_WINDOW + 1);
+  }
+
+  rel_rx_slot_t *slot = &rx_slots[seq % REL_WINDOW];
+  if (slot->valid) {
+    rel_stats.duplicates++;
+  } else {
+    memcpy(&slot->packet, packet, sizeof(hrms_comm_packet_t));
+    slot->received_ms = now_ms;
+    slot->valid = true;
+    rel_rx_drain();
+  }
+
+  rel_send_ack(packet, seq, now_ms);
+}
+
+void hrms_reliable_on_ack(const hrms_comm_packet_t *packet) {
+  if (!packet || packet->payload_size < HRMS_RELIABLE_ACK_SIZE) {
+    return;
+  }
+
+  uint32_t acked = rel_widen(packet->payload[0], tx_base);
+  uint32_t cumulative = rel_widen(packet->payload[1], tx_base);
+
+  // Everything below the receiver's next expected sequence has arrived
+  for (uint32_t seq = tx_base; seq != tx_next && (int32_t)(cumulative - seq) > 0; seq++) {
+    rel_tx_ack(seq);
+  }
+  if ((acked - tx_base) < (tx_next - tx_base)) {
+    rel_tx_ack(acked);
+  }
+
+  rel_tx_slide();
+}
+
+void hrms_reliable_poll(uint32_t now_ms) {
+  for (uint8_t i = 0; i < REL_WINDOW; i++) {
+    rel_tx_slot_t *slot = &tx_slots[i];
+    if (!slot->in_use || (now_ms - slot->sent_ms) < HRMS_RELIABLE_RTO_MS) {
+      continue;
+    }
+
+    if (slot->retries >= HRMS_RELIABLE_MAX_RETRIES) {
+      slot->in_use = false;
+      rel_stats.failed++;
+      continue;
+    }
+
+    slot->retries++;
+    slot->sent_ms = now_ms;
+    rel_stats.retransmits++;
+    if (rel_tx) {
+      rel_tx(slot->frame, slot->len);
+    }
+  }
+  rel_tx_slide();
+
+  // Receiver: stop waiting for a frame once the one behind it is stale
+  for (uint32_t seq = rx_next; seq != rx_next + REL_WINDOW; seq++) {
+    rel_rx_slot_t *slot = &rx_slots[seq % REL_WINDOW];
+    if (slot->valid) {
+      if ((now_ms - slot->received_ms) >= HRMS_RELIABLE_GAP_MS) {
+        rel_rx_skip_to(seq);
+      }
+      break;
+    }
+  }
+}
+
+uint8_t hrms_reliable_in_flight(void) {
+  return (uint8_t)(tx_next - tx_base);
+}
+
+void hrms_reliable_get_stats(hrms_reliable_stats_t *stats) {
+  if (stats) {
+    memcpy(stats, &rel_stats, sizeof(hrms_reliable_stats_t));
+  }
+}
+
+// Full sequence closest to the reference with the given low byte
+static uint32_t rel_widen(uint8_t seq, uint32_t reference) {
+  return reference + (uint32_t)(int32_t)(int8_t)(uint8_t)(seq - (uint8_t)reference);
+}
+
+static void rel_tx_ack(uint32_t seq) {
+  rel_tx_slot_t *slot = &tx_slots[seq % REL_WINDOW];
+  if (slot->in_use && slot->seq == seq) {
+    slot->in_use = false;
+    rel_stats.acked++;
+  }
+}
+
+static void rel_tx_slide(void) {
+  while (tx_base != tx_next && !tx_slots[tx_base % REL_WINDOW].in_use) {
+    tx_base++;
+  }
+}
+
+static void rel_rx_deliver(rel_rx_slot_t *slot) {
+  slot->valid = false;
+  rel_stats.delivered++;
+  if (rel_deliver) {
+    rel_deliver(&slot->packet);
+  }
+}
+
+static void rel_rx_drain(void) {
+  while (rx_slots[rx_next % REL_WINDOW].valid) {
+    rel_rx_deliver(&rx_slots[rx_next % REL_WINDOW]);
+    rx_next++;
+  }
+}
+
+// Advance to seq, delivering what is buffered and counting what is missing
+static void rel_rx_skip_to(uint32_t seq) {
+  while ((int32_t)(seq - rx_next) > 0) {
+    rel_rx_slot_t *slot = &rx_slots[rx_next % REL_WINDOW];
+    if (slot->valid) {
+      rel_rx_deliver(slot);
+    } else {
+      rel_stats.gaps_skipped++;
+    }
+    rx_next++;
+  }
+  rel_rx_drain();
+}
+
+static void rel_send_ack(const hrms_comm_packet_t *packet, uint32_t seq, uint32_t now_ms) {
+  if (!rel_tx) {
+    return;
+  }
+
+  hrms_comm_packet_t ack;
+  memset(&ack, 0, sizeof(ack));
+  ack.packet_id = hrms_packet_get_next_id();
+  ack.packet_type = HRMS_COMM_PACKET_ACK;
+  ack.source_id = packet->dest_id;
+  ack.dest_id = packet->source_id;
+  ack.timestamp = now_ms;
+  ack.payload_size = HRMS_RELIABLE_ACK_SIZE;
+  ack.payload[0] = (uint8_t)seq;
+  ack.payload[1] = (uint8_t)rx_next;
+
+  uint8_t frame[HRMS_WIRE_MAX_FRAME_SIZE];
+  size_t len = hrms_packet_encode(&ack, frame, sizeof(frame));
+  if (len > 0) {
+    rel_tx(frame, len);
+  }
+}
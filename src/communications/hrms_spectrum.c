@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+#include "hrms_spectrum.h"
+#include "hrms_config.h"
+#include "libc_stubs.h"
+
+static uint16_t channel_hits[HRMS_SPECTRUM_CHANNELS];
+static uint16_t channel_samples = 0;   // Samples per channel since reset
+static hrms_spectrum_stats_t spectrum_stats;
+
+void hrms_spectrum_reset(void) {
+  memset(channel_hits, 0, sizeof(channel_hits));
+  channel_samples = 0;
+}
+
+bool hrms_spectrum_scan(uint8_t sweeps) {
+  uint8_t hits[HRMS_SPECTRUM_CHANNELS];
+
+  for (uint8_t s = 0; s < sweeps; s++) {
+    uint32_t elapsed = hrms_nrf24l01_scan(hits, HRMS_SPECTRUM_SAMPLES);
+    if (elapsed == 0) {
+      return false;
+    }
+
+    // Halve the history instead of overflowing - keeps the ratios
+    if (channel_samples > 0xFFFF - HRMS_SPECTRUM_SAMPLES) {
+      for (uint8_t ch = 0; ch < HRMS_SPECTRUM_CHANNELS; ch++) {
+        channel_hits[ch] /= 2;
+      }
+      channel_samples /= 2;
+    }
+
+    for (uint8_t ch = 0; ch < HRMS_SPECTRUM_CHANNELS; ch++) {
+      channel_hits[ch] += hits[ch];
+    }
+    channel_samples += HRMS_SPECTRUM_SAMPLES;
+
+    spectrum_stats.sweeps++;
+    spectrum_stats.last_sweep_us = elapsed;
+    if (elapsed > spectrum_stats.max_sweep_us) {
+      spectrum_stats.max_sweep_us = elapsed;
+    }
+  }
+
+  return true;
+}
+
+uint8_t hrms_spectrum_occupancy(uint8_t channel) {
+  if (channel >= HRMS_SPECTRUM_CHANNELS || channel_samples == 0) {
+    return 0;
+  }
+  return (uint8_t)((channel_hits[channel] * 100UL) / channel_samples);
+}
+
+uint8_t hrms_spectrum_quietest(uint8_t first, uint8_t last) {
+  if (last > NRF24L01_MAX_CHANNEL) {
+    last = NRF24L01_MAX_CHANNEL;
+  }
+  if (first > last) {
+    first = last;
+  }
+
+  uint8_t best = first;
+  uint32_t best_score = UINT32_MAX;
+
+  for (uint8_t ch = first; ch <= last; ch++) {
+    // Own hits count double, each neighbour's once
+    uint32_t score = 2UL * channel_hits[ch];
+    if (ch > 0) {
+      score += channel_hits[ch - 1];
+    }
+    if (ch < NRF24L01_MAX_CHANNEL) {
+      score += channel_hits[ch + 1];
+    }
+
+    if (score < best_score) {
+      best_score = score;
+      best = ch;
+    }
+  }
+
+  return best;
+}
+
+void hrms_spectrum_get_stats(hrms_spectrum_stats_t *stats) {
+  if (stats) {
+    memcpy(stats, &spectrum_stats, sizeof(hrms_spectrum_stats_t));
+  }
+}
@@ -0,0 +1,327 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+#include "hrms_timesync.h"
+#include "hrms_timer.h"
+#include "hrms_uart.h"
+#include "hrms_config.h"
+#include "libc_stubs.h"
+
+#define TS_MAX_SKEW_Q32     4294967   // 1000 ppm in 2^-32 units - beyond any crystal
+#define TS_SKEW_GAIN        4         // A new skew measurement weighs 1/4
+
+static void ts_put_u32(uint8_t *buf, uint32_t value);
+static uint32_t ts_get_u32(const uint8_t *buf);
+static void ts_exchange(hrms_timesync_t *ts, uint32_t t1, uint32_t t2, uint32_t t3, uint32_t t4,
+                        bool answering);
+static void ts_add_sample(hrms_timesync_t *ts, const hrms_timesync_sample_t *sample);
+static void ts_take_anchor(hrms_timesync_t *ts, const hrms_timesync_sample_t *sample);
+static bool ts_offset_at(hrms_timesync_t *ts, uint32_t local, uint32_t *offset);
+static void ts_expire(hrms_timesync_t *ts);
+static uint32_t ts_stale_cycles(void);
+static bool ts_ratio_q32(int32_t num, uint32_t den, int32_t *ratio);
+
+void hrms_timesync_init(hrms_timesync_t *ts, hrms_timesync_clock_t clock) {
+  ts->clock = clock ? clock : hrms_timer_cycles;
+  ts->request_outstanding = false;
+  ts->prev_valid = false;
+  ts->answer_valid = false;
+  ts->peer_ref_valid = false;
+  ts->block_count = 0;
+  ts->anchor_valid = false;
+  ts->skew_q32 = 0;
+  ts->skew_valid = false;
+  memset(&ts->stats, 0, sizeof(ts->stats));
+}
+
+size_t hrms_timesync_make_request(hrms_timesync_t *ts, uint32_t tick, uint8_t *payload,
+                                  size_t max_len) {
+  if (!payload || max_len < HRMS_TIMESYNC_REQUEST_SIZE) {
+    return 0;
+  }
+
+  ts_expire(ts);
+
+  size_t len = HRMS_TIMESYNC_REQUEST_SIZE;
+  payload[0] = HRMS_TIMESYNC_OP_REQUEST;
+  ts_put_u32(&payload[5], tick);
+
+  // Hand the peer the two stamps of the last exchange only we know
+  if (ts->prev_valid && max_len >= HRMS_TIMESYNC_REQUEST_PREV_SIZE) {
+    ts_put_u32(&payload[9], ts->prev_t1);
+    ts_put_u32(&payload[13], ts->prev_t4);
+    len = HRMS_TIMESYNC_REQUEST_PREV_SIZE;
+  }
+
+  // A lost request is simply replaced by the next one; t1 last, right before the load
+  ts->request_t1 = ts->clock();
+  ts->request_outstanding = true;
+  ts_put_u32(&payload[1], ts->request_t1);
+
+  return len;
+}
+
+size_t hrms_timesync_make_reply(hrms_timesync_t *ts, const uint8_t *request, size_t len,
+                                uint32_t rx_cycles, uint32_t tick,
+                                uint8_t *payload, size_t max_len) {
+  if (!request || !payload || len < HRMS_TIMESYNC_REQUEST_SIZE ||
+      request[0] != HRMS_TIMESYNC_OP_REQUEST || max_len < HRMS_TIMESYNC_REPLY_SIZE) {
+    return 0;
+  }
+
+  ts_expire(ts);
+
+  uint32_t t1 = ts_get_u32(&request[1]);
+  ts->peer_ref_tick = ts_get_u32(&request[5]);
+  ts->peer_ref_cycles = t1;
+  ts->peer_ref_valid = true;
+
+  // The previous exchange is complete once we know when our reply arrived
+  if (len >= HRMS_TIMESYNC_REQUEST_PREV_SIZE && ts->answer_valid &&
+      ts_get_u32(&request[9]) == ts->answer_t1) {
+    ts_exchange(ts, ts->answer_t1, ts->answer_t2, ts->answer_t3, ts_get_u32(&request[13]), true);
+  }
+
+  payload[0] = HRMS_TIMESYNC_OP_REPLY;
+  memcpy(&payload[1], &request[1], 4);          // t1 echoed as is
+  ts_put_u32(&payload[5], rx_cycles);           // t2
+  ts_put_u32(&payload[13], tick);
+
+  // t3 last, as close to the send as possible
+  ts->answer_t1 = t1;
+  ts->answer_t2 = rx_cycles;
+  ts->answer_t3 = ts->clock();
+  ts->answer_valid = true;
+  ts_put_u32(&payload[9], ts->answer_t3);
+
+  return HRMS_TIMESYNC_REPLY_SIZE;
+}
+
+bool hrms_timesync_on_reply(hrms_timesync_t *ts, const uint8_t *payload, size_t len,
+                            uint32_t rx_cycles) {
+  if (!payload || len < HRMS_TIMESYNC_REPLY_SIZE || payload[0] != HRMS_TIMESYNC_OP_REPLY ||
+      !ts->request_outstanding || ts_get_u32(&payload[1]) != ts->request_t1) {
+    return false;
+  }
+
+  ts->request_outstanding = false;
+
+  uint32_t t3 = ts_get_u32(&payload[9]);
+  ts->peer_ref_tick = ts_get_u32(&payload[13]);
+  ts->peer_ref_cycles = t3;
+  ts->peer_ref_valid = true;
+
+  ts->prev_t1 = ts->request_t1;
+  ts->prev_t4 = rx_cycles;
+  ts->prev_valid = true;
+
+  ts_exchange(ts, ts->request_t1, ts_get_u32(&payload[5]), t3, rx_cycles, false);
+  return true;
+}
+
+bool hrms_timesync_to_peer(hrms_timesync_t *ts, uint32_t local_cycles, uint32_t *peer_cycles) {
+  uint32_t offset;
+  if (!peer_cycles || !ts_offset_at(ts, local_cycles, &offset)) {
+    return false;
+  }
+
+  *peer_cycles = local_cycles + offset;
+  return true;
+}
+
+bool hrms_timesync_to_local(hrms_timesync_t *ts, uint32_t peer_cycles, uint32_t *local_cycles) {
+  // The offset changes by ppm - evaluating it at the rough local time is enough
+  uint32_t offset;
+  if (!local_cycles || !ts->anchor_valid ||
+      !ts_offset_at(ts, peer_cycles - ts->anchor.offset, &offset)) {
+    return false;
+  }
+
+  *local_cycles = peer_cycles - offset;
+  return true;
+}
+
+bool hrms_timesync_peer_tick_to_local(hrms_timesync_t *ts, uint16_t peer_tick,
+                                      uint32_t *local_cycles) {
+  if (!ts->peer_ref_valid) {
+    return false;
+  }
+
+  // Modulo 2^32 multiply, so ticks before the reference come out right too
+  int16_t ms = (int16_t)(peer_tick - (uint16_t)ts->peer_ref_tick);
+  uint32_t peer_cycles = ts->peer_ref_cycles +
+                         (uint32_t)(int32_t)ms * hrms_timer_us_to_cycles(1000U);
+
+  return hrms_timesync_to_local(ts, peer_cycles, local_cycles);
+}
+
+void hrms_timesync_get_stats(hrms_timesync_t *ts, hrms_timesync_stats_t *stats) {
+  if (!stats) {
+    return;
+  }
+
+  ts->stats.valid = ts_offset_at(ts, ts->clock(), &ts->stats.offset_cycles);
+  ts->stats.skew_ppb = (int32_t)(((int64_t)ts->skew_q32 * 1000000000) >> 32);
+  memcpy(stats, &ts->stats, sizeof(hrms_timesync_stats_t));
+}
+
+void hrms_timesync_dump(hrms_timesync_t *ts) {
+  hrms_timesync_stats_t stats;
+  hrms_timesync_get_stats(ts, &stats);
+
+  hrms_uart_send_str("sync ");
+  if (!stats.valid) {
+    hrms_uart_send_str("none");
+  } else {
+    hrms_uart_send_str("offset cycles ");
+    hrms_uart_send_dec(stats.offset_cycles);
+    hrms_uart_send_str(" skew ppb ");
+    if (stats.skew_ppb < 0) {
+      hrms_uart_send_str("-");
+    }
+    hrms_uart_send_dec((uint32_t)(stats.skew_ppb < 0 ? -stats.skew_ppb : stats.skew_ppb));
+    hrms_uart_send_str(" delay us ");
+    hrms_uart_send_dec(stats.delay_us);
+  }
+  hrms_uart_send_str(" updates ");
+  hrms_uart_send_dec(stats.updates);
+  hrms_uart_send_str("/");
+  hrms_uart_send_dec(stats.exchanges);
+  hrms_uart_send_str("\r\n");
+}
+
+static void ts_put_u32(uint8_t *buf, uint32_t value) {
+  buf[0] = (uint8_t)(value & 0xFF);
+  buf[1] = (uint8_t)((value >> 8) & 0xFF);
+  buf[2] = (uint8_t)((value >> 16) & 0xFF);
+  buf[3] = (uint8_t)((value >> 24) & 0xFF);
+}
+
+static uint32_t ts_get_u32(const uint8_t *buf) {
+  return (uint32_t)buf[0] | ((uint32_t)buf[1] << 8) |
+         ((uint32_t)buf[2] << 16) | ((uint32_t)buf[3] << 24);
+}
+
+// t1/t4 on the starting end's clock, t2/t3 on the answering end's
+static void ts_exchange(hrms_timesync_t *ts, uint32_t t1, uint32_t t2, uint32_t t3, uint32_t t4,
+                        bool answering) {
+  uint32_t total = t4 - t1;
+  uint32_t turnaround = t3 - t2;
+  if (turnaround > total) {
+    ts->stats.rejected++;
+    return;
+  }
+
+  hrms_timesync_sample_t sample;
+  sample.rtt = total - turnaround;
+  uint32_t arrival = t1 + sample.rtt / 2;       // t2 on the starting end's clock
+
+  if (answering) {
+    sample.local = t2;
+    sample.offset = arrival - t2;
+  } else {
+    sample.local = arrival;
+    sample.offset = t2 - arrival;
+  }
+
+  ts->stats.exchanges++;
+  ts_add_sample(ts, &sample);
+}
+
+// Queueing and retransmits only ever add delay - the fastest of a block wins
+static void ts_add_sample(hrms_timesync_t *ts, const hrms_timesync_sample_t *sample) {
+  if (ts->block_count == 0 || sample->rtt < ts->block_best.rtt) {
+    ts->block_best = *sample;
+  }
+
+  if (++ts->block_count >= HRMS_TIMESYNC_BLOCK) {
+    ts->block_count = 0;
+    ts_take_anchor(ts, &ts->block_best);
+  }
+}
+
+static void ts_take_anchor(hrms_timesync_t *ts, const hrms_timesync_sample_t *sample) {
+  uint32_t elapsed = sample->local - ts->anchor.local;
+
+  if (ts->anchor_valid && elapsed > 0 && elapsed <= ts_stale_cycles()) {
+    // Offset moved between anchors at the rate the crystals differ
+    int32_t measured;
+    if (ts_ratio_q32((int32_t)(sample->offset - ts->anchor.offset), elapsed, &measured)) {
+      ts->skew_q32 = ts->skew_valid ? ts->skew_q32 + (measured - ts->skew_q32) / TS_SKEW_GAIN
+                                    : measured;
+      ts->skew_valid = true;
+    }
+  } else {
+    ts->skew_q32 = 0;
+    ts->skew_valid = false;
+  }
+
+  ts->anchor = *sample;
+  ts->anchor_valid = true;
+  ts->stats.updates++;
+  ts->stats.delay_us = hrms_timer_cycles_to_us(sample->rtt / 2);
+}
+
+// Anchor offset carried forward by the skew; signed elapsed fits 32 bits
+static bool ts_offset_at(hrms_timesync_t *ts, uint32_t local, uint32_t *offset) {
+  ts_expire(ts);
+  if (!ts->anchor_valid) {
+    return false;
+  }
+
+  uint32_t stale = ts_stale_cycles();
+
+  int32_t elapsed = (int32_t)(local - ts->anchor.local);
+  uint32_t distance = (elapsed < 0) ? 0U - (uint32_t)elapsed : (uint32_t)elapsed;
+  if (distance > stale) {
+    return false;
+  }
+
+  // 32x32->64 multiply, high word taken - no 64-bit division
+  *offset = ts->anchor.offset + (uint32_t)(int32_t)(((int64_t)ts->skew_q32 * elapsed) >> 32);
+  return true;
+}
+
+// Checked on every exchange too, so an old ts->anchor goes before the counter wraps onto it
+static void ts_expire(hrms_timesync_t *ts) {
+  if (ts->anchor_valid && ts->clock() - ts->anchor.local > ts_stale_cycles()) {
+    ts->anchor_valid = false;
+    ts->skew_valid = false;
+    ts->skew_q32 = 0;
+  }
+}
+
+static uint32_t ts_stale_cycles(void) {
+  return hrms_timer_us_to_cycles(HRMS_TIMESYNC_STALE_MS * 1000U);
+}
+
+// num / den in 2^-32 units, by shift-and-subtract (|num| < den)
+static bool ts_ratio_q32(int32_t num, uint32_t den, int32_t *ratio) {
+  uint32_t rem = (num < 0) ? 0U - (uint32_t)num : (uint32_t)num;
+  if (den == 0 || rem >= den) {
+    return false;
+  }
+
+  uint32_t quotient = 0;
+  for (uint8_t i = 0; i < 32; i++) {
+    bool carry = (rem & 0x80000000U) != 0;
+    rem <<= 1;
+    quotient <<= 1;
+    if (carry || rem >= den) {
+      rem -= den;
+      quotient |= 1;
+    }
+  }
+
+  if (quotient > TS_MAX_SKEW_Q32) {
+    return false;   // Not a crystal - a bad ts->anchor; keep the old skew
+  }
+  *ratio = (num < 0) ? -(int32_t)quotient : (int32_t)quotient;
+  return true;
+}
@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+#include "hrms_tx_sched.h"
+#include "hrms_packet_utils.h"
+#include "hrms_config.h"
+#include "libc_stubs.h"
+
+#if HRMS_TX_BULK_BURST < HRMS_WIRE_MAX_FRAME_SIZE
+#error "HRMS_TX_BULK_BURST must hold at least one full frame"
+#endif
+
+// Tokens are kept in milli-bytes so the refill needs no division
+#define SCHED_TOKEN_SCALE     1000U
+#define SCHED_TOKEN_MAX       ((uint32_t)HRMS_TX_BULK_BURST * SCHED_TOKEN_SCALE)
+#define SCHED_REFILL_CAP_MS   (SCHED_TOKEN_MAX / HRMS_TX_BULK_RATE_BPS + 1)
+
+typedef struct {
+  uint8_t frame[HRMS_WIRE_MAX_FRAME_SIZE];
+  uint8_t len;
+  uint8_t tag;
+} sched_entry_t;
+
+// Ring of entries; depth 1 with replace set is a "latest wins" slot
+typedef struct {
+  sched_entry_t *entries;
+  uint8_t depth;
+  uint8_t head;
+  uint8_t count;
+  bool replace;
+} sched_queue_t;
+
+static sched_entry_t control_entries[1];
+static sched_entry_t ack_entries[HRMS_TX_ACK_DEPTH];
+static sched_entry_t heartbeat_entries[1];
+static sched_entry_t bulk_entries[HRMS_TX_BULK_DEPTH];
+
+// Indexed by hrms_tx_class_t, highest priority first
+static sched_queue_t queues[HRMS_TX_CLASS_COUNT] = {
+  { control_entries,   1,                  0, 0, true  },
+  { ack_entries,       HRMS_TX_ACK_DEPTH,  0, 0, false },
+  { heartbeat_entries, 1,                  0, 0, true  },
+  { bulk_entries,      HRMS_TX_BULK_DEPTH, 0, 0, false },
+};
+
+static uint32_t bulk_tokens = SCHED_TOKEN_MAX;
+static uint32_t bulk_refill_ms = 0;
+static hrms_tx_sched_stats_t sched_stats;
+
+static void sched_refill(uint32_t now_ms);
+
+void hrms_tx_sched_init(uint32_t now_ms) {
+  for (uint8_t i = 0; i < HRMS_TX_CLASS_COUNT; i++) {
+    queues[i].head = 0;
+    queues[i].count = 0;
+  }
+
+  bulk_tokens = SCHED_TOKEN_MAX;
+  bulk_refill_ms = now_ms;
+  memset(&sched_stats, 0, sizeof(sched_stats));
+}
+
+bool hrms_tx_sched_push(hrms_tx_class_t cls, const uint8_t *frame, size_t len, uint8_t tag) {
+  if (cls >= HRMS_TX_CLASS_COUNT || !frame || len == 0 || len > HRMS_WIRE_MAX_FRAME_SIZE) {
+    return false;
+  }
+
+  sched_queue_t *queue = &queues[cls];
+  sched_entry_t *entry;
+
+  if (queue->count < queue->depth) {
+    entry = &queue->entries[(queue->head + queue->count) % queue->depth];
+    queue->count++;
+  } else if (queue->replace) {
+    // Stale position/beacon - overwrite it rather than queue behind it
+    entry = &queue->entries[queue->head];
+    sched_stats.replaced++;
+  } else {
+    sched_stats.dropped++;
+    return false;
+  }
+
+  memcpy(entry->frame, frame, len);
+  entry->len = (uint8_t)len;
+  entry->tag = tag;
+  sched_stats.queued[cls]++;
+
+  return true;
+}
+
+bool hrms_tx_sched_pop(uint32_t now_ms, uint8_t *frame, size_t *len,
+                       hrms_tx_class_t *cls, uint8_t *tag) {
+  if (!frame || !len) {
+    return false;
+  }
+
+  for (uint8_t c = 0; c < HRMS_TX_CLASS_COUNT; c++) {
+    sched_queue_t *queue = &queues[c];
+    if (queue->count == 0) {
+      continue;
+    }
+
+    sched_entry_t *entry = &queue->entries[queue->head];
+
+    if (c == HRMS_TX_CLASS_BULK) {
+      sched_refill(now_ms);
+      uint32_t cost = (uint32_t)entry->len * SCHED_TOKEN_SCALE;
+      if (bulk_tokens < cost) {
+        sched_stats.throttled++;
+        return false;
+      }
+      bulk_tokens -= cost;
+    }
+
+    memcpy(frame, entry->frame, entry->len);
+    *len = entry->len;
+    if (cls) {
+      *cls = (hrms_tx_class_t)c;
+    }
+    if (tag) {
+      *tag = entry->tag;
+    }
+
+    queue->head = (uint8_t)((queue->head + 1) % queue->depth);
+    queue->count--;
+    sched_stats.sent[c]++;
+    return true;
+  }
+
+  return false;
+}
+
+bool hrms_tx_sched_pending(hrms_tx_class_t cls) {
+  return cls < HRMS_TX_CLASS_COUNT && queues[cls].count > 0;
+}
+
+uint32_t hrms_tx_sched_next_ms(uint32_t now_ms, uint32_t max_ms) {
+  for (uint8_t c = 0; c < HRMS_TX_CLASS_BULK; c++) {
+    if (queues[c].count > 0) {
+      return 0;
+    }
+  }
+
+  sched_queue_t *bulk = &queues[HRMS_TX_CLASS_BULK];
+  if (bulk->count == 0) {
+    return max_ms;
+  }
+
+  sched_refill(now_ms);
+  uint32_t cost = (uint32_t)bulk->entries[bulk->head].len * SCHED_TOKEN_SCALE;
+  if (bulk_tokens >= cost) {
+    return 0;
+  }
+
+  uint32_t wait = (cost - bulk_tokens + HRMS_TX_BULK_RATE_BPS - 1) / HRMS_TX_BULK_RATE_BPS;
+  return (wait < max_ms) ? wait : max_ms;
+}
+
+void hrms_tx_sched_get_stats(hrms_tx_sched_stats_t *stats) {
+  if (stats) {
+    memcpy(stats, &sched_stats, sizeof(hrms_tx_sched_stats_t));
+  }
+}
+
+// One millisecond at HRMS_TX_BULK_RATE_BPS is exactly RATE milli-bytes
+static void sched_refill(uint32_t now_ms) {
+  uint32_t elapsed = now_ms - bulk_refill_ms;
+  bulk_refill_ms = now_ms;
+
+  if (elapsed > SCHED_REFILL_CAP_MS) {
+    elapsed = SCHED_REFILL_CAP_MS;
+  }
+
+  bulk_tokens += elapsed * HRMS_TX_BULK_RATE_BPS;
+  if (bulk_tokens > SCHED_TOKEN_MAX) {
+    bulk_tokens = SCHED_TOKEN_MAX;
+  }
+}
@@ -9,7 +9,9 @@
 
 #include "hrms_controller.h"
 #include "FreeRTOS.h"
+#include "hrms_config.h"
 #include "hrms_gpio.h"
+#include "hrms_param.h"
 #include "hrms_pins.h"
 #include "hrms_types.h"
 #include "libc_stubs.h"
@@ -24,6 +26,11 @@ char num_buf[12];
 // Pre-initialized actuator command template for performance
 static hrms_actuator_command_t default_actuator_cmd;
 
+// Last packet heard from the remote peer
+static uint32_t last_remote_tick = 0;
+static bool remote_heard = false;
+static bool remote_error = false;
+
 /* -------------------- Public Controller -------------------- */
 
 void hrms_controller_init(void) {
@@ -63,6 +70,16 @@ void hrms_controller_process(const hrms_sensor_data_t *in,
   // Only update dynamic values
   out->led.blink_speed_ms = 200;
 
+  // Heart while the peer is heard from, star while it reports an error
+  uint32_t now_tick = xTaskGetTickCount();
+  if (remote_heard &&
+      (now_tick - last_remote_tick) < pdMS_TO_TICKS(HRMS_REMOTE_LINK_TIMEOUT_MS)) {
+    out->oled.icon1 = HRMS_OLED_ICON_HEART;
+    if (remote_error) {
+      out->oled.icon2 = HRMS_OLED_ICON_STAR;
+    }
+  }
+
   // Update dynamic OLED text with joystick movement and button state
   // Show X and Y values in smalltext1 and smalltext2
   
@@ -95,7 +112,13 @@ void hrms_controller_process(const hrms_sensor_data_t *in,
        in->joystick.y_axis != last_joystick.y_axis ||
        in->joystick.button_pressed != last_joystick.button_pressed);
 
-  bool time_elapsed = (now - last_transmission_request) > pdMS_TO_TICKS(500);
+  bool time_elapsed = (now - last_transmission_request) >
+                      pdMS_TO_TICKS(hrms_param_get(HRMS_PARAM_TX_INTERVAL_MS));
+
+#if HRMS_JOYSTICK_BATCH
+  // The sensor task streams every sample to the hub in batches
+  joystick_changed = false;
+#endif
 
   if (joystick_changed && time_elapsed) {
     out->comm.should_transmit = true;
@@ -107,6 +130,20 @@ void hrms_controller_process(const hrms_sensor_data_t *in,
   }
 }
 
+void hrms_controller_process_remote(const hrms_remote_event_t *event) {
+  if (!event)
+    return;
+
+  last_remote_tick = event->timestamp;
+  remote_heard = true;
+
+  if (event->type == HRMS_COMM_PACKET_ERROR) {
+    remote_error = true;
+  } else if (event->type == HRMS_COMM_PACKET_STATUS) {
+    remote_error = false;
+  }
+}
+
 void hrms_controller_process_button(const hrms_button_event_t *event,
                                     hrms_actuator_command_t *command) {
   static uint32_t last_press_tick = 0;
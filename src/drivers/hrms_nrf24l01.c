@@ -13,15 +13,88 @@
 #include "hrms_gpio.h"
 #include "hrms_spi.h"
 #include "hrms_delay.h"
+#include "hrms_timer.h"
+#include "hrms_config.h"
+#include "hrms_exti_dispatcher.h"
 #include "libc_stubs.h"
+#include "stm32f1xx.h"
+#if HRMS_NRF24_SPI_TRANSPORT == HRMS_NRF24_SPI_SIM
+#include "hrms_nrf24l01_sim.h"
+#endif
 #include <stdbool.h>
 
+#define NRF24L01_TX_TIMEOUT_MS 10
+#define NRF24L01_CE_PULSE_US 15       // Minimum 10us
+#define NRF24L01_MODE_SETTLE_US 150   // RX -> standby before the next CE pulse
+#define NRF24L01_POWER_UP_US 2000     // Tpd2stby with margin
+#define NRF24L01_RPD_SETTLE_US 170    // Tstby2a + AGC before RPD is valid
+#define NRF24L01_IRQ_FLAGS (NRF24L01_STATUS_RX_DR | NRF24L01_STATUS_TX_DS | NRF24L01_STATUS_MAX_RT)
+
 // Module state
 static bool is_listening = false;
 static nrf24l01_config_t current_config;
+static TaskHandle_t irq_task = NULL;
+#if HRMS_NRF24_SPI_TRANSPORT != HRMS_NRF24_SPI_SIM
+static TaskHandle_t scan_task = NULL;   // Woken by the settle one-shot
+#endif
+
+// Pipelined TX state - tags mirror the hardware TX FIFO order
+static nrf24l01_tx_callback_t tx_callback = NULL;
+static uint8_t tx_tags[NRF24L01_TX_PIPELINE_DEPTH];
+static uint8_t tx_head = 0;
+static uint8_t tx_count = 0;
+static bool tx_ce_active = false;
+
+// Single-payload TX state machine - timer and IRQ interrupts move it along
+static volatile nrf24l01_tx_state_t tx_state = NRF24L01_TX_IDLE;
+static uint32_t tx_state_since = 0;
+static nrf24l01_tx_timing_t tx_timing;
+
+// IRQ edge while listening: the moment a payload landed in the RX FIFO
+static volatile uint32_t rx_irq_stamp = 0;
+static volatile bool rx_irq_stamped = false;
+
+// Radio not ready for a CE pulse until settle_us after settle_since
+static uint32_t settle_since = 0;
+static uint32_t settle_us = 0;
+
+// Shadow of the single-byte writable registers (0x00-0x1D), bit per valid entry
+#define NRF24L01_SHADOW_SIZE (NRF24L01_REG_FEATURE + 1)
+static uint8_t reg_shadow[NRF24L01_SHADOW_SIZE];
+static uint32_t reg_shadow_valid = 0;
+
+static uint8_t nrf24l01_rf_setup_value(nrf24l01_power_t power, nrf24l01_datarate_t datarate);
+static void nrf24l01_load_payload(const uint8_t *data, uint8_t length);
+static void nrf24l01_tx_complete(bool success);
+static void nrf24l01_burst_start(void);
+
+// State machine timing
+static void nrf24l01_tx_enter(nrf24l01_tx_state_t state);
+static void nrf24l01_tx_pulse_start(void);
+static void nrf24l01_tx_pulse_end(void);
+static void nrf24l01_after_us(uint32_t us, hrms_timer_callback_t callback);
+static void nrf24l01_scan_settle(void);
+#if HRMS_NRF24_SPI_TRANSPORT != HRMS_NRF24_SPI_SIM
+static void nrf24l01_scan_wake(void);
+#endif
+static void nrf24l01_settle(uint32_t us);
+static uint32_t nrf24l01_settle_remaining_us(void);
+static uint32_t nrf24l01_timestamp(void);
+static uint32_t nrf24l01_ticks_to_us(uint32_t ticks);
+
+// IRQ pin handling
+static void nrf24l01_irq_init(void);
+#if HRMS_NRF24_SPI_TRANSPORT != HRMS_NRF24_SPI_SIM
+static void nrf24l01_irq_handler(void);
+#endif
+static uint8_t nrf24l01_wait_status(uint8_t mask, uint32_t timeout_ms);
 
 // Low-level SPI functions
+static void nrf24l01_spi_init(void);
+static uint8_t nrf24l01_command(uint8_t cmd, const uint8_t *tx, uint8_t *rx, uint8_t length);
+#if HRMS_NRF24_SPI_TRANSPORT == HRMS_NRF24_SPI_BITBANG
 static uint8_t nrf24l01_spi_transfer(uint8_t data);
+#endif
 static void nrf24l01_cs_low(void);
 static void nrf24l01_cs_high(void);
 static void nrf24l01_ce_low(void);
@@ -29,7 +102,10 @@ static void nrf24l01_ce_high(void);
 
 // Register access functions
 static uint8_t nrf24l01_read_register(uint8_t reg);
+static uint8_t nrf24l01_read_register_chip(uint8_t reg);
 static void nrf24l01_write_register(uint8_t reg, uint8_t value);
+static bool nrf24l01_reg_cacheable(uint8_t reg);
+static void nrf24l01_shadow_sync(void);
 static void nrf24l01_write_register_multi(uint8_t reg, const uint8_t *data, uint8_t length);
 
 bool hrms_nrf24l01_init(void) {
@@ -38,41 +114,46 @@ bool hrms_nrf24l01_init(void) {
   hrms_gpio_config_output((uint32_t)HRMS_NRF24L01_CE_PORT, HRMS_NRF24L01_CE_PIN);
   hrms_gpio_config_input_pullup((uint32_t)HRMS_NRF24L01_IRQ_PORT, HRMS_NRF24L01_IRQ_PIN);
   
-  // Initialize SPI pins for software (bit-bang) SPI
-  hrms_gpio_config_output((uint32_t)HRMS_NRF24L01_SPI_PORT, HRMS_NRF24L01_SCK_PIN);
-  hrms_gpio_config_input((uint32_t)HRMS_NRF24L01_SPI_PORT, HRMS_NRF24L01_MISO_PIN);
-  hrms_gpio_config_output((uint32_t)HRMS_NRF24L01_SPI_PORT, HRMS_NRF24L01_MOSI_PIN);
-  
   // Set initial pin states
   nrf24l01_cs_high();
   nrf24l01_ce_low();
-  hrms_gpio_clear_pin((uint32_t)HRMS_NRF24L01_SPI_PORT, HRMS_NRF24L01_SCK_PIN);   // SCK low
-  hrms_gpio_clear_pin((uint32_t)HRMS_NRF24L01_SPI_PORT, HRMS_NRF24L01_MOSI_PIN);  // MOSI low
+  
+  // Initialize SPI transport (SPI2 + DMA or bit-bang)
+  nrf24l01_spi_init();
+  
+  // IRQ pin (active low) on EXTI10
+  nrf24l01_irq_init();
+  
+#if HRMS_NRF24_SPI_TRANSPORT != HRMS_NRF24_SPI_SIM
+  // One-shot timer for CE pulses and settle waits
+  hrms_timer_init();
+#endif
+  tx_state = NRF24L01_TX_IDLE;
+  memset(&tx_timing, 0, sizeof(tx_timing));
   
   // Wait for module to power up
   hrms_delay_ms(100);
   
   // Reset the module
+  reg_shadow_valid = 0;
   nrf24l01_write_register(NRF24L01_REG_CONFIG, 0x08); // Power down
   hrms_delay_ms(5);
   
   // Check if module is responding by reading a known register
-  uint8_t test_value = nrf24l01_read_register(NRF24L01_REG_CONFIG);
+  uint8_t test_value = nrf24l01_read_register_chip(NRF24L01_REG_CONFIG);
   if (test_value == 0xFF || test_value == 0x00) {
     return false; // Module not responding
   }
   
+  // Start from the chip's actual register state
+  nrf24l01_shadow_sync();
+  
   // Clear interrupt flags
   hrms_nrf24l01_clear_interrupts();
   
   // Flush TX and RX FIFOs
-  nrf24l01_cs_low();
-  nrf24l01_spi_transfer(NRF24L01_CMD_FLUSH_TX);
-  nrf24l01_cs_high();
-  
-  nrf24l01_cs_low();
-  nrf24l01_spi_transfer(NRF24L01_CMD_FLUSH_RX);
-  nrf24l01_cs_high();
+  nrf24l01_command(NRF24L01_CMD_FLUSH_TX, NULL, NULL, 0);
+  nrf24l01_command(NRF24L01_CMD_FLUSH_RX, NULL, NULL, 0);
   
   is_listening = false;
 
@@ -87,29 +168,15 @@ bool hrms_nrf24l01_configure(const nrf24l01_config_t *config) {
   // Store current configuration
   memcpy(&current_config, config, sizeof(nrf24l01_config_t));
   
-  // Power down for configuration
+  // Power down for configuration (takes effect immediately)
   hrms_nrf24l01_power_down();
-  hrms_delay_ms(5);
   
   // Set RF channel
   nrf24l01_write_register(NRF24L01_REG_RF_CH, config->channel);
   
   // Set RF setup (power and data rate)
-  uint8_t rf_setup = 0;
-  switch (config->power) {
-    case NRF24L01_POWER_0DBM:    rf_setup |= 0x06; break;
-    case NRF24L01_POWER_NEG6DBM: rf_setup |= 0x04; break;
-    case NRF24L01_POWER_NEG12DBM: rf_setup |= 0x02; break;
-    case NRF24L01_POWER_NEG18DBM: rf_setup |= 0x00; break;
-  }
-  
-  switch (config->datarate) {
-    case NRF24L01_DATARATE_1MBPS:   rf_setup |= 0x00; break;
-    case NRF24L01_DATARATE_2MBPS:   rf_setup |= 0x08; break;
-    case NRF24L01_DATARATE_250KBPS: rf_setup |= 0x20; break;
-  }
-  
-  nrf24l01_write_register(NRF24L01_REG_RF_SETUP, rf_setup);
+  nrf24l01_write_register(NRF24L01_REG_RF_SETUP,
+                          nrf24l01_rf_setup_value(config->power, config->datarate));
   
   // Set address width (5 bytes)
   nrf24l01_write_register(NRF24L01_REG_SETUP_AW, 0x03);
@@ -122,30 +189,105 @@ bool hrms_nrf24l01_configure(const nrf24l01_config_t *config) {
   nrf24l01_write_register_multi(NRF24L01_REG_RX_ADDR_P0, config->address, NRF24L01_ADDR_WIDTH);
   nrf24l01_write_register_multi(NRF24L01_REG_TX_ADDR, config->address, NRF24L01_ADDR_WIDTH);
   
+  // Extra pipes for a star receiver: P1 is a full address, P2-P5 only its LSByte
+  uint8_t pipes = config->rx_pipes;
+  if (pipes == 0) {
+    pipes = 1;
+  } else if (pipes > NRF24L01_RX_PIPES) {
+    pipes = NRF24L01_RX_PIPES;
+  }
+  current_config.rx_pipes = pipes;
+  uint8_t pipe_mask = (uint8_t)((1 << pipes) - 1);
+  
+  if (pipes > 1) {
+    uint8_t pipe_address[NRF24L01_ADDR_WIDTH];
+    hrms_nrf24l01_pipe_address(config->address, 1, pipe_address);
+    nrf24l01_write_register_multi(NRF24L01_REG_RX_ADDR_P1, pipe_address, NRF24L01_ADDR_WIDTH);
+    for (uint8_t pipe = 2; pipe < pipes; pipe++) {
+      hrms_nrf24l01_pipe_address(config->address, pipe, pipe_address);
+      nrf24l01_write_register(NRF24L01_REG_RX_ADDR_P0 + pipe, pipe_address[0]);
+    }
+  }
+  
   // Set payload sizes
-  nrf24l01_write_register(NRF24L01_REG_RX_PW_P0, NRF24L01_MAX_PAYLOAD_SIZE);
+  for (uint8_t pipe = 0; pipe < pipes; pipe++) {
+    nrf24l01_write_register(NRF24L01_REG_RX_PW_P0 + pipe, NRF24L01_MAX_PAYLOAD_SIZE);
+  }
   
   // Enable auto-acknowledgment
   if (config->auto_ack) {
-    nrf24l01_write_register(NRF24L01_REG_EN_AA, 0x01); // Enable for pipe 0
+    nrf24l01_write_register(NRF24L01_REG_EN_AA, pipe_mask); // Enable for open pipes
   } else {
     nrf24l01_write_register(NRF24L01_REG_EN_AA, 0x00); // Disable
   }
   
-  // Enable RX pipe 0
-  nrf24l01_write_register(NRF24L01_REG_EN_RXADDR, 0x01);
+  // Enable RX pipes
+  nrf24l01_write_register(NRF24L01_REG_EN_RXADDR, pipe_mask);
+  
+  // Dynamic payload length and ack payloads
+  bool ack_payload = config->ack_payload && config->auto_ack;
+  bool dynamic_payload = config->dynamic_payload || ack_payload;
+  current_config.ack_payload = ack_payload;
+  current_config.dynamic_payload = dynamic_payload;
+  
+  uint8_t feature = 0;
+  if (dynamic_payload) {
+    feature |= NRF24L01_FEATURE_EN_DPL;
+  }
+  if (ack_payload) {
+    feature |= NRF24L01_FEATURE_EN_ACK_PAY;
+  }
+  nrf24l01_write_register(NRF24L01_REG_FEATURE, feature);
+  if (feature && nrf24l01_read_register_chip(NRF24L01_REG_FEATURE) != feature) {
+    // Original nRF24L01 ignores FEATURE until ACTIVATE 0x73 is sent
+    uint8_t key = 0x73;
+    nrf24l01_command(NRF24L01_CMD_ACTIVATE, &key, NULL, 1);
+    reg_shadow_valid &= ~(1UL << NRF24L01_REG_FEATURE);
+    nrf24l01_write_register(NRF24L01_REG_FEATURE, feature);
+  }
+  nrf24l01_write_register(NRF24L01_REG_DYNPD, dynamic_payload ? pipe_mask : 0x00);
   
   // Power up
   hrms_nrf24l01_power_up();
   
+#if HRMS_NRF24_SHADOW_VERIFY
+  if (!hrms_nrf24l01_verify_shadow()) {
+    return false;
+  }
+#endif
+  
   return true;
 }
 
 bool hrms_nrf24l01_send(const uint8_t *data, uint8_t length) {
+  if (!hrms_nrf24l01_send_async(data, length)) {
+    return false;
+  }
+  
+  // Sleep on the IRQ while the timer runs the CE pulse and the frame is on air
+  nrf24l01_wait_status(NRF24L01_STATUS_TX_DS | NRF24L01_STATUS_MAX_RT,
+                       NRF24L01_TX_TIMEOUT_MS);
+  
+  bool success = false;
+  if (!hrms_nrf24l01_send_result(&success)) {
+    hrms_nrf24l01_send_abort();
+  }
+  
+  return success;
+}
+
+bool hrms_nrf24l01_send_async(const uint8_t *data, uint8_t length) {
   if (!data || length == 0 || length > NRF24L01_MAX_PAYLOAD_SIZE) {
     return false;
   }
   
+  // The state machine owns the TX flags; it cannot share them with a burst
+  if (tx_count > 0 || tx_state != NRF24L01_TX_IDLE) {
+    return false;
+  }
+  
+  nrf24l01_tx_enter(NRF24L01_TX_LOAD);
+  
   // Switch to TX mode
   hrms_nrf24l01_stop_listening();
   
@@ -153,67 +295,240 @@ bool hrms_nrf24l01_send(const uint8_t *data, uint8_t length) {
   nrf24l01_write_register(NRF24L01_REG_STATUS, NRF24L01_STATUS_TX_DS | NRF24L01_STATUS_MAX_RT);
   
   // Load payload
-  nrf24l01_cs_low();
-  nrf24l01_spi_transfer(NRF24L01_CMD_W_TX_PAYLOAD);
-  for (uint8_t i = 0; i < length; i++) {
-    nrf24l01_spi_transfer(data[i]);
+  nrf24l01_load_payload(data, length);
+  
+  // Pulse CE once power-up / mode change has settled
+  nrf24l01_after_us(nrf24l01_settle_remaining_us(), nrf24l01_tx_pulse_start);
+  
+  return true;
+}
+
+bool hrms_nrf24l01_send_result(bool *success) {
+  if (success) {
+    *success = false;
   }
-  nrf24l01_cs_high();
   
-  // Pulse CE to start transmission
-  nrf24l01_ce_high();
-  hrms_delay_us(15); // Minimum 10us pulse
+  if (tx_state != NRF24L01_TX_WAIT_ACK && tx_state != NRF24L01_TX_DONE) {
+    return false;
+  }
+  
+  uint8_t status = hrms_nrf24l01_get_status();
+  if (!(status & (NRF24L01_STATUS_TX_DS | NRF24L01_STATUS_MAX_RT))) {
+    return false;
+  }
+  
+  // Polling paths get here before the IRQ interrupt marks the send done
+  taskENTER_CRITICAL();
+  if (tx_state == NRF24L01_TX_WAIT_ACK) {
+    nrf24l01_tx_enter(NRF24L01_TX_DONE);
+  }
+  taskEXIT_CRITICAL();
+  
+  // Clear TX interrupt flags only - a pending RX_DR stays for the receiver
+  nrf24l01_write_register(NRF24L01_REG_STATUS, NRF24L01_STATUS_TX_DS | NRF24L01_STATUS_MAX_RT);
+  
+  // MAX_RT leaves the payload in the TX FIFO
+  if (status & NRF24L01_STATUS_MAX_RT) {
+    nrf24l01_command(NRF24L01_CMD_FLUSH_TX, NULL, NULL, 0);
+  }
+  
+  if (success) {
+    *success = (status & NRF24L01_STATUS_TX_DS) != 0;
+  }
+  
+  tx_timing.frames++;
+  nrf24l01_tx_enter(NRF24L01_TX_IDLE);
+  return true;
+}
+
+void hrms_nrf24l01_send_abort(void) {
+  if (tx_state == NRF24L01_TX_IDLE) {
+    return;
+  }
+  
+#if HRMS_NRF24_SPI_TRANSPORT != HRMS_NRF24_SPI_SIM
+  hrms_timer_cancel();
+#endif
   nrf24l01_ce_low();
+  nrf24l01_command(NRF24L01_CMD_FLUSH_TX, NULL, NULL, 0);
+  nrf24l01_write_register(NRF24L01_REG_STATUS, NRF24L01_STATUS_TX_DS | NRF24L01_STATUS_MAX_RT);
   
-  // Wait for transmission to complete (timeout after 10ms)
-  uint32_t timeout = 10000; // 10ms in microseconds
-  uint8_t status;
+  tx_timing.frames++;
+  nrf24l01_tx_enter(NRF24L01_TX_IDLE);
+}
+
+nrf24l01_tx_state_t hrms_nrf24l01_tx_state(void) {
+  return tx_state;
+}
+
+void hrms_nrf24l01_get_tx_timing(nrf24l01_tx_timing_t *timing) {
+  if (!timing) {
+    return;
+  }
   
-  while (timeout > 0) {
-    status = hrms_nrf24l01_get_status();
-    if (status & (NRF24L01_STATUS_TX_DS | NRF24L01_STATUS_MAX_RT)) {
-      break;
+  taskENTER_CRITICAL();
+  memcpy(timing, &tx_timing, sizeof(nrf24l01_tx_timing_t));
+  taskEXIT_CRITICAL();
+}
+
+bool hrms_nrf24l01_take_rx_stamp(uint32_t *cycles) {
+  bool stamped;
+  
+  taskENTER_CRITICAL();
+  stamped = rx_irq_stamped;
+  if (stamped && cycles) {
+    *cycles = rx_irq_stamp;
+  }
+  rx_irq_stamped = false;
+  taskEXIT_CRITICAL();
+  
+  return stamped;
+}
+
+bool hrms_nrf24l01_enqueue(const uint8_t *data, uint8_t length, uint8_t tag) {
+  if (!data || length == 0 || length > NRF24L01_MAX_PAYLOAD_SIZE ||
+      tx_count >= NRF24L01_TX_PIPELINE_DEPTH || tx_state != NRF24L01_TX_IDLE) {
+    return false;
+  }
+  
+  if (is_listening) {
+    hrms_nrf24l01_stop_listening();
+  }
+  
+  nrf24l01_load_payload(data, length);
+  tx_tags[(tx_head + tx_count) % NRF24L01_TX_PIPELINE_DEPTH] = tag;
+  tx_count++;
+  
+  // Holding CE high in PTX sends every FIFO entry back-to-back
+  if (!tx_ce_active) {
+    tx_ce_active = true;
+    nrf24l01_after_us(nrf24l01_settle_remaining_us(), nrf24l01_burst_start);
+  }
+  
+  return true;
+}
+
+// With at most two payloads in flight the flags say exactly how many left
+// the FIFO: TX_DS is cleared on every pass, so a latched TX_DS always
+// belongs to the oldest unretired payload
+void hrms_nrf24l01_process_tx(void) {
+  if (tx_count == 0) {
+    return;
+  }
+  
+  uint8_t status = hrms_nrf24l01_get_status();
+  
+  if (status & NRF24L01_STATUS_MAX_RT) {
+    // The failed payload stalls the FIFO. With two in flight, TX_DS beside
+    // MAX_RT means the first was ACKed and the second failed
+    nrf24l01_ce_low();
+    tx_ce_active = false;
+    uint8_t acked = ((status & NRF24L01_STATUS_TX_DS) && tx_count > 1) ? 1 : 0;
+    nrf24l01_command(NRF24L01_CMD_FLUSH_TX, NULL, NULL, 0);
+    nrf24l01_write_register(NRF24L01_REG_STATUS, NRF24L01_STATUS_TX_DS | NRF24L01_STATUS_MAX_RT);
+    while (acked-- > 0) {
+      nrf24l01_tx_complete(true);
+    }
+    while (tx_count > 0) {
+      nrf24l01_tx_complete(false);
     }
-    hrms_delay_us(10);
-    timeout -= 10;
+    return;
   }
   
-  // Clear interrupt flags
-  nrf24l01_write_register(NRF24L01_REG_STATUS, NRF24L01_STATUS_TX_DS | NRF24L01_STATUS_MAX_RT);
+  if (!(status & NRF24L01_STATUS_TX_DS)) {
+    return;
+  }
   
-  // Check if transmission was successful
-  bool success = (status & NRF24L01_STATUS_TX_DS) != 0;
+  // Clear TX_DS before sampling the FIFO so a later completion raises IRQ again
+  nrf24l01_write_register(NRF24L01_REG_STATUS, NRF24L01_STATUS_TX_DS);
   
-  return success;
+  uint8_t done = 1;
+  if (tx_count > 1 &&
+      (nrf24l01_read_register(NRF24L01_REG_FIFO_STATUS) & NRF24L01_FIFO_TX_EMPTY)) {
+    // The second finished too; its TX_DS may have landed after the clear
+    done = tx_count;
+    nrf24l01_write_register(NRF24L01_REG_STATUS, NRF24L01_STATUS_TX_DS);
+  }
+  
+  while (done-- > 0) {
+    nrf24l01_tx_complete(true);
+  }
+  
+  if (tx_count == 0) {
+    nrf24l01_ce_low();
+    tx_ce_active = false;
+  }
+}
+
+uint8_t hrms_nrf24l01_tx_pending(void) {
+  return tx_count;
+}
+
+void hrms_nrf24l01_set_tx_callback(nrf24l01_tx_callback_t callback) {
+  tx_callback = callback;
+}
+
+bool hrms_nrf24l01_write_ack_payload(uint8_t pipe, const uint8_t *data, uint8_t length) {
+  if (!data || length == 0 || length > NRF24L01_MAX_PAYLOAD_SIZE || pipe > 5 ||
+      !current_config.ack_payload) {
+    return false;
+  }
+  
+  uint8_t status = nrf24l01_command(NRF24L01_CMD_W_ACK_PAYLOAD | pipe, data, NULL, length);
+  return (status & NRF24L01_STATUS_TX_FULL) == 0;
+}
+
+bool hrms_nrf24l01_ack_payload_sent(void) {
+  if (!(hrms_nrf24l01_get_status() & NRF24L01_STATUS_TX_DS)) {
+    return false;
+  }
+  
+  nrf24l01_write_register(NRF24L01_REG_STATUS, NRF24L01_STATUS_TX_DS);
+  return true;
 }
 
 bool hrms_nrf24l01_available(void) {
+  // RX_P_NO reads 111 only when the RX FIFO is empty, so payloads behind
+  // an already-cleared RX_DR are still seen
   uint8_t status = hrms_nrf24l01_get_status();
-  return (status & NRF24L01_STATUS_RX_DR) != 0;
+  return (status & NRF24L01_STATUS_RX_P_NO) != NRF24L01_STATUS_RX_P_NO_EMPTY;
 }
 
 uint8_t hrms_nrf24l01_receive(uint8_t *data, uint8_t max_length) {
+  return hrms_nrf24l01_receive_from(data, max_length, NULL);
+}
+
+uint8_t hrms_nrf24l01_receive_from(uint8_t *data, uint8_t max_length, uint8_t *pipe) {
   if (!data || max_length == 0) {
     return 0;
   }
   
-  if (!hrms_nrf24l01_available()) {
+  // RX_P_NO names the pipe of the payload at the head of the RX FIFO
+  uint8_t rx_p_no = hrms_nrf24l01_get_status() & NRF24L01_STATUS_RX_P_NO;
+  if (rx_p_no == NRF24L01_STATUS_RX_P_NO_EMPTY) {
     return 0;
   }
+  if (pipe) {
+    *pipe = rx_p_no >> 1;
+  }
   
   // Read payload size
   uint8_t payload_size = NRF24L01_MAX_PAYLOAD_SIZE;
+  if (current_config.dynamic_payload) {
+    nrf24l01_command(NRF24L01_CMD_R_RX_PL_WID, NULL, &payload_size, 1);
+    if (payload_size == 0 || payload_size > NRF24L01_MAX_PAYLOAD_SIZE) {
+      // Corrupt width - datasheet requires flushing the RX FIFO
+      nrf24l01_command(NRF24L01_CMD_FLUSH_RX, NULL, NULL, 0);
+      nrf24l01_write_register(NRF24L01_REG_STATUS, NRF24L01_STATUS_RX_DR);
+      return 0;
+    }
+  }
   if (payload_size > max_length) {
     payload_size = max_length;
   }
   
   // Read payload
-  nrf24l01_cs_low();
-  nrf24l01_spi_transfer(NRF24L01_CMD_R_RX_PAYLOAD);
-  for (uint8_t i = 0; i < payload_size; i++) {
-    data[i] = nrf24l01_spi_transfer(NRF24L01_CMD_NOP);
-  }
-  nrf24l01_cs_high();
+  nrf24l01_command(NRF24L01_CMD_R_RX_PAYLOAD, NULL, data, payload_size);
   
   // Clear RX interrupt flag
   nrf24l01_write_register(NRF24L01_REG_STATUS, NRF24L01_STATUS_RX_DR);
@@ -221,6 +536,15 @@ uint8_t hrms_nrf24l01_receive(uint8_t *data, uint8_t max_length) {
   return payload_size;
 }
 
+void hrms_nrf24l01_pipe_address(const uint8_t *base, uint8_t pipe, uint8_t *address) {
+  if (!base || !address) {
+    return;
+  }
+  
+  memcpy(address, base, NRF24L01_ADDR_WIDTH);
+  address[0] = (uint8_t)(base[0] + pipe);
+}
+
 void hrms_nrf24l01_start_listening(void) {
   if (!is_listening) {
     // Set to receive mode
@@ -228,12 +552,9 @@ void hrms_nrf24l01_start_listening(void) {
     config |= NRF24L01_CONFIG_PRIM_RX | NRF24L01_CONFIG_PWR_UP;
     nrf24l01_write_register(NRF24L01_REG_CONFIG, config);
     
-    // Set CE high to enable RX
+    // Set CE high to enable RX - the chip settles (130us) on its own
     nrf24l01_ce_high();
     
-    // Wait for mode change
-    hrms_delay_us(150);
-    
     is_listening = true;
   }
 }
@@ -249,8 +570,8 @@ void hrms_nrf24l01_stop_listening(void) {
     config |= NRF24L01_CONFIG_PWR_UP;
     nrf24l01_write_register(NRF24L01_REG_CONFIG, config);
     
-    // Wait for mode change
-    hrms_delay_us(150);
+    // Next CE pulse waits out the mode change (timer, not the caller)
+    nrf24l01_settle(NRF24L01_MODE_SETTLE_US);
     
     is_listening = false;
   }
@@ -261,10 +582,84 @@ bool hrms_nrf24l01_is_listening(void) {
 }
 
 uint8_t hrms_nrf24l01_get_status(void) {
-  nrf24l01_cs_low();
-  uint8_t status = nrf24l01_spi_transfer(NRF24L01_CMD_NOP);
-  nrf24l01_cs_high();
-  return status;
+  return nrf24l01_command(NRF24L01_CMD_NOP, NULL, NULL, 0);
+}
+
+void hrms_nrf24l01_set_rf(nrf24l01_datarate_t datarate, nrf24l01_power_t power) {
+  current_config.datarate = datarate;
+  current_config.power = power;
+  
+  // RF_SETUP can change in standby or RX; the shadow skips no-op writes
+  nrf24l01_write_register(NRF24L01_REG_RF_SETUP, nrf24l01_rf_setup_value(power, datarate));
+}
+
+void hrms_nrf24l01_set_channel(uint8_t channel) {
+  if (channel > NRF24L01_MAX_CHANNEL) {
+    return;
+  }
+  current_config.channel = channel;
+  
+  // Leave RX while retuning so the synthesizer settles on the new channel
+  if (is_listening) {
+    nrf24l01_ce_low();
+    nrf24l01_write_register(NRF24L01_REG_RF_CH, channel);
+    nrf24l01_ce_high();
+  } else {
+    nrf24l01_write_register(NRF24L01_REG_RF_CH, channel);
+  }
+}
+
+uint8_t hrms_nrf24l01_get_observe_tx(void) {
+  return nrf24l01_read_register(NRF24L01_REG_OBSERVE_TX);
+}
+
+uint32_t hrms_nrf24l01_scan(uint8_t *hits, uint8_t samples) {
+  if (!hits || samples == 0 || tx_count > 0 || tx_state != NRF24L01_TX_IDLE) {
+    return 0;
+  }
+  
+  bool was_listening = is_listening;
+  uint8_t channel = current_config.channel;
+  
+  // RPD is only meaningful in RX once the oscillator is up
+  hrms_delay_us(nrf24l01_settle_remaining_us());
+  hrms_nrf24l01_start_listening();
+  
+  uint32_t start = nrf24l01_timestamp();
+  for (uint8_t ch = 0; ch <= NRF24L01_MAX_CHANNEL; ch++) {
+    // Retune with CE low, then let the synthesizer and AGC settle
+    nrf24l01_ce_low();
+    nrf24l01_write_register(NRF24L01_REG_RF_CH, ch);
+    nrf24l01_ce_high();
+    nrf24l01_scan_settle();
+    
+    // RPD tracks the channel live while in RX - sample it back to back
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < samples; i++) {
+      count += nrf24l01_read_register(NRF24L01_REG_RPD) & NRF24L01_RPD_DETECTED;
+    }
+    hits[ch] = count;
+  }
+  uint32_t elapsed = nrf24l01_ticks_to_us(nrf24l01_timestamp() - start);
+  
+  // Back to where the link was
+  nrf24l01_ce_low();
+  nrf24l01_write_register(NRF24L01_REG_RF_CH, channel);
+  if (was_listening) {
+    nrf24l01_ce_high();
+  } else {
+    hrms_nrf24l01_stop_listening();
+  }
+  
+  return elapsed ? elapsed : 1;
+}
+
+void hrms_nrf24l01_set_irq_task(TaskHandle_t task) {
+  irq_task = task;
+}
+
+uint8_t hrms_nrf24l01_wait_irq(uint32_t timeout_ms) {
+  return nrf24l01_wait_status(NRF24L01_IRQ_FLAGS, timeout_ms) & NRF24L01_IRQ_FLAGS;
 }
 
 void hrms_nrf24l01_clear_interrupts(void) {
@@ -282,12 +677,104 @@ void hrms_nrf24l01_power_down(void) {
 
 void hrms_nrf24l01_power_up(void) {
   uint8_t config = nrf24l01_read_register(NRF24L01_REG_CONFIG);
+  if (config & NRF24L01_CONFIG_PWR_UP) {
+    return; // Already in standby - no write, no oscillator start-up wait
+  }
   config |= NRF24L01_CONFIG_PWR_UP;
   nrf24l01_write_register(NRF24L01_REG_CONFIG, config);
-  hrms_delay_ms(2); // Wait for power up
+  
+  // Oscillator start-up; the first CE pulse is deferred until it is done
+  nrf24l01_settle(NRF24L01_POWER_UP_US);
+}
+
+#if HRMS_NRF24_SPI_TRANSPORT == HRMS_NRF24_SPI_HW_DMA
+
+// Low-level helper functions - Hardware SPI2 with DMA for multi-byte frames
+static void nrf24l01_spi_init(void) {
+  hrms_spi2_init();
+}
+
+static uint8_t nrf24l01_command(uint8_t cmd, const uint8_t *tx, uint8_t *rx, uint8_t length) {
+  // Command byte and data go out as one frame so the payload is a single DMA transfer
+  uint8_t tx_frame[NRF24L01_MAX_PAYLOAD_SIZE + 1];
+  uint8_t rx_frame[NRF24L01_MAX_PAYLOAD_SIZE + 1];
+
+  if (length > NRF24L01_MAX_PAYLOAD_SIZE) {
+    length = NRF24L01_MAX_PAYLOAD_SIZE;
+  }
+
+  tx_frame[0] = cmd;
+  if (tx) {
+    memcpy(&tx_frame[1], tx, length);
+  } else {
+    memset(&tx_frame[1], NRF24L01_CMD_NOP, length);
+  }
+
+  nrf24l01_cs_low();
+  hrms_spi2_transfer_buffer(tx_frame, rx_frame, length + 1);
+  nrf24l01_cs_high();
+
+  if (rx) {
+    memcpy(rx, &rx_frame[1], length);
+  }
+
+  return rx_frame[0]; // STATUS is shifted out with every command byte
+}
+
+static void nrf24l01_cs_low(void) {
+  hrms_gpio_clear_pin((uint32_t)HRMS_NRF24L01_SPI_PORT, HRMS_NRF24L01_NSS_PIN);
+}
+
+static void nrf24l01_cs_high(void) {
+  // SPI2 has drained by the time the transfer returns
+  hrms_gpio_set_pin((uint32_t)HRMS_NRF24L01_SPI_PORT, HRMS_NRF24L01_NSS_PIN);
+}
+
+#elif HRMS_NRF24_SPI_TRANSPORT == HRMS_NRF24_SPI_SIM
+
+// Low-level helper functions - simulated chip, no SPI peripheral involved
+static void nrf24l01_spi_init(void) {
+  // Simulated radios keep their state across driver init, like real ones
+}
+
+static uint8_t nrf24l01_command(uint8_t cmd, const uint8_t *tx, uint8_t *rx, uint8_t length) {
+  nrf24l01_cs_low();
+  uint8_t status = hrms_nrf24_sim_command(HRMS_NRF24_SIM_LOCAL, cmd, tx, rx, length);
+  nrf24l01_cs_high();
+  return status;
+}
+
+static void nrf24l01_cs_low(void) {
+}
+
+static void nrf24l01_cs_high(void) {
 }
 
+#else
+
 // Low-level helper functions - Software SPI implementation (slower and more stable)
+static void nrf24l01_spi_init(void) {
+  hrms_gpio_config_output((uint32_t)HRMS_NRF24L01_SPI_PORT, HRMS_NRF24L01_SCK_PIN);
+  hrms_gpio_config_input((uint32_t)HRMS_NRF24L01_SPI_PORT, HRMS_NRF24L01_MISO_PIN);
+  hrms_gpio_config_output((uint32_t)HRMS_NRF24L01_SPI_PORT, HRMS_NRF24L01_MOSI_PIN);
+
+  hrms_gpio_clear_pin((uint32_t)HRMS_NRF24L01_SPI_PORT, HRMS_NRF24L01_SCK_PIN);   // SCK low
+  hrms_gpio_clear_pin((uint32_t)HRMS_NRF24L01_SPI_PORT, HRMS_NRF24L01_MOSI_PIN);  // MOSI low
+}
+
+static uint8_t nrf24l01_command(uint8_t cmd, const uint8_t *tx, uint8_t *rx, uint8_t length) {
+  nrf24l01_cs_low();
+  uint8_t status = nrf24l01_spi_transfer(cmd);
+  for (uint8_t i = 0; i < length; i++) {
+    uint8_t value = nrf24l01_spi_transfer(tx ? tx[i] : NRF24L01_CMD_NOP);
+    if (rx) {
+      rx[i] = value;
+    }
+  }
+  nrf24l01_cs_high();
+  return status;
+}
+
 static uint8_t nrf24l01_spi_transfer(uint8_t data) {
   uint8_t result = 0;
   
@@ -334,36 +821,336 @@ static void nrf24l01_cs_high(void) {
   hrms_delay_us(5); // CS recovery time
 }
 
+#endif /* HRMS_NRF24_SPI_TRANSPORT */
+
 static void nrf24l01_ce_low(void) {
+#if HRMS_NRF24_SPI_TRANSPORT == HRMS_NRF24_SPI_SIM
+  hrms_nrf24_sim_set_ce(HRMS_NRF24_SIM_LOCAL, false);
+#else
   hrms_gpio_clear_pin((uint32_t)HRMS_NRF24L01_CE_PORT, HRMS_NRF24L01_CE_PIN);
+#endif
 }
 
 static void nrf24l01_ce_high(void) {
+#if HRMS_NRF24_SPI_TRANSPORT == HRMS_NRF24_SPI_SIM
+  hrms_nrf24_sim_set_ce(HRMS_NRF24_SIM_LOCAL, true);
+#else
   hrms_gpio_set_pin((uint32_t)HRMS_NRF24L01_CE_PORT, HRMS_NRF24L01_CE_PIN);
+#endif
+}
+
+static uint8_t nrf24l01_rf_setup_value(nrf24l01_power_t power, nrf24l01_datarate_t datarate) {
+  uint8_t rf_setup = 0;
+  switch (power) {
+    case NRF24L01_POWER_0DBM:    rf_setup |= 0x06; break;
+    case NRF24L01_POWER_NEG6DBM: rf_setup |= 0x04; break;
+    case NRF24L01_POWER_NEG12DBM: rf_setup |= 0x02; break;
+    case NRF24L01_POWER_NEG18DBM: rf_setup |= 0x00; break;
+  }
+  
+  switch (datarate) {
+    case NRF24L01_DATARATE_1MBPS:   rf_setup |= 0x00; break;
+    case NRF24L01_DATARATE_2MBPS:   rf_setup |= 0x08; break;
+    case NRF24L01_DATARATE_250KBPS: rf_setup |= 0x20; break;
+  }
+  
+  return rf_setup;
+}
+
+static void nrf24l01_load_payload(const uint8_t *data, uint8_t length) {
+  // With static widths, zero-pad to the RX_PW_P0 the receiver expects
+  if (current_config.dynamic_payload) {
+    nrf24l01_command(NRF24L01_CMD_W_TX_PAYLOAD, data, NULL, length);
+  } else {
+    uint8_t frame[NRF24L01_MAX_PAYLOAD_SIZE];
+    memcpy(frame, data, length);
+    memset(&frame[length], 0, NRF24L01_MAX_PAYLOAD_SIZE - length);
+    nrf24l01_command(NRF24L01_CMD_W_TX_PAYLOAD, frame, NULL, NRF24L01_MAX_PAYLOAD_SIZE);
+  }
+}
+
+static void nrf24l01_burst_start(void) {
+  // The burst may have been retired while the radio was settling
+  if (tx_ce_active) {
+    nrf24l01_ce_high();
+  }
+}
+
+static void nrf24l01_tx_enter(nrf24l01_tx_state_t state) {
+  uint32_t now = nrf24l01_timestamp();
+  
+  // IDLE is not timed - gaps between sends can exceed the counter range
+  if (tx_state != NRF24L01_TX_IDLE) {
+    tx_timing.time_us[tx_state] += nrf24l01_ticks_to_us(now - tx_state_since);
+  }
+  tx_state_since = now;
+  tx_state = state;
+}
+
+// Task context or TIM2 interrupt
+static void nrf24l01_tx_pulse_start(void) {
+  nrf24l01_tx_enter(NRF24L01_TX_PULSE);
+  nrf24l01_ce_high();
+  nrf24l01_after_us(NRF24L01_CE_PULSE_US, nrf24l01_tx_pulse_end);
+}
+
+// TIM2 interrupt (or task context when the timer is unavailable)
+static void nrf24l01_tx_pulse_end(void) {
+  nrf24l01_ce_low();
+  nrf24l01_tx_enter(NRF24L01_TX_WAIT_ACK);
+}
+
+static void nrf24l01_after_us(uint32_t us, hrms_timer_callback_t callback) {
+#if HRMS_NRF24_SPI_TRANSPORT == HRMS_NRF24_SPI_SIM
+  // Simulated time only moves when the chip is polled
+  (void)us;
+  callback();
+#else
+  // Interrupts stay masked until the scheduler starts - busy wait instead
+  if (us == 0 || us > 0xFFFF || xTaskGetSchedulerState() != taskSCHEDULER_RUNNING ||
+      !hrms_timer_oneshot_us((uint16_t)us, callback)) {
+    hrms_delay_us(us);
+    callback();
+  }
+#endif
+}
+
+// Sleep through the RX/AGC settle of a scanned channel; other tasks get the CPU
+static void nrf24l01_scan_settle(void) {
+#if HRMS_NRF24_SPI_TRANSPORT == HRMS_NRF24_SPI_SIM
+  hrms_delay_us(NRF24L01_RPD_SETTLE_US); // Advances simulated time
+#else
+  // Interrupts stay masked until the scheduler starts - busy wait instead
+  scan_task = xTaskGetCurrentTaskHandle();
+  if (xTaskGetSchedulerState() != taskSCHEDULER_RUNNING ||
+      !hrms_timer_oneshot_us(NRF24L01_RPD_SETTLE_US, nrf24l01_scan_wake)) {
+    hrms_delay_us(NRF24L01_RPD_SETTLE_US);
+    return;
+  }
+  
+  // Other bits (an IRQ edge) end the wait early; STATUS is re-read by their
+  // own waits, so only the scan bit is consumed. Two ticks bound a lost one-shot.
+  uint32_t bits = 0;
+  while (!(bits & HRMS_NRF24L01_NOTIFY_SCAN)) {
+    if (xTaskNotifyWait(0, HRMS_NRF24L01_NOTIFY_SCAN, &bits, 2) != pdTRUE) {
+      hrms_timer_cancel();
+      break;
+    }
+  }
+#endif
+}
+
+#if HRMS_NRF24_SPI_TRANSPORT != HRMS_NRF24_SPI_SIM
+// TIM2 interrupt
+static void nrf24l01_scan_wake(void) {
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+  xTaskNotifyFromISR(scan_task, HRMS_NRF24L01_NOTIFY_SCAN, eSetBits, &xHigherPriorityTaskWoken);
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+#endif
+
+static void nrf24l01_settle(uint32_t us) {
+  // Keep the later of the running and the new deadline
+  if (us > nrf24l01_settle_remaining_us()) {
+    settle_since = nrf24l01_timestamp();
+    settle_us = us;
+  }
+}
+
+static uint32_t nrf24l01_settle_remaining_us(void) {
+  uint32_t elapsed = nrf24l01_ticks_to_us(nrf24l01_timestamp() - settle_since);
+  return (elapsed < settle_us) ? (settle_us - elapsed) : 0;
+}
+
+static uint32_t nrf24l01_timestamp(void) {
+#if HRMS_NRF24_SPI_TRANSPORT == HRMS_NRF24_SPI_SIM
+  return hrms_nrf24_sim_now();
+#else
+  return hrms_timer_cycles();
+#endif
+}
+
+static uint32_t nrf24l01_ticks_to_us(uint32_t ticks) {
+#if HRMS_NRF24_SPI_TRANSPORT == HRMS_NRF24_SPI_SIM
+  return ticks; // Simulator clock is already in microseconds
+#else
+  return hrms_timer_cycles_to_us(ticks);
+#endif
+}
+
+static void nrf24l01_tx_complete(bool success) {
+  uint8_t tag = tx_tags[tx_head];
+  tx_head = (tx_head + 1) % NRF24L01_TX_PIPELINE_DEPTH;
+  tx_count--;
+  
+  if (tx_callback) {
+    tx_callback(tag, success);
+  }
+}
+
+static void nrf24l01_irq_init(void) {
+#if HRMS_NRF24_SPI_TRANSPORT == HRMS_NRF24_SPI_SIM
+  // The simulated IRQ line has no EXTI edge; waits poll STATUS instead
+#else
+  RCC->APB2ENR |= RCC_APB2ENR_AFIOEN;
+
+  // EXTI10 <- GPIOB
+  AFIO->EXTICR[HRMS_NRF24L01_IRQ_PIN / 4] &= ~(0xF << (4 * (HRMS_NRF24L01_IRQ_PIN % 4)));
+  AFIO->EXTICR[HRMS_NRF24L01_IRQ_PIN / 4] |= (0x1 << (4 * (HRMS_NRF24L01_IRQ_PIN % 4)));
+
+  // IRQ is active low
+  EXTI->IMR |= (1 << HRMS_NRF24L01_IRQ_PIN);
+  EXTI->FTSR |= (1 << HRMS_NRF24L01_IRQ_PIN);
+  EXTI->RTSR &= ~(1 << HRMS_NRF24L01_IRQ_PIN);
+
+  hrms_exti_register_callback(HRMS_NRF24L01_IRQ_PIN, nrf24l01_irq_handler);
+
+  // Notifies a task, so must stay below configMAX_SYSCALL_INTERRUPT_PRIORITY
+  NVIC_SetPriority(EXTI15_10_IRQn, 12);
+  NVIC_EnableIRQ(EXTI15_10_IRQn);
+#endif
+}
+
+#if HRMS_NRF24_SPI_TRANSPORT != HRMS_NRF24_SPI_SIM
+static void nrf24l01_irq_handler(void) {
+  // TX_DS/MAX_RT ends the on-air phase; STATUS is read later in task context
+  if (tx_state == NRF24L01_TX_WAIT_ACK) {
+    nrf24l01_tx_enter(NRF24L01_TX_DONE);
+  } else if (is_listening) {
+    // Only RX_DR fires in RX mode - stamp it before the task wakes up
+    rx_irq_stamp = nrf24l01_timestamp();
+    rx_irq_stamped = true;
+  }
+
+  if (irq_task == NULL) {
+    return;
+  }
+
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+  xTaskNotifyFromISR(irq_task, HRMS_NRF24L01_NOTIFY_IRQ, eSetBits, &xHigherPriorityTaskWoken);
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+#endif
+
+static uint8_t nrf24l01_wait_status(uint8_t mask, uint32_t timeout_ms) {
+  uint8_t status = hrms_nrf24l01_get_status();
+
+  // Without a scheduler or from a foreign task nobody gets the notification
+  if (HRMS_NRF24_SPI_TRANSPORT == HRMS_NRF24_SPI_SIM ||
+      irq_task == NULL || xTaskGetSchedulerState() != taskSCHEDULER_RUNNING ||
+      xTaskGetCurrentTaskHandle() != irq_task) {
+    uint32_t timeout_us = timeout_ms * 1000;
+    while (!(status & mask) && timeout_us > 0) {
+      hrms_delay_us(10);
+      timeout_us -= 10;
+      status = hrms_nrf24l01_get_status();
+    }
+    return status;
+  }
+
+  TickType_t start = xTaskGetTickCount();
+  TickType_t timeout = pdMS_TO_TICKS(timeout_ms);
+
+  // STATUS is checked before each wait, so an edge that fired before the
+  // wait (or belongs to another flag) never blocks the caller
+  while (!(status & mask)) {
+    TickType_t elapsed = xTaskGetTickCount() - start;
+    if (elapsed >= timeout) {
+      break;
+    }
+    // Another pending flag already holds IRQ low, so no new edge will come
+    TickType_t wait = (status & NRF24L01_IRQ_FLAGS) ? 1 : (timeout - elapsed);
+    xTaskNotifyWait(0, HRMS_NRF24L01_NOTIFY_IRQ, NULL, wait);
+    status = hrms_nrf24l01_get_status();
+  }
+
+  return status;
 }
 
 static uint8_t nrf24l01_read_register(uint8_t reg) {
-  nrf24l01_cs_low();
-  nrf24l01_spi_transfer(NRF24L01_CMD_R_REGISTER | reg);
-  uint8_t value = nrf24l01_spi_transfer(NRF24L01_CMD_NOP);
-  nrf24l01_cs_high();
+  if (nrf24l01_reg_cacheable(reg) && (reg_shadow_valid & (1UL << reg))) {
+    return reg_shadow[reg];
+  }
+  
+  uint8_t value = nrf24l01_read_register_chip(reg);
+  if (nrf24l01_reg_cacheable(reg)) {
+    reg_shadow[reg] = value;
+    reg_shadow_valid |= (1UL << reg);
+  }
+  return value;
+}
+
+static uint8_t nrf24l01_read_register_chip(uint8_t reg) {
+  uint8_t value = 0;
+  nrf24l01_command(NRF24L01_CMD_R_REGISTER | reg, NULL, &value, 1);
   return value;
 }
 
 static void nrf24l01_write_register(uint8_t reg, uint8_t value) {
-  nrf24l01_cs_low();
-  nrf24l01_spi_transfer(NRF24L01_CMD_W_REGISTER | reg);
-  nrf24l01_spi_transfer(value);
-  nrf24l01_cs_high();
+  if (nrf24l01_reg_cacheable(reg)) {
+    if ((reg_shadow_valid & (1UL << reg)) && reg_shadow[reg] == value) {
+      return; // Chip already holds this value
+    }
+    reg_shadow[reg] = value;
+    reg_shadow_valid |= (1UL << reg);
+  }
+  nrf24l01_command(NRF24L01_CMD_W_REGISTER | reg, &value, NULL, 1);
 }
 
-static void nrf24l01_write_register_multi(uint8_t reg, const uint8_t *data, uint8_t length) {
-  nrf24l01_cs_low();
-  nrf24l01_spi_transfer(NRF24L01_CMD_W_REGISTER | reg);
-  for (uint8_t i = 0; i < length; i++) {
-    nrf24l01_spi_transfer(data[i]);
+static bool nrf24l01_reg_cacheable(uint8_t reg) {
+  switch (reg) {
+    case NRF24L01_REG_CONFIG:
+    case NRF24L01_REG_EN_AA:
+    case NRF24L01_REG_EN_RXADDR:
+    case NRF24L01_REG_SETUP_AW:
+    case NRF24L01_REG_SETUP_RETR:
+    case NRF24L01_REG_RF_CH:
+    case NRF24L01_REG_RF_SETUP:
+    case NRF24L01_REG_RX_ADDR_P2:
+    case NRF24L01_REG_RX_ADDR_P3:
+    case NRF24L01_REG_RX_ADDR_P4:
+    case NRF24L01_REG_RX_ADDR_P5:
+    case NRF24L01_REG_RX_PW_P0:
+    case NRF24L01_REG_RX_PW_P1:
+    case NRF24L01_REG_RX_PW_P2:
+    case NRF24L01_REG_RX_PW_P3:
+    case NRF24L01_REG_RX_PW_P4:
+    case NRF24L01_REG_RX_PW_P5:
+    case NRF24L01_REG_DYNPD:
+    case NRF24L01_REG_FEATURE:
+      return true;
+    default:
+      return false; // STATUS is write-1-to-clear, the rest are read-only or multi-byte
+  }
+}
+
+static void nrf24l01_shadow_sync(void) {
+  reg_shadow_valid = 0;
+  for (uint8_t reg = 0; reg < NRF24L01_SHADOW_SIZE; reg++) {
+    if (nrf24l01_reg_cacheable(reg)) {
+      reg_shadow[reg] = nrf24l01_read_register_chip(reg);
+      reg_shadow_valid |= (1UL << reg);
+    }
   }
-  nrf24l01_cs_high();
+}
+
+bool hrms_nrf24l01_verify_shadow(void) {
+  bool match = true;
+  for (uint8_t reg = 0; reg < NRF24L01_SHADOW_SIZE; reg++) {
+    if (!nrf24l01_reg_cacheable(reg) || !(reg_shadow_valid & (1UL << reg))) {
+      continue;
+    }
+    uint8_t actual = nrf24l01_read_register_chip(reg);
+    if (actual != reg_shadow[reg]) {
+      reg_shadow[reg] = actual;
+      match = false;
+    }
+  }
+  return match;
+}
+
+static void nrf24l01_write_register_multi(uint8_t reg, const uint8_t *data, uint8_t length) {
+  nrf24l01_command(NRF24L01_CMD_W_REGISTER | reg, data, NULL, length);
 }
 
 bool hrms_nrf24l01_self_test(void) {
@@ -376,15 +1163,11 @@ bool hrms_nrf24l01_self_test(void) {
   // Configure pins (already done in init, but ensure they're set)
   hrms_gpio_set_pin((uint32_t)HRMS_NRF24L01_SPI_PORT, HRMS_NRF24L01_NSS_PIN);   // CS high
   hrms_gpio_clear_pin((uint32_t)HRMS_NRF24L01_CE_PORT, HRMS_NRF24L01_CE_PIN);   // CE low
-  hrms_gpio_clear_pin((uint32_t)HRMS_NRF24L01_SPI_PORT, HRMS_NRF24L01_SCK_PIN);  // SCK low
-  hrms_gpio_clear_pin((uint32_t)HRMS_NRF24L01_SPI_PORT, HRMS_NRF24L01_MOSI_PIN); // MOSI low
   
   // Quick basic test: try to communicate with nRF24L01
   hrms_delay_ms(20); // Short power up delay
   
-  nrf24l01_cs_low();
-  uint8_t status = nrf24l01_spi_transfer(NRF24L01_CMD_NOP);
-  nrf24l01_cs_high();
+  uint8_t status = hrms_nrf24l01_get_status();
   
   // Simple test: if we get a reasonable response, radio is working
   bool radio_ok = (status != 0x00 && status != 0xFF);
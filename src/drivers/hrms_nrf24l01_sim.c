@@ -0,0 +1,684 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+#include "hrms_config.h"
+
+#if HRMS_NRF24_SPI_TRANSPORT == HRMS_NRF24_SPI_SIM
+
+#include "hrms_nrf24l01_sim.h"
+#include "hrms_nrf24l01.h"
+#include "libc_stubs.h"
+
+#define SIM_REG_COUNT       0x1E
+#define SIM_PIPES           6
+#define SIM_SETTLE_US       130   // PLL settling before every TX and ACK
+#define SIM_CMD_W_TX_PAYLOAD_NOACK 0xB0
+
+#define SIM_CONFIG_EN_CRC   0x08
+#define SIM_CONFIG_CRCO     0x04
+#define SIM_RF_DR_LOW       0x20
+#define SIM_RF_DR_HIGH      0x08
+#define SIM_IRQ_FLAGS       (NRF24L01_STATUS_RX_DR | NRF24L01_STATUS_TX_DS | NRF24L01_STATUS_MAX_RT)
+
+typedef struct {
+  uint8_t data[NRF24L01_MAX_PAYLOAD_SIZE];
+  uint8_t len;
+  uint8_t pipe;              // RX: pipe received on; PRX TX: ack payload pipe
+  bool no_ack;
+  uint32_t written_us;
+} sim_frame_t;
+
+typedef struct {
+  sim_frame_t items[NRF24L01_TX_FIFO_DEPTH];
+  uint8_t head;
+  uint8_t count;
+} sim_fifo_t;
+
+typedef enum {
+  SIM_IDLE = 0,
+  SIM_TX_AIR,                // Data frame on its way to the receiver
+  SIM_TX_WAIT_ACK            // Waiting for the ACK or the ARD window to end
+} sim_phase_t;
+
+typedef struct {
+  uint8_t regs[SIM_REG_COUNT];
+  uint8_t rx_addr_p0[NRF24L01_ADDR_WIDTH];
+  uint8_t rx_addr_p1[NRF24L01_ADDR_WIDTH];
+  uint8_t tx_addr[NRF24L01_ADDR_WIDTH];
+  uint8_t flags;             // RX_DR | TX_DS | MAX_RT
+  sim_fifo_t rx;
+  sim_fifo_t tx;
+  bool ce;
+
+  // PTX state
+  sim_phase_t phase;
+  uint32_t event_us;
+  uint8_t attempts;
+  uint8_t pid;
+  bool ack_ok;
+  sim_frame_t ack;           // ACK payload carried back (len 0 if none)
+
+  // PRX duplicate detection (PID + payload checksum stands in for CRC)
+  uint8_t last_pid[SIM_PIPES];
+  uint16_t last_sum[SIM_PIPES];
+  bool last_valid[SIM_PIPES];
+} sim_radio_t;
+
+static sim_radio_t radios[HRMS_NRF24_SIM_RADIOS];
+static hrms_nrf24_sim_ether_t ether;
+static hrms_nrf24_sim_stats_t sim_stats;
+static uint16_t channel_loss[NRF24L01_MAX_CHANNEL + 1];
+static uint32_t (*sim_clock)(void) = NULL;
+static uint32_t sim_time_us = 0;
+static uint32_t sim_rand_state = 0;
+static bool sim_ready = false;
+
+static void sim_reset_radio(sim_radio_t *r);
+static uint32_t sim_now(void);
+static void sim_run(uint32_t now);
+static void sim_try_start(sim_radio_t *r, uint32_t now);
+static void sim_end_air(sim_radio_t *r);
+static void sim_end_wait(sim_radio_t *r);
+static bool sim_deliver(sim_radio_t *ptx, const sim_frame_t *frame, bool *acked, sim_frame_t *ack);
+static int sim_match_pipe(const sim_radio_t *prx, const uint8_t *addr);
+static uint8_t sim_status(const sim_radio_t *r);
+static uint8_t sim_fifo_status(const sim_radio_t *r);
+static uint8_t *sim_addr_reg(sim_radio_t *r, uint8_t reg);
+static uint8_t sim_addr_width(const sim_radio_t *r);
+static uint32_t sim_air_time(const sim_radio_t *r, uint8_t len);
+static bool sim_dpl(const sim_radio_t *r, uint8_t pipe);
+static bool sim_lost(uint8_t channel);
+static uint8_t sim_rpd(const sim_radio_t *r);
+static uint32_t sim_random(void);
+static uint16_t sim_checksum(const sim_frame_t *frame);
+static bool sim_fifo_push(sim_fifo_t *fifo, const sim_frame_t *frame);
+static sim_frame_t *sim_fifo_peek(sim_fifo_t *fifo);
+static void sim_fifo_pop(sim_fifo_t *fifo);
+
+void hrms_nrf24_sim_init(const hrms_nrf24_sim_ether_t *medium) {
+  for (uint8_t i = 0; i < HRMS_NRF24_SIM_RADIOS; i++) {
+    sim_reset_radio(&radios[i]);
+  }
+  memset(&sim_stats, 0, sizeof(sim_stats));
+  memset(&ether, 0, sizeof(ether));
+  memset(channel_loss, 0, sizeof(channel_loss));
+  sim_rand_state = 0x2545F491;
+  sim_ready = true;
+
+  if (medium) {
+    hrms_nrf24_sim_set_ether(medium);
+  }
+}
+
+void hrms_nrf24_sim_set_ether(const hrms_nrf24_sim_ether_t *medium) {
+  if (!medium) {
+    return;
+  }
+
+  ether = *medium;
+  if (ether.loss_permille > 1000) {
+    ether.loss_permille = 1000;
+  }
+  sim_rand_state = ether.seed ? ether.seed : 0x2545F491;
+}
+
+void hrms_nrf24_sim_set_channel_loss(uint8_t channel, uint16_t loss_permille) {
+  if (channel > NRF24L01_MAX_CHANNEL) {
+    return;
+  }
+  channel_loss[channel] = (loss_permille > 1000) ? 1000 : loss_permille;
+}
+
+void hrms_nrf24_sim_set_clock(uint32_t (*now_us)(void)) {
+  sim_clock = now_us;
+}
+
+void hrms_nrf24_sim_advance(uint32_t us) {
+  if (!sim_ready) {
+    hrms_nrf24_sim_init(NULL);
+  }
+  sim_time_us += us;
+  sim_run(sim_now());
+}
+
+uint32_t hrms_nrf24_sim_now(void) {
+  return sim_now();
+}
+
+uint8_t hrms_nrf24_sim_command(uint8_t radio, uint8_t cmd, const uint8_t *tx,
+                               uint8_t *rx, uint8_t length) {
+  if (radio >= HRMS_NRF24_SIM_RADIOS) {
+    return 0xFF; // Nothing on the bus
+  }
+  if (!sim_ready) {
+    hrms_nrf24_sim_init(NULL);
+  }
+
+  uint32_t now = sim_now();
+  sim_run(now);
+
+  sim_radio_t *r = &radios[radio];
+  uint8_t status = sim_status(r); // Shifted out before the command executes
+
+  if (rx) {
+    memset(rx, 0, length);
+  }
+
+  if (cmd <= (NRF24L01_CMD_W_REGISTER | 0x1F)) {
+    uint8_t reg = cmd & 0x1F;
+    uint8_t *addr = sim_addr_reg(r, reg);
+    bool write = (cmd & NRF24L01_CMD_W_REGISTER) != 0;
+
+    if (reg >= SIM_REG_COUNT) {
+      // Reserved - reads as zero, writes ignored
+    } else if (!write) {
+      if (addr) {
+        for (uint8_t i = 0; i < length && i < NRF24L01_ADDR_WIDTH && rx; i++) {
+          rx[i] = addr[i];
+        }
+      } else if (rx && length > 0) {
+        switch (reg) {
+          case NRF24L01_REG_STATUS:      rx[0] = sim_status(r);      break;
+          case NRF24L01_REG_FIFO_STATUS: rx[0] = sim_fifo_status(r); break;
+          case NRF24L01_REG_RPD:         rx[0] = sim_rpd(r);         break;
+          default:                       rx[0] = r->regs[reg];       break;
+        }
+      }
+    } else if (tx && length > 0) {
+      if (addr) {
+        for (uint8_t i = 0; i < length && i < NRF24L01_ADDR_WIDTH; i++) {
+          addr[i] = tx[i];
+        }
+      } else {
+        switch (reg) {
+          case NRF24L01_REG_STATUS:
+            r->flags &= ~(tx[0] & SIM_IRQ_FLAGS); // Write 1 to clear
+            break;
+          case NRF24L01_REG_OBSERVE_TX:
+          case NRF24L01_REG_RPD:
+          case NRF24L01_REG_FIFO_STATUS:
+            break;                                // Read-only
+          case NRF24L01_REG_RF_CH:
+            r->regs[reg] = tx[0] & 0x7F;
+            r->regs[NRF24L01_REG_OBSERVE_TX] &= ~NRF24L01_OBSERVE_PLOS_CNT;
+            break;
+          case NRF24L01_REG_CONFIG:
+            r->regs[reg] = tx[0];
+            if (!(tx[0] & NRF24L01_CONFIG_PWR_UP)) {
+              r->phase = SIM_IDLE;                // Power down aborts any TX
+            }
+            break;
+          default:
+            r->regs[reg] = tx[0];
+            break;
+        }
+      }
+    }
+  } else if (cmd == NRF24L01_CMD_R_RX_PAYLOAD) {
+    sim_frame_t *frame = sim_fifo_peek(&r->rx);
+    if (frame) {
+      if (rx) {
+        memcpy(rx, frame->data, length < frame->len ? length : frame->len);
+      }
+      sim_fifo_pop(&r->rx);
+    }
+  } else if (cmd == NRF24L01_CMD_R_RX_PL_WID) {
+    sim_frame_t *frame = sim_fifo_peek(&r->rx);
+    if (rx && length > 0) {
+      rx[0] = frame ? frame->len : 0;
+    }
+  } else if (cmd == NRF24L01_CMD_W_TX_PAYLOAD || cmd == SIM_CMD_W_TX_PAYLOAD_NOACK ||
+             (cmd & 0xF8) == NRF24L01_CMD_W_ACK_PAYLOAD) {
+    if (tx && length > 0 && length <= NRF24L01_MAX_PAYLOAD_SIZE) {
+      sim_frame_t frame;
+      memset(&frame, 0, sizeof(frame));
+      memcpy(frame.data, tx, length);
+      frame.len = length;
+      frame.no_ack = (cmd == SIM_CMD_W_TX_PAYLOAD_NOACK);
+      frame.pipe = ((cmd & 0xF8) == NRF24L01_CMD_W_ACK_PAYLOAD) ? (cmd & 0x07) : 0;
+      frame.written_us = now;
+      sim_fifo_push(&r->tx, &frame);             // Dropped when TX_FULL
+    }
+  } else if (cmd == NRF24L01_CMD_FLUSH_TX) {
+    r->tx.count = 0;
+    r->phase = SIM_IDLE;
+    r->attempts = 0;
+  } else if (cmd == NRF24L01_CMD_FLUSH_RX) {
+    r->rx.count = 0;
+  }
+  // REUSE_TX_PL is not modelled; ACTIVATE is a no-op (nRF24L01+ behaviour)
+
+  sim_try_start(r, now);
+  return status;
+}
+
+void hrms_nrf24_sim_set_ce(uint8_t radio, bool level) {
+  if (radio >= HRMS_NRF24_SIM_RADIOS) {
+    return;
+  }
+  if (!sim_ready) {
+    hrms_nrf24_sim_init(NULL);
+  }
+
+  uint32_t now = sim_now();
+  sim_run(now);
+
+  radios[radio].ce = level;
+  sim_try_start(&radios[radio], now);
+}
+
+bool hrms_nrf24_sim_irq(uint8_t radio) {
+  if (radio >= HRMS_NRF24_SIM_RADIOS) {
+    return false;
+  }
+  if (!sim_ready) {
+    hrms_nrf24_sim_init(NULL);
+  }
+
+  sim_run(sim_now());
+
+  // CONFIG MASK_* bits sit at the same positions as the STATUS flags
+  const sim_radio_t *r = &radios[radio];
+  return (r->flags & ~r->regs[NRF24L01_REG_CONFIG] & SIM_IRQ_FLAGS) != 0;
+}
+
+void hrms_nrf24_sim_get_stats(hrms_nrf24_sim_stats_t *stats) {
+  if (stats) {
+    memcpy(stats, &sim_stats, sizeof(hrms_nrf24_sim_stats_t));
+  }
+}
+
+static void sim_reset_radio(sim_radio_t *r) {
+  memset(r, 0, sizeof(*r));
+
+  // nRF24L01+ power-on values
+  r->regs[NRF24L01_REG_CONFIG] = 0x08;
+  r->regs[NRF24L01_REG_EN_AA] = 0x3F;
+  r->regs[NRF24L01_REG_EN_RXADDR] = 0x03;
+  r->regs[NRF24L01_REG_SETUP_AW] = 0x03;
+  r->regs[NRF24L01_REG_SETUP_RETR] = 0x03;
+  r->regs[NRF24L01_REG_RF_CH] = 0x02;
+  r->regs[NRF24L01_REG_RF_SETUP] = 0x0E;
+  r->regs[NRF24L01_REG_RX_ADDR_P2] = 0xC3;
+  r->regs[NRF24L01_REG_RX_ADDR_P3] = 0xC4;
+  r->regs[NRF24L01_REG_RX_ADDR_P4] = 0xC5;
+  r->regs[NRF24L01_REG_RX_ADDR_P5] = 0xC6;
+  memset(r->rx_addr_p0, 0xE7, NRF24L01_ADDR_WIDTH);
+  memset(r->rx_addr_p1, 0xC2, NRF24L01_ADDR_WIDTH);
+  memset(r->tx_addr, 0xE7, NRF24L01_ADDR_WIDTH);
+}
+
+static uint32_t sim_now(void) {
+  return sim_clock ? sim_clock() : sim_time_us;
+}
+
+// Run every air event due at or before now, in time order
+static void sim_run(uint32_t now) {
+  for (;;) {
+    sim_radio_t *next = NULL;
+    for (uint8_t i = 0; i < HRMS_NRF24_SIM_RADIOS; i++) {
+      sim_radio_t *r = &radios[i];
+      if (r->phase == SIM_IDLE || (int32_t)(r->event_us - now) > 0) {
+        continue;
+      }
+      if (!next || (int32_t)(r->event_us - next->event_us) < 0) {
+        next = r;
+      }
+    }
+    if (!next) {
+      return;
+    }
+
+    if (next->phase == SIM_TX_AIR) {
+      sim_end_air(next);
+    } else {
+      sim_end_wait(next);
+    }
+  }
+}
+
+// PTX with CE high starts on any queued payload (a CE pulse is enough)
+static void sim_try_start(sim_radio_t *r, uint32_t now) {
+  uint8_t config = r->regs[NRF24L01_REG_CONFIG];
+
+  if (r->phase != SIM_IDLE || !r->ce || r->tx.count == 0 ||
+      !(config & NRF24L01_CONFIG_PWR_UP) || (config & NRF24L01_CONFIG_PRIM_RX) ||
+      (r->flags & NRF24L01_STATUS_MAX_RT)) {
+    return;
+  }
+
+  if (r->attempts == 0) {
+    r->pid = (r->pid + 1) & 0x03; // New payload, new PID
+  }
+
+  r->phase = SIM_TX_AIR;
+  r->event_us = now + SIM_SETTLE_US + sim_air_time(r, sim_fifo_peek(&r->tx)->len) + ether.latency_us;
+}
+
+static void sim_end_air(sim_radio_t *r) {
+  uint32_t t = r->event_us;
+  sim_frame_t *frame = sim_fifo_peek(&r->tx);
+
+  sim_stats.frames_on_air++;
+  sim_stats.air_time_us += sim_air_time(r, frame->len);
+
+  bool expect_ack = !frame->no_ack && (r->regs[NRF24L01_REG_EN_AA] & 0x01);
+  bool acked = false;
+  r->ack.len = 0;
+
+  uint8_t channel = r->regs[NRF24L01_REG_RF_CH];
+  if (sim_lost(channel)) {
+    sim_stats.frames_lost++;
+  } else {
+    sim_deliver(r, frame, &acked, &r->ack);
+  }
+
+  if (!expect_ack) {
+    r->ack_ok = true;
+    r->phase = SIM_TX_WAIT_ACK;
+    return; // Completes at the same instant
+  }
+
+  uint32_t ard_us = (((r->regs[NRF24L01_REG_SETUP_RETR] >> 4) & 0x0F) + 1) * 250;
+  uint32_t ack_at = t + SIM_SETTLE_US + sim_air_time(r, r->ack.len) + ether.latency_us;
+
+  r->ack_ok = false;
+  r->event_us = t + ard_us;
+
+  if (acked) {
+    sim_stats.air_time_us += sim_air_time(r, r->ack.len);
+    if (sim_lost(channel)) {
+      sim_stats.acks_lost++;
+    } else if ((int32_t)(ack_at - (t + ard_us)) <= 0) {
+      r->ack_ok = true;  // ARD too short for the ACK payload means a miss
+      r->event_us = ack_at;
+    }
+  }
+
+  r->phase = SIM_TX_WAIT_ACK;
+}
+
+static void sim_end_wait(sim_radio_t *r) {
+  uint32_t t = r->event_us;
+  sim_frame_t *frame = sim_fifo_peek(&r->tx);
+  uint8_t observe = r->regs[NRF24L01_REG_OBSERVE_TX];
+
+  r->phase = SIM_IDLE;
+
+  if (r->ack_ok) {
+    uint32_t latency = t - frame->written_us;
+    sim_stats.delivered++;
+    sim_stats.latency_sum_us += latency;
+    if (latency > sim_stats.latency_max_us) {
+      sim_stats.latency_max_us = latency;
+    }
+
+    r->regs[NRF24L01_REG_OBSERVE_TX] = (observe & NRF24L01_OBSERVE_PLOS_CNT) | r->attempts;
+    r->flags |= NRF24L01_STATUS_TX_DS;
+    sim_fifo_pop(&r->tx);
+    r->attempts = 0;
+
+    // ACK payload lands in the PTX RX FIFO on pipe 0
+    if (r->ack.len > 0 && sim_fifo_push(&r->rx, &r->ack)) {
+      r->flags |= NRF24L01_STATUS_RX_DR;
+    }
+
+    sim_try_start(r, t);
+    return;
+  }
+
+  uint8_t arc = r->regs[NRF24L01_REG_SETUP_RETR] & 0x0F;
+  if (r->attempts < arc) {
+    r->attempts++;
+    r->regs[NRF24L01_REG_OBSERVE_TX] = (observe & NRF24L01_OBSERVE_PLOS_CNT) | r->attempts;
+    r->phase = SIM_TX_AIR;
+    r->event_us = t + SIM_SETTLE_US + sim_air_time(r, frame->len) + ether.latency_us;
+    return;
+  }
+
+  // Out of retransmits - payload stays in the FIFO until flushed
+  uint8_t plos = observe >> 4;
+  if (plos < 0x0F) {
+    plos++;
+  }
+  r->regs[NRF24L01_REG_OBSERVE_TX] = (uint8_t)(plos << 4) | r->attempts;
+  r->flags |= NRF24L01_STATUS_MAX_RT;
+  r->attempts = 0;
+  sim_stats.max_rt++;
+}
+
+// Hand a frame to the first PRX that can hear it; reports whether it ACKs
+static bool sim_deliver(sim_radio_t *ptx, const sim_frame_t *frame, bool *acked, sim_frame_t *ack) {
+  for (uint8_t i = 0; i < HRMS_NRF24_SIM_RADIOS; i++) {
+    sim_radio_t *prx = &radios[i];
+    uint8_t config = prx->regs[NRF24L01_REG_CONFIG];
+
+    if (prx == ptx || !prx->ce || !(config & NRF24L01_CONFIG_PWR_UP) ||
+        !(config & NRF24L01_CONFIG_PRIM_RX) ||
+        prx->regs[NRF24L01_REG_RF_CH] != ptx->regs[NRF24L01_REG_RF_CH] ||
+        (prx->regs[NRF24L01_REG_RF_SETUP] & (SIM_RF_DR_LOW | SIM_RF_DR_HIGH)) !=
+        (ptx->regs[NRF24L01_REG_RF_SETUP] & (SIM_RF_DR_LOW | SIM_RF_DR_HIGH)) ||
+        sim_addr_width(prx) != sim_addr_width(ptx)) {
+      continue;
+    }
+
+    int pipe = sim_match_pipe(prx, ptx->tx_addr);
+    if (pipe < 0) {
+      continue;
+    }
+
+    // Packet control field must agree, otherwise the CRC check fails
+    if (sim_dpl(prx, (uint8_t)pipe) != sim_dpl(ptx, 0)) {
+      return false;
+    }
+    if (!sim_dpl(prx, (uint8_t)pipe) &&
+        frame->len != prx->regs[NRF24L01_REG_RX_PW_P0 + pipe]) {
+      return false;
+    }
+
+    bool send_ack = !frame->no_ack && (prx->regs[NRF24L01_REG_EN_AA] & (1 << pipe));
+    uint16_t sum = sim_checksum(frame);
+    bool duplicate = prx->last_valid[pipe] && prx->last_pid[pipe] == ptx->pid &&
+                     prx->last_sum[pipe] == sum;
+
+    if (!duplicate) {
+      sim_frame_t received = *frame;
+      received.pipe = (uint8_t)pipe;
+      if (!sim_fifo_push(&prx->rx, &received)) {
+        return false; // RX FIFO full - discarded, no ACK
+      }
+      prx->flags |= NRF24L01_STATUS_RX_DR;
+      prx->last_pid[pipe] = ptx->pid;
+      prx->last_sum[pipe] = sum;
+      prx->last_valid[pipe] = true;
+    }
+
+    if (send_ack) {
+      *acked = true;
+
+      // First ack payload queued for this pipe rides on the ACK
+      if ((prx->regs[NRF24L01_REG_FEATURE] & NRF24L01_FEATURE_EN_ACK_PAY) &&
+          sim_dpl(prx, (uint8_t)pipe)) {
+        for (uint8_t n = 0; n < prx->tx.count; n++) {
+          uint8_t idx = (prx->tx.head + n) % NRF24L01_TX_FIFO_DEPTH;
+          if (prx->tx.items[idx].pipe != pipe) {
+            continue;
+          }
+          *ack = prx->tx.items[idx];
+          ack->pipe = 0;
+          // Close the gap so the remaining payloads keep their order
+          for (uint8_t m = n; m + 1 < prx->tx.count; m++) {
+            prx->tx.items[(prx->tx.head + m) % NRF24L01_TX_FIFO_DEPTH] =
+              prx->tx.items[(prx->tx.head + m + 1) % NRF24L01_TX_FIFO_DEPTH];
+          }
+          prx->tx.count--;
+          prx->flags |= NRF24L01_STATUS_TX_DS; // PRX: ACK payload sent
+          break;
+        }
+      }
+    }
+    return true;
+  }
+
+  return false;
+}
+
+static int sim_match_pipe(const sim_radio_t *prx, const uint8_t *addr) {
+  uint8_t aw = sim_addr_width(prx);
+  uint8_t enabled = prx->regs[NRF24L01_REG_EN_RXADDR];
+
+  for (uint8_t pipe = 0; pipe < SIM_PIPES; pipe++) {
+    if (!(enabled & (1 << pipe))) {
+      continue;
+    }
+
+    const uint8_t *base = (pipe == 0) ? prx->rx_addr_p0 : prx->rx_addr_p1;
+    bool match = true;
+    for (uint8_t i = 0; i < aw && match; i++) {
+      // Pipes 2-5 share P1's upper bytes and only own the LSB
+      uint8_t expect = (i == 0 && pipe >= 2) ? prx->regs[NRF24L01_REG_RX_ADDR_P0 + pipe] : base[i];
+      match = (addr[i] == expect);
+    }
+    if (match) {
+      return pipe;
+    }
+  }
+
+  return -1;
+}
+
+static uint8_t sim_status(const sim_radio_t *r) {
+  uint8_t status = r->flags & SIM_IRQ_FLAGS;
+
+  status |= r->rx.count ? (uint8_t)(r->rx.items[r->rx.head].pipe << 1) : NRF24L01_STATUS_RX_P_NO_EMPTY;
+  if (r->tx.count == NRF24L01_TX_FIFO_DEPTH) {
+    status |= NRF24L01_STATUS_TX_FULL;
+  }
+
+  return status;
+}
+
+static uint8_t sim_fifo_status(const sim_radio_t *r) {
+  uint8_t fifo = 0;
+
+  if (r->tx.count == NRF24L01_TX_FIFO_DEPTH) fifo |= NRF24L01_FIFO_TX_FULL;
+  if (r->tx.count == 0)                      fifo |= NRF24L01_FIFO_TX_EMPTY;
+  if (r->rx.count == NRF24L01_TX_FIFO_DEPTH) fifo |= NRF24L01_FIFO_RX_FULL;
+  if (r->rx.count == 0)                      fifo |= NRF24L01_FIFO_RX_EMPTY;
+
+  return fifo;
+}
+
+static uint8_t *sim_addr_reg(sim_radio_t *r, uint8_t reg) {
+  switch (reg) {
+    case NRF24L01_REG_RX_ADDR_P0: return r->rx_addr_p0;
+    case NRF24L01_REG_RX_ADDR_P1: return r->rx_addr_p1;
+    case NRF24L01_REG_TX_ADDR:    return r->tx_addr;
+    default:                      return NULL;
+  }
+}
+
+static uint8_t sim_addr_width(const sim_radio_t *r) {
+  uint8_t aw = r->regs[NRF24L01_REG_SETUP_AW] & 0x03;
+  return aw ? (uint8_t)(aw + 2) : NRF24L01_ADDR_WIDTH;
+}
+
+// Preamble + address + 9-bit packet control + payload + CRC
+static uint32_t sim_air_time(const sim_radio_t *r, uint8_t len) {
+  uint8_t config = r->regs[NRF24L01_REG_CONFIG];
+  uint8_t rf_setup = r->regs[NRF24L01_REG_RF_SETUP];
+  uint32_t crc = (config & SIM_CONFIG_EN_CRC) ? ((config & SIM_CONFIG_CRCO) ? 2 : 1) : 0;
+  uint32_t bits = 8 + 8 * sim_addr_width(r) + 9 + 8 * len + 8 * crc;
+
+  if (rf_setup & SIM_RF_DR_LOW) {
+    return bits * 4;            // 250 kbps
+  }
+  if (rf_setup & SIM_RF_DR_HIGH) {
+    return (bits + 1) / 2;      // 2 Mbps
+  }
+  return bits;                  // 1 Mbps
+}
+
+static bool sim_dpl(const sim_radio_t *r, uint8_t pipe) {
+  return (r->regs[NRF24L01_REG_FEATURE] & NRF24L01_FEATURE_EN_DPL) &&
+         (r->regs[NRF24L01_REG_DYNPD] & (1 << pipe));
+}
+
+static bool sim_lost(uint8_t channel) {
+  uint32_t loss = ether.loss_permille;
+  if (channel <= NRF24L01_MAX_CHANNEL) {
+    loss += channel_loss[channel];
+  }
+  if (loss == 0) {
+    return false;
+  }
+
+  return (sim_random() % 1000) < loss;
+}
+
+// Carrier from another radio on air on this channel, or from the
+// interferer behind the channel's loss (busy that share of the time)
+static uint8_t sim_rpd(const sim_radio_t *r) {
+  uint8_t channel = r->regs[NRF24L01_REG_RF_CH];
+  if (!r->ce || !(r->regs[NRF24L01_REG_CONFIG] & NRF24L01_CONFIG_PRIM_RX) ||
+      channel > NRF24L01_MAX_CHANNEL) {
+    return 0;
+  }
+
+  for (uint8_t i = 0; i < HRMS_NRF24_SIM_RADIOS; i++) {
+    const sim_radio_t *other = &radios[i];
+    if (other != r && other->phase == SIM_TX_AIR &&
+        other->regs[NRF24L01_REG_RF_CH] == channel) {
+      return NRF24L01_RPD_DETECTED;
+    }
+  }
+
+  if (channel_loss[channel] && (sim_random() % 1000) < channel_loss[channel]) {
+    return NRF24L01_RPD_DETECTED;
+  }
+  return 0;
+}
+
+// xorshift32 - reproducible loss pattern for a given seed
+static uint32_t sim_random(void) {
+  sim_rand_state ^= sim_rand_state << 13;
+  sim_rand_state ^= sim_rand_state >> 17;
+  sim_rand_state ^= sim_rand_state << 5;
+  return sim_rand_state;
+}
+
+static uint16_t sim_checksum(const sim_frame_t *frame) {
+  uint16_t sum = frame->len;
+  for (uint8_t i = 0; i < frame->len; i++) {
+    sum = (uint16_t)((sum << 1) | (sum >> 15)) ^ frame->data[i];
+  }
+  return sum;
+}
+
+static bool sim_fifo_push(sim_fifo_t *fifo, const sim_frame_t *frame) {
+  if (fifo->count == NRF24L01_TX_FIFO_DEPTH) {
+    return false;
+  }
+  fifo->items[(fifo->head + fifo->count) % NRF24L01_TX_FIFO_DEPTH] = *frame;
+  fifo->count++;
+  return true;
+}
+
+static sim_frame_t *sim_fifo_peek(sim_fifo_t *fifo) {
+  return fifo->count ? &fifo->items[fifo->head] : NULL;
+}
+
+static void sim_fifo_pop(sim_fifo_t *fifo) {
+  if (fifo->count) {
+    fifo->head = (fifo->head + 1) % NRF24L01_TX_FIFO_DEPTH;
+    fifo->count--;
+  }
+}
+
+#endif /* HRMS_NRF24_SPI_TRANSPORT == HRMS_NRF24_SPI_SIM */
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+#include "hrms_timer.h"
+#include "stm32f1xx.h"
+#include <stddef.h>
+
+static volatile hrms_timer_callback_t oneshot_callback = NULL;
+
+int hrms_timer_init(void) {
+  RCC->APB1ENR |= RCC_APB1ENR_TIM2EN;
+
+  // APB1 runs at HCLK/2, so the timer clock is doubled back to HCLK
+  TIM2->CR1 = TIM_CR1_OPM | TIM_CR1_URS;   // Stop after one update, only overflow raises UIF
+  TIM2->PSC = (SystemCoreClock / 1000000U) - 1U;
+  TIM2->ARR = 0xFFFF;
+  TIM2->EGR = TIM_EGR_UG;                   // Load PSC now
+  TIM2->SR = 0;
+  TIM2->DIER = TIM_DIER_UIE;
+
+  // Callbacks may notify tasks, so stay below configMAX_SYSCALL_INTERRUPT_PRIORITY
+  NVIC_SetPriority(TIM2_IRQn, 12);
+  NVIC_EnableIRQ(TIM2_IRQn);
+
+  return 0;
+}
+
+bool hrms_timer_oneshot_us(uint16_t us, hrms_timer_callback_t callback) {
+  if (us == 0 || !callback || (TIM2->CR1 & TIM_CR1_CEN)) {
+    return false;
+  }
+
+  oneshot_callback = callback;
+  TIM2->CNT = 0;
+  TIM2->ARR = us;                           // Fires after us+1 ticks - never early
+  TIM2->CR1 |= TIM_CR1_CEN;
+
+  return true;
+}
+
+void hrms_timer_cancel(void) {
+  TIM2->CR1 &= ~TIM_CR1_CEN;
+  TIM2->SR = 0;
+  oneshot_callback = NULL;
+}
+
+uint32_t hrms_timer_cycles(void) {
+  return DWT->CYCCNT;
+}
+
+uint32_t hrms_timer_cycles_to_us(uint32_t cycles) {
+  return cycles / (SystemCoreClock / 1000000U);
+}
+
+uint32_t hrms_timer_us_to_cycles(uint32_t us) {
+  return us * (SystemCoreClock / 1000000U);
+}
+
+void TIM2_IRQHandler(void) {
+  if (TIM2->SR & TIM_SR_UIF) {
+    TIM2->SR = ~TIM_SR_UIF;
+
+    hrms_timer_callback_t callback = oneshot_callback;
+    oneshot_callback = NULL;
+    if (callback) {
+      callback();
+    }
+  }
+}
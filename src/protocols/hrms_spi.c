@@ -11,6 +11,9 @@
 #include "hrms_gpio.h"
 #include "hrms_delay.h"
 #include "hrms_pins.h"
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "task.h"
 #include <stdbool.h>
 
 // SPI Configuration
@@ -204,3 +207,165 @@ void hrms_spi1_deinit(void) {
     
     spi_initialized = false;
 }
+
+// SPI2 / DMA state
+static bool spi2_initialized = false;
+static SemaphoreHandle_t spi2_dma_done = NULL;
+static uint8_t spi2_dummy_tx = 0xFF;
+static uint8_t spi2_dummy_rx;
+
+/**
+ * Wait for an SPI2 status flag with a bounded spin
+ */
+static int hrms_spi2_wait_flag(uint32_t flag) {
+    volatile uint32_t timeout = SPI_TIMEOUT_MS * 1000;
+    while (!(SPI2->SR & flag)) {
+        if (--timeout == 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Initialize SPI2 peripheral and DMA channels
+ */
+int hrms_spi2_init(void) {
+    if (spi2_initialized) {
+        return 0;
+    }
+
+    // Enable GPIOB, SPI2 and DMA1 clocks
+    RCC->APB2ENR |= RCC_APB2ENR_IOPBEN;
+    RCC->APB1ENR |= RCC_APB1ENR_SPI2EN;
+    RCC->AHBENR |= RCC_AHBENR_DMA1EN;
+
+    // SCK and MOSI - Alternate function push-pull, MISO - Input floating
+    hrms_gpio_config_alternate_pushpull((uint32_t)HRMS_NRF24L01_SPI_PORT, HRMS_NRF24L01_SCK_PIN);
+    hrms_gpio_config_alternate_pushpull((uint32_t)HRMS_NRF24L01_SPI_PORT, HRMS_NRF24L01_MOSI_PIN);
+    hrms_gpio_config_input((uint32_t)HRMS_NRF24L01_SPI_PORT, HRMS_NRF24L01_MISO_PIN);
+
+    // Configure SPI2: master, Mode 0, software NSS
+    SPI2->CR1 = 0;
+    SPI2->CR1 |= SPI_CR1_MSTR;
+    SPI2->CR1 |= SPI_CR1_BR_0;        // Baudrate = fPCLK1/4 (36MHz/4 = 9MHz, nRF24 max is 10MHz)
+    SPI2->CR1 |= SPI_CR1_SSM;
+    SPI2->CR1 |= SPI_CR1_SSI;
+    SPI2->CR2 = 0;
+
+    // DMA1 peripheral addresses never change
+    DMA1_Channel4->CCR = 0;
+    DMA1_Channel4->CPAR = (uint32_t)&SPI2->DR;
+    DMA1_Channel5->CCR = 0;
+    DMA1_Channel5->CPAR = (uint32_t)&SPI2->DR;
+
+    if (spi2_dma_done == NULL) {
+        spi2_dma_done = xSemaphoreCreateBinary();
+        if (spi2_dma_done == NULL) {
+            return -1;
+        }
+    }
+
+    // RX complete interrupt must stay below configMAX_SYSCALL_INTERRUPT_PRIORITY
+    NVIC_SetPriority(DMA1_Channel4_IRQn, 12);
+    NVIC_EnableIRQ(DMA1_Channel4_IRQn);
+
+    SPI2->CR1 |= SPI_CR1_SPE;
+
+    spi2_initialized = true;
+    return 0;
+}
+
+/**
+ * Send and receive a byte via SPI2
+ */
+uint8_t hrms_spi2_transfer(uint8_t data) {
+    if (!spi2_initialized) {
+        return 0xFF;
+    }
+
+    if (hrms_spi2_wait_flag(SPI_SR_TXE)) return 0xFF;
+    SPI2->DR = data;
+
+    if (hrms_spi2_wait_flag(SPI_SR_RXNE)) return 0xFF;
+    return (uint8_t)SPI2->DR;
+}
+
+/**
+ * Full-duplex multi-byte transfer via SPI2
+ */
+int hrms_spi2_transfer_buffer(const uint8_t *tx_data, uint8_t *rx_data, size_t len) {
+    if (!spi2_initialized || len == 0) {
+        return -1;
+    }
+
+    if (len < HRMS_SPI2_DMA_MIN_LEN) {
+        for (size_t i = 0; i < len; i++) {
+            uint8_t rx = hrms_spi2_transfer(tx_data ? tx_data[i] : 0xFF);
+            if (rx_data) {
+                rx_data[i] = rx;
+            }
+        }
+        return 0;
+    }
+
+    // Block on the semaphore only when there is a scheduler to switch to;
+    // FreeRTOS keeps interrupts masked until vTaskStartScheduler()
+    bool use_irq = (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING);
+    if (use_irq) {
+        xSemaphoreTake(spi2_dma_done, 0); // Drop a stale give from a timed-out transfer
+    }
+
+    DMA1->IFCR = DMA_IFCR_CGIF4 | DMA_IFCR_CGIF5;
+
+    // RX channel: peripheral -> memory
+    DMA1_Channel4->CMAR = rx_data ? (uint32_t)rx_data : (uint32_t)&spi2_dummy_rx;
+    DMA1_Channel4->CNDTR = len;
+    DMA1_Channel4->CCR = DMA_CCR_PL_1 | (rx_data ? DMA_CCR_MINC : 0) |
+                         (use_irq ? DMA_CCR_TCIE : 0) | DMA_CCR_EN;
+
+    // TX channel: memory -> peripheral
+    DMA1_Channel5->CMAR = tx_data ? (uint32_t)tx_data : (uint32_t)&spi2_dummy_tx;
+    DMA1_Channel5->CNDTR = len;
+    DMA1_Channel5->CCR = DMA_CCR_DIR | (tx_data ? DMA_CCR_MINC : 0) | DMA_CCR_EN;
+
+    // Enable RX request first so the first received byte is never missed
+    SPI2->CR2 |= SPI_CR2_RXDMAEN;
+    SPI2->CR2 |= SPI_CR2_TXDMAEN;
+
+    int result = 0;
+    if (use_irq) {
+        if (xSemaphoreTake(spi2_dma_done, pdMS_TO_TICKS(SPI_TIMEOUT_MS)) != pdTRUE) {
+            result = -1;
+        }
+    } else {
+        volatile uint32_t timeout = SPI_TIMEOUT_MS * 1000;
+        while (!(DMA1->ISR & DMA_ISR_TCIF4)) {
+            if (--timeout == 0) {
+                result = -1;
+                break;
+            }
+        }
+    }
+
+    SPI2->CR2 &= ~(SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN);
+    DMA1_Channel4->CCR = 0;
+    DMA1_Channel5->CCR = 0;
+    DMA1->IFCR = DMA_IFCR_CGIF4 | DMA_IFCR_CGIF5;
+
+    return result;
+}
+
+/**
+ * SPI2 RX DMA complete - every byte of the frame has been clocked
+ */
+void DMA1_Channel4_IRQHandler(void) {
+    if (DMA1->ISR & DMA_ISR_TCIF4) {
+        DMA1->IFCR = DMA_IFCR_CTCIF4;
+        DMA1_Channel4->CCR &= ~DMA_CCR_TCIE;
+
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+        xSemaphoreGiveFromISR(spi2_dma_done, &xHigherPriorityTaskWoken);
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    }
+}
@@ -38,3 +38,23 @@ void hrms_uart_send_u32(uint32_t val) {
   hrms_uart_send_u8(val & 0xFF);
 }
 
+void hrms_uart_send_str(const char *str) {
+  while (*str) {
+    hrms_uart_send_u8((uint8_t)*str++);
+  }
+}
+
+void hrms_uart_send_dec(uint32_t val) {
+  char digits[10];
+  int n = 0;
+
+  do {
+    digits[n++] = (char)('0' + val % 10);
+    val /= 10;
+  } while (val);
+
+  while (n > 0) {
+    hrms_uart_send_u8((uint8_t)digits[--n]);
+  }
+}
+
@@ -12,11 +12,11 @@
 #include "hrms_pins.h"
 #include "hrms_gpio.h"
 #include "hrms_adc.h"
+#include "hrms_param.h"
 #include "libc_stubs.h"
 
 // Calibration values - adjust based on your joystick
 #define JOYSTICK_CENTER_VALUE 2048  // ADC center value (12-bit ADC: 0-4095)
-#define JOYSTICK_DEADZONE 600       // Very large deadzone to prevent servo shaking
 #define JOYSTICK_MAX_VALUE 4095     // Maximum ADC value
 #define JOYSTICK_UPDATE_THRESHOLD 100  // Only update if change is significant
 
@@ -49,17 +49,18 @@ bool hrms_joystick_read(hrms_joystick_data_t *data) {
   int16_t x_centered = (int16_t)vrx_raw - JOYSTICK_CENTER_VALUE;
   int16_t y_centered = (int16_t)vry_raw - JOYSTICK_CENTER_VALUE;
   
-  // Apply deadzone
-  if (x_centered > -JOYSTICK_DEADZONE && x_centered < JOYSTICK_DEADZONE) {
+  // Apply deadzone (tunable at runtime, see hrms_param.h)
+  int16_t deadzone = (int16_t)hrms_param_get(HRMS_PARAM_JOYSTICK_DEADZONE);
+  if (x_centered > -deadzone && x_centered < deadzone) {
     x_centered = 0;
   }
-  if (y_centered > -JOYSTICK_DEADZONE && y_centered < JOYSTICK_DEADZONE) {
+  if (y_centered > -deadzone && y_centered < deadzone) {
     y_centered = 0;
   }
   
   // Scale to -1000 to +1000 range
-  int16_t new_x = (x_centered * 1000) / (JOYSTICK_CENTER_VALUE - JOYSTICK_DEADZONE);
-  int16_t new_y = (y_centered * 1000) / (JOYSTICK_CENTER_VALUE - JOYSTICK_DEADZONE);
+  int16_t new_x = (x_centered * 1000) / (JOYSTICK_CENTER_VALUE - deadzone);
+  int16_t new_y = (y_centered * 1000) / (JOYSTICK_CENTER_VALUE - deadzone);
   
   // Clamp values
   if (new_x > 1000) new_x = 1000;
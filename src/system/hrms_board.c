@@ -15,6 +15,10 @@
 #include "hrms_uart.h"
 #include "hrms_adc.h"
 #include "hrms_delay.h"
+#include "hrms_crc.h"
+#include "hrms_pins.h"
+
+#define BOARD_UID_SIZE  12
 
 void hrms_board_init(void) {
   hrms_clock_init();    // System clocks
@@ -24,6 +28,7 @@ void hrms_board_init(void) {
   hrms_uart_init();
   hrms_i2c1_init();
   hrms_adc_init();
+  hrms_crc_init();
 
   // Enable cycle counter
   CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
@@ -32,3 +37,30 @@ void hrms_board_init(void) {
 
   hrms_delay_init();
 }
+
+void hrms_board_seed(uint8_t *out, size_t len) {
+  if (!out) {
+    return;
+  }
+
+  // This chip: two boards flashed with the same link key never share a seed
+  const uint8_t *uid = (const uint8_t *)UID_BASE;
+  for (size_t i = 0; i < len; i++) {
+    out[i] = (i < BOARD_UID_SIZE) ? uid[i] : 0;
+  }
+
+  // This boot: start-up time varies with the peripherals, and the low bit
+  // of a conversion on the joystick inputs is noise
+  uint32_t cycles = DWT->CYCCNT;
+  for (size_t i = 0; i < len; i++) {
+    uint8_t noise = (uint8_t)(cycles >> (8 * (i % 4)));
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      uint16_t x = 0;
+      uint16_t y = 0;
+      hrms_adc_read(HRMS_JOYSTICK_VRX_ADC_CHANNEL, &x);
+      hrms_adc_read(HRMS_JOYSTICK_VRY_ADC_CHANNEL, &y);
+      noise ^= (uint8_t)(((x ^ y) & 1U) << bit);
+    }
+    out[i] ^= noise;
+  }
+}
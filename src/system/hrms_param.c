@@ -0,0 +1,198 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+#include "hrms_param.h"
+#include "hrms_nrf24l01.h"
+#include "hrms_config.h"
+#include "libc_stubs.h"
+
+// Batched frames carry the sample period in one byte
+#if HRMS_JOYSTICK_BATCH
+#define PARAM_SAMPLE_DEFAULT_MS   (1000 / HRMS_JOYSTICK_SAMPLE_HZ)
+#define PARAM_SAMPLE_MAX_MS       255
+#else
+#define PARAM_SAMPLE_DEFAULT_MS   HRMS_SENSOR_READ_INTERVAL_MS
+#define PARAM_SAMPLE_MAX_MS       1000
+#endif
+
+typedef struct {
+  hrms_param_type_t type;
+  uint32_t min;
+  uint32_t max;
+  uint32_t def;
+} param_desc_t;
+
+// Indexed by hrms_param_id_t
+static const param_desc_t param_table[HRMS_PARAM_COUNT] = {
+  [HRMS_PARAM_JOYSTICK_DEADZONE]  = { HRMS_PARAM_U16, 0, 1500, HRMS_JOYSTICK_DEADZONE },
+  [HRMS_PARAM_TX_INTERVAL_MS]     = { HRMS_PARAM_U16, 0, 10000, HRMS_COMM_TX_INTERVAL_MS },
+  [HRMS_PARAM_RADIO_CHANNEL]      = { HRMS_PARAM_U8, 0, NRF24L01_MAX_CHANNEL, HRMS_NRF24_CHANNEL },
+  [HRMS_PARAM_SAMPLE_INTERVAL_MS] = { HRMS_PARAM_U16, 1, PARAM_SAMPLE_MAX_MS, PARAM_SAMPLE_DEFAULT_MS },
+};
+
+static volatile uint32_t param_values[HRMS_PARAM_COUNT];
+static hrms_param_hook_t param_hooks[HRMS_PARAM_COUNT];
+
+static size_t param_put_tlv(uint8_t id, bool error, uint8_t *buf, size_t max_len);
+
+void hrms_param_init(void) {
+  for (uint8_t i = 0; i < HRMS_PARAM_COUNT; i++) {
+    param_values[i] = param_table[i].def;
+    param_hooks[i] = NULL;
+  }
+}
+
+uint32_t hrms_param_get(hrms_param_id_t id) {
+  if ((uint32_t)id >= HRMS_PARAM_COUNT) {
+    return 0;
+  }
+  return param_values[id];
+}
+
+bool hrms_param_set(hrms_param_id_t id, uint32_t value) {
+  if ((uint32_t)id >= HRMS_PARAM_COUNT ||
+      value < param_table[id].min || value > param_table[id].max) {
+    return false;
+  }
+
+  if (param_hooks[id] && !param_hooks[id](value)) {
+    return false;
+  }
+
+  param_values[id] = value;
+  return true;
+}
+
+void hrms_param_update(hrms_param_id_t id, uint32_t value) {
+  if ((uint32_t)id < HRMS_PARAM_COUNT) {
+    param_values[id] = value;
+  }
+}
+
+void hrms_param_set_hook(hrms_param_id_t id, hrms_param_hook_t hook) {
+  if ((uint32_t)id < HRMS_PARAM_COUNT) {
+    param_hooks[id] = hook;
+  }
+}
+
+size_t hrms_param_handle(const uint8_t *request, size_t len, uint8_t *reply, size_t max_len) {
+  if (!request || !reply || len < HRMS_PARAM_HEADER_SIZE || max_len < HRMS_PARAM_HEADER_SIZE ||
+      (request[0] != HRMS_PARAM_OP_GET && request[0] != HRMS_PARAM_OP_SET)) {
+    return 0;
+  }
+
+  reply[0] = HRMS_PARAM_OP_REPLY;
+  reply[1] = request[1];
+  size_t out = HRMS_PARAM_HEADER_SIZE;
+
+  // Bare GET: list everything that fits
+  if (request[0] == HRMS_PARAM_OP_GET && len == HRMS_PARAM_HEADER_SIZE) {
+    for (uint8_t id = 0; id < HRMS_PARAM_COUNT; id++) {
+      size_t n = param_put_tlv(id, false, &reply[out], max_len - out);
+      if (n == 0) {
+        break;
+      }
+      out += n;
+    }
+    return out;
+  }
+
+  size_t offset = HRMS_PARAM_HEADER_SIZE;
+  hrms_param_tlv_t tlv;
+  while (hrms_param_next_tlv(request, len, &offset, &tlv)) {
+    bool error = tlv.error || tlv.id >= HRMS_PARAM_COUNT;
+
+    if (!error && request[0] == HRMS_PARAM_OP_SET) {
+      error = tlv.len != (uint8_t)param_table[tlv.id].type ||
+              !hrms_param_set((hrms_param_id_t)tlv.id, tlv.value);
+    }
+
+    size_t n = param_put_tlv(tlv.id, error, &reply[out], max_len - out);
+    if (n == 0) {
+      break;
+    }
+    out += n;
+  }
+
+  return out;
+}
+
+size_t hrms_param_make_request(uint8_t op, uint8_t seq, const hrms_param_id_t *ids,
+                               const uint32_t *values, uint8_t count,
+                               uint8_t *buf, size_t max_len) {
+  if (!buf || max_len < HRMS_PARAM_HEADER_SIZE || (count > 0 && !ids) ||
+      (op == HRMS_PARAM_OP_SET && count > 0 && !values) ||
+      (op != HRMS_PARAM_OP_GET && op != HRMS_PARAM_OP_SET)) {
+    return 0;
+  }
+
+  buf[0] = op;
+  buf[1] = seq;
+  size_t out = HRMS_PARAM_HEADER_SIZE;
+
+  for (uint8_t i = 0; i < count; i++) {
+    if ((uint32_t)ids[i] >= HRMS_PARAM_COUNT) {
+      return 0;
+    }
+
+    uint8_t size = (op == HRMS_PARAM_OP_SET) ? (uint8_t)param_table[ids[i]].type : 0;
+    if (out + HRMS_PARAM_TLV_HEADER_SIZE + size > max_len) {
+      return 0;
+    }
+
+    buf[out++] = (uint8_t)ids[i];
+    buf[out++] = size;
+    for (uint8_t b = 0; b < size; b++) {
+      buf[out++] = (uint8_t)((values[i] >> (8 * b)) & 0xFF);
+    }
+  }
+
+  return out;
+}
+
+bool hrms_param_next_tlv(const uint8_t *payload, size_t len, size_t *offset,
+                         hrms_param_tlv_t *tlv) {
+  if (!payload || !offset || !tlv || *offset + HRMS_PARAM_TLV_HEADER_SIZE > len) {
+    return false;
+  }
+
+  const uint8_t *p = &payload[*offset];
+  uint8_t size = p[1];
+  if (size > sizeof(uint32_t) || *offset + HRMS_PARAM_TLV_HEADER_SIZE + size > len) {
+    return false;
+  }
+
+  tlv->id = p[0] & (uint8_t)~HRMS_PARAM_TLV_ERROR;
+  tlv->error = (p[0] & HRMS_PARAM_TLV_ERROR) != 0;
+  tlv->len = size;
+  tlv->value = 0;
+  for (uint8_t b = 0; b < size; b++) {
+    tlv->value |= (uint32_t)p[HRMS_PARAM_TLV_HEADER_SIZE + b] << (8 * b);
+  }
+
+  *offset += HRMS_PARAM_TLV_HEADER_SIZE + size;
+  return true;
+}
+
+// Current value as a reply TLV; unknown ids carry no value
+static size_t param_put_tlv(uint8_t id, bool error, uint8_t *buf, size_t max_len) {
+  uint8_t size = (id < HRMS_PARAM_COUNT) ? (uint8_t)param_table[id].type : 0;
+  if (HRMS_PARAM_TLV_HEADER_SIZE + (size_t)size > max_len) {
+    return 0;
+  }
+
+  uint32_t value = (id < HRMS_PARAM_COUNT) ? param_values[id] : 0;
+  buf[0] = id | (error ? HRMS_PARAM_TLV_ERROR : 0);
+  buf[1] = size;
+  for (uint8_t b = 0; b < size; b++) {
+    buf[HRMS_PARAM_TLV_HEADER_SIZE + b] = (uint8_t)((value >> (8 * b)) & 0xFF);
+  }
+
+  return HRMS_PARAM_TLV_HEADER_SIZE + size;
+}
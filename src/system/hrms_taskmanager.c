@@ -26,6 +26,9 @@
 
 #include "hrms_button.h"
 #include "hrms_communication_hub.h"
+#include "hrms_packet_utils.h"
+#include "hrms_param.h"
+#include "hrms_config.h"
 #include "libc_stubs.h"
 
 // --- Task declarations ---
@@ -37,6 +40,8 @@ static void vCommunicationHubTask(void *pvParameters);
 // --- Event Handlers ---
 static void handle_sensor_data(void);
 static void handle_button_event(void);
+static void handle_remote_event(void);
+static void comm_rx_to_controller(const hrms_comm_packet_t *packet);
 
 // --- Task and queue settings ---
 #define SENSOR_HUB_TASK_STACK 384
@@ -54,10 +59,22 @@ static QueueHandle_t xSensorDataQueue = NULL;
 static QueueHandle_t xActuatorCmdQueue = NULL;
 static QueueHandle_t xButtonEventQueue = NULL;
 static QueueHandle_t xCommCmdQueue = NULL;
+static QueueHandle_t xRemoteEventQueue = NULL;
+#if HRMS_JOYSTICK_BATCH
+static QueueHandle_t xJoystickSampleQueue = NULL;
+#define JOYSTICK_SAMPLE_QUEUE_LENGTH (2 * HRMS_JOYSTICK_BATCH_SIZE)
+#define CONTROLLER_PERIOD_MS 200 // Controller stays at 200 ms whatever the sample rate
+#endif
 static QueueSetHandle_t xControllerQueueSet = NULL;
 
+// --- Task handles ---
+static TaskHandle_t xCommHubTaskHandle = NULL;
+
 void hrms_taskmanager_setup(void) {
 
+  // Defaults first - modules read their tunables from the registry
+  hrms_param_init();
+
   xSensorDataQueue = xQueueCreate(15, sizeof(hrms_sensor_data_t));
   configASSERT(xSensorDataQueue != NULL);
 
@@ -70,11 +87,20 @@ void hrms_taskmanager_setup(void) {
   xCommCmdQueue = xQueueCreate(10, sizeof(hrms_comm_command_t));
   configASSERT(xCommCmdQueue != NULL);
 
+  xRemoteEventQueue = xQueueCreate(4, sizeof(hrms_remote_event_t));
+  configASSERT(xRemoteEventQueue != NULL);
+
+#if HRMS_JOYSTICK_BATCH
+  xJoystickSampleQueue = xQueueCreate(JOYSTICK_SAMPLE_QUEUE_LENGTH, sizeof(hrms_joystick_sample_t));
+  configASSERT(xJoystickSampleQueue != NULL);
+#endif
+
   // Queue set - sum of member queue lengths
-  xControllerQueueSet = xQueueCreateSet(15 + 8); // sensor + button
+  xControllerQueueSet = xQueueCreateSet(15 + 8 + 4); // sensor + button + remote
   configASSERT(xControllerQueueSet != NULL);
   xQueueAddToSet(xSensorDataQueue, xControllerQueueSet);
   xQueueAddToSet(xButtonEventQueue, xControllerQueueSet);
+  xQueueAddToSet(xRemoteEventQueue, xControllerQueueSet);
 
   // Init all modules
   hrms_sensor_hub_init();
@@ -83,6 +109,11 @@ void hrms_taskmanager_setup(void) {
   hrms_communication_hub_init();
   hrms_button_init(xButtonEventQueue);
 
+  // Packets from the peer that the controller acts on
+  hrms_communication_hub_set_rx_handler(HRMS_COMM_PACKET_HEARTBEAT, comm_rx_to_controller);
+  hrms_communication_hub_set_rx_handler(HRMS_COMM_PACKET_ERROR, comm_rx_to_controller);
+  hrms_communication_hub_set_reliable_handler(comm_rx_to_controller);
+
   // Tasks (always run sensor and actuator hub)
   xTaskCreate(vSensorHubTask, "SensorHub", SENSOR_HUB_TASK_STACK, NULL,
               SENSOR_HUB_TASK_PRIORITY, NULL);
@@ -94,7 +125,10 @@ void hrms_taskmanager_setup(void) {
               ACTUATOR_HUB_TASK_PRIORITY, NULL);
 
   xTaskCreate(vCommunicationHubTask, "CommHub", COMMUNICATION_HUB_TASK_STACK,
-              NULL, COMMUNICATION_HUB_TASK_PRIORITY, NULL);
+              NULL, COMMUNICATION_HUB_TASK_PRIORITY, &xCommHubTaskHandle);
+
+  // Radio IRQ events are delivered to the CommHub task as notifications
+  hrms_communication_hub_set_task(xCommHubTaskHandle);
 }
 
 void hrms_taskmanager_start(void) { vTaskStartScheduler(); }
@@ -104,6 +138,36 @@ static void vSensorHubTask(void *pvParameters) {
   (void)pvParameters;
   hrms_sensor_data_t sensor_data;
 
+#if HRMS_JOYSTICK_BATCH
+  // Sample the joystick every HRMS_PARAM_SAMPLE_INTERVAL_MS for the radio
+  // batch and hand one reading per CONTROLLER_PERIOD_MS to the controller
+  TickType_t last_wake = xTaskGetTickCount();
+  uint32_t controller_ms = 0;
+
+  for (;;) {
+    uint32_t period_ms = hrms_param_get(HRMS_PARAM_SAMPLE_INTERVAL_MS);
+    vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(period_ms));
+
+    if (!hrms_sensor_hub_read(&sensor_data)) {
+      continue;
+    }
+
+    hrms_joystick_sample_t sample;
+    sample.data = sensor_data.joystick;
+    sample.timestamp = xTaskGetTickCount();
+    if (xQueueSendToBack(xJoystickSampleQueue, &sample, 0) != pdPASS) {
+      // Sample queue full - the comm task fell behind, sample dropped
+    }
+
+    controller_ms += period_ms;
+    if (controller_ms >= CONTROLLER_PERIOD_MS) {
+      controller_ms = 0;
+      if (xQueueSendToBack(xSensorDataQueue, &sensor_data, pdMS_TO_TICKS(10)) != pdPASS) {
+        // Queue full - sensor data lost
+      }
+    }
+  }
+#else
   for (;;) {
     if (hrms_sensor_hub_read(&sensor_data)) {
       // Add error handling with timeout
@@ -112,8 +176,10 @@ static void vSensorHubTask(void *pvParameters) {
       }
     }
 
-    vTaskDelay(pdMS_TO_TICKS(200)); // Slower sensor reading for stability
+    // Slow by default for stability, tunable at runtime
+    vTaskDelay(pdMS_TO_TICKS(hrms_param_get(HRMS_PARAM_SAMPLE_INTERVAL_MS)));
   }
+#endif
 }
 
 static void vControllerTask(void *pvParameters) {
@@ -131,6 +197,8 @@ static void vControllerTask(void *pvParameters) {
       handle_sensor_data();
     } else if (activated == xButtonEventQueue) {
       handle_button_event();
+    } else if (activated == xRemoteEventQueue) {
+      handle_remote_event();
     }
   }
 }
@@ -160,34 +228,39 @@ static void vActuatorHubTask(void *pvParameters) {
 static void vCommunicationHubTask(void *pvParameters) {
   (void)pvParameters;
 
-  hrms_comm_packet_t packet;
   hrms_comm_command_t comm_cmd;
 
   for (;;) {
     // Process communication hub (maintenance tasks)
     hrms_communication_hub_process();
 
+#if HRMS_JOYSTICK_BATCH
+    // Feed sampled joystick readings into the batch (flushes when full)
+    hrms_joystick_sample_t sample;
+    while (xQueueReceive(xJoystickSampleQueue, &sample, 0) == pdPASS) {
+      hrms_communication_hub_push_sample(&sample);
+    }
+
+    // The wait below paces the loop, so don't block on commands here
+    if (xQueueReceive(xCommCmdQueue, &comm_cmd, 0) == pdPASS) {
+#else
     // Handle outgoing communication commands (TX) - block for efficiency
     if (xQueueReceive(xCommCmdQueue, &comm_cmd, pdMS_TO_TICKS(10)) == pdPASS) {
+#endif
       if (comm_cmd.should_transmit) {
         hrms_communication_hub_send_joystick_data(&comm_cmd);
       }
     }
 
-    // Check for incoming data (RX)
-    uint8_t rx_buffer[sizeof(hrms_comm_packet_t)];
-    size_t received_len = 0;
-    if (hrms_communication_hub_receive(rx_buffer, sizeof(rx_buffer),
-                                       &received_len)) {
-      // Received data - convert back to packet if needed
-      if (received_len == sizeof(hrms_comm_packet_t)) {
-        memcpy(&packet, rx_buffer, sizeof(packet));
-        // Handle received packet based on type or forward to controller
-        // For now, just process it in the communication hub
-      }
-    }
+    // Decode and dispatch everything the radio received
+    hrms_communication_hub_service_rx();
+
+    // Send what this cycle queued: stick position first, bulk last
+    hrms_communication_hub_service_tx();
 
-    vTaskDelay(pdMS_TO_TICKS(20)); // Reduced cycle time for better responsiveness
+    // Sleep until the radio IRQ fires (RX ready), the cycle time elapses or
+    // a queued batch is due
+    hrms_communication_hub_wait(hrms_communication_hub_idle_ms(20));
   }
 }
 
@@ -215,3 +288,30 @@ static void handle_button_event(void) {
     }
   }
 }
+
+static void handle_remote_event(void) {
+  hrms_remote_event_t event;
+
+  if (xQueueReceive(xRemoteEventQueue, &event, 0) == pdPASS) {
+    hrms_controller_process_remote(&event);
+  }
+}
+
+// Runs in the CommHub task - hand the packet over without blocking the radio
+static void comm_rx_to_controller(const hrms_comm_packet_t *packet) {
+  if (packet->packet_type != HRMS_COMM_PACKET_HEARTBEAT &&
+      packet->packet_type != HRMS_COMM_PACKET_STATUS &&
+      packet->packet_type != HRMS_COMM_PACKET_ERROR) {
+    return;
+  }
+
+  hrms_remote_event_t event;
+  event.type = packet->packet_type;
+  event.source_id = packet->source_id;
+  event.code = (packet->payload_size > 0) ? packet->payload[0] : 0;
+  event.timestamp = xTaskGetTickCount();
+
+  if (xQueueSendToBack(xRemoteEventQueue, &event, 0) != pdPASS) {
+    // Controller behind - event dropped, the next heartbeat refreshes it
+  }
+}
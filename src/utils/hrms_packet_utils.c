@@ -8,6 +8,8 @@
  */
 
 #include "hrms_packet_utils.h"
+#include "hrms_crc.h"
+#include "hrms_config.h"
 #include "FreeRTOS.h"
 #include "task.h"
 #include "libc_stubs.h"
@@ -16,6 +18,15 @@
 // Static packet ID counter
 static uint8_t next_packet_id = 1;
 
+static size_t wire_put_body(const hrms_comm_packet_t *packet, uint8_t *buf);
+static uint16_t wire_checksum(const uint8_t *data, size_t len);
+static void wire_put_u16(uint8_t *buf, uint16_t value);
+static uint16_t wire_get_u16(const uint8_t *buf);
+static size_t wire_put_varint(uint8_t *buf, size_t buf_len, uint32_t value);
+static size_t wire_get_varint(const uint8_t *buf, size_t len, uint32_t *value);
+static uint32_t wire_zigzag(int32_t value);
+static int32_t wire_unzigzag(uint32_t value);
+
 void hrms_packet_create_heartbeat(hrms_comm_packet_t *packet, uint8_t source_id) {
   if (!packet) {
     return;
@@ -38,47 +49,301 @@ void hrms_packet_set_checksum(hrms_comm_packet_t *packet) {
     return;
   }
 
-  // Simple checksum calculation (excluding checksum field itself)
-  uint16_t checksum = 0;
-  uint8_t *data = (uint8_t*)packet;
-  
-  // Calculate checksum for all fields except checksum field
-  for (size_t i = 0; i < offsetof(hrms_comm_packet_t, checksum); i++) {
-    checksum += data[i];
+  // Same bytes and CRC as the wire frame - no struct padding involved
+  uint8_t body[HRMS_WIRE_HEADER_SIZE + HRMS_COMM_MAX_PAYLOAD_SIZE];
+  packet->checksum = wire_checksum(body, wire_put_body(packet, body));
+}
+
+bool hrms_packet_verify_checksum(const hrms_comm_packet_t *packet) {
+  if (!packet) {
+    return false;
   }
-  
-  // Include timestamp in checksum
-  uint8_t *timestamp_ptr = (uint8_t*)&packet->timestamp;
-  for (size_t i = 0; i < sizeof(packet->timestamp); i++) {
-    checksum += timestamp_ptr[i];
+
+  uint8_t body[HRMS_WIRE_HEADER_SIZE + HRMS_COMM_MAX_PAYLOAD_SIZE];
+  return (packet->checksum == wire_checksum(body, wire_put_body(packet, body)));
+}
+
+size_t hrms_packet_encode(const hrms_comm_packet_t *packet, uint8_t *buf, size_t buf_len) {
+  if (!packet || !buf || packet->payload_size > HRMS_WIRE_MAX_PAYLOAD_SIZE) {
+    return 0;
   }
-  
+
+  size_t frame_len = HRMS_WIRE_HEADER_SIZE + packet->payload_size + HRMS_WIRE_CHECKSUM_SIZE;
+  if (buf_len < frame_len) {
+    return 0;
+  }
+
+  size_t body_len = wire_put_body(packet, buf);
+  wire_put_u16(&buf[body_len], wire_checksum(buf, body_len));
+
+  return frame_len;
+}
+
+void hrms_packet_encode_header(const hrms_comm_packet_t *packet, uint8_t *buf) {
+  buf[0] = (uint8_t)packet->packet_type;
+  buf[1] = packet->packet_id;
+  buf[2] = packet->source_id;
+  buf[3] = packet->dest_id;
+  buf[4] = packet->payload_size;
+  wire_put_u16(&buf[5], (uint16_t)packet->timestamp);
+}
+
+bool hrms_packet_decode(const uint8_t *buf, size_t len, hrms_comm_packet_t *packet) {
+  if (!buf || !packet || len < HRMS_WIRE_HEADER_SIZE + HRMS_WIRE_CHECKSUM_SIZE) {
+    return false;
+  }
+
+  uint8_t payload_size = buf[4];
+  if (payload_size > HRMS_WIRE_MAX_PAYLOAD_SIZE) {
+    return false;
+  }
+
+  size_t body_len = HRMS_WIRE_HEADER_SIZE + payload_size;
+  if (len < body_len + HRMS_WIRE_CHECKSUM_SIZE) {
+    return false;
+  }
+
+  uint16_t checksum = wire_get_u16(&buf[body_len]);
+  if (checksum != wire_checksum(buf, body_len)) {
+    return false;
+  }
+
+  packet->packet_type = (hrms_comm_packet_type_t)buf[0];
+  packet->packet_id = buf[1];
+  packet->source_id = buf[2];
+  packet->dest_id = buf[3];
+  packet->payload_size = payload_size;
+  packet->timestamp = wire_get_u16(&buf[5]);
+  memcpy(packet->payload, &buf[HRMS_WIRE_HEADER_SIZE], payload_size);
   packet->checksum = checksum;
+
+  return true;
 }
 
-bool hrms_packet_verify_checksum(const hrms_comm_packet_t *packet) {
-  if (!packet) {
+size_t hrms_packet_encode_joystick(const hrms_joystick_data_t *data, uint8_t *buf, size_t buf_len) {
+  if (!data || !buf || buf_len < HRMS_WIRE_JOYSTICK_SIZE) {
+    return 0;
+  }
+
+  wire_put_u16(&buf[0], (uint16_t)data->x_axis);
+  wire_put_u16(&buf[2], (uint16_t)data->y_axis);
+  buf[4] = data->button_pressed ? HRMS_WIRE_BUTTON_PRESSED : 0;
+
+  return HRMS_WIRE_JOYSTICK_SIZE;
+}
+
+bool hrms_packet_decode_joystick(const uint8_t *buf, size_t len, hrms_joystick_data_t *data) {
+  if (!buf || !data || len < HRMS_WIRE_JOYSTICK_SIZE) {
     return false;
   }
 
-  // Calculate expected checksum
-  uint16_t expected_checksum = 0;
-  const uint8_t *data = (const uint8_t*)packet;
-  
-  // Calculate checksum for all fields except checksum field
-  for (size_t i = 0; i < offsetof(hrms_comm_packet_t, checksum); i++) {
-    expected_checksum += data[i];
+  data->x_axis = (int16_t)wire_get_u16(&buf[0]);
+  data->y_axis = (int16_t)wire_get_u16(&buf[2]);
+  data->button_pressed = (buf[4] & HRMS_WIRE_BUTTON_PRESSED) != 0;
+
+  return true;
+}
+
+void hrms_joystick_codec_init(hrms_joystick_codec_t *codec) {
+  if (codec) {
+    memset(codec, 0, sizeof(hrms_joystick_codec_t));
   }
-  
-  // Include timestamp in checksum
-  const uint8_t *timestamp_ptr = (const uint8_t*)&packet->timestamp;
-  for (size_t i = 0; i < sizeof(packet->timestamp); i++) {
-    expected_checksum += timestamp_ptr[i];
+}
+
+size_t hrms_packet_encode_joystick_delta(hrms_joystick_codec_t *codec,
+                                         const hrms_joystick_data_t *samples, uint8_t count,
+                                         uint8_t *buf, size_t buf_len) {
+  if (!codec || !samples || !buf || buf_len == 0 ||
+      count == 0 || count > HRMS_WIRE_JOYSTICK_MAX_BATCH) {
+    return 0;
   }
-  
-  return (packet->checksum == expected_checksum);
+
+  // New keyframe when none is ACKed yet, or periodically to bound drift
+  bool keyframe = !codec->reference_valid ||
+                  codec->frames_since_keyframe >= HRMS_JOYSTICK_KEYFRAME_INTERVAL;
+
+  const hrms_joystick_data_t *reference = &codec->reference;
+  uint8_t id = codec->reference_id;
+  if (keyframe) {
+    codec->pending = samples[0];
+    codec->pending_id = (uint8_t)((codec->reference_id + 1) & HRMS_WIRE_JOYSTICK_ID_MASK);
+    codec->pending_valid = true;
+    reference = &codec->pending;
+    id = codec->pending_id;
+  }
+
+  buf[0] = (uint8_t)((keyframe ? HRMS_WIRE_JOYSTICK_KEYFRAME : 0) |
+                     ((count - 1) << HRMS_WIRE_JOYSTICK_COUNT_SHIFT) | id);
+  size_t pos = 1;
+
+  for (uint8_t i = 0; i < count; i++) {
+    // First sample against the keyframe, the rest against their predecessor
+    const hrms_joystick_data_t *base = (i == 0) ? reference : &samples[i - 1];
+    int32_t dx = samples[i].x_axis;
+    int32_t dy = samples[i].y_axis;
+    if (!keyframe || i > 0) {
+      dx -= base->x_axis;
+      dy -= base->y_axis;
+    }
+
+    size_t n = wire_put_varint(&buf[pos], buf_len - pos, wire_zigzag(dx));
+    if (n == 0) {
+      return 0;
+    }
+    pos += n;
+
+    // Button rides in the low bit of the y varint
+    uint32_t y = (wire_zigzag(dy) << 1) | (samples[i].button_pressed ? 1U : 0U);
+    n = wire_put_varint(&buf[pos], buf_len - pos, y);
+    if (n == 0) {
+      return 0;
+    }
+    pos += n;
+  }
+
+  return pos;
+}
+
+void hrms_joystick_codec_on_ack(hrms_joystick_codec_t *codec, bool delivered) {
+  if (!codec) {
+    return;
+  }
+
+  // Only a keyframe the peer is known to hold may serve as reference
+  if (codec->pending_valid && delivered) {
+    codec->reference = codec->pending;
+    codec->reference_id = codec->pending_id;
+    codec->reference_valid = true;
+    codec->frames_since_keyframe = 0;
+  } else if (codec->frames_since_keyframe < 0xFF) {
+    codec->frames_since_keyframe++;
+  }
+  codec->pending_valid = false;
+}
+
+bool hrms_packet_decode_joystick_delta(hrms_joystick_codec_t *codec, const uint8_t *buf, size_t len,
+                                       hrms_joystick_data_t *samples, uint8_t max_samples,
+                                       uint8_t *count) {
+  if (!codec || !buf || !samples || !count || len < 1) {
+    return false;
+  }
+
+  bool keyframe = (buf[0] & HRMS_WIRE_JOYSTICK_KEYFRAME) != 0;
+  uint8_t n_samples = (uint8_t)(((buf[0] & HRMS_WIRE_JOYSTICK_COUNT_MASK) >> HRMS_WIRE_JOYSTICK_COUNT_SHIFT) + 1);
+  uint8_t id = buf[0] & HRMS_WIRE_JOYSTICK_ID_MASK;
+
+  if (n_samples > max_samples) {
+    return false;
+  }
+  if (!keyframe && (!codec->reference_valid || codec->reference_id != id)) {
+    return false; // Keyframe never arrived - wait for the next one
+  }
+
+  hrms_joystick_data_t reference = codec->reference;
+  const hrms_joystick_data_t *base = &reference;
+  size_t pos = 1;
+
+  for (uint8_t i = 0; i < n_samples; i++) {
+    uint32_t x;
+    uint32_t y;
+    size_t n = wire_get_varint(&buf[pos], len - pos, &x);
+    if (n == 0) {
+      return false;
+    }
+    pos += n;
+    n = wire_get_varint(&buf[pos], len - pos, &y);
+    if (n == 0) {
+      return false;
+    }
+    pos += n;
+
+    int32_t dx = wire_unzigzag(x);
+    int32_t dy = wire_unzigzag(y >> 1);
+    if (keyframe && i == 0) {
+      reference.x_axis = (int16_t)dx;
+      reference.y_axis = (int16_t)dy;
+      dx = 0;
+      dy = 0;
+    }
+
+    samples[i].x_axis = (int16_t)(base->x_axis + dx);
+    samples[i].y_axis = (int16_t)(base->y_axis + dy);
+    samples[i].button_pressed = (y & 1U) != 0;
+    base = &samples[i];
+  }
+
+  // Commit only once the whole frame parsed
+  if (keyframe) {
+    codec->reference = reference;
+    codec->reference_id = id;
+    codec->reference_valid = true;
+  }
+  *count = n_samples;
+  return true;
 }
 
 uint8_t hrms_packet_get_next_id(void) {
   return next_packet_id++;
+}
+
+// Header + payload; the caller guarantees room for the payload
+static size_t wire_put_body(const hrms_comm_packet_t *packet, uint8_t *buf) {
+  uint8_t payload_size = packet->payload_size;
+  if (payload_size > HRMS_COMM_MAX_PAYLOAD_SIZE) {
+    payload_size = HRMS_COMM_MAX_PAYLOAD_SIZE;
+  }
+
+  hrms_packet_encode_header(packet, buf);
+  memcpy(&buf[HRMS_WIRE_HEADER_SIZE], packet->payload, payload_size);
+
+  return HRMS_WIRE_HEADER_SIZE + payload_size;
+}
+
+// CRC-32 truncated to its low 16 bits
+static uint16_t wire_checksum(const uint8_t *data, size_t len) {
+  return (uint16_t)hrms_crc32(data, len);
+}
+
+static void wire_put_u16(uint8_t *buf, uint16_t value) {
+  buf[0] = (uint8_t)(value & 0xFF);
+  buf[1] = (uint8_t)(value >> 8);
+}
+
+static uint16_t wire_get_u16(const uint8_t *buf) {
+  return (uint16_t)(buf[0] | (buf[1] << 8));
+}
+
+// LEB128: 7 bits per byte, high bit set on all but the last
+static size_t wire_put_varint(uint8_t *buf, size_t buf_len, uint32_t value) {
+  size_t pos = 0;
+  do {
+    if (pos >= buf_len) {
+      return 0;
+    }
+    uint8_t byte = value & 0x7F;
+    value >>= 7;
+    buf[pos++] = value ? (byte | 0x80) : byte;
+  } while (value);
+  return pos;
+}
+
+static size_t wire_get_varint(const uint8_t *buf, size_t len, uint32_t *value) {
+  uint32_t result = 0;
+  for (size_t pos = 0; pos < len && pos < 5; pos++) {
+    result |= (uint32_t)(buf[pos] & 0x7F) << (7 * pos);
+    if (!(buf[pos] & 0x80)) {
+      *value = result;
+      return pos + 1;
+    }
+  }
+  return 0;
+}
+
+// Small magnitudes of either sign become small unsigned values
+static uint32_t wire_zigzag(int32_t value) {
+  return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static int32_t wire_unzigzag(uint32_t value) {
+  return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
 }
\ No newline at end of file
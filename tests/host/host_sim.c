@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+#include "host_sim.h"
+#include "host_stubs.h"
+
+#define HOST_SIM_STEP_US    10
+
+const nrf24l01_config_t host_sim_config = {
+  .channel = HOST_SIM_CHANNEL,
+  .power = NRF24L01_POWER_0DBM,
+  .datarate = NRF24L01_DATARATE_2MBPS,
+  .address = {0xE7, 0xE7, 0xE7, 0xE7, 0xE7},
+  .auto_ack = true,
+  .retries = 3,
+  .retry_delay = 1,
+  .dynamic_payload = true,
+  .ack_payload = false,
+  .rx_pipes = 1,
+};
+
+static void radio_write(uint8_t radio, uint8_t reg, uint8_t value) {
+  hrms_nrf24_sim_command(radio, NRF24L01_CMD_W_REGISTER | reg, &value, NULL, 1);
+}
+
+static void peer_write(uint8_t reg, uint8_t value) {
+  radio_write(HRMS_NRF24_SIM_PEER, reg, value);
+}
+
+void host_sim_reset(uint16_t loss_permille) {
+  hrms_nrf24_sim_ether_t ether = {
+    .loss_permille = loss_permille,
+    .latency_us = 0,
+    .seed = 1,
+  };
+
+  host_reset_clock();
+  hrms_nrf24_sim_init(&ether);
+  hrms_nrf24_sim_set_clock(host_now_us);
+}
+
+bool host_sim_start(uint16_t loss_permille) {
+  host_sim_reset(loss_permille);
+  return hrms_nrf24l01_init() && hrms_nrf24l01_configure(&host_sim_config);
+}
+
+void host_sim_peer_prx(bool ack_payload) {
+  uint8_t feature = NRF24L01_FEATURE_EN_DPL | (ack_payload ? NRF24L01_FEATURE_EN_ACK_PAY : 0);
+
+  peer_write(NRF24L01_REG_RF_CH, HOST_SIM_CHANNEL);
+  peer_write(NRF24L01_REG_RF_SETUP, 0x0E);             // 2 Mbps, 0 dBm
+  peer_write(NRF24L01_REG_EN_AA, 0x01);
+  peer_write(NRF24L01_REG_EN_RXADDR, 0x01);
+  peer_write(NRF24L01_REG_FEATURE, feature);
+  peer_write(NRF24L01_REG_DYNPD, 0x01);
+  peer_write(NRF24L01_REG_CONFIG, 0x0F);               // EN_CRC | CRCO | PWR_UP | PRIM_RX
+  hrms_nrf24_sim_set_ce(HRMS_NRF24_SIM_PEER, true);
+}
+
+uint8_t host_sim_peer_receive(uint8_t *data) {
+  return host_sim_node_receive(HRMS_NRF24_SIM_PEER, data);
+}
+
+void host_sim_peer_ack_payload(const uint8_t *data, uint8_t length) {
+  hrms_nrf24_sim_command(HRMS_NRF24_SIM_PEER, NRF24L01_CMD_W_ACK_PAYLOAD, data, NULL, length);
+}
+
+static void node_setup(uint8_t radio, uint8_t pipe, uint8_t config) {
+  uint8_t address[NRF24L01_ADDR_WIDTH];
+  hrms_nrf24l01_pipe_address(host_sim_config.address, pipe, address);
+
+  radio_write(radio, NRF24L01_REG_RF_CH, HOST_SIM_CHANNEL);
+  radio_write(radio, NRF24L01_REG_RF_SETUP, 0x06);         // 1 Mbps, 0 dBm
+  radio_write(radio, NRF24L01_REG_SETUP_RETR, 0x53);       // 1500 us, 3 retries
+  radio_write(radio, NRF24L01_REG_EN_AA, 0x01);
+  radio_write(radio, NRF24L01_REG_EN_RXADDR, 0x01);
+  radio_write(radio, NRF24L01_REG_RX_PW_P0, NRF24L01_MAX_PAYLOAD_SIZE);
+  hrms_nrf24_sim_command(radio, NRF24L01_CMD_W_REGISTER | NRF24L01_REG_TX_ADDR, address, NULL,
+                         NRF24L01_ADDR_WIDTH);
+  hrms_nrf24_sim_command(radio, NRF24L01_CMD_W_REGISTER | NRF24L01_REG_RX_ADDR_P0, address, NULL,
+                         NRF24L01_ADDR_WIDTH);
+  radio_write(radio, NRF24L01_REG_CONFIG, config);
+  hrms_nrf24_sim_set_ce(radio, true);
+}
+
+void host_sim_node_ptx(uint8_t radio, uint8_t pipe) {
+  node_setup(radio, pipe, 0x0E);                           // EN_CRC | CRCO | PWR_UP, PTX
+}
+
+void host_sim_node_prx(uint8_t radio, uint8_t pipe) {
+  node_setup(radio, pipe, 0x0F);                           // ... | PRIM_RX
+}
+
+uint8_t host_sim_node_receive(uint8_t radio, uint8_t *data) {
+  uint8_t status = hrms_nrf24_sim_command(radio, NRF24L01_CMD_NOP, NULL, NULL, 0);
+  if ((status & NRF24L01_STATUS_RX_P_NO) == NRF24L01_STATUS_RX_P_NO_EMPTY) {
+    return 0;
+  }
+
+  uint8_t length = 0;
+  hrms_nrf24_sim_command(radio, NRF24L01_CMD_R_RX_PL_WID, NULL, &length, 1);
+  hrms_nrf24_sim_command(radio, NRF24L01_CMD_R_RX_PAYLOAD, NULL, data, length);
+  radio_write(radio, NRF24L01_REG_STATUS, NRF24L01_STATUS_RX_DR);
+  return length;
+}
+
+void host_sim_node_channel(uint8_t radio, uint8_t channel) {
+  radio_write(radio, NRF24L01_REG_RF_CH, channel);
+}
+
+void host_sim_node_load(uint8_t radio, const uint8_t *data) {
+  hrms_nrf24_sim_command(radio, NRF24L01_CMD_W_TX_PAYLOAD, data, NULL, NRF24L01_MAX_PAYLOAD_SIZE);
+}
+
+uint8_t host_sim_node_result(uint8_t radio) {
+  uint8_t status = hrms_nrf24_sim_command(radio, NRF24L01_CMD_NOP, NULL, NULL, 0);
+  uint8_t result = status & (NRF24L01_STATUS_TX_DS | NRF24L01_STATUS_MAX_RT);
+
+  if (result & NRF24L01_STATUS_MAX_RT) {
+    hrms_nrf24_sim_command(radio, NRF24L01_CMD_FLUSH_TX, NULL, NULL, 0);
+  }
+  if (result) {
+    radio_write(radio, NRF24L01_REG_STATUS, result);
+  }
+  return result;
+}
+
+bool host_sim_wait_irq(uint32_t timeout_us) {
+  for (uint32_t waited = 0; waited < timeout_us; waited += HOST_SIM_STEP_US) {
+    if (hrms_nrf24_sim_irq(HRMS_NRF24_SIM_LOCAL)) {
+      return true;
+    }
+    host_advance_us(HOST_SIM_STEP_US);
+  }
+  return hrms_nrf24_sim_irq(HRMS_NRF24_SIM_LOCAL);
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+#ifndef HOST_SIM_H
+#define HOST_SIM_H
+
+#include "hrms_nrf24l01.h"
+#include "hrms_nrf24l01_sim.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @file host_sim.h
+ * @brief Simulator setup for host tests (SIM transport)
+ *
+ * The driver owns HRMS_NRF24_SIM_LOCAL; the peer (and the star nodes) are
+ * programmed with raw register writes so a test never depends on the code
+ * it checks at both ends. All radios run on the host virtual clock.
+ */
+
+#define HOST_SIM_CHANNEL    76
+
+extern const nrf24l01_config_t host_sim_config;
+
+/**
+ * Reset the virtual clock and all radios, and put the simulator on it
+ * @param loss_permille Ether frame loss (0-1000)
+ */
+void host_sim_reset(uint16_t loss_permille);
+
+/**
+ * host_sim_reset(), then init and configure the local radio with
+ * host_sim_config
+ * @param loss_permille Ether frame loss (0-1000)
+ * @return true if the driver came up
+ */
+bool host_sim_start(uint16_t loss_permille);
+
+/**
+ * Put the peer in PRX on HOST_SIM_CHANNEL, 2 Mbps, DPL on pipe 0
+ * @param ack_payload Enable ack payloads on the peer
+ */
+void host_sim_peer_prx(bool ack_payload);
+
+/**
+ * Pop one payload from the peer RX FIFO
+ * @param data Output buffer (32 bytes)
+ * @return Payload length, 0 if the FIFO is empty
+ */
+uint8_t host_sim_peer_receive(uint8_t *data);
+
+/**
+ * Queue an ack payload on peer pipe 0
+ */
+void host_sim_peer_ack_payload(const uint8_t *data, uint8_t length);
+
+/**
+ * Put a radio in PTX as node `pipe` of a star: hrms_nrf24_comm settings
+ * (HOST_SIM_CHANNEL, 1 Mbps, static 32-byte payloads, 3 retries at
+ * 1500 us) on hrms_nrf24l01_pipe_address(host_sim_config.address, pipe)
+ * @param radio Simulator radio index (not HRMS_NRF24_SIM_LOCAL)
+ * @param pipe Base station pipe to send to (0-5, 6+ for an unopened one)
+ */
+void host_sim_node_ptx(uint8_t radio, uint8_t pipe);
+
+/**
+ * Put a radio in PRX with the same settings as host_sim_node_ptx(),
+ * listening on pipe `pipe`'s address as its pipe 0
+ * @param radio Simulator radio index (not HRMS_NRF24_SIM_LOCAL)
+ * @param pipe Base station pipe whose address to listen on
+ */
+void host_sim_node_prx(uint8_t radio, uint8_t pipe);
+
+/**
+ * Pop one payload from a radio's RX FIFO
+ * @param radio Simulator radio index
+ * @param data Output buffer (32 bytes)
+ * @return Payload length, 0 if the FIFO is empty
+ */
+uint8_t host_sim_node_receive(uint8_t radio, uint8_t *data);
+
+/**
+ * Retune a simulated radio
+ * @param radio Simulator radio index
+ * @param channel RF channel (0-125)
+ */
+void host_sim_node_channel(uint8_t radio, uint8_t channel);
+
+/**
+ * Load a 32-byte payload on a star node; CE stays high, so it goes out
+ * as soon as the radio is free
+ */
+void host_sim_node_load(uint8_t radio, const uint8_t *data);
+
+/**
+ * Take the TX result of a star node, flushing its FIFO after MAX_RT
+ * @return NRF24L01_STATUS_TX_DS, NRF24L01_STATUS_MAX_RT or 0 (still busy)
+ */
+uint8_t host_sim_node_result(uint8_t radio);
+
+/**
+ * Advance virtual time in small steps until the local IRQ line asserts
+ * @param timeout_us Give up after this long
+ * @return true if the IRQ asserted
+ */
+bool host_sim_wait_irq(uint32_t timeout_us);
+
+#endif /* HOST_SIM_H */
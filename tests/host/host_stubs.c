@@ -0,0 +1,210 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+#include "host_stubs.h"
+#include "hrms_delay.h"
+#include "hrms_timer.h"
+#include "hrms_gpio.h"
+#include "hrms_board.h"
+#include "hrms_uart.h"
+#include "hrms_exti_dispatcher.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define HOST_GPIO_PORTS  8
+
+int host_failures = 0;
+
+static uint32_t host_clock_us = 0;
+static uint16_t host_gpio[HOST_GPIO_PORTS];
+
+// GPIOA..GPIOG sit 0x400 apart on APB2
+static uint16_t *host_gpio_port(uint32_t port) {
+  return &host_gpio[(port >> 10) % HOST_GPIO_PORTS];
+}
+
+int host_report(const char *name) {
+  printf("%s: %s\n", name, host_failures ? "FAILED" : "ok");
+  return host_failures ? 1 : 0;
+}
+
+uint32_t host_now_us(void) {
+  return host_clock_us;
+}
+
+void host_advance_us(uint32_t us) {
+  host_clock_us += us;
+}
+
+void host_reset_clock(void) {
+  host_clock_us = 0;
+}
+
+bool host_gpio_level(uint32_t port, uint32_t pin) {
+  return (*host_gpio_port(port) >> pin) & 1U;
+}
+
+// Delay and timers: all on the virtual clock
+void hrms_delay_init(void) {
+}
+
+void hrms_delay_ms(uint32_t ms) {
+  host_advance_us(ms * 1000U);
+}
+
+void hrms_delay_us(uint32_t us) {
+  host_advance_us(us);
+}
+
+int hrms_timer_init(void) {
+  return 0;
+}
+
+bool hrms_timer_oneshot_us(uint16_t us, hrms_timer_callback_t callback) {
+  // No interrupts on the host - callers fall back to a busy wait
+  (void)us;
+  (void)callback;
+  return false;
+}
+
+void hrms_timer_cancel(void) {
+}
+
+uint32_t hrms_timer_cycles(void) {
+  return host_clock_us * HOST_CYCLES_PER_US;
+}
+
+uint32_t hrms_timer_cycles_to_us(uint32_t cycles) {
+  return cycles / HOST_CYCLES_PER_US;
+}
+
+uint32_t hrms_timer_us_to_cycles(uint32_t us) {
+  return us * HOST_CYCLES_PER_US;
+}
+
+// Board seed: a different one on every call, as on every boot
+void hrms_board_seed(uint8_t *out, size_t len) {
+  static uint32_t boots = 0;
+  boots++;
+  for (size_t i = 0; i < len; i++) {
+    out[i] = (uint8_t)(boots * 131U + i);
+  }
+}
+
+// GPIO: levels are recorded, configuration is ignored
+void hrms_gpio_init(void) {
+}
+
+void hrms_gpio_config_output(uint32_t port, uint32_t pin) {
+  (void)port;
+  (void)pin;
+}
+
+void hrms_gpio_config_input(uint32_t port, uint32_t pin) {
+  (void)port;
+  (void)pin;
+}
+
+void hrms_gpio_config_input_pullup(uint32_t port, uint32_t pin) {
+  (void)port;
+  (void)pin;
+}
+
+void hrms_gpio_config_analog(uint32_t port, uint32_t pin) {
+  (void)port;
+  (void)pin;
+}
+
+void hrms_gpio_config_alternate_pushpull(uint32_t port, uint32_t pin) {
+  (void)port;
+  (void)pin;
+}
+
+void hrms_gpio_set_pin(uint32_t port, uint32_t pin) {
+  *host_gpio_port(port) |= (uint16_t)(1U << pin);
+}
+
+void hrms_gpio_clear_pin(uint32_t port, uint32_t pin) {
+  *host_gpio_port(port) &= (uint16_t)~(1U << pin);
+}
+
+void hrms_gpio_toggle_pin(uint32_t port, uint32_t pin) {
+  *host_gpio_port(port) ^= (uint16_t)(1U << pin);
+}
+
+int hrms_gpio_read_pin(uint32_t port, uint32_t pin) {
+  return host_gpio_level(port, pin) ? 1 : 0;
+}
+
+void hrms_exti_register_callback(uint8_t exti_line, hrms_exti_callback_t callback) {
+  (void)exti_line;
+  (void)callback;
+}
+
+// Debug UART goes to stdout
+void hrms_uart_send_u8(uint8_t val) {
+  printf("%02X", val);
+}
+
+void hrms_uart_send_u32(uint32_t val) {
+  printf("%08X", (unsigned)val);
+}
+
+void hrms_uart_send_str(const char *str) {
+  fputs(str, stdout);
+}
+
+void hrms_uart_send_dec(uint32_t val) {
+  printf("%u", (unsigned)val);
+}
+
+// Kernel: one thread, scheduler never started
+void vPortEnterCritical(void) {
+}
+
+void vPortExitCritical(void) {
+}
+
+TickType_t xTaskGetTickCount(void) {
+  return host_clock_us / 1000U;
+}
+
+BaseType_t xTaskGetSchedulerState(void) {
+  return taskSCHEDULER_NOT_STARTED;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+  return NULL;
+}
+
+BaseType_t xTaskGenericNotifyWait(UBaseType_t uxIndexToWaitOn, uint32_t ulBitsToClearOnEntry,
+                                  uint32_t ulBitsToClearOnExit, uint32_t *pulNotificationValue,
+                                  TickType_t xTicksToWait) {
+  (void)uxIndexToWaitOn;
+  (void)ulBitsToClearOnEntry;
+  (void)ulBitsToClearOnExit;
+  if (pulNotificationValue) {
+    *pulNotificationValue = 0;
+  }
+  host_advance_us(xTicksToWait * 1000U);
+  return pdFALSE;
+}
+
+BaseType_t xTaskGenericNotifyFromISR(TaskHandle_t xTaskToNotify, UBaseType_t uxIndexToNotify,
+                                     uint32_t ulValue, eNotifyAction eAction,
+                                     uint32_t *pulPreviousNotificationValue,
+                                     BaseType_t *pxHigherPriorityTaskWoken) {
+  (void)xTaskToNotify;
+  (void)uxIndexToNotify;
+  (void)ulValue;
+  (void)eAction;
+  (void)pulPreviousNotificationValue;
+  (void)pxHigherPriorityTaskWoken;
+  return pdPASS;
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+#ifndef HOST_STUBS_H
+#define HOST_STUBS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+/**
+ * @file host_stubs.h
+ * @brief Board and kernel stand-ins for running firmware modules on Linux
+ *
+ * One virtual microsecond counter backs hrms_delay_us(), the tick count
+ * and the DWT cycle counter (72 cycles per us), so busy waits in the
+ * driver move time forward instead of spinning. The scheduler reports
+ * "not started", which sends the driver down its polling paths. GPIO
+ * writes are recorded per port and pin.
+ */
+
+#define HOST_CYCLES_PER_US   72
+
+// Fails the test but keeps going, so one run lists every broken check
+#define CHECK(cond) \
+  do { \
+    if (!(cond)) { \
+      printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      host_failures++; \
+    } \
+  } while (0)
+
+extern int host_failures;
+
+/**
+ * Print the test result
+ * @param name Test name
+ * @return Process exit code: 0 if every CHECK passed
+ */
+int host_report(const char *name);
+
+/**
+ * Current virtual time
+ * @return Microseconds since the last host_reset_clock()
+ */
+uint32_t host_now_us(void);
+
+/**
+ * Move virtual time forward
+ * @param us Microseconds
+ */
+void host_advance_us(uint32_t us);
+
+/**
+ * Restart virtual time at 0
+ */
+void host_reset_clock(void);
+
+/**
+ * Last level written to a GPIO pin
+ * @param port GPIO port address, as passed to hrms_gpio_*()
+ * @param pin Pin number (0-15)
+ * @return true if the pin was set high
+ */
+bool host_gpio_level(uint32_t port, uint32_t pin);
+
+#endif /* HOST_STUBS_H */
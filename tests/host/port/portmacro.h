@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+#ifndef PORTMACRO_H
+#define PORTMACRO_H
+
+/*
+ * Host stand-in for FreeRTOS/portable/GCC/ARM_CM3/portmacro.h: the same
+ * types, no scheduler and no Cortex-M instructions. Only what the kernel
+ * headers need to declare the API the host tests link against stubs for.
+ */
+
+#include <stdint.h>
+
+#define portCHAR          char
+#define portFLOAT         float
+#define portDOUBLE        double
+#define portLONG          long
+#define portSHORT         short
+#define portSTACK_TYPE    uint32_t
+#define portBASE_TYPE     long
+
+typedef portSTACK_TYPE   StackType_t;
+typedef long             BaseType_t;
+typedef unsigned long    UBaseType_t;
+typedef uint32_t         TickType_t;
+
+#define portMAX_DELAY                ( TickType_t ) 0xffffffffUL
+#define portTICK_TYPE_IS_ATOMIC      1
+#define portSTACK_GROWTH             ( -1 )
+#define portTICK_PERIOD_MS           ( ( TickType_t ) 1000 / configTICK_RATE_HZ )
+#define portBYTE_ALIGNMENT           8
+#define portDONT_DISCARD
+
+#define portYIELD()
+#define portEND_SWITCHING_ISR( xSwitchRequired )    ( void ) ( xSwitchRequired )
+#define portYIELD_FROM_ISR( x )                     portEND_SWITCHING_ISR( x )
+
+#define portSET_INTERRUPT_MASK_FROM_ISR()           0
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR( x )      ( void ) ( x )
+#define portDISABLE_INTERRUPTS()
+#define portENABLE_INTERRUPTS()
+#define portENTER_CRITICAL()                        vPortEnterCritical()
+#define portEXIT_CRITICAL()                         vPortExitCritical()
+
+#define portTASK_FUNCTION_PROTO( vFunction, pvParameters )    void vFunction( void * pvParameters )
+#define portTASK_FUNCTION( vFunction, pvParameters )          void vFunction( void * pvParameters )
+
+#define portNOP()
+#define portINLINE              __inline
+#define portFORCE_INLINE        inline __attribute__( ( always_inline ) )
+#define portMEMORY_BARRIER()    __asm volatile ( "" ::: "memory" )
+
+void vPortEnterCritical( void );
+void vPortExitCritical( void );
+
+#endif /* PORTMACRO_H */
@@ -0,0 +1,226 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+/**
+ * @file test_freq_hop.c
+ * @brief Frequency hopping (HRMS_NRF24_FREQ_HOP=1) against the radio simulator
+ *
+ * hrms_nrf24_comm runs on the local radio. The far end is a reference
+ * implementation of the hop protocol on a raw simulator radio: it follows
+ * the slot named in each frame and parks on the rendezvous channel after
+ * HRMS_HOP_RESYNC_MS of silence.
+ *
+ * As transmitter, the module must blacklist a jammed channel, keep the
+ * link delivering, and find the receiver on rendezvous after a forced loss
+ * of sync. As receiver, it must follow the slots it is told and fall back
+ * to rendezvous on its own.
+ */
+
+#include "host_stubs.h"
+#include "host_sim.h"
+#include "hrms_nrf24_comm.h"
+#include "hrms_freq_hop.h"
+#include "hrms_config.h"
+
+#define HOP_PEER            HRMS_NRF24_SIM_PEER
+#define HOP_RENDEZVOUS      0xFF
+#define HOP_FRAME_MS        5       // 200 Hz control stream
+#define HOP_PAYLOAD         8
+#define HOP_JAMMED_SLOT     3
+#define HOP_JAM_PERMILLE    700
+
+// Reference receiver
+static uint8_t peer_slot;
+static uint8_t peer_channel;
+static uint32_t peer_last_rx_ms;
+static uint32_t peer_received;
+static uint32_t peer_resyncs;
+static uint8_t peer_last_rx_channel;
+static uint32_t peer_on_channel[NRF24L01_MAX_CHANNEL + 1];
+
+static uint32_t now_ms(void) {
+  return host_now_us() / 1000U;
+}
+
+static void peer_tune(uint8_t slot) {
+  peer_slot = slot;
+  peer_channel = (slot == HOP_RENDEZVOUS) ? HRMS_NRF24_CHANNEL : hrms_freq_hop_channel(slot);
+  host_sim_node_channel(HOP_PEER, peer_channel);
+}
+
+static void peer_poll(void) {
+  uint8_t data[NRF24L01_MAX_PAYLOAD_SIZE];
+
+  while (host_sim_node_receive(HOP_PEER, data) > 0) {
+    CHECK(data[0] < HRMS_HOP_CHANNELS);
+    peer_received++;
+    peer_last_rx_channel = peer_channel;
+    peer_on_channel[peer_channel]++;
+    peer_last_rx_ms = now_ms();
+    peer_tune(data[0]);
+  }
+
+  if (peer_slot != HOP_RENDEZVOUS && (now_ms() - peer_last_rx_ms) >= HRMS_HOP_RESYNC_MS) {
+    peer_resyncs++;
+    peer_tune(HOP_RENDEZVOUS);
+  }
+}
+
+static uint8_t local_channel(void) {
+  uint8_t channel = 0;
+  hrms_nrf24_sim_command(HRMS_NRF24_SIM_LOCAL, NRF24L01_CMD_R_REGISTER | NRF24L01_REG_RF_CH,
+                         NULL, &channel, 1);
+  return channel;
+}
+
+// One control frame per HOP_FRAME_MS, serviced like the hub task does
+static uint32_t send_frames(uint32_t count) {
+  uint8_t payload[HOP_PAYLOAD] = {0};
+  uint32_t delivered = 0;
+
+  for (uint32_t i = 0; i < count; i++) {
+    uint32_t start = host_now_us();
+    payload[0] = (uint8_t)i;
+    if (hrms_nrf24_comm_send(payload, sizeof(payload))) {
+      delivered++;
+    }
+    peer_poll();
+    hrms_nrf24_comm_process();
+
+    uint32_t spent = host_now_us() - start;
+    if (spent < HOP_FRAME_MS * 1000U) {
+      host_advance_us(HOP_FRAME_MS * 1000U - spent);
+    }
+    peer_poll();
+  }
+  return delivered;
+}
+
+static void test_hopping(void) {
+  uint32_t before = peer_received;
+
+  CHECK(send_frames(64) == 64);
+  CHECK(peer_received - before == 64);
+  CHECK(peer_resyncs == 0);
+
+  // Every slot of the sequence carried traffic; rendezvous only the first frame
+  for (uint8_t slot = 0; slot < HRMS_HOP_CHANNELS; slot++) {
+    CHECK(peer_on_channel[hrms_freq_hop_channel(slot)] > 0);
+  }
+  CHECK(peer_on_channel[HRMS_NRF24_CHANNEL] == 1);
+}
+
+static void test_blacklist(void) {
+  uint8_t jammed = hrms_freq_hop_channel(HOP_JAMMED_SLOT);
+  hrms_freq_hop_stats_t stats;
+
+  hrms_nrf24_sim_set_channel_loss(jammed, HOP_JAM_PERMILLE);
+  uint32_t delivered = send_frames(256);
+  hrms_freq_hop_get_stats(&stats);
+  CHECK(stats.blacklisted == 1);
+  CHECK(stats.blacklist_events == 1);
+  CHECK(delivered >= 250);
+  printf("  %u.%u%% loss on channel %u: blacklisted, %u/256 frames delivered\n",
+         HOP_JAM_PERMILLE / 10, HOP_JAM_PERMILLE % 10, jammed, (unsigned)delivered);
+
+  // Blacklisted: the link no longer lands there
+  uint32_t on_jammed = peer_on_channel[jammed];
+  CHECK(send_frames(64) == 64);
+  CHECK(peer_on_channel[jammed] == on_jammed);
+  CHECK(peer_resyncs == 0);
+  hrms_nrf24_sim_set_channel_loss(jammed, 0);
+}
+
+static void test_transmitter_resync(void) {
+  hrms_nrf24_sim_ether_t ether = {.loss_permille = 1000, .latency_us = 0, .seed = 1};
+
+  // Receiver hears nothing for longer than HRMS_HOP_RESYNC_MS
+  hrms_nrf24_sim_set_ether(&ether);
+  CHECK(send_frames(HRMS_HOP_RESYNC_MS / HOP_FRAME_MS + 4) == 0);
+  CHECK(peer_resyncs == 1);
+  CHECK(peer_slot == HOP_RENDEZVOUS);
+
+  // First frame back meets the receiver on rendezvous, then hopping resumes
+  ether.loss_permille = 0;
+  hrms_nrf24_sim_set_ether(&ether);
+  uint32_t before = peer_received;
+  CHECK(send_frames(1) == 1);
+  CHECK(peer_received == before + 1);
+  CHECK(peer_last_rx_channel == HRMS_NRF24_CHANNEL);
+  CHECK(send_frames(16) == 16);
+  CHECK(peer_last_rx_channel != HRMS_NRF24_CHANNEL);
+  CHECK(peer_resyncs == 1);
+}
+
+static bool peer_send(uint8_t slot) {
+  uint8_t frame[NRF24L01_MAX_PAYLOAD_SIZE] = {0};
+  frame[0] = slot;
+  frame[1] = 0x5A;
+  host_sim_node_load(HOP_PEER, frame);
+
+  for (uint32_t waited = 0; waited < 50000; waited += 10) {
+    uint8_t result = host_sim_node_result(HOP_PEER);
+    if (result) {
+      return result == NRF24L01_STATUS_TX_DS;
+    }
+    host_advance_us(10);
+  }
+  return false;
+}
+
+static bool local_receive(void) {
+  uint8_t data[NRF24L01_MAX_PAYLOAD_SIZE];
+  size_t len = 0;
+  return hrms_nrf24_comm_receive(data, sizeof(data), &len) &&
+         len == NRF24L01_MAX_PAYLOAD_SIZE - 1 && data[0] == 0x5A;
+}
+
+static void idle(uint32_t ms) {
+  for (uint32_t t = 0; t < ms; t += HOP_FRAME_MS) {
+    host_advance_us(HOP_FRAME_MS * 1000U);
+    hrms_nrf24_comm_process();
+  }
+}
+
+static void test_receiver_resync(void) {
+  // Roles swap: the reference end transmits, the module listens
+  host_sim_node_ptx(HOP_PEER, 0);
+  idle(HRMS_HOP_RESYNC_MS + 2 * HOP_FRAME_MS);
+  CHECK(local_channel() == HRMS_NRF24_CHANNEL);
+
+  // Each frame names the next slot; the module follows
+  CHECK(peer_send(5));
+  CHECK(local_receive());
+  CHECK(local_channel() == hrms_freq_hop_channel(5));
+  host_sim_node_channel(HOP_PEER, hrms_freq_hop_channel(5));
+  CHECK(peer_send(6));
+  CHECK(local_receive());
+  CHECK(local_channel() == hrms_freq_hop_channel(6));
+
+  // Transmitter gone: the module parks on rendezvous, where they meet again
+  idle(HRMS_HOP_RESYNC_MS + 2 * HOP_FRAME_MS);
+  CHECK(local_channel() == HRMS_NRF24_CHANNEL);
+  host_sim_node_channel(HOP_PEER, HRMS_NRF24_CHANNEL);
+  CHECK(peer_send(7));
+  CHECK(local_receive());
+  CHECK(local_channel() == hrms_freq_hop_channel(7));
+}
+
+int main(void) {
+  host_sim_reset(0);
+  CHECK(hrms_nrf24_comm_init());
+  host_sim_node_prx(HOP_PEER, 0);
+  peer_tune(HOP_RENDEZVOUS);
+
+  test_hopping();
+  test_blacklist();
+  test_transmitter_resync();
+  test_receiver_resync();
+  return host_report("test_freq_hop");
+}
@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+/**
+ * @file test_joystick_delta.c
+ * @brief Joystick delta codec: compression ratio on a recorded trace
+ *
+ * Replays fixtures/joystick_trace.csv through the codec the way the hub
+ * batches it (1-byte period header, fewer samples when a batch does not
+ * fit a frame) at 1 to 8 samples per frame, with every 5th frame lost.
+ * Every frame that decodes must reproduce its samples exactly. The ratio
+ * is against one plain HRMS_WIRE_JOYSTICK_SIZE payload per sample, for
+ * the payload bytes and for whole wire frames.
+ *
+ * Usage: test_joystick_delta <tests/host>
+ */
+
+#include "host_stubs.h"
+#include "hrms_packet_utils.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define TRACE_FILE          "fixtures/joystick_trace.csv"
+#define TRACE_MAX_SAMPLES   4096
+#define LOSS_EVERY          5
+
+static hrms_joystick_data_t trace[TRACE_MAX_SAMPLES];
+static size_t trace_len;
+
+static bool load_trace(const char *dir) {
+  char path[256];
+  char line[64];
+
+  snprintf(path, sizeof(path), "%s/%s", dir, TRACE_FILE);
+  FILE *f = fopen(path, "r");
+  if (!f) {
+    printf("cannot open %s\n", path);
+    return false;
+  }
+
+  trace_len = 0;
+  while (fgets(line, sizeof(line), f) && trace_len < TRACE_MAX_SAMPLES) {
+    int t_ms, x, y, button;
+    if (line[0] == '#' || sscanf(line, "%d,%d,%d,%d", &t_ms, &x, &y, &button) != 4) {
+      continue;
+    }
+    trace[trace_len].x_axis = (int16_t)x;
+    trace[trace_len].y_axis = (int16_t)y;
+    trace[trace_len].button_pressed = (button != 0);
+    trace_len++;
+  }
+
+  fclose(f);
+  return trace_len > 0;
+}
+
+static bool same_sample(const hrms_joystick_data_t *a, const hrms_joystick_data_t *b) {
+  return a->x_axis == b->x_axis && a->y_axis == b->y_axis &&
+         a->button_pressed == b->button_pressed;
+}
+
+// Ratio x100: plain bytes over delta bytes
+static uint32_t ratio_x100(size_t plain, size_t delta) {
+  return delta ? (uint32_t)(plain * 100 / delta) : 0;
+}
+
+static uint32_t replay(uint8_t batch) {
+  hrms_joystick_codec_t tx, rx;
+  uint8_t payload[HRMS_WIRE_MAX_PAYLOAD_SIZE];
+  hrms_joystick_data_t decoded[HRMS_WIRE_JOYSTICK_MAX_BATCH];
+  size_t delta_bytes = 0;
+  size_t frames = 0;
+  size_t keyframes = 0;
+  size_t dropped = 0;
+  size_t pos = 0;
+
+  hrms_joystick_codec_init(&tx);
+  hrms_joystick_codec_init(&rx);
+
+  while (pos < trace_len) {
+    uint8_t count = (trace_len - pos < batch) ? (uint8_t)(trace_len - pos) : batch;
+    size_t len = 0;
+
+    // Large deltas may not fit - retry with fewer samples, as the hub does
+    for (; count > 0; count--) {
+      len = hrms_packet_encode_joystick_delta(&tx, &trace[pos], count,
+                                              &payload[HRMS_WIRE_JOYSTICK_BATCH_HEADER],
+                                              sizeof(payload) - HRMS_WIRE_JOYSTICK_BATCH_HEADER);
+      if (len > 0) {
+        break;
+      }
+    }
+    CHECK(count > 0);
+    if (count == 0) {
+      return 0;
+    }
+    len += HRMS_WIRE_JOYSTICK_BATCH_HEADER;
+    if (payload[HRMS_WIRE_JOYSTICK_BATCH_HEADER] & HRMS_WIRE_JOYSTICK_KEYFRAME) {
+      keyframes++;
+    }
+
+    bool delivered = (frames % LOSS_EVERY) != LOSS_EVERY - 1;
+    if (delivered) {
+      uint8_t n = 0;
+      if (hrms_packet_decode_joystick_delta(&rx, &payload[HRMS_WIRE_JOYSTICK_BATCH_HEADER],
+                                            len - HRMS_WIRE_JOYSTICK_BATCH_HEADER,
+                                            decoded, HRMS_WIRE_JOYSTICK_MAX_BATCH, &n)) {
+        CHECK(n == count);
+        for (uint8_t i = 0; i < n && i < count; i++) {
+          CHECK(same_sample(&decoded[i], &trace[pos + i]));
+        }
+      } else {
+        dropped++;
+      }
+    }
+    hrms_joystick_codec_on_ack(&tx, delivered);
+
+    delta_bytes += len;
+    frames++;
+    pos += count;
+  }
+
+  // The sender only builds on ACKed keyframes, so nothing is undecodable
+  CHECK(dropped == 0);
+
+  size_t plain_bytes = trace_len * HRMS_WIRE_JOYSTICK_SIZE;
+  size_t overhead = HRMS_WIRE_HEADER_SIZE + HRMS_WIRE_CHECKSUM_SIZE;
+  size_t plain_wire = trace_len * (HRMS_WIRE_JOYSTICK_SIZE + overhead);
+  size_t delta_wire = delta_bytes + frames * overhead;
+  uint32_t payload_ratio = ratio_x100(plain_bytes, delta_bytes);
+  uint32_t wire_ratio = ratio_x100(plain_wire, delta_wire);
+
+  printf("  %5u %6u %5u %7u.%02u %6u.%02u %6u.%02u\n", batch, (unsigned)frames,
+         (unsigned)keyframes,
+         (unsigned)(delta_bytes * 100 / trace_len / 100), (unsigned)(delta_bytes * 100 / trace_len % 100),
+         (unsigned)(payload_ratio / 100), (unsigned)(payload_ratio % 100),
+         (unsigned)(wire_ratio / 100), (unsigned)(wire_ratio % 100));
+  return wire_ratio;
+}
+
+int main(int argc, char **argv) {
+  if (!load_trace(argc > 1 ? argv[1] : ".")) {
+    return 1;
+  }
+
+  printf("  %zu samples, every %uth frame lost\n", trace_len, LOSS_EVERY);
+  printf("  %5s %6s %5s %10s %9s %9s\n", "batch", "frames", "keys", "B/sample", "payload", "wire");
+
+  uint32_t previous = 0;
+  for (uint8_t batch = 1; batch <= HRMS_WIRE_JOYSTICK_MAX_BATCH; batch *= 2) {
+    uint32_t wire_ratio = replay(batch);
+    // Batching amortises the frame header, so each step must gain
+    CHECK(wire_ratio > previous);
+    previous = wire_ratio;
+  }
+  // Eight samples per frame: at least 3.5x fewer bytes on air than one frame each
+  CHECK(previous >= 350);
+
+  return host_report("test_joystick_delta");
+}
@@ -0,0 +1,249 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+/**
+ * @file test_keystream.c
+ * @brief Sealed frames and sessions between two link ends
+ *
+ * Two keystream states share the key, each with its own boot seed, and
+ * pass session announcements and sealed payloads to each other directly.
+ * Checks that valid frames open once, that replayed, tampered and
+ * previous-session frames are refused, that a reboot on either end gets a
+ * fresh window, and that counters past 16 bits and long gaps in reception
+ * are rebuilt correctly.
+ */
+
+#include "host_stubs.h"
+#include "hrms_keystream.h"
+#include "hrms_packet_utils.h"
+#include "hrms_types.h"
+#include "hrms_config.h"
+#include <string.h>
+
+#define KS_FRAME_DATA   6
+#define KS_LONG_GAP     40000     // Frames lost in a row, beyond the 16-bit reach
+
+// Wire headers, authenticated with each payload
+static const uint8_t session_ad[HRMS_WIRE_HEADER_SIZE] = {
+  HRMS_COMM_PACKET_SESSION, 0, 0x01, 0x02, HRMS_KEYSTREAM_SESSION_SIZE, 0, 0
+};
+static const uint8_t frame_ad[HRMS_WIRE_HEADER_SIZE] = {
+  HRMS_COMM_PACKET_CONTROL_CMD, 0, 0x01, 0x02, KS_FRAME_DATA + HRMS_KEYSTREAM_OVERHEAD, 0, 0
+};
+
+static const uint8_t key[HRMS_KEYSTREAM_KEY_SIZE] = HRMS_KEYSTREAM_KEY;
+
+typedef struct {
+  uint8_t bytes[HRMS_WIRE_MAX_PAYLOAD_SIZE];
+  size_t len;
+} sealed_t;
+
+static void boot(hrms_keystream_t *ks, uint8_t seed_byte) {
+  uint8_t seed[HRMS_KEYSTREAM_SEED_SIZE];
+  memset(seed, seed_byte, sizeof(seed));
+  hrms_keystream_init(ks, key, seed);
+}
+
+static hrms_keystream_session_t announce(hrms_keystream_t *from, hrms_keystream_t *to,
+                                         sealed_t *record) {
+  sealed_t frame;
+  frame.len = hrms_keystream_session_build(from, session_ad, sizeof(session_ad),
+                                           frame.bytes, sizeof(frame.bytes));
+  CHECK(frame.len == HRMS_KEYSTREAM_SESSION_SIZE);
+  if (record) {
+    *record = frame;
+  }
+  return hrms_keystream_session_receive(to, session_ad, sizeof(session_ad), frame.bytes, frame.len);
+}
+
+// The exchange the hubs run, whichever end booted last
+static void connect(hrms_keystream_t *a, hrms_keystream_t *b) {
+  CHECK(announce(a, b, NULL) == HRMS_KEYSTREAM_SESSION_CHALLENGE);
+  CHECK(announce(b, a, NULL) == HRMS_KEYSTREAM_SESSION_NEW);
+  CHECK(announce(a, b, NULL) == HRMS_KEYSTREAM_SESSION_NEW);
+  CHECK(announce(b, a, NULL) == HRMS_KEYSTREAM_SESSION_CURRENT);
+}
+
+static sealed_t seal(hrms_keystream_t *ks, uint8_t marker) {
+  uint8_t data[KS_FRAME_DATA];
+  sealed_t frame;
+  memset(data, marker, sizeof(data));
+  frame.len = hrms_keystream_encrypt(ks, frame_ad, sizeof(frame_ad), data, sizeof(data),
+                                     frame.bytes, sizeof(frame.bytes));
+  CHECK(frame.len == KS_FRAME_DATA + HRMS_KEYSTREAM_OVERHEAD);
+  return frame;
+}
+
+// Opened with the expected content and counter
+static bool opens(hrms_keystream_t *ks, const sealed_t *frame, uint8_t marker, uint32_t counter) {
+  uint8_t data[HRMS_KEYSTREAM_MAX_DATA];
+  uint32_t full = 0;
+  size_t len = hrms_keystream_decrypt(ks, frame_ad, sizeof(frame_ad), frame->bytes, frame->len,
+                                      data, sizeof(data), &full);
+  if (len != KS_FRAME_DATA || full != counter) {
+    return false;
+  }
+  for (size_t i = 0; i < len; i++) {
+    if (data[i] != marker) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool refused(hrms_keystream_t *ks, const sealed_t *frame) {
+  uint8_t data[HRMS_KEYSTREAM_MAX_DATA];
+  return hrms_keystream_decrypt(ks, frame_ad, sizeof(frame_ad), frame->bytes, frame->len,
+                                data, sizeof(data), NULL) == 0;
+}
+
+static void test_frames(void) {
+  hrms_keystream_t a, b;
+  hrms_keystream_stats_t stats;
+  boot(&a, 0x11);
+  boot(&b, 0x22);
+
+  // Nothing opens before a session is taken
+  sealed_t early = seal(&a, 1);
+  CHECK(refused(&b, &early));
+  hrms_keystream_get_stats(&b, &stats);
+  CHECK(stats.auth_failed == 1);
+
+  connect(&a, &b);
+
+  // Valid, then the same frame again
+  sealed_t first = seal(&a, 2);
+  CHECK(opens(&b, &first, 2, 1));
+  CHECK(refused(&b, &first));
+  hrms_keystream_get_stats(&b, &stats);
+  CHECK(stats.replayed == 1);
+
+  // A flipped tag bit, or a header that is not the one sealed, is refused
+  // and does not spend the counter
+  sealed_t next = seal(&a, 3);
+  sealed_t tampered = next;
+  tampered.bytes[tampered.len - 1] ^= 0x01;
+  CHECK(refused(&b, &tampered));
+  uint8_t data[HRMS_KEYSTREAM_MAX_DATA];
+  CHECK(hrms_keystream_decrypt(&b, session_ad, sizeof(session_ad), next.bytes, next.len,
+                               data, sizeof(data), NULL) == 0);
+  hrms_keystream_get_stats(&b, &stats);
+  CHECK(stats.auth_failed == 3);
+  CHECK(opens(&b, &next, 3, 2));
+
+  // Out of order within the window, once each
+  sealed_t late = seal(&a, 4);
+  sealed_t later = seal(&a, 5);
+  CHECK(opens(&b, &later, 5, 4));
+  CHECK(opens(&b, &late, 4, 3));
+  CHECK(refused(&b, &late));
+
+  // The other direction has its own counters
+  sealed_t back = seal(&b, 6);
+  CHECK(opens(&a, &back, 6, 0));
+}
+
+static void test_peer_reboot(void) {
+  hrms_keystream_t a, b;
+  hrms_keystream_stats_t stats;
+  sealed_t old_announcement;
+  boot(&a, 0x11);
+  boot(&b, 0x22);
+  connect(&a, &b);
+  CHECK(announce(&a, &b, &old_announcement) == HRMS_KEYSTREAM_SESSION_CURRENT);
+
+  sealed_t before[3];
+  for (uint8_t i = 0; i < 3; i++) {
+    before[i] = seal(&a, i);
+    CHECK(opens(&b, &before[i], i, i));
+  }
+
+  // Same key, new seed: counters start over under a new nonce
+  boot(&a, 0x33);
+  sealed_t fresh = seal(&a, 7);
+  CHECK(refused(&b, &fresh));
+
+  // A recorded announcement of the previous boot is not taken
+  CHECK(hrms_keystream_session_receive(&b, session_ad, sizeof(session_ad), old_announcement.bytes,
+                                       old_announcement.len) == HRMS_KEYSTREAM_SESSION_CURRENT);
+  connect(&a, &b);
+  CHECK(hrms_keystream_session_receive(&b, session_ad, sizeof(session_ad), old_announcement.bytes,
+                                       old_announcement.len) == HRMS_KEYSTREAM_SESSION_CHALLENGE);
+
+  // Counter 0 of the new boot is not counted as a replay of the old one
+  sealed_t after = seal(&a, 8);
+  CHECK(opens(&b, &after, 8, 1));
+  for (uint8_t i = 0; i < 3; i++) {
+    CHECK(refused(&b, &before[i]));
+  }
+  hrms_keystream_get_stats(&b, &stats);
+  CHECK(stats.sessions == 2);
+}
+
+static void test_receiver_reboot(void) {
+  hrms_keystream_t a, b;
+  boot(&a, 0x11);
+  boot(&b, 0x22);
+  connect(&a, &b);
+
+  // The sender keeps its session through the receiver's reboot, well past
+  // 16 bits of counter
+  uint32_t opened = 0;
+  for (uint32_t i = 0; i < 70000; i++) {
+    sealed_t frame = seal(&a, 0);
+    opened += opens(&b, &frame, 0, i);
+  }
+  CHECK(opened == 70000);
+  sealed_t recorded = seal(&a, 1);
+  CHECK(opens(&b, &recorded, 1, 70000));
+
+  boot(&b, 0x44);
+  connect(&a, &b);
+  CHECK(refused(&b, &recorded));
+  sealed_t next = seal(&a, 2);
+  CHECK(opens(&b, &next, 2, 70001));
+}
+
+static void test_long_gap(void) {
+  hrms_keystream_t a, b;
+  boot(&a, 0x11);
+  boot(&b, 0x22);
+  connect(&a, &b);
+
+  sealed_t frame = seal(&a, 1);
+  CHECK(opens(&b, &frame, 1, 0));
+
+  // Out of range for longer than the 16-bit counter reaches
+  for (uint32_t i = 0; i < KS_LONG_GAP; i++) {
+    seal(&a, 0);
+  }
+  sealed_t lost = seal(&a, 2);
+  CHECK(refused(&b, &lost));
+
+  // The next announcement moves the receiver up to the sender
+  CHECK(announce(&a, &b, NULL) == HRMS_KEYSTREAM_SESSION_CURRENT);
+  frame = seal(&a, 3);
+  CHECK(opens(&b, &frame, 3, KS_LONG_GAP + 2));
+
+  // An older announcement does not move it back
+  sealed_t stale;
+  hrms_keystream_t copy = a;
+  copy.tx_counter = 5;
+  CHECK(announce(&copy, &b, &stale) == HRMS_KEYSTREAM_SESSION_CURRENT);
+  frame = seal(&a, 4);
+  CHECK(opens(&b, &frame, 4, KS_LONG_GAP + 3));
+}
+
+int main(void) {
+  test_frames();
+  test_peer_reboot();
+  test_receiver_reboot();
+  test_long_gap();
+  return host_report("test_keystream");
+}
@@ -0,0 +1,348 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+/**
+ * @file test_link_quality.c
+ * @brief Adaptive data rate and TX power on the simulator
+ *
+ * The communication hub sends a 200 Hz stick stream from the local radio.
+ * A simulator radio receives it and applies every LINK rate switch it
+ * hears, as the remote receiver does. The ether is clean, then lossy, then
+ * clean again. Every RF change the estimator commits is logged and checked:
+ * - a clean link climbs to 2 Mbps, then trims power;
+ * - a lossy link restores power before it gives up rate;
+ * - each phase only moves one way;
+ * - changes are at least HRMS_LINK_MIN_FRAMES apart.
+ *
+ * Switch requests are sealed. Both ends first exchange session frames,
+ * then the receiver side checks that the hub only acts on a fresh request
+ * carrying a valid tag.
+ */
+
+#include "host_stubs.h"
+#include "host_sim.h"
+#include "hrms_communication_hub.h"
+#include "hrms_link_quality.h"
+#include "hrms_packet_utils.h"
+#include "hrms_keystream.h"
+#include "hrms_config.h"
+#include <string.h>
+
+#define LINK_PEER         HRMS_NRF24_SIM_PEER
+#define LINK_CYCLE_MS     5
+#define LINK_LOSSY        300     // Per-frame loss, data and ACK alike (permille)
+#define LINK_MAX_CHANGES  16
+
+typedef struct {
+  uint32_t frame;
+  hrms_link_rf_t rf;
+} link_change_t;
+
+static link_change_t changes[LINK_MAX_CHANGES];
+static uint8_t change_count;
+static hrms_link_rf_t last_rf;
+static uint32_t sticks_sent;
+static uint32_t sticks_received;
+static hrms_keystream_t peer_ks;
+
+// RF_SETUP rate bits of the peer, 0 dBm
+static void peer_set_rate(nrf24l01_datarate_t datarate) {
+  uint8_t rf_setup = 0x06;
+  if (datarate == NRF24L01_DATARATE_2MBPS) {
+    rf_setup |= 0x08;
+  } else if (datarate == NRF24L01_DATARATE_250KBPS) {
+    rf_setup |= 0x20;
+  }
+  hrms_nrf24_sim_command(LINK_PEER, NRF24L01_CMD_W_REGISTER | NRF24L01_REG_RF_SETUP,
+                         &rf_setup, NULL, 1);
+}
+
+// Remote receiver: count sticks, follow sealed rate switches and sessions
+static hrms_keystream_session_t peer_poll(void) {
+  hrms_keystream_session_t session = HRMS_KEYSTREAM_SESSION_INVALID;
+  uint8_t data[NRF24L01_MAX_PAYLOAD_SIZE];
+  uint8_t request[HRMS_KEYSTREAM_MAX_DATA];
+  hrms_comm_packet_t packet;
+
+  while (host_sim_node_receive(LINK_PEER, data) > 0) {
+    if (!hrms_packet_decode(data, sizeof(data), &packet)) {
+      continue;
+    }
+    if (packet.packet_type == HRMS_COMM_PACKET_CONTROL_CMD) {
+      sticks_received++;
+    } else if (packet.packet_type == HRMS_COMM_PACKET_LINK) {
+      size_t len = hrms_keystream_decrypt(&peer_ks, data, HRMS_WIRE_HEADER_SIZE, packet.payload,
+                                          packet.payload_size, request, sizeof(request), NULL);
+      CHECK(len == HRMS_LINK_SWITCH_SIZE);
+      if (len == HRMS_LINK_SWITCH_SIZE && request[0] == HRMS_LINK_OP_SWITCH_RATE) {
+        peer_set_rate((nrf24l01_datarate_t)request[1]);
+      }
+    } else if (packet.packet_type == HRMS_COMM_PACKET_SESSION) {
+      session = hrms_keystream_session_receive(&peer_ks, data, HRMS_WIRE_HEADER_SIZE,
+                                               packet.payload, packet.payload_size);
+      CHECK(session != HRMS_KEYSTREAM_SESSION_INVALID);
+    }
+  }
+  return session;
+}
+
+static void log_change(void) {
+  hrms_link_quality_stats_t stats;
+  hrms_link_quality_get_stats(&stats);
+
+  if (stats.rf.datarate != last_rf.datarate || stats.rf.power != last_rf.power) {
+    if (change_count < LINK_MAX_CHANGES) {
+      changes[change_count].frame = stats.frames;
+      changes[change_count].rf = stats.rf;
+    }
+    change_count++;
+    last_rf = stats.rf;
+  }
+}
+
+// Hub task cycles: one stick frame each, then maintenance
+static void run(uint32_t ms) {
+  hrms_comm_command_t cmd;
+  memset(&cmd, 0, sizeof(cmd));
+  cmd.should_transmit = true;
+  cmd.packet_type = HRMS_COMM_PACKET_CONTROL_CMD;
+  cmd.dest_id = 0x02;
+
+  for (uint32_t t = 0; t < ms; t += LINK_CYCLE_MS) {
+    uint32_t cycle_start = host_now_us();
+
+    cmd.joystick_data.x_axis = (int16_t)(t % 1000);
+    CHECK(hrms_communication_hub_send_joystick_data(&cmd));
+    sticks_sent++;
+    hrms_communication_hub_service_tx();
+    peer_poll();
+    hrms_communication_hub_process();
+    peer_poll();            // The receiver acts on a LINK frame as it lands
+    log_change();
+
+    uint32_t spent = host_now_us() - cycle_start;
+    if (spent < LINK_CYCLE_MS * 1000U) {
+      host_advance_us(LINK_CYCLE_MS * 1000U - spent);
+    }
+  }
+}
+
+static void set_loss(uint16_t permille) {
+  hrms_nrf24_sim_ether_t ether = {.loss_permille = permille, .latency_us = 0, .seed = 7};
+  hrms_nrf24_sim_set_ether(&ether);
+}
+
+// Faster rate / lower power ranks higher
+static int rate_rank(nrf24l01_datarate_t datarate) {
+  return (datarate == NRF24L01_DATARATE_250KBPS) ? 0 : (datarate == NRF24L01_DATARATE_1MBPS) ? 1 : 2;
+}
+
+// Changes [first, last) all go one way, spaced by HRMS_LINK_MIN_FRAMES
+static bool one_way(uint8_t first, uint8_t last, bool up, hrms_link_rf_t from) {
+  uint32_t previous_frame = 0;
+  for (uint8_t i = first; i < last && i < LINK_MAX_CHANGES; i++) {
+    int rate = rate_rank(changes[i].rf.datarate) - rate_rank(from.datarate);
+    int power = (int)changes[i].rf.power - (int)from.power;
+    if ((up && (rate < 0 || power < 0 || (rate == 0 && power == 0))) ||
+        (!up && (rate > 0 || power > 0 || (rate == 0 && power == 0)))) {
+      return false;
+    }
+    if (i > first && changes[i].frame - previous_frame < HRMS_LINK_MIN_FRAMES) {
+      return false;
+    }
+    previous_frame = changes[i].frame;
+    from = changes[i].rf;
+  }
+  return true;
+}
+
+static uint8_t peer_rate_bits(void) {
+  uint8_t rf_setup = 0;
+  hrms_nrf24_sim_command(LINK_PEER, NRF24L01_CMD_R_REGISTER | NRF24L01_REG_RF_SETUP,
+                         NULL, &rf_setup, 1);
+  return rf_setup & 0x28;
+}
+
+// A switch request from the peer, sealed with the shared key or in the clear
+static void make_switch(nrf24l01_datarate_t datarate, bool seal, uint8_t *frame) {
+  const uint8_t request[HRMS_LINK_SWITCH_SIZE] = {HRMS_LINK_OP_SWITCH_RATE, (uint8_t)datarate};
+  hrms_comm_packet_t packet;
+  memset(&packet, 0, sizeof(packet));
+  packet.packet_type = HRMS_COMM_PACKET_LINK;
+  packet.source_id = 0x02;
+  packet.dest_id = 0x01;
+
+  if (seal) {
+    uint8_t header[HRMS_WIRE_HEADER_SIZE];
+    packet.payload_size = HRMS_LINK_SWITCH_SIZE + HRMS_KEYSTREAM_OVERHEAD;
+    hrms_packet_encode_header(&packet, header);
+    CHECK(hrms_keystream_encrypt(&peer_ks, header, sizeof(header), request, sizeof(request),
+                                 packet.payload, sizeof(packet.payload)) == packet.payload_size);
+  } else {
+    packet.payload_size = HRMS_LINK_SWITCH_SIZE;
+    memcpy(packet.payload, request, sizeof(request));
+  }
+
+  memset(frame, 0, NRF24L01_MAX_PAYLOAD_SIZE);
+  CHECK(hrms_packet_encode(&packet, frame, NRF24L01_MAX_PAYLOAD_SIZE) > 0);
+}
+
+// Peer transmits one frame at its current rate; the hub task picks it up
+static void peer_send(const uint8_t *frame) {
+  host_sim_node_load(LINK_PEER, frame);
+  uint8_t result = 0;
+  for (uint32_t waited = 0; waited < 50000 && !result; waited += 10) {
+    result = host_sim_node_result(LINK_PEER);
+    host_advance_us(10);
+  }
+  CHECK(result == NRF24L01_STATUS_TX_DS);
+  hrms_communication_hub_service_rx();
+}
+
+// Peer announces its session, echoing the hub's challenge
+static void peer_send_session(void) {
+  uint8_t frame[NRF24L01_MAX_PAYLOAD_SIZE];
+  uint8_t header[HRMS_WIRE_HEADER_SIZE];
+  hrms_comm_packet_t packet;
+  memset(&packet, 0, sizeof(packet));
+  packet.packet_type = HRMS_COMM_PACKET_SESSION;
+  packet.source_id = 0x02;
+  packet.dest_id = 0x01;
+  packet.payload_size = HRMS_KEYSTREAM_SESSION_SIZE;
+  hrms_packet_encode_header(&packet, header);
+  CHECK(hrms_keystream_session_build(&peer_ks, header, sizeof(header), packet.payload,
+                                     sizeof(packet.payload)) == HRMS_KEYSTREAM_SESSION_SIZE);
+
+  memset(frame, 0, sizeof(frame));
+  CHECK(hrms_packet_encode(&packet, frame, sizeof(frame)) > 0);
+  peer_send(frame);
+}
+
+// Fresh boot on both ends, then the session exchange the hub starts
+static void start(void) {
+  static const uint8_t key[HRMS_KEYSTREAM_KEY_SIZE] = HRMS_KEYSTREAM_KEY;
+  uint8_t seed[HRMS_KEYSTREAM_SEED_SIZE];
+  hrms_comm_stats_t comm;
+
+  host_sim_reset(0);
+  hrms_communication_hub_init();
+  memset(seed, 0xA5, sizeof(seed));
+  hrms_keystream_init(&peer_ks, key, seed);
+  host_sim_node_prx(LINK_PEER, 0);
+
+  // Hub announces; the peer has no echo to offer yet, so it answers
+  hrms_communication_hub_process();
+  hrms_communication_hub_service_tx();
+  CHECK(peer_poll() == HRMS_KEYSTREAM_SESSION_CHALLENGE);
+  host_sim_node_ptx(LINK_PEER, 0);
+  peer_send_session();
+
+  // The hub took the peer's session and announces again with its echo
+  host_sim_node_prx(LINK_PEER, 0);
+  hrms_communication_hub_process();
+  hrms_communication_hub_service_tx();
+  CHECK(peer_poll() == HRMS_KEYSTREAM_SESSION_NEW);
+
+  hrms_communication_hub_get_stats(&comm);
+  CHECK(comm.packets_rejected == 0);
+}
+
+static void test_adaptation(void) {
+  hrms_link_quality_stats_t stats;
+
+  start();
+  hrms_link_quality_get_stats(&stats);
+  last_rf = stats.rf;
+  CHECK(last_rf.datarate == NRF24L01_DATARATE_1MBPS && last_rf.power == NRF24L01_POWER_0DBM);
+
+  // Clean: up to 2 Mbps, then down to -18 dBm
+  hrms_link_rf_t from = last_rf;
+  run(1000);
+  CHECK(change_count == 4);
+  CHECK(one_way(0, change_count, true, from));
+  CHECK(changes[0].rf.datarate == NRF24L01_DATARATE_2MBPS);
+  CHECK(last_rf.datarate == NRF24L01_DATARATE_2MBPS && last_rf.power == NRF24L01_POWER_NEG18DBM);
+  CHECK(peer_rate_bits() == 0x08);
+  CHECK(sticks_received == sticks_sent);
+
+  // Lossy: power back to 0 dBm first, then 1 Mbps, then 250 kbps
+  uint8_t mark = change_count;
+  from = last_rf;
+  uint32_t sent_before = sticks_sent, received_before = sticks_received;
+  set_loss(LINK_LOSSY);
+  run(3000);
+  CHECK(change_count - mark == 5);
+  CHECK(one_way(mark, change_count, false, from));
+  CHECK(changes[mark + 2].rf.power == NRF24L01_POWER_0DBM &&
+        changes[mark + 2].rf.datarate == NRF24L01_DATARATE_2MBPS);
+  CHECK(last_rf.datarate == NRF24L01_DATARATE_250KBPS && last_rf.power == NRF24L01_POWER_0DBM);
+  CHECK(peer_rate_bits() == 0x20);
+  uint32_t lossy_permille = (sticks_received - received_before) * 1000U / (sticks_sent - sent_before);
+  CHECK(lossy_permille >= 850);
+
+  // Clean again: climbs back, never down on the way
+  mark = change_count;
+  from = last_rf;
+  set_loss(0);
+  run(1000);
+  CHECK(one_way(mark, change_count, true, from));
+  CHECK(last_rf.datarate == NRF24L01_DATARATE_2MBPS && last_rf.power == NRF24L01_POWER_NEG18DBM);
+  CHECK(peer_rate_bits() == 0x08);
+
+  hrms_link_quality_get_stats(&stats);
+  CHECK(stats.rate_switches == 5);
+  printf("  %u RF changes, %u rate switches, %u.%u%% of sticks through %u%% frame loss\n",
+         (unsigned)change_count, (unsigned)stats.rate_switches,
+         (unsigned)(lossy_permille / 10), (unsigned)(lossy_permille % 10), LINK_LOSSY / 10);
+}
+
+static nrf24l01_datarate_t hub_rate(void) {
+  hrms_link_quality_stats_t stats;
+  hrms_link_quality_get_stats(&stats);
+  return stats.rf.datarate;
+}
+
+static void test_sealed_switch(void) {
+  uint8_t forged[NRF24L01_MAX_PAYLOAD_SIZE];
+  uint8_t slow[NRF24L01_MAX_PAYLOAD_SIZE];
+  uint8_t fast[NRF24L01_MAX_PAYLOAD_SIZE];
+  hrms_comm_stats_t comm;
+
+  start();
+  host_sim_node_ptx(LINK_PEER, 0);
+  make_switch(NRF24L01_DATARATE_250KBPS, false, forged);
+  make_switch(NRF24L01_DATARATE_250KBPS, true, slow);
+  make_switch(NRF24L01_DATARATE_2MBPS, true, fast);
+
+  // In the clear: ACKed by the radio, refused by the hub
+  peer_send(forged);
+  hrms_communication_hub_get_stats(&comm);
+  CHECK(comm.packets_rejected == 1);
+  CHECK(hub_rate() == NRF24L01_DATARATE_1MBPS);
+
+  // Sealed: both ends move
+  peer_send(slow);
+  CHECK(hub_rate() == NRF24L01_DATARATE_250KBPS);
+  peer_set_rate(NRF24L01_DATARATE_250KBPS);
+  peer_send(fast);
+  CHECK(hub_rate() == NRF24L01_DATARATE_2MBPS);
+  peer_set_rate(NRF24L01_DATARATE_2MBPS);
+
+  // Recorded and played back: the tag is good, the counter is spent
+  peer_send(slow);
+  hrms_communication_hub_get_stats(&comm);
+  CHECK(comm.packets_rejected == 2);
+  CHECK(hub_rate() == NRF24L01_DATARATE_2MBPS);
+}
+
+int main(void) {
+  test_adaptation();
+  test_sealed_switch();
+  return host_report("test_link_quality");
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+/**
+ * @file test_nrf24l01_burst.c
+ * @brief Pipelined TX (enqueue/process_tx) against the radio simulator
+ *
+ * A full pipeline is cut off after k ACKs by raising the channel loss to
+ * 100%. process_tx() is only called once MAX_RT is up, with TX_DS from
+ * the earlier ACK still latched: the k delivered payloads must be
+ * reported as sent and only the rest as failed. The FIFO is never written
+ * beyond the queued payloads.
+ */
+
+#include "host_stubs.h"
+#include "host_sim.h"
+#include <string.h>
+
+#define BURST_TIMEOUT_US    50000
+
+static bool results[NRF24L01_TX_PIPELINE_DEPTH];
+static uint8_t result_tags[NRF24L01_TX_PIPELINE_DEPTH];
+static uint8_t result_count;
+
+static void on_tx_done(uint8_t tag, bool success) {
+  if (result_count < NRF24L01_TX_PIPELINE_DEPTH) {
+    result_tags[result_count] = tag;
+    results[result_count] = success;
+  }
+  result_count++;
+}
+
+static void run_burst(uint8_t acked) {
+  uint8_t payload[12] = "burst frame";
+  hrms_nrf24_sim_stats_t stats;
+
+  CHECK(host_sim_start(0));
+  host_sim_peer_prx(false);
+  hrms_nrf24l01_set_tx_callback(on_tx_done);
+  result_count = 0;
+  if (acked == 0) {
+    hrms_nrf24_sim_set_channel_loss(HOST_SIM_CHANNEL, 1000);
+  }
+
+  for (uint8_t tag = 0; tag < NRF24L01_TX_PIPELINE_DEPTH; tag++) {
+    payload[0] = tag;
+    CHECK(hrms_nrf24l01_enqueue(payload, sizeof(payload), tag));
+  }
+
+  // Peer goes deaf once `acked` payloads got through
+  uint32_t waited = 0;
+  bool max_rt = false;
+  while (!max_rt && waited < BURST_TIMEOUT_US) {
+    hrms_nrf24_sim_get_stats(&stats);
+    if (stats.delivered >= acked) {
+      hrms_nrf24_sim_set_channel_loss(HOST_SIM_CHANNEL, 1000);
+    }
+    max_rt = (hrms_nrf24l01_get_status() & NRF24L01_STATUS_MAX_RT) != 0;
+    host_advance_us(10);
+    waited += 10;
+  }
+  CHECK(max_rt);
+  hrms_nrf24_sim_get_stats(&stats);
+  CHECK(stats.delivered == acked);
+  CHECK(acked == 0 || (hrms_nrf24l01_get_status() & NRF24L01_STATUS_TX_DS));
+
+  hrms_nrf24l01_process_tx();
+  CHECK(hrms_nrf24l01_tx_pending() == 0);
+  CHECK(result_count == NRF24L01_TX_PIPELINE_DEPTH);
+  for (uint8_t i = 0; i < NRF24L01_TX_PIPELINE_DEPTH; i++) {
+    CHECK(result_tags[i] == i);
+    CHECK(results[i] == (i < acked));
+  }
+
+  // FIFO flushed and flags cleared
+  uint8_t status = hrms_nrf24l01_get_status();
+  CHECK(!(status & (NRF24L01_STATUS_TX_DS | NRF24L01_STATUS_MAX_RT | NRF24L01_STATUS_TX_FULL)));
+
+  // Nothing else goes on air, and the peer got exactly the ACKed payloads
+  uint8_t received[NRF24L01_MAX_PAYLOAD_SIZE];
+  uint8_t count = 0;
+  host_advance_us(BURST_TIMEOUT_US);
+  while (host_sim_peer_receive(received) == sizeof(payload)) {
+    CHECK(received[0] == count);
+    count++;
+  }
+  CHECK(count == acked);
+  hrms_nrf24_sim_get_stats(&stats);
+  CHECK(stats.delivered == acked && stats.max_rt == 1);
+
+  printf("  %u of %u ACKed before MAX_RT: ok %u, failed %u\n", acked, NRF24L01_TX_PIPELINE_DEPTH,
+         acked, NRF24L01_TX_PIPELINE_DEPTH - acked);
+}
+
+static void test_full_burst(void) {
+  uint8_t payload[8] = "all ok";
+  uint8_t received[NRF24L01_MAX_PAYLOAD_SIZE];
+
+  CHECK(host_sim_start(0));
+  host_sim_peer_prx(false);
+  hrms_nrf24l01_set_tx_callback(on_tx_done);
+  result_count = 0;
+
+  for (uint8_t tag = 0; tag < NRF24L01_TX_PIPELINE_DEPTH; tag++) {
+    CHECK(hrms_nrf24l01_enqueue(payload, sizeof(payload), tag));
+  }
+  CHECK(!hrms_nrf24l01_enqueue(payload, sizeof(payload), 9)); // Pipeline full
+
+  for (uint32_t waited = 0; hrms_nrf24l01_tx_pending() > 0 && waited < BURST_TIMEOUT_US;
+       waited += 10) {
+    hrms_nrf24l01_process_tx();
+    host_advance_us(10);
+  }
+  CHECK(hrms_nrf24l01_tx_pending() == 0);
+  CHECK(result_count == NRF24L01_TX_PIPELINE_DEPTH);
+  for (uint8_t i = 0; i < NRF24L01_TX_PIPELINE_DEPTH; i++) {
+    CHECK(results[i]);
+  }
+
+  uint8_t count = 0;
+  while (host_sim_peer_receive(received) == sizeof(payload)) {
+    count++;
+  }
+  CHECK(count == NRF24L01_TX_PIPELINE_DEPTH);
+}
+
+int main(void) {
+  test_full_burst();
+  for (uint8_t acked = 0; acked < NRF24L01_TX_PIPELINE_DEPTH; acked++) {
+    run_burst(acked);
+  }
+  return host_report("test_nrf24l01_burst");
+}
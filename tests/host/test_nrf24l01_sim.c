@@ -0,0 +1,233 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+/**
+ * @file test_nrf24l01_sim.c
+ * @brief nRF24L01 driver end to end against the two-radio simulator
+ *
+ * Blocking send, receive, ack payloads and retransmits over a clean and a
+ * lossy ether, and an RPD sweep. The peer is driven with raw register access (host_sim.c).
+ */
+
+#include "host_stubs.h"
+#include "host_sim.h"
+#include <string.h>
+
+#define PEER_TIMEOUT_US   20000
+
+static void peer_write(uint8_t reg, uint8_t value) {
+  hrms_nrf24_sim_command(HRMS_NRF24_SIM_PEER, NRF24L01_CMD_W_REGISTER | reg, &value, NULL, 1);
+}
+
+static uint8_t peer_status(void) {
+  return hrms_nrf24_sim_command(HRMS_NRF24_SIM_PEER, NRF24L01_CMD_NOP, NULL, NULL, 0);
+}
+
+// Peer as PTX: one payload, CE pulse, wait for TX_DS or MAX_RT
+static bool peer_send(const uint8_t *data, uint8_t length) {
+  peer_write(NRF24L01_REG_CONFIG, 0x0E);                   // EN_CRC | CRCO | PWR_UP
+  peer_write(NRF24L01_REG_STATUS, NRF24L01_STATUS_TX_DS | NRF24L01_STATUS_MAX_RT);
+  hrms_nrf24_sim_command(HRMS_NRF24_SIM_PEER, NRF24L01_CMD_W_TX_PAYLOAD, data, NULL, length);
+  hrms_nrf24_sim_set_ce(HRMS_NRF24_SIM_PEER, true);
+  hrms_nrf24_sim_set_ce(HRMS_NRF24_SIM_PEER, false);
+
+  uint8_t status = peer_status();
+  for (uint32_t waited = 0; !(status & (NRF24L01_STATUS_TX_DS | NRF24L01_STATUS_MAX_RT)) &&
+       waited < PEER_TIMEOUT_US; waited += 10) {
+    host_advance_us(10);
+    status = peer_status();
+  }
+  if (status & NRF24L01_STATUS_MAX_RT) {
+    hrms_nrf24_sim_command(HRMS_NRF24_SIM_PEER, NRF24L01_CMD_FLUSH_TX, NULL, NULL, 0);
+  }
+  return (status & NRF24L01_STATUS_TX_DS) != 0;
+}
+
+static void test_clean_link(void) {
+  uint8_t payload[NRF24L01_MAX_PAYLOAD_SIZE];
+  uint8_t received[NRF24L01_MAX_PAYLOAD_SIZE];
+  hrms_nrf24_sim_stats_t stats;
+
+  CHECK(host_sim_start(0));
+  host_sim_peer_prx(false);
+
+  // Every length, in order, intact, first try
+  for (uint8_t length = 1; length <= NRF24L01_MAX_PAYLOAD_SIZE; length++) {
+    for (uint8_t i = 0; i < length; i++) {
+      payload[i] = (uint8_t)(length + i);
+    }
+    CHECK(hrms_nrf24l01_send(payload, length));
+    CHECK(host_sim_peer_receive(received) == length);
+    CHECK(memcmp(received, payload, length) == 0);
+    CHECK((hrms_nrf24l01_get_observe_tx() & 0x0F) == 0);
+  }
+
+  hrms_nrf24_sim_get_stats(&stats);
+  CHECK(stats.frames_on_air == NRF24L01_MAX_PAYLOAD_SIZE);
+  CHECK(stats.delivered == NRF24L01_MAX_PAYLOAD_SIZE);
+  CHECK(stats.max_rt == 0);
+
+  nrf24l01_tx_timing_t timing;
+  hrms_nrf24l01_get_tx_timing(&timing);
+  CHECK(timing.frames == NRF24L01_MAX_PAYLOAD_SIZE);
+  CHECK(hrms_nrf24l01_tx_state() == NRF24L01_TX_IDLE);
+}
+
+static void test_lossy_link(void) {
+  const uint16_t sends = 300;
+  uint8_t payload[4];
+  uint8_t received[NRF24L01_MAX_PAYLOAD_SIZE];
+  hrms_nrf24_sim_stats_t stats;
+  uint16_t ok = 0;
+  uint16_t got = 0;
+  int32_t last_seq = -1;
+
+  CHECK(host_sim_start(250));
+  host_sim_peer_prx(false);
+
+  for (uint16_t seq = 0; seq < sends; seq++) {
+    payload[0] = (uint8_t)seq;
+    payload[1] = (uint8_t)(seq >> 8);
+    payload[2] = 0xAA;
+    payload[3] = 0x55;
+    if (hrms_nrf24l01_send(payload, sizeof(payload))) {
+      ok++;
+    }
+
+    // Retransmits of an already received payload are filtered by PID
+    while (host_sim_peer_receive(received) == sizeof(payload)) {
+      int32_t rx_seq = received[0] | (received[1] << 8);
+      CHECK(rx_seq > last_seq);
+      last_seq = rx_seq;
+      got++;
+    }
+  }
+
+  hrms_nrf24_sim_get_stats(&stats);
+  CHECK(ok > 0 && ok < sends);
+  CHECK(stats.delivered == ok);
+  CHECK(stats.max_rt == (uint32_t)(sends - ok));
+  CHECK(stats.frames_on_air > sends);
+  CHECK(stats.frames_lost > 0 && stats.acks_lost > 0);
+  // A lost ACK fails a send the peer did get, never the other way round
+  CHECK(got >= ok && got <= sends);
+  printf("  loss 25%%: %u/%u ACKed, %u received, %u frames on air\n",
+         ok, sends, got, (unsigned)stats.frames_on_air);
+}
+
+static void test_receive(void) {
+  const uint8_t payload[] = "from peer";
+  uint8_t received[NRF24L01_MAX_PAYLOAD_SIZE];
+  uint8_t pipe = 0xFF;
+
+  CHECK(host_sim_start(0));
+  hrms_nrf24l01_start_listening();
+  CHECK(!hrms_nrf24l01_available());
+
+  peer_write(NRF24L01_REG_RF_CH, HOST_SIM_CHANNEL);
+  peer_write(NRF24L01_REG_RF_SETUP, 0x0E);
+  peer_write(NRF24L01_REG_FEATURE, NRF24L01_FEATURE_EN_DPL);
+  peer_write(NRF24L01_REG_DYNPD, 0x01);
+  CHECK(peer_send(payload, sizeof(payload)));
+
+  // IRQ line follows RX_DR
+  CHECK(hrms_nrf24_sim_irq(HRMS_NRF24_SIM_LOCAL));
+  CHECK(hrms_nrf24l01_available());
+  CHECK(hrms_nrf24l01_receive_from(received, sizeof(received), &pipe) == sizeof(payload));
+  CHECK(pipe == 0);
+  CHECK(memcmp(received, payload, sizeof(payload)) == 0);
+  CHECK(!hrms_nrf24l01_available());
+  CHECK(!hrms_nrf24_sim_irq(HRMS_NRF24_SIM_LOCAL));
+
+  // Not listening: no ACK, nothing received
+  hrms_nrf24l01_stop_listening();
+  CHECK(!peer_send(payload, sizeof(payload)));
+  CHECK(!hrms_nrf24l01_available());
+}
+
+static void test_ack_payload(void) {
+  const uint8_t request[] = "ping";
+  const uint8_t reply[] = "pong";
+  uint8_t received[NRF24L01_MAX_PAYLOAD_SIZE];
+  nrf24l01_config_t config = host_sim_config;
+
+  CHECK(host_sim_start(0));
+  config.ack_payload = true;
+  CHECK(hrms_nrf24l01_configure(&config));
+  host_sim_peer_prx(true);
+  host_sim_peer_ack_payload(reply, sizeof(reply));
+
+  // Reply rides back on the ACK and lands in the local RX FIFO
+  CHECK(hrms_nrf24l01_send(request, sizeof(request)));
+  CHECK(hrms_nrf24l01_available());
+  CHECK(hrms_nrf24l01_receive(received, sizeof(received)) == sizeof(reply));
+  CHECK(memcmp(received, reply, sizeof(reply)) == 0);
+  CHECK(host_sim_peer_receive(received) == sizeof(request));
+  CHECK(peer_status() & NRF24L01_STATUS_TX_DS);
+
+  // Nothing queued: a plain ACK
+  CHECK(hrms_nrf24l01_send(request, sizeof(request)));
+  CHECK(!hrms_nrf24l01_available());
+}
+
+static void test_channel_mismatch(void) {
+  const uint8_t payload[] = "lost";
+  uint8_t received[NRF24L01_MAX_PAYLOAD_SIZE];
+  hrms_nrf24_sim_stats_t stats;
+
+  CHECK(host_sim_start(0));
+  host_sim_peer_prx(false);
+  hrms_nrf24l01_set_channel(HOST_SIM_CHANNEL + 2);
+
+  // Original transmission plus host_sim_config.retries, then MAX_RT
+  CHECK(!hrms_nrf24l01_send(payload, sizeof(payload)));
+  CHECK(host_sim_peer_receive(received) == 0);
+  hrms_nrf24_sim_get_stats(&stats);
+  CHECK(stats.frames_on_air == 1U + host_sim_config.retries);
+  CHECK(stats.max_rt == 1);
+
+  hrms_nrf24l01_set_channel(HOST_SIM_CHANNEL);
+  CHECK(hrms_nrf24l01_send(payload, sizeof(payload)));
+  CHECK(host_sim_peer_receive(received) == sizeof(payload));
+}
+
+static void test_scan(void) {
+  uint8_t hits[NRF24L01_MAX_CHANNEL + 1];
+  uint8_t channel = 0;
+
+  CHECK(host_sim_start(0));
+  hrms_nrf24l01_start_listening();
+  hrms_nrf24_sim_set_channel_loss(40, 1000);   // Interferer always on air
+
+  uint32_t elapsed = hrms_nrf24l01_scan(hits, 8);
+  CHECK(elapsed > 0);
+  for (uint8_t ch = 0; ch <= NRF24L01_MAX_CHANNEL; ch++) {
+    CHECK(hits[ch] == ((ch == 40) ? 8 : 0));
+  }
+
+  // Back on the link channel, still listening
+  hrms_nrf24_sim_command(HRMS_NRF24_SIM_LOCAL, NRF24L01_CMD_R_REGISTER | NRF24L01_REG_RF_CH,
+                         NULL, &channel, 1);
+  CHECK(channel == HOST_SIM_CHANNEL);
+  CHECK(hrms_nrf24l01_is_listening());
+  hrms_nrf24_sim_set_channel_loss(40, 0);
+
+  // Simulated SPI is free, so this is all RX settle - slept through on target
+  printf("  sweep: %u channels in %u us\n", NRF24L01_MAX_CHANNEL + 1, (unsigned)elapsed);
+}
+
+int main(void) {
+  test_clean_link();
+  test_lossy_link();
+  test_receive();
+  test_ack_payload();
+  test_channel_mismatch();
+  test_scan();
+  return host_report("test_nrf24l01_sim");
+}
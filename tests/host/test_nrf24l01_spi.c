@@ -0,0 +1,277 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+/**
+ * @file test_nrf24l01_spi.c
+ * @brief SPI transaction checks for the nRF24L01 driver (HW_DMA transport)
+ *
+ * hrms_spi2_transfer_buffer() is replaced by a register-level mock of the
+ * chip that logs every NSS-framed transaction. The checks pin down what
+ * the register shadow and single-frame DMA transfers buy: cached reads
+ * and no-op writes never reach the bus, and a payload is one transfer.
+ * hrms_nrf24l01_init() is not called - it programs EXTI/NVIC directly.
+ */
+
+#include "host_stubs.h"
+#include "hrms_nrf24l01.h"
+#include "hrms_spi.h"
+#include "hrms_gpio.h"
+#include "hrms_pins.h"
+#include "stm32f1xx.h"
+#include <string.h>
+
+#define MOCK_LOG_SIZE   64
+#define MOCK_IRQ_FLAGS  (NRF24L01_STATUS_RX_DR | NRF24L01_STATUS_TX_DS | NRF24L01_STATUS_MAX_RT)
+
+typedef struct {
+  uint8_t cmd;
+  uint8_t len;      // Bytes on the bus, command byte included
+} mock_xfer_t;
+
+static uint8_t mock_regs[0x20];
+static uint8_t mock_status;                         // IRQ flags, RX_P_NO, TX_FULL
+static uint8_t mock_rx[NRF24L01_MAX_PAYLOAD_SIZE];
+static uint8_t mock_rx_len;
+static mock_xfer_t mock_log[MOCK_LOG_SIZE];
+static uint32_t mock_xfers;
+static uint32_t mock_bytes;
+
+static uint32_t nss_port(void) {
+  return (uint32_t)(uintptr_t)HRMS_NRF24L01_SPI_PORT;
+}
+
+static uint32_t ce_port(void) {
+  return (uint32_t)(uintptr_t)HRMS_NRF24L01_CE_PORT;
+}
+
+int hrms_spi2_init(void) {
+  return 0;
+}
+
+int hrms_spi2_transfer_buffer(const uint8_t *tx_data, uint8_t *rx_data, size_t len) {
+  // Every command must sit inside its own NSS-low window
+  CHECK(!host_gpio_level(nss_port(), HRMS_NRF24L01_NSS_PIN));
+  CHECK(len >= 1 && len <= NRF24L01_MAX_PAYLOAD_SIZE + 1);
+
+  uint8_t cmd = tx_data[0];
+  if (mock_xfers < MOCK_LOG_SIZE) {
+    mock_log[mock_xfers].cmd = cmd;
+    mock_log[mock_xfers].len = (uint8_t)len;
+  }
+  mock_xfers++;
+  mock_bytes += (uint32_t)len;
+
+  rx_data[0] = mock_status;
+  memset(&rx_data[1], 0, len - 1);
+
+  if (cmd == NRF24L01_CMD_R_RX_PL_WID) {
+    rx_data[1] = mock_rx_len;
+  } else if (cmd == NRF24L01_CMD_R_RX_PAYLOAD) {
+    memcpy(&rx_data[1], mock_rx, len - 1);
+  } else if ((cmd & 0xE0) == NRF24L01_CMD_R_REGISTER && len > 1) {
+    rx_data[1] = mock_regs[cmd & 0x1F];
+  } else if ((cmd & 0xE0) == NRF24L01_CMD_W_REGISTER && len > 1) {
+    uint8_t reg = cmd & 0x1F;
+    if (reg == NRF24L01_REG_STATUS) {
+      mock_status &= (uint8_t)~(tx_data[1] & MOCK_IRQ_FLAGS);
+    } else {
+      mock_regs[reg] = tx_data[1];
+    }
+  }
+  return 0;
+}
+
+static void mock_clear_log(void) {
+  mock_xfers = 0;
+  mock_bytes = 0;
+}
+
+static uint32_t mock_count(uint8_t cmd) {
+  uint32_t count = 0;
+  for (uint32_t i = 0; i < mock_xfers && i < MOCK_LOG_SIZE; i++) {
+    if (mock_log[i].cmd == cmd) {
+      count++;
+    }
+  }
+  return count;
+}
+
+static void report_bytes(const char *what) {
+  printf("  %-28s %2u transfers %3u bytes\n", what, (unsigned)mock_xfers, (unsigned)mock_bytes);
+}
+
+static const nrf24l01_config_t test_config = {
+  .channel = 76,
+  .power = NRF24L01_POWER_0DBM,
+  .datarate = NRF24L01_DATARATE_2MBPS,
+  .address = {0xE7, 0xE7, 0xE7, 0xE7, 0xE7},
+  .auto_ack = true,
+  .retries = 3,
+  .retry_delay = 5,
+  .dynamic_payload = true,
+  .ack_payload = false,
+  .rx_pipes = 1,
+};
+
+static void test_configure(void) {
+  // Cold shadow: every register goes out once
+  mock_clear_log();
+  CHECK(hrms_nrf24l01_configure(&test_config));
+  CHECK(mock_regs[NRF24L01_REG_RF_CH] == 76);
+  CHECK(mock_regs[NRF24L01_REG_CONFIG] & NRF24L01_CONFIG_PWR_UP);
+  uint32_t cold = mock_xfers;
+  report_bytes("configure (cold)");
+
+  // Warm shadow: only CONFIG (power cycle), the two multi-byte address
+  // writes and the FEATURE read-back remain
+  mock_clear_log();
+  CHECK(hrms_nrf24l01_configure(&test_config));
+  CHECK(mock_xfers == 5);
+  CHECK(mock_count(NRF24L01_CMD_W_REGISTER | NRF24L01_REG_CONFIG) == 2);
+  CHECK(mock_count(NRF24L01_CMD_R_REGISTER | NRF24L01_REG_CONFIG) == 0);
+  CHECK(mock_count(NRF24L01_CMD_W_REGISTER | NRF24L01_REG_RF_CH) == 0);
+  CHECK(mock_xfers < cold);
+  report_bytes("configure (warm)");
+}
+
+static void test_mode_switch(void) {
+  // CONFIG comes from the shadow: a mode switch is one 2-byte write
+  mock_clear_log();
+  hrms_nrf24l01_start_listening();
+  CHECK(mock_xfers == 1 && mock_bytes == 2);
+  CHECK(mock_regs[NRF24L01_REG_CONFIG] & NRF24L01_CONFIG_PRIM_RX);
+  CHECK(host_gpio_level(ce_port(), HRMS_NRF24L01_CE_PIN));
+  report_bytes("start_listening");
+
+  mock_clear_log();
+  hrms_nrf24l01_stop_listening();
+  CHECK(mock_xfers == 1 && mock_bytes == 2);
+  CHECK(!(mock_regs[NRF24L01_REG_CONFIG] & NRF24L01_CONFIG_PRIM_RX));
+  CHECK(!host_gpio_level(ce_port(), HRMS_NRF24L01_CE_PIN));
+  report_bytes("stop_listening");
+}
+
+static void test_set_channel(void) {
+  mock_clear_log();
+  hrms_nrf24l01_set_channel(76);
+  CHECK(mock_xfers == 0);
+
+  hrms_nrf24l01_set_channel(40);
+  CHECK(mock_xfers == 1 && mock_bytes == 2);
+  CHECK(mock_regs[NRF24L01_REG_RF_CH] == 40);
+  report_bytes("set_channel (1 change)");
+}
+
+static void test_payload_write(void) {
+  uint8_t payload[NRF24L01_MAX_PAYLOAD_SIZE];
+  for (uint8_t i = 0; i < sizeof(payload); i++) {
+    payload[i] = i;
+  }
+
+  // Full payload: command byte plus 32 data bytes in one DMA transfer
+  mock_clear_log();
+  CHECK(hrms_nrf24l01_enqueue(payload, sizeof(payload), 7));
+  CHECK(mock_xfers == 1);
+  CHECK(mock_log[0].cmd == NRF24L01_CMD_W_TX_PAYLOAD);
+  CHECK(mock_log[0].len == NRF24L01_MAX_PAYLOAD_SIZE + 1);
+  CHECK(host_gpio_level(ce_port(), HRMS_NRF24L01_CE_PIN));
+  report_bytes("enqueue (32 bytes)");
+
+  // Delivered: STATUS via NOP and clear TX_DS; one in flight needs no FIFO_STATUS
+  mock_status |= NRF24L01_STATUS_TX_DS;
+  mock_regs[NRF24L01_REG_FIFO_STATUS] = NRF24L01_FIFO_TX_EMPTY | NRF24L01_FIFO_RX_EMPTY;
+  mock_clear_log();
+  hrms_nrf24l01_process_tx();
+  CHECK(hrms_nrf24l01_tx_pending() == 0);
+  CHECK(mock_xfers == 2 && mock_bytes == 3);
+  CHECK(!(mock_status & NRF24L01_STATUS_TX_DS));
+  CHECK(!host_gpio_level(ce_port(), HRMS_NRF24L01_CE_PIN));
+  report_bytes("process_tx (delivered)");
+}
+
+static bool max_rt_results[NRF24L01_TX_PIPELINE_DEPTH];
+static uint8_t max_rt_count;
+
+static void on_tx_done(uint8_t tag, bool success) {
+  (void)tag;
+  if (max_rt_count < NRF24L01_TX_PIPELINE_DEPTH) {
+    max_rt_results[max_rt_count] = success;
+  }
+  max_rt_count++;
+}
+
+static void test_max_rt(void) {
+  uint8_t payload[8] = {0};
+
+  hrms_nrf24l01_set_tx_callback(on_tx_done);
+  max_rt_count = 0;
+  CHECK(hrms_nrf24l01_enqueue(payload, sizeof(payload), 1));
+  CHECK(hrms_nrf24l01_enqueue(payload, sizeof(payload), 2));
+  CHECK(!hrms_nrf24l01_enqueue(payload, sizeof(payload), 3));
+
+  // First ACKed, second ran out of retries: flush and clear, nothing written
+  mock_status |= NRF24L01_STATUS_TX_DS | NRF24L01_STATUS_MAX_RT;
+  mock_clear_log();
+  hrms_nrf24l01_process_tx();
+  CHECK(hrms_nrf24l01_tx_pending() == 0);
+  CHECK(max_rt_count == 2 && max_rt_results[0] && !max_rt_results[1]);
+  CHECK(mock_count(NRF24L01_CMD_W_TX_PAYLOAD) == 0);
+  CHECK(mock_count(NRF24L01_CMD_FLUSH_TX) == 1);
+  CHECK(!(mock_status & (NRF24L01_STATUS_TX_DS | NRF24L01_STATUS_MAX_RT)));
+  report_bytes("process_tx (MAX_RT)");
+  hrms_nrf24l01_set_tx_callback(NULL);
+}
+
+static void test_receive(void) {
+  uint8_t data[NRF24L01_MAX_PAYLOAD_SIZE];
+
+  mock_rx_len = 12;
+  for (uint8_t i = 0; i < mock_rx_len; i++) {
+    mock_rx[i] = (uint8_t)(0xA0 + i);
+  }
+  mock_status = NRF24L01_STATUS_RX_DR | (1 << 1); // Pipe 1
+
+  // NOP for RX_P_NO, width, payload, clear RX_DR
+  mock_clear_log();
+  uint8_t pipe = 0xFF;
+  CHECK(hrms_nrf24l01_receive_from(data, sizeof(data), &pipe) == 12);
+  CHECK(pipe == 1);
+  CHECK(memcmp(data, mock_rx, 12) == 0);
+  CHECK(mock_xfers == 4);
+  CHECK(mock_log[0].cmd == NRF24L01_CMD_NOP && mock_log[0].len == 1);
+  CHECK(mock_log[1].cmd == NRF24L01_CMD_R_RX_PL_WID && mock_log[1].len == 2);
+  CHECK(mock_log[2].cmd == NRF24L01_CMD_R_RX_PAYLOAD && mock_log[2].len == 13);
+  CHECK(mock_log[3].cmd == (NRF24L01_CMD_W_REGISTER | NRF24L01_REG_STATUS));
+  CHECK(mock_bytes == 18);
+  CHECK(!(mock_status & NRF24L01_STATUS_RX_DR));
+  report_bytes("receive_from (12 bytes)");
+
+  // Empty FIFO costs a single STATUS byte
+  mock_status = NRF24L01_STATUS_RX_P_NO_EMPTY;
+  mock_clear_log();
+  CHECK(hrms_nrf24l01_receive_from(data, sizeof(data), NULL) == 0);
+  CHECK(mock_xfers == 1 && mock_bytes == 1);
+}
+
+int main(void) {
+  // NSS idles high; init() is skipped, so raise it here
+  hrms_gpio_set_pin(nss_port(), HRMS_NRF24L01_NSS_PIN);
+  mock_regs[NRF24L01_REG_CONFIG] = 0x08;
+  mock_status = NRF24L01_STATUS_RX_P_NO_EMPTY;
+
+  test_configure();
+  test_mode_switch();
+  test_set_channel();
+  test_payload_write();
+  test_max_rt();
+  test_receive();
+
+  CHECK(host_gpio_level(nss_port(), HRMS_NRF24L01_NSS_PIN));
+  return host_report("test_nrf24l01_spi");
+}
@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+/**
+ * @file test_nrf24l01_star.c
+ * @brief Six-pipe star receiver against six simulated transmitters
+ *
+ * Built with HRMS_NRF24_RX_PIPES=6. The communication hub runs on the
+ * local radio as the base station; simulator radios 1-6 are the nodes,
+ * each sending to its own pipe address. Checks that the driver reports
+ * the pipe of every payload, that the hub counts each node under its own
+ * source, and that a node on an unopened pipe is never ACKed.
+ */
+
+#include "host_stubs.h"
+#include "host_sim.h"
+#include "hrms_communication_hub.h"
+#include "hrms_packet_utils.h"
+#include <string.h>
+
+#define STAR_NODES        NRF24L01_RX_PIPES
+#define STAR_STEP_US      10
+#define STAR_TIMEOUT_US   200000
+
+static uint8_t node_radio(uint8_t node) {
+  return (uint8_t)(HRMS_NRF24_SIM_PEER + node);
+}
+
+static void make_frame(uint8_t node, uint8_t seq, uint8_t *frame) {
+  hrms_comm_packet_t packet;
+  memset(&packet, 0, sizeof(packet));
+  packet.packet_type = HRMS_COMM_PACKET_STATUS;
+  packet.packet_id = seq;
+  packet.source_id = node;
+  packet.dest_id = 0x01;
+  packet.payload_size = 1;
+  packet.payload[0] = seq;
+
+  memset(frame, 0, NRF24L01_MAX_PAYLOAD_SIZE);
+  CHECK(hrms_packet_encode(&packet, frame, NRF24L01_MAX_PAYLOAD_SIZE) > 0);
+}
+
+static uint8_t wait_result(uint8_t radio) {
+  for (uint32_t waited = 0; waited < STAR_TIMEOUT_US; waited += STAR_STEP_US) {
+    uint8_t result = host_sim_node_result(radio);
+    if (result) {
+      return result;
+    }
+    host_advance_us(STAR_STEP_US);
+  }
+  return 0;
+}
+
+static void test_pipe_routing(void) {
+  uint8_t frame[NRF24L01_MAX_PAYLOAD_SIZE];
+  uint8_t data[NRF24L01_MAX_PAYLOAD_SIZE];
+
+  // One at a time, in reverse so pipe and send order differ
+  for (int node = STAR_NODES - 1; node >= 0; node--) {
+    memset(frame, 0, sizeof(frame));
+    frame[0] = (uint8_t)(0xA0 + node);
+    host_sim_node_load(node_radio((uint8_t)node), frame);
+    CHECK(wait_result(node_radio((uint8_t)node)) == NRF24L01_STATUS_TX_DS);
+
+    uint8_t pipe = 0xFF;
+    CHECK(hrms_nrf24l01_receive_from(data, sizeof(data), &pipe) == NRF24L01_MAX_PAYLOAD_SIZE);
+    CHECK(pipe == node);
+    CHECK(data[0] == 0xA0 + node);
+  }
+}
+
+static void test_source_stats(void) {
+  uint8_t frames[STAR_NODES][NRF24L01_MAX_PAYLOAD_SIZE];
+  uint8_t sent[STAR_NODES] = {0};
+  bool busy[STAR_NODES] = {false};
+  uint8_t data[NRF24L01_MAX_PAYLOAD_SIZE];
+  size_t len;
+  uint32_t resends = 0;
+  uint32_t start = host_now_us();
+
+  // Node n sends n + 1 frames; all six transmit at once
+  for (uint32_t waited = 0; waited < STAR_TIMEOUT_US; waited += STAR_STEP_US) {
+    bool done = true;
+    for (uint8_t node = 0; node < STAR_NODES; node++) {
+      if (busy[node]) {
+        uint8_t result = host_sim_node_result(node_radio(node));
+        if (result & NRF24L01_STATUS_TX_DS) {
+          sent[node]++;
+          busy[node] = false;
+        } else if (result & NRF24L01_STATUS_MAX_RT) {
+          resends++;
+          busy[node] = false;
+        }
+      }
+      if (!busy[node] && sent[node] < node + 1) {
+        make_frame(node, sent[node], frames[node]);
+        host_sim_node_load(node_radio(node), frames[node]);
+        busy[node] = true;
+      }
+      done = done && sent[node] == node + 1;
+    }
+
+    while (hrms_communication_hub_receive(data, sizeof(data), &len)) {
+      CHECK(len == NRF24L01_MAX_PAYLOAD_SIZE);
+    }
+    if (done) {
+      break;
+    }
+    host_advance_us(STAR_STEP_US);
+  }
+
+  uint32_t total = 0;
+  for (uint8_t node = 0; node < STAR_NODES; node++) {
+    hrms_comm_source_stats_t stats;
+    CHECK(sent[node] == node + 1);
+    CHECK(hrms_communication_hub_get_source_stats(node, &stats));
+    CHECK(stats.packets_received == (uint32_t)node + 1);
+    CHECK(stats.bytes_received == ((uint32_t)node + 1) * NRF24L01_MAX_PAYLOAD_SIZE);
+    total += stats.packets_received;
+  }
+
+  hrms_comm_stats_t comm;
+  hrms_communication_hub_get_stats(&comm);
+  CHECK(comm.packets_received == total);
+  CHECK(!hrms_communication_hub_get_source_stats(STAR_NODES, NULL));
+
+  printf("  %u nodes, %u frames in %u us, %u MAX_RT resends\n", STAR_NODES, (unsigned)total,
+         (unsigned)(host_now_us() - start), (unsigned)resends);
+}
+
+static void test_unopened_pipe(void) {
+  uint8_t frame[NRF24L01_MAX_PAYLOAD_SIZE] = {0xEE};
+  uint8_t data[NRF24L01_MAX_PAYLOAD_SIZE];
+  size_t len;
+  hrms_comm_stats_t before, after;
+
+  // Pipe 6 does not exist: no ACK, nothing lands in any source
+  hrms_communication_hub_get_stats(&before);
+  host_sim_node_ptx(node_radio(0), STAR_NODES);
+  host_sim_node_load(node_radio(0), frame);
+  CHECK(wait_result(node_radio(0)) == NRF24L01_STATUS_MAX_RT);
+  CHECK(!hrms_communication_hub_receive(data, sizeof(data), &len));
+  hrms_communication_hub_get_stats(&after);
+  CHECK(after.packets_received == before.packets_received);
+}
+
+int main(void) {
+  host_sim_reset(0);
+  hrms_communication_hub_init();
+  CHECK(hrms_nrf24l01_is_listening());
+
+  for (uint8_t node = 0; node < STAR_NODES; node++) {
+    host_sim_node_ptx(node_radio(node), node);
+  }
+
+  test_pipe_routing();
+  test_source_stats();
+  test_unopened_pipe();
+  return host_report("test_nrf24l01_star");
+}
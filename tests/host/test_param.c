@@ -0,0 +1,244 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+/**
+ * @file test_param.c
+ * @brief Parameter registry: TLV get/set, range and hook refusals, bad input
+ *
+ * Requests are built with hrms_param_make_request() or by hand where they
+ * must be malformed, answered with hrms_param_handle() and the reply read
+ * back with hrms_param_next_tlv(), as the two ends of the link do.
+ */
+
+#include "host_stubs.h"
+#include "hrms_param.h"
+#include "hrms_nrf24l01.h"
+#include "hrms_config.h"
+#include <string.h>
+
+#define PARAM_BUF   32
+
+static uint8_t reply[PARAM_BUF];
+static size_t reply_len;
+static uint32_t hook_calls;
+
+static bool hook_refuse(uint32_t value) {
+  (void)value;
+  hook_calls++;
+  return false;
+}
+
+static bool hook_accept(uint32_t value) {
+  (void)value;
+  hook_calls++;
+  return true;
+}
+
+static void handle(const uint8_t *request, size_t len) {
+  memset(reply, 0, sizeof(reply));
+  reply_len = hrms_param_handle(request, len, reply, sizeof(reply));
+}
+
+// TLV n of the reply
+static bool reply_tlv(uint8_t n, hrms_param_tlv_t *tlv) {
+  size_t offset = HRMS_PARAM_HEADER_SIZE;
+  for (uint8_t i = 0; i <= n; i++) {
+    if (!hrms_param_next_tlv(reply, reply_len, &offset, tlv)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static uint8_t reply_count(void) {
+  hrms_param_tlv_t tlv;
+  uint8_t count = 0;
+  while (reply_tlv(count, &tlv)) {
+    count++;
+  }
+  return count;
+}
+
+static void test_get(void) {
+  static const uint8_t sizes[HRMS_PARAM_COUNT] = {2, 2, 1, 2};
+  hrms_param_tlv_t tlv;
+  uint8_t request[PARAM_BUF];
+  hrms_param_init();
+
+  // Bare GET: every parameter, in id order, at its default
+  size_t len = hrms_param_make_request(HRMS_PARAM_OP_GET, 7, NULL, NULL, 0, request, sizeof(request));
+  CHECK(len == HRMS_PARAM_HEADER_SIZE);
+  handle(request, len);
+  CHECK(reply[0] == HRMS_PARAM_OP_REPLY && reply[1] == 7);
+  CHECK(reply_count() == HRMS_PARAM_COUNT);
+  for (uint8_t id = 0; id < HRMS_PARAM_COUNT; id++) {
+    CHECK(reply_tlv(id, &tlv) && tlv.id == id && !tlv.error && tlv.len == sizes[id]);
+    CHECK(tlv.value == hrms_param_get((hrms_param_id_t)id));
+  }
+  CHECK(hrms_param_get(HRMS_PARAM_JOYSTICK_DEADZONE) == HRMS_JOYSTICK_DEADZONE);
+  CHECK(hrms_param_get(HRMS_PARAM_TX_INTERVAL_MS) == HRMS_COMM_TX_INTERVAL_MS);
+  CHECK(hrms_param_get(HRMS_PARAM_RADIO_CHANNEL) == HRMS_NRF24_CHANNEL);
+
+  // Named ids only, in request order
+  const hrms_param_id_t ids[2] = {HRMS_PARAM_RADIO_CHANNEL, HRMS_PARAM_JOYSTICK_DEADZONE};
+  len = hrms_param_make_request(HRMS_PARAM_OP_GET, 8, ids, NULL, 2, request, sizeof(request));
+  CHECK(len == HRMS_PARAM_HEADER_SIZE + 2 * HRMS_PARAM_TLV_HEADER_SIZE);
+  handle(request, len);
+  CHECK(reply_count() == 2);
+  CHECK(reply_tlv(0, &tlv) && tlv.id == HRMS_PARAM_RADIO_CHANNEL && tlv.value == HRMS_NRF24_CHANNEL);
+  CHECK(reply_tlv(1, &tlv) && tlv.id == HRMS_PARAM_JOYSTICK_DEADZONE);
+
+  // Only what fits the reply
+  reply_len = hrms_param_handle(request, len, reply, HRMS_PARAM_HEADER_SIZE + 3);
+  CHECK(reply_len == HRMS_PARAM_HEADER_SIZE + 3);
+  CHECK(reply_count() == 1);
+}
+
+static void test_set(void) {
+  hrms_param_tlv_t tlv;
+  uint8_t request[PARAM_BUF];
+  hrms_param_init();
+
+  const hrms_param_id_t ids[2] = {HRMS_PARAM_JOYSTICK_DEADZONE, HRMS_PARAM_TX_INTERVAL_MS};
+  const uint32_t values[2] = {750, 20};
+  size_t len = hrms_param_make_request(HRMS_PARAM_OP_SET, 1, ids, values, 2, request, sizeof(request));
+  CHECK(len == HRMS_PARAM_HEADER_SIZE + 2 * (HRMS_PARAM_TLV_HEADER_SIZE + 2));
+  handle(request, len);
+  CHECK(reply_count() == 2);
+  CHECK(reply_tlv(0, &tlv) && !tlv.error && tlv.value == 750);
+  CHECK(reply_tlv(1, &tlv) && !tlv.error && tlv.value == 20);
+  CHECK(hrms_param_get(HRMS_PARAM_JOYSTICK_DEADZONE) == 750);
+  CHECK(hrms_param_get(HRMS_PARAM_TX_INTERVAL_MS) == 20);
+
+  // Out of range on either side: flagged, old value reported and kept
+  const hrms_param_id_t range_ids[2] = {HRMS_PARAM_JOYSTICK_DEADZONE, HRMS_PARAM_SAMPLE_INTERVAL_MS};
+  const uint32_t range_values[2] = {1501, 0};
+  uint32_t sample = hrms_param_get(HRMS_PARAM_SAMPLE_INTERVAL_MS);
+  len = hrms_param_make_request(HRMS_PARAM_OP_SET, 2, range_ids, range_values, 2,
+                                request, sizeof(request));
+  handle(request, len);
+  CHECK(reply_tlv(0, &tlv) && tlv.error && tlv.id == HRMS_PARAM_JOYSTICK_DEADZONE && tlv.value == 750);
+  CHECK(reply_tlv(1, &tlv) && tlv.error && tlv.value == sample);
+  CHECK(hrms_param_get(HRMS_PARAM_JOYSTICK_DEADZONE) == 750);
+  CHECK(hrms_param_get(HRMS_PARAM_SAMPLE_INTERVAL_MS) == sample);
+  CHECK(!hrms_param_set(HRMS_PARAM_RADIO_CHANNEL, NRF24L01_MAX_CHANNEL + 1));
+
+  // A U16 sent as one byte is refused whatever its value
+  const uint8_t short_value[] = {HRMS_PARAM_OP_SET, 3, HRMS_PARAM_JOYSTICK_DEADZONE, 1, 100};
+  handle(short_value, sizeof(short_value));
+  CHECK(reply_count() == 1);
+  CHECK(reply_tlv(0, &tlv) && tlv.error && tlv.value == 750);
+  CHECK(hrms_param_get(HRMS_PARAM_JOYSTICK_DEADZONE) == 750);
+}
+
+static void test_hook(void) {
+  hrms_param_tlv_t tlv;
+  uint8_t request[PARAM_BUF];
+  const hrms_param_id_t id = HRMS_PARAM_RADIO_CHANNEL;
+  uint32_t channel = 90;
+  hrms_param_init();
+  hook_calls = 0;
+
+  hrms_param_set_hook(id, hook_refuse);
+  size_t len = hrms_param_make_request(HRMS_PARAM_OP_SET, 1, &id, &channel, 1, request, sizeof(request));
+  handle(request, len);
+  CHECK(hook_calls == 1);
+  CHECK(reply_tlv(0, &tlv) && tlv.error && tlv.value == HRMS_NRF24_CHANNEL);
+  CHECK(hrms_param_get(id) == HRMS_NRF24_CHANNEL);
+
+  // Out of range never reaches the hook
+  channel = NRF24L01_MAX_CHANNEL + 1;
+  len = hrms_param_make_request(HRMS_PARAM_OP_SET, 2, &id, &channel, 1, request, sizeof(request));
+  handle(request, len);
+  CHECK(hook_calls == 1);
+
+  hrms_param_set_hook(id, hook_accept);
+  channel = 90;
+  len = hrms_param_make_request(HRMS_PARAM_OP_SET, 3, &id, &channel, 1, request, sizeof(request));
+  handle(request, len);
+  CHECK(hook_calls == 2);
+  CHECK(reply_tlv(0, &tlv) && !tlv.error && tlv.value == 90);
+
+  // A change the owner made itself is recorded without the hook
+  hrms_param_update(id, 12);
+  CHECK(hook_calls == 2 && hrms_param_get(id) == 12);
+
+  // init drops the hooks
+  hrms_param_init();
+  CHECK(hrms_param_set(id, 40) && hook_calls == 2);
+}
+
+static void test_unknown(void) {
+  hrms_param_tlv_t tlv;
+  uint8_t request[PARAM_BUF];
+  hrms_param_init();
+
+  const hrms_param_id_t bad = HRMS_PARAM_COUNT;
+  CHECK(hrms_param_make_request(HRMS_PARAM_OP_GET, 1, &bad, NULL, 1, request, sizeof(request)) == 0);
+  CHECK(hrms_param_get(bad) == 0);
+  CHECK(!hrms_param_set(bad, 1));
+
+  // Flagged with no value; the known id after it is still answered
+  const uint8_t get[] = {HRMS_PARAM_OP_GET, 4, 0x20, 0, HRMS_PARAM_TX_INTERVAL_MS, 0};
+  handle(get, sizeof(get));
+  CHECK(reply_count() == 2);
+  CHECK(reply_tlv(0, &tlv) && tlv.error && tlv.id == 0x20 && tlv.len == 0);
+  CHECK(reply_tlv(1, &tlv) && !tlv.error && tlv.value == HRMS_COMM_TX_INTERVAL_MS);
+
+  const uint8_t set[] = {HRMS_PARAM_OP_SET, 5, 0x20, 2, 0x34, 0x12};
+  handle(set, sizeof(set));
+  CHECK(reply_count() == 1);
+  CHECK(reply_tlv(0, &tlv) && tlv.error && tlv.len == 0);
+
+  // Not a request at all
+  const uint8_t not_request[] = {HRMS_PARAM_OP_REPLY, 6};
+  handle(not_request, sizeof(not_request));
+  CHECK(reply_len == 0);
+  handle(not_request, 1);
+  CHECK(reply_len == 0);
+}
+
+static void test_truncated(void) {
+  hrms_param_tlv_t tlv;
+  size_t offset;
+  hrms_param_init();
+
+  // Value cut short, header cut short, length past a 32-bit value
+  const uint8_t cut_value[] = {HRMS_PARAM_OP_SET, 1, HRMS_PARAM_JOYSTICK_DEADZONE, 2, 0x10};
+  const uint8_t cut_header[] = {HRMS_PARAM_OP_SET, 1, HRMS_PARAM_JOYSTICK_DEADZONE};
+  const uint8_t too_long[] = {HRMS_PARAM_OP_SET, 1, HRMS_PARAM_JOYSTICK_DEADZONE, 5, 1, 2, 3, 4, 5};
+  offset = HRMS_PARAM_HEADER_SIZE;
+  CHECK(!hrms_param_next_tlv(cut_value, sizeof(cut_value), &offset, &tlv));
+  CHECK(offset == HRMS_PARAM_HEADER_SIZE);
+  CHECK(!hrms_param_next_tlv(cut_header, sizeof(cut_header), &offset, &tlv));
+  CHECK(!hrms_param_next_tlv(too_long, sizeof(too_long), &offset, &tlv));
+
+  // Nothing is applied or answered from a truncated TLV
+  handle(cut_value, sizeof(cut_value));
+  CHECK(reply_len == HRMS_PARAM_HEADER_SIZE);
+  CHECK(hrms_param_get(HRMS_PARAM_JOYSTICK_DEADZONE) == HRMS_JOYSTICK_DEADZONE);
+
+  // Whole TLVs ahead of the cut still go through
+  const uint8_t partial[] = {HRMS_PARAM_OP_SET, 2, HRMS_PARAM_TX_INTERVAL_MS, 2, 0x2C, 0x01,
+                             HRMS_PARAM_JOYSTICK_DEADZONE, 2, 0x10};
+  handle(partial, sizeof(partial));
+  CHECK(reply_count() == 1);
+  CHECK(reply_tlv(0, &tlv) && !tlv.error && tlv.value == 300);
+  CHECK(hrms_param_get(HRMS_PARAM_TX_INTERVAL_MS) == 300);
+  CHECK(hrms_param_get(HRMS_PARAM_JOYSTICK_DEADZONE) == HRMS_JOYSTICK_DEADZONE);
+}
+
+int main(void) {
+  test_get();
+  test_set();
+  test_hook();
+  test_unknown();
+  test_truncated();
+  return host_report("test_param");
+}
@@ -0,0 +1,304 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+/**
+ * @file test_reliable.c
+ * @brief Selective-repeat window: reordering, duplicates, give-up, wrap, restart
+ *
+ * The module holds both window ends, so it talks to itself: every frame it
+ * sends lands on a captured wire, and the test decides which frames reach
+ * the other end, in which order and how often.
+ */
+
+#include "host_stubs.h"
+#include "hrms_reliable.h"
+#include "hrms_packet_utils.h"
+#include "hrms_config.h"
+#include <string.h>
+
+#define WIRE_FRAMES     32
+#define REL_MAX_LOG     512
+
+static uint8_t wire[WIRE_FRAMES][HRMS_WIRE_MAX_FRAME_SIZE];
+static size_t wire_len[WIRE_FRAMES];
+static uint8_t wire_count;
+
+static uint16_t delivered[REL_MAX_LOG];
+static uint32_t delivered_count;
+
+static uint32_t now_ms;
+
+static bool wire_tx(const uint8_t *frame, size_t len) {
+  CHECK(wire_count < WIRE_FRAMES);
+  if (wire_count < WIRE_FRAMES) {
+    memcpy(wire[wire_count], frame, len);
+    wire_len[wire_count++] = len;
+  }
+  return true;
+}
+
+static void record(const hrms_comm_packet_t *packet) {
+  if (delivered_count < REL_MAX_LOG) {
+    delivered[delivered_count] = (uint16_t)(packet->payload[0] | (packet->payload[1] << 8));
+  }
+  delivered_count++;
+}
+
+static void reset(void) {
+  hrms_reliable_init(wire_tx, record);
+  wire_count = 0;
+  delivered_count = 0;
+  now_ms = 1000;
+}
+
+static hrms_comm_packet_t frame_at(uint8_t index) {
+  hrms_comm_packet_t packet;
+  CHECK(hrms_packet_decode(wire[index], wire_len[index], &packet));
+  return packet;
+}
+
+static void make_data(hrms_comm_packet_t *packet, uint16_t marker) {
+  memset(packet, 0, sizeof(*packet));
+  packet->packet_type = HRMS_COMM_PACKET_STATUS;
+  packet->source_id = 0x01;
+  packet->dest_id = 0x02;
+  packet->payload_size = 2;
+  packet->payload[0] = (uint8_t)marker;
+  packet->payload[1] = (uint8_t)(marker >> 8);
+}
+
+static bool send(uint16_t marker) {
+  hrms_comm_packet_t packet;
+  make_data(&packet, marker);
+  return hrms_reliable_send(&packet, now_ms);
+}
+
+// Hand frame i to the other end: data to the receiver, ACKs to the sender
+static void deliver(uint8_t index) {
+  hrms_comm_packet_t packet = frame_at(index);
+  if (packet.packet_type == HRMS_COMM_PACKET_ACK) {
+    hrms_reliable_on_ack(&packet);
+  } else {
+    hrms_reliable_on_receive(&packet, now_ms);
+  }
+}
+
+// Deliver everything on the wire, including what that provokes, in order
+static void flush(void) {
+  for (uint8_t i = 0; i < wire_count; i++) {
+    deliver(i);
+  }
+  wire_count = 0;
+}
+
+static bool delivered_in_order(uint16_t first, uint32_t count) {
+  if (delivered_count != count) {
+    return false;
+  }
+  for (uint32_t i = 0; i < count; i++) {
+    if (delivered[i] != (uint16_t)(first + i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void test_out_of_order(void) {
+  static const uint8_t order[HRMS_RELIABLE_WINDOW] = {2, 0, 3, 1};
+  static const uint8_t out[HRMS_RELIABLE_WINDOW] = {0, 1, 1, 4};   // Delivered after each
+  hrms_reliable_stats_t stats;
+  reset();
+
+  for (uint16_t i = 0; i < HRMS_RELIABLE_WINDOW; i++) {
+    CHECK(send(i));
+  }
+  CHECK(!send(99));   // Window full
+  CHECK(hrms_reliable_in_flight() == HRMS_RELIABLE_WINDOW);
+
+  // Nothing comes out until the gap at 0 is filled, then all in order
+  uint8_t sent = wire_count;
+  for (uint8_t i = 0; i < sent; i++) {
+    deliver(order[i]);
+    CHECK(delivered_count == out[i]);
+  }
+  CHECK(delivered_in_order(0, HRMS_RELIABLE_WINDOW));
+
+  // One ACK per data frame; the last cumulative one covers them all
+  CHECK(wire_count == sent * 2);
+  for (uint8_t i = sent; i < wire_count; i++) {
+    deliver(i);
+  }
+  wire_count = 0;
+  CHECK(hrms_reliable_in_flight() == 0);
+
+  hrms_reliable_get_stats(&stats);
+  CHECK(stats.sent == HRMS_RELIABLE_WINDOW && stats.acked == HRMS_RELIABLE_WINDOW);
+  CHECK(stats.duplicates == 0 && stats.retransmits == 0);
+}
+
+static void test_duplicates(void) {
+  hrms_reliable_stats_t stats;
+  reset();
+
+  CHECK(send(0));
+  CHECK(send(1));
+  deliver(0);               // Data 0 -> ACK {0, 1} at index 2
+  CHECK(wire_count == 3);
+
+  // The same ACK twice acknowledges once
+  deliver(2);
+  deliver(2);
+  hrms_reliable_get_stats(&stats);
+  CHECK(stats.acked == 1);
+  CHECK(hrms_reliable_in_flight() == 1);
+
+  // A retransmit of delivered data is dropped, but ACKed again
+  deliver(0);
+  CHECK(wire_count == 4);
+  CHECK(frame_at(3).packet_type == HRMS_COMM_PACKET_ACK);
+  CHECK(delivered_in_order(0, 1));
+  hrms_reliable_get_stats(&stats);
+  CHECK(stats.duplicates == 1 && stats.gaps_skipped == 0);
+
+  // A duplicate of a frame buffered ahead of a gap is dropped too
+  reset();
+  CHECK(send(0));
+  CHECK(send(1));
+  deliver(1);
+  deliver(1);
+  CHECK(delivered_count == 0);
+  deliver(0);
+  CHECK(delivered_in_order(0, 2));
+  hrms_reliable_get_stats(&stats);
+  CHECK(stats.duplicates == 1);
+}
+
+static void test_give_up(void) {
+  hrms_reliable_stats_t stats;
+  reset();
+
+  // Frame 0 never arrives; 1 and 2 wait behind it
+  CHECK(send(0));
+  CHECK(send(1));
+  CHECK(send(2));
+  uint32_t received_ms = now_ms;
+  deliver(1);
+  deliver(2);
+  for (uint8_t i = 3; i < wire_count; i++) {
+    deliver(i);             // Selective ACKs for 1 and 2
+  }
+  wire_count = 0;
+  CHECK(delivered_count == 0);
+  CHECK(hrms_reliable_in_flight() == 3);   // Base is still 0
+
+  // Sender: one retransmit per RTO, all lost, then it gives 0 up
+  for (uint8_t retry = 1; retry <= HRMS_RELIABLE_MAX_RETRIES; retry++) {
+    now_ms += HRMS_RELIABLE_RTO_MS;
+    hrms_reliable_poll(now_ms);
+    CHECK(wire_count == 1);
+    wire_count = 0;
+  }
+  hrms_reliable_get_stats(&stats);
+  CHECK(stats.retransmits == HRMS_RELIABLE_MAX_RETRIES && stats.failed == 0);
+  CHECK(delivered_count == 0);
+
+  // Giving up and skipping the gap happen on the same poll
+  now_ms = received_ms + HRMS_RELIABLE_GAP_MS - 1;
+  hrms_reliable_poll(now_ms);
+  CHECK(delivered_count == 0);
+  now_ms = received_ms + HRMS_RELIABLE_GAP_MS;
+  hrms_reliable_poll(now_ms);
+  CHECK(wire_count == 0);
+  CHECK(hrms_reliable_in_flight() == 0);
+  CHECK(delivered_count == 2 && delivered[0] == 1 && delivered[1] == 2);
+
+  hrms_reliable_get_stats(&stats);
+  CHECK(stats.failed == 1);
+  CHECK(stats.acked == 2);
+  CHECK(stats.gaps_skipped == 1);
+
+  // The link carries on from 3
+  CHECK(send(3));
+  flush();
+  CHECK(delivered_count == 3 && delivered[2] == 3);
+  CHECK(hrms_reliable_in_flight() == 0);
+}
+
+static void test_wrap(void) {
+  reset();
+
+  // Lossless up to just below the 8-bit wrap
+  for (uint16_t i = 0; i < 254; i++) {
+    CHECK(send(i));
+    flush();
+  }
+  CHECK(delivered_in_order(0, 254));
+
+  // 254, 255, 256, 257 travel as 0xFE, 0xFF, 0x00, 0x01 - shuffle them
+  static const uint8_t order[HRMS_RELIABLE_WINDOW] = {3, 0, 2, 1};
+  for (uint16_t i = 254; i < 254 + HRMS_RELIABLE_WINDOW; i++) {
+    CHECK(send(i));
+  }
+  CHECK(frame_at(2).packet_id == 0x00);
+  uint8_t sent = wire_count;
+  for (uint8_t i = 0; i < sent; i++) {
+    deliver(order[i]);
+  }
+  for (uint8_t i = sent; i < wire_count; i++) {
+    deliver(i);
+  }
+  wire_count = 0;
+  CHECK(delivered_in_order(0, 254 + HRMS_RELIABLE_WINDOW));
+  CHECK(hrms_reliable_in_flight() == 0);
+
+  // And well past it
+  for (uint16_t i = 254 + HRMS_RELIABLE_WINDOW; i < 300; i++) {
+    CHECK(send(i));
+    flush();
+  }
+  CHECK(delivered_in_order(0, 300));
+}
+
+static void test_peer_restart(void) {
+  hrms_reliable_stats_t stats;
+  hrms_comm_packet_t packet;
+
+  // Receiver expects 300 (0x2C on the wire) after test_wrap
+  test_wrap();
+  wire_count = 0;
+
+  // A rebooted peer starts over at 0, far behind the window
+  make_data(&packet, 1000);
+  packet.packet_id = 0;
+  hrms_reliable_on_receive(&packet, now_ms);
+  make_data(&packet, 1001);
+  packet.packet_id = 1;
+  hrms_reliable_on_receive(&packet, now_ms);
+
+  hrms_reliable_get_stats(&stats);
+  CHECK(stats.resyncs == 1);
+  CHECK(stats.duplicates == 0);
+  CHECK(delivered_count == 302);
+  CHECK(delivered[300] == 1000 && delivered[301] == 1001);
+
+  // ACKs name the new sequence, so the restarted sender can slide
+  CHECK(wire_count == 2);
+  packet = frame_at(1);
+  CHECK(packet.packet_type == HRMS_COMM_PACKET_ACK);
+  CHECK(packet.payload[0] == 1 && packet.payload[1] == 2);
+}
+
+int main(void) {
+  test_out_of_order();
+  test_duplicates();
+  test_give_up();
+  test_wrap();
+  test_peer_restart();
+  return host_report("test_reliable");
+}
@@ -0,0 +1,187 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+/**
+ * @file test_timesync.c
+ * @brief Clock sync between two ends with a known offset and skew
+ *
+ * The starting end stamps with the virtual cycle counter, the answering end
+ * with a clock derived from it: a fixed offset plus TS_SKEW_PPB running
+ * fast. Requests and replies are handed over directly, with the radio
+ * delay and the turnaround spent on the virtual clock and some requests
+ * held up on one leg only. Checks that both ends find the offset and skew,
+ * that conversions either way land on the other clock, across the wrap of
+ * the 32-bit counter, that a late reply is not taken, and that the
+ * estimate is dropped once the exchanges stop.
+ */
+
+#include "host_stubs.h"
+#include "hrms_timesync.h"
+#include "hrms_timer.h"
+#include "hrms_config.h"
+
+#define TS_OFFSET         0x9E3779B9U   // Peer cycle counter minus ours at time 0
+#define TS_SKEW_PPB       40000         // Peer crystal 40 ppm fast
+#define TS_PERIOD_US      200000U
+#define TS_FLIGHT_US      300U          // Radio delay, each way
+#define TS_QUEUED_US      2500U         // Extra delay on a held-up request
+#define TS_TURNAROUND_US  150U
+#define TS_RUN_US         90000000U     // Past the 59.6 s wrap of the cycle counter
+
+#define TS_OFFSET_TOLERANCE   HOST_CYCLES_PER_US
+#define TS_SKEW_TOLERANCE_PPB 50
+
+static uint64_t peer_cycles64(void) {
+  uint64_t cycles = (uint64_t)host_now_us() * HOST_CYCLES_PER_US;
+  return TS_OFFSET + cycles + cycles * TS_SKEW_PPB / 1000000000U;
+}
+
+static uint32_t peer_clock(void) {
+  return (uint32_t)peer_cycles64();
+}
+
+static uint32_t local_tick(void) {
+  return host_now_us() / 1000U;
+}
+
+static uint32_t peer_tick(void) {
+  return (uint32_t)(peer_cycles64() / (HOST_CYCLES_PER_US * 1000U));
+}
+
+static int32_t distance(uint32_t a, uint32_t b) {
+  return (int32_t)(a - b);
+}
+
+static int32_t magnitude(int32_t value) {
+  return value < 0 ? -value : value;
+}
+
+// One exchange started by a; the request leg is held up when queued
+static bool exchange(hrms_timesync_t *a, hrms_timesync_t *b, bool queued) {
+  uint8_t request[HRMS_TIMESYNC_REQUEST_PREV_SIZE];
+  uint8_t reply[HRMS_TIMESYNC_REPLY_SIZE];
+
+  size_t request_len = hrms_timesync_make_request(a, local_tick(), request, sizeof(request));
+  CHECK(request_len >= HRMS_TIMESYNC_REQUEST_SIZE);
+  host_advance_us(TS_FLIGHT_US + (queued ? TS_QUEUED_US : 0));
+
+  uint32_t t2 = peer_clock();
+  host_advance_us(TS_TURNAROUND_US);
+  size_t reply_len = hrms_timesync_make_reply(b, request, request_len, t2, peer_tick(),
+                                              reply, sizeof(reply));
+  CHECK(reply_len == HRMS_TIMESYNC_REPLY_SIZE);
+  host_advance_us(TS_FLIGHT_US);
+
+  return hrms_timesync_on_reply(a, reply, reply_len, hrms_timer_cycles());
+}
+
+static void run(hrms_timesync_t *a, hrms_timesync_t *b, uint32_t duration_us) {
+  uint32_t end = host_now_us() + duration_us;
+  for (uint32_t i = 0; host_now_us() < end; i++) {
+    // Every other one held up, the last of each block among them
+    CHECK(exchange(a, b, (i % 2) == 1));
+    host_advance_us(TS_PERIOD_US);
+  }
+}
+
+static void test_offset_and_skew(void) {
+  hrms_timesync_t a, b;
+  hrms_timesync_stats_t stats;
+  host_reset_clock();
+  hrms_timesync_init(&a, NULL);
+  hrms_timesync_init(&b, peer_clock);
+
+  hrms_timesync_get_stats(&a, &stats);
+  CHECK(!stats.valid);
+
+  run(&a, &b, TS_RUN_US);
+
+  // Starting end: peer minus ours
+  hrms_timesync_get_stats(&a, &stats);
+  CHECK(stats.valid);
+  CHECK(magnitude(distance(stats.offset_cycles, peer_clock() - hrms_timer_cycles())) <=
+        TS_OFFSET_TOLERANCE);
+  CHECK(magnitude(stats.skew_ppb - TS_SKEW_PPB) <= TS_SKEW_TOLERANCE_PPB);
+  CHECK(stats.delay_us + 1 >= TS_FLIGHT_US && stats.delay_us <= TS_FLIGHT_US);
+  CHECK(stats.rejected == 0);
+
+  // Answering end: the same estimate, negated
+  hrms_timesync_get_stats(&b, &stats);
+  CHECK(stats.valid);
+  CHECK(magnitude(distance(stats.offset_cycles, hrms_timer_cycles() - peer_clock())) <=
+        TS_OFFSET_TOLERANCE);
+  CHECK(magnitude(stats.skew_ppb + TS_SKEW_PPB) <= TS_SKEW_TOLERANCE_PPB);
+
+  // Conversions either way, from both ends
+  uint32_t converted;
+  CHECK(hrms_timesync_to_peer(&a, hrms_timer_cycles(), &converted));
+  CHECK(magnitude(distance(converted, peer_clock())) <= TS_OFFSET_TOLERANCE);
+  CHECK(hrms_timesync_to_local(&a, peer_clock(), &converted));
+  CHECK(magnitude(distance(converted, hrms_timer_cycles())) <= TS_OFFSET_TOLERANCE);
+  CHECK(hrms_timesync_to_local(&b, hrms_timer_cycles(), &converted));
+  CHECK(magnitude(distance(converted, peer_clock())) <= TS_OFFSET_TOLERANCE);
+
+  // Carried forward by the skew between exchanges
+  host_advance_us(5000000U);
+  CHECK(hrms_timesync_to_peer(&a, hrms_timer_cycles(), &converted));
+  CHECK(magnitude(distance(converted, peer_clock())) <= TS_OFFSET_TOLERANCE);
+
+  // A peer packet timestamp lands within the tick
+  CHECK(hrms_timesync_peer_tick_to_local(&a, (uint16_t)peer_tick(), &converted));
+  CHECK(magnitude(distance(converted, hrms_timer_cycles())) <=
+        (int32_t)hrms_timer_us_to_cycles(1000U));
+}
+
+static void test_late_reply(void) {
+  hrms_timesync_t a, b;
+  uint8_t request[HRMS_TIMESYNC_REQUEST_PREV_SIZE];
+  uint8_t reply[HRMS_TIMESYNC_REPLY_SIZE];
+  host_reset_clock();
+  hrms_timesync_init(&a, NULL);
+  hrms_timesync_init(&b, peer_clock);
+
+  // The reply comes back after a newer request replaced the one it answers
+  size_t len = hrms_timesync_make_request(&a, local_tick(), request, sizeof(request));
+  host_advance_us(TS_FLIGHT_US);
+  len = hrms_timesync_make_reply(&b, request, len, peer_clock(), peer_tick(),
+                                 reply, sizeof(reply));
+  host_advance_us(TS_PERIOD_US);
+  hrms_timesync_make_request(&a, local_tick(), request, sizeof(request));
+  CHECK(!hrms_timesync_on_reply(&a, reply, len, hrms_timer_cycles()));
+
+  // The current request is still answered; the late reply stays refused
+  CHECK(exchange(&a, &b, false));
+  CHECK(!hrms_timesync_on_reply(&a, reply, len, hrms_timer_cycles()));
+}
+
+static void test_stale(void) {
+  hrms_timesync_t a, b;
+  hrms_timesync_stats_t stats;
+  host_reset_clock();
+  hrms_timesync_init(&a, NULL);
+  hrms_timesync_init(&b, peer_clock);
+
+  run(&a, &b, 5000000U);
+  hrms_timesync_get_stats(&a, &stats);
+  CHECK(stats.valid);
+
+  // No exchange for longer than the estimate is trusted
+  host_advance_us(HRMS_TIMESYNC_STALE_MS * 1000U + 1000U);
+  uint32_t converted;
+  CHECK(!hrms_timesync_to_peer(&a, hrms_timer_cycles(), &converted));
+  hrms_timesync_get_stats(&b, &stats);
+  CHECK(!stats.valid);
+}
+
+int main(void) {
+  test_offset_and_skew();
+  test_late_reply();
+  test_stale();
+  return host_report("test_timesync");
+}
@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+/**
+ * @file test_tx_sched.c
+ * @brief Transmit scheduler driven by the communication hub on the simulator
+ *
+ * The hub runs on the local radio and a simulator radio receives what it
+ * sends. Checks the on-air order of the four classes, that a newer control
+ * frame replaces a waiting one, and that a saturating bulk load is held to
+ * the token bucket while a 200 Hz control stream goes out every cycle.
+ */
+
+#include "host_stubs.h"
+#include "host_sim.h"
+#include "hrms_communication_hub.h"
+#include "hrms_tx_sched.h"
+#include "hrms_packet_utils.h"
+#include "hrms_config.h"
+#include <string.h>
+
+#define SCHED_PEER        HRMS_NRF24_SIM_PEER
+#define SCHED_CYCLE_MS    5       // Hub loop at the joystick rate
+#define SCHED_RUN_MS      1000
+#define SCHED_MAX_FRAMES  8
+
+static uint8_t received_types[SCHED_MAX_FRAMES];
+
+static void start(void) {
+  host_sim_reset(0);
+  hrms_communication_hub_init();
+  host_sim_node_prx(SCHED_PEER, 0);
+}
+
+// Packet type of every frame the peer got, in arrival order
+static uint8_t peer_drain(void) {
+  uint8_t data[NRF24L01_MAX_PAYLOAD_SIZE];
+  uint8_t count = 0;
+
+  while (host_sim_node_receive(SCHED_PEER, data) > 0) {
+    if (count < SCHED_MAX_FRAMES) {
+      received_types[count] = data[0];
+    }
+    count++;
+  }
+  return count;
+}
+
+static bool send_stick(int16_t x) {
+  hrms_comm_command_t cmd;
+  memset(&cmd, 0, sizeof(cmd));
+  cmd.should_transmit = true;
+  cmd.packet_type = HRMS_COMM_PACKET_CONTROL_CMD;
+  cmd.dest_id = 0x02;
+  cmd.joystick_data.x_axis = x;
+  return hrms_communication_hub_send_joystick_data(&cmd);
+}
+
+// A full-size telemetry frame, queued straight into the bulk class
+static bool push_bulk(void) {
+  hrms_comm_packet_t packet;
+  uint8_t frame[HRMS_WIRE_MAX_FRAME_SIZE];
+
+  memset(&packet, 0, sizeof(packet));
+  packet.packet_type = HRMS_COMM_PACKET_SENSOR_DATA;
+  packet.source_id = 0x01;
+  packet.dest_id = 0x02;
+  packet.payload_size = HRMS_WIRE_MAX_PAYLOAD_SIZE;
+  size_t len = hrms_packet_encode(&packet, frame, sizeof(frame));
+  CHECK(len == HRMS_WIRE_MAX_FRAME_SIZE);
+  return hrms_tx_sched_push(HRMS_TX_CLASS_BULK, frame, len, 0);
+}
+
+static void test_priority(void) {
+  const uint8_t telemetry[4] = {1, 2, 3, 4};
+  hrms_tx_sched_stats_t stats;
+  start();
+
+  // Queued lowest priority first; at most three per round (peer RX FIFO)
+  CHECK(hrms_communication_hub_send_reliable(HRMS_COMM_PACKET_STATUS, 0x02,
+                                             telemetry, sizeof(telemetry)));
+  CHECK(hrms_communication_hub_send_sync(0x02));
+  CHECK(send_stick(100));
+  CHECK(send_stick(200));   // Replaces the waiting stick frame
+  hrms_communication_hub_service_tx();
+  CHECK(peer_drain() == 3);
+  CHECK(received_types[0] == HRMS_COMM_PACKET_CONTROL_CMD);
+  CHECK(received_types[1] == HRMS_COMM_PACKET_SYNC);
+  CHECK(received_types[2] == HRMS_COMM_PACKET_STATUS);
+
+  hrms_tx_sched_get_stats(&stats);
+  CHECK(stats.replaced == 1);
+  CHECK(stats.sent[HRMS_TX_CLASS_CONTROL] == 1);
+
+  CHECK(hrms_communication_hub_send_reliable(HRMS_COMM_PACKET_STATUS, 0x02,
+                                             telemetry, sizeof(telemetry)));
+  CHECK(hrms_communication_hub_send_heartbeat());
+  CHECK(send_stick(300));
+  hrms_communication_hub_service_tx();
+  CHECK(peer_drain() == 3);
+  CHECK(received_types[0] == HRMS_COMM_PACKET_CONTROL_CMD);
+  CHECK(received_types[1] == HRMS_COMM_PACKET_HEARTBEAT);
+  CHECK(received_types[2] == HRMS_COMM_PACKET_STATUS);
+
+  CHECK(hrms_communication_hub_send_heartbeat());
+  CHECK(hrms_communication_hub_send_sync(0x02));
+  hrms_communication_hub_service_tx();
+  CHECK(peer_drain() == 2);
+  CHECK(received_types[0] == HRMS_COMM_PACKET_SYNC);
+  CHECK(received_types[1] == HRMS_COMM_PACKET_HEARTBEAT);
+
+  hrms_communication_hub_service_tx();
+  CHECK(peer_drain() == 0);
+}
+
+static void test_bulk_bucket(void) {
+  hrms_tx_sched_stats_t stats;
+  uint32_t control = 0;
+  uint32_t bulk = 0;
+  bool control_first = true;
+  start();
+
+  for (uint32_t t = 0; t < SCHED_RUN_MS; t += SCHED_CYCLE_MS) {
+    uint32_t cycle_start = host_now_us();
+
+    // Bulk always has more waiting than it may send
+    CHECK(send_stick((int16_t)t));
+    while (push_bulk()) {
+    }
+
+    hrms_communication_hub_service_tx();
+    uint8_t count = peer_drain();
+    CHECK(count >= 1 && count <= 2);
+    control_first = control_first && received_types[0] == HRMS_COMM_PACKET_CONTROL_CMD;
+    for (uint8_t i = 0; i < count && i < SCHED_MAX_FRAMES; i++) {
+      control += (received_types[i] == HRMS_COMM_PACKET_CONTROL_CMD);
+      bulk += (received_types[i] == HRMS_COMM_PACKET_SENSOR_DATA);
+    }
+
+    host_advance_us(SCHED_CYCLE_MS * 1000U - (host_now_us() - cycle_start));
+  }
+
+  // Every stick frame went out, ahead of bulk
+  CHECK(control == SCHED_RUN_MS / SCHED_CYCLE_MS);
+  CHECK(control_first);
+
+  // Bulk got its rate plus the burst, to within the frame in progress
+  uint32_t bytes = bulk * HRMS_WIRE_MAX_FRAME_SIZE;
+  uint32_t allowed = HRMS_TX_BULK_RATE_BPS * SCHED_RUN_MS / 1000U + HRMS_TX_BULK_BURST;
+  CHECK(bytes <= allowed);
+  CHECK(bytes + HRMS_WIRE_MAX_FRAME_SIZE > allowed - HRMS_WIRE_MAX_FRAME_SIZE);
+
+  hrms_tx_sched_get_stats(&stats);
+  CHECK(stats.throttled > 0);
+  CHECK(stats.dropped > 0);
+  printf("  %u ms: %u control frames, %u bulk frames (%u B of %u B allowed)\n",
+         SCHED_RUN_MS, (unsigned)control, (unsigned)bulk, (unsigned)bytes, (unsigned)allowed);
+}
+
+int main(void) {
+  test_priority();
+  test_bulk_bucket();
+  return host_report("test_tx_sched");
+}
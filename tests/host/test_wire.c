@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+/**
+ * @file test_wire.c
+ * @brief On-air wire format: round trip, truncated and corrupted frames
+ *
+ * Ends with the per-frame byte count of each packet kind against the
+ * sizeof(hrms_comm_packet_t) the hub used to put on air.
+ */
+
+#include "host_stubs.h"
+#include "hrms_packet_utils.h"
+#include "hrms_crc.h"
+#include <string.h>
+
+static void make_packet(hrms_comm_packet_t *packet, hrms_comm_packet_type_t type,
+                        const uint8_t *payload, uint8_t payload_size) {
+  memset(packet, 0, sizeof(*packet));
+  packet->packet_type = type;
+  packet->packet_id = 0x5A;
+  packet->source_id = 0x01;
+  packet->dest_id = 0x02;
+  packet->timestamp = 0xABCD1234;
+  packet->payload_size = payload_size;
+  if (payload_size) {
+    memcpy(packet->payload, payload, payload_size);
+  }
+}
+
+static void test_crc(void) {
+  // CRC-32/MPEG-2 check value
+  const uint8_t check[] = "123456789";
+  CHECK(hrms_crc32(check, 9) == 0x0376E6E7);
+}
+
+static void test_layout(void) {
+  const uint8_t payload[] = {0x11, 0x22, 0x33};
+  hrms_comm_packet_t packet;
+  uint8_t frame[HRMS_WIRE_MAX_FRAME_SIZE];
+
+  make_packet(&packet, HRMS_COMM_PACKET_STATUS, payload, sizeof(payload));
+  size_t len = hrms_packet_encode(&packet, frame, sizeof(frame));
+  CHECK(len == HRMS_WIRE_HEADER_SIZE + sizeof(payload) + HRMS_WIRE_CHECKSUM_SIZE);
+
+  // Fixed offsets, little-endian timestamp truncated to 16 bits
+  CHECK(frame[0] == HRMS_COMM_PACKET_STATUS);
+  CHECK(frame[1] == 0x5A);
+  CHECK(frame[2] == 0x01);
+  CHECK(frame[3] == 0x02);
+  CHECK(frame[4] == sizeof(payload));
+  CHECK(frame[5] == 0x34 && frame[6] == 0x12);
+  CHECK(memcmp(&frame[HRMS_WIRE_HEADER_SIZE], payload, sizeof(payload)) == 0);
+
+  uint16_t crc = (uint16_t)hrms_crc32(frame, HRMS_WIRE_HEADER_SIZE + sizeof(payload));
+  CHECK(frame[10] == (uint8_t)crc && frame[11] == (uint8_t)(crc >> 8));
+}
+
+static void test_round_trip(void) {
+  uint8_t payload[HRMS_WIRE_MAX_PAYLOAD_SIZE];
+  uint8_t frame[HRMS_WIRE_MAX_FRAME_SIZE];
+  hrms_comm_packet_t packet, decoded;
+
+  for (uint8_t i = 0; i < sizeof(payload); i++) {
+    payload[i] = (uint8_t)(i * 37 + 1);
+  }
+
+  // Every payload size, every packet type
+  for (uint8_t size = 0; size <= HRMS_WIRE_MAX_PAYLOAD_SIZE; size++) {
+    for (int type = 0; type < HRMS_COMM_PACKET_TYPE_COUNT; type++) {
+      make_packet(&packet, (hrms_comm_packet_type_t)type, payload, size);
+      size_t len = hrms_packet_encode(&packet, frame, sizeof(frame));
+      CHECK(len == (size_t)(HRMS_WIRE_HEADER_SIZE + size + HRMS_WIRE_CHECKSUM_SIZE));
+      CHECK(len <= HRMS_WIRE_MAX_FRAME_SIZE);
+
+      memset(&decoded, 0xCC, sizeof(decoded));
+      CHECK(hrms_packet_decode(frame, len, &decoded));
+      CHECK(decoded.packet_type == packet.packet_type);
+      CHECK(decoded.packet_id == packet.packet_id);
+      CHECK(decoded.source_id == packet.source_id);
+      CHECK(decoded.dest_id == packet.dest_id);
+      CHECK(decoded.payload_size == size);
+      CHECK(decoded.timestamp == (packet.timestamp & 0xFFFF));
+      CHECK(memcmp(decoded.payload, payload, size) == 0);
+
+      // Static-width radios pad the frame to 32 bytes
+      memset(&frame[len], 0, sizeof(frame) - len);
+      CHECK(hrms_packet_decode(frame, sizeof(frame), &decoded));
+    }
+  }
+
+  // Oversized payload and short output buffer are refused
+  make_packet(&packet, HRMS_COMM_PACKET_STATUS, payload, HRMS_WIRE_MAX_PAYLOAD_SIZE);
+  packet.payload_size = HRMS_WIRE_MAX_PAYLOAD_SIZE + 1;
+  CHECK(hrms_packet_encode(&packet, frame, sizeof(frame)) == 0);
+  packet.payload_size = 4;
+  CHECK(hrms_packet_encode(&packet, frame, HRMS_WIRE_HEADER_SIZE + 4 + 1) == 0);
+
+  // Typed joystick payload
+  hrms_joystick_data_t stick = {.x_axis = -1000, .y_axis = 734, .button_pressed = true};
+  hrms_joystick_data_t stick_out;
+  make_packet(&packet, HRMS_COMM_PACKET_CONTROL_CMD, NULL, 0);
+  packet.payload_size = (uint8_t)hrms_packet_encode_joystick(&stick, packet.payload,
+                                                             sizeof(packet.payload));
+  CHECK(packet.payload_size == HRMS_WIRE_JOYSTICK_SIZE);
+  size_t len = hrms_packet_encode(&packet, frame, sizeof(frame));
+  CHECK(hrms_packet_decode(frame, len, &decoded));
+  CHECK(hrms_packet_decode_joystick(decoded.payload, decoded.payload_size, &stick_out));
+  CHECK(stick_out.x_axis == -1000 && stick_out.y_axis == 734 && stick_out.button_pressed);
+  CHECK(!hrms_packet_decode_joystick(decoded.payload, HRMS_WIRE_JOYSTICK_SIZE - 1, &stick_out));
+}
+
+static void test_truncated(void) {
+  const uint8_t payload[] = {1, 2, 3, 4, 5, 6, 7, 8};
+  uint8_t frame[HRMS_WIRE_MAX_FRAME_SIZE];
+  hrms_comm_packet_t packet, decoded;
+
+  make_packet(&packet, HRMS_COMM_PACKET_SENSOR_DATA, payload, sizeof(payload));
+  size_t len = hrms_packet_encode(&packet, frame, sizeof(frame));
+
+  // Any frame cut short of its checksum is rejected
+  for (size_t cut = 0; cut < len; cut++) {
+    CHECK(!hrms_packet_decode(frame, cut, &decoded));
+  }
+  CHECK(hrms_packet_decode(frame, len, &decoded));
+
+  // payload_size beyond the frame limit is rejected before the CRC
+  frame[4] = HRMS_WIRE_MAX_PAYLOAD_SIZE + 1;
+  CHECK(!hrms_packet_decode(frame, sizeof(frame), &decoded));
+
+  CHECK(!hrms_packet_decode(NULL, len, &decoded));
+}
+
+static void test_bad_crc(void) {
+  const uint8_t payload[] = {0xDE, 0xAD, 0xBE, 0xEF};
+  uint8_t frame[HRMS_WIRE_MAX_FRAME_SIZE];
+  hrms_comm_packet_t packet, decoded;
+
+  make_packet(&packet, HRMS_COMM_PACKET_CONFIG, payload, sizeof(payload));
+  size_t len = hrms_packet_encode(&packet, frame, sizeof(frame));
+
+  // Every single-bit error is caught, checksum bytes included
+  uint32_t caught = 0;
+  for (size_t byte = 0; byte < len; byte++) {
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      frame[byte] ^= (uint8_t)(1U << bit);
+      if (!hrms_packet_decode(frame, len, &decoded)) {
+        caught++;
+      }
+      frame[byte] ^= (uint8_t)(1U << bit);
+    }
+  }
+  CHECK(caught == len * 8);
+  CHECK(hrms_packet_decode(frame, len, &decoded));
+
+  // The in-memory checksum follows the same CRC
+  hrms_packet_set_checksum(&packet);
+  CHECK(packet.checksum == decoded.checksum);
+  CHECK(hrms_packet_verify_checksum(&packet));
+  packet.payload[0] ^= 0x01;
+  CHECK(!hrms_packet_verify_checksum(&packet));
+}
+
+static void bench_frame_bytes(void) {
+  uint8_t frame[HRMS_WIRE_MAX_FRAME_SIZE];
+  uint8_t payload[HRMS_WIRE_MAX_PAYLOAD_SIZE];
+  hrms_comm_packet_t packet;
+  const struct {
+    const char *name;
+    hrms_comm_packet_type_t type;
+    uint8_t payload_size;
+  } kinds[] = {
+    {"heartbeat", HRMS_COMM_PACKET_HEARTBEAT, 0},
+    {"ack", HRMS_COMM_PACKET_ACK, 1},
+    {"joystick", HRMS_COMM_PACKET_CONTROL_CMD, HRMS_WIRE_JOYSTICK_SIZE},
+    {"full payload", HRMS_COMM_PACKET_SENSOR_DATA, HRMS_WIRE_MAX_PAYLOAD_SIZE},
+  };
+
+  memset(payload, 0x55, sizeof(payload));
+  printf("  %-14s %6s %6s\n", "frame", "wire", "struct");
+  for (size_t i = 0; i < sizeof(kinds) / sizeof(kinds[0]); i++) {
+    make_packet(&packet, kinds[i].type, payload, kinds[i].payload_size);
+    size_t len = hrms_packet_encode(&packet, frame, sizeof(frame));
+    CHECK(len > 0 && len <= HRMS_WIRE_MAX_FRAME_SIZE);
+    printf("  %-14s %6u %6u\n", kinds[i].name, (unsigned)len,
+           (unsigned)sizeof(hrms_comm_packet_t));
+  }
+}
+
+int main(void) {
+  test_crc();
+  test_layout();
+  test_round_trip();
+  test_truncated();
+  test_bad_crc();
+  bench_frame_bytes();
+  return host_report("test_wire");
+}
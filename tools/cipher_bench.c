@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+/**
+ * @file cipher_bench.c
+ * @brief Host build of the cipher backend benchmark (`make bench-host`)
+ *
+ * Runs hrms_cipher_benchmark() with a host cycle counter in place of the
+ * DWT and keeps the best of several runs. On target, call
+ * hrms_cipher_dump_benchmark() instead.
+ *
+ * Then the per-frame cost of the configured backend in the link layer:
+ * sealing and opening one frame with its keystream block computed on the
+ * spot and ready from the ring (hrms_keystream_benchmark()).
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include <string.h>
+#include "hrms_cipher.h"
+#include "hrms_keystream.h"
+#include "hrms_timer.h"
+#include "hrms_uart.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#define BENCH_RUNS 200
+
+// TSC where there is one, nanoseconds elsewhere
+uint32_t hrms_timer_cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  return (uint32_t)__rdtsc();
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)(ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+#endif
+}
+
+void hrms_uart_send_str(const char *str) {
+  fputs(str, stdout);
+}
+
+void hrms_uart_send_dec(uint32_t value) {
+  printf("%u", (unsigned)value);
+}
+
+static uint32_t bench_min(uint32_t a, uint32_t b) {
+  return (a < b) ? a : b;
+}
+
+// Best of BENCH_RUNS per column; false if a sealed frame failed to open
+static bool bench_keystream(const hrms_keystream_t *ks, size_t len) {
+  hrms_keystream_bench_t best;
+  hrms_keystream_bench_t run;
+  hrms_keystream_benchmark(ks, len, &best);
+
+  for (int i = 1; i < BENCH_RUNS; i++) {
+    hrms_keystream_benchmark(ks, len, &run);
+    best.seal_cycles = bench_min(best.seal_cycles, run.seal_cycles);
+    best.seal_cached_cycles = bench_min(best.seal_cached_cycles, run.seal_cached_cycles);
+    best.open_cycles = bench_min(best.open_cycles, run.open_cycles);
+    best.open_cached_cycles = bench_min(best.open_cached_cycles, run.open_cached_cycles);
+    best.refill_cycles = bench_min(best.refill_cycles, run.refill_cycles);
+    best.open_ok = best.open_ok && run.open_ok;
+  }
+
+  printf("%-10u %8u %8u %8u %8u %8u %s\n", (unsigned)len,
+         (unsigned)best.seal_cycles, (unsigned)best.seal_cached_cycles,
+         (unsigned)best.open_cycles, (unsigned)best.open_cached_cycles,
+         (unsigned)best.refill_cycles, best.open_ok ? "ok" : "FAIL");
+  return best.open_ok;
+}
+
+int main(void) {
+  hrms_cipher_bench_t best[8];
+  hrms_cipher_bench_t run[8];
+  size_t count = hrms_cipher_benchmark(best, 8);
+
+  for (int i = 1; i < BENCH_RUNS; i++) {
+    hrms_cipher_benchmark(run, 8);
+    for (size_t b = 0; b < count; b++) {
+      best[b].init_cycles = bench_min(best[b].init_cycles, run[b].init_cycles);
+      best[b].frame_cycles = bench_min(best[b].frame_cycles, run[b].frame_cycles);
+      best[b].cycles_per_byte_q8 = bench_min(best[b].cycles_per_byte_q8, run[b].cycles_per_byte_q8);
+      best[b].selftest_ok = best[b].selftest_ok && run[b].selftest_ok;
+    }
+  }
+
+  printf("%-10s %8s %8s %8s %6s %s\n", "cipher", "cyc/B", "frame", "init", "ram", "kat");
+  for (size_t b = 0; b < count; b++) {
+    printf("%-10s %8.2f %8u %8u %6u %s\n", best[b].name,
+           best[b].cycles_per_byte_q8 / 256.0, (unsigned)best[b].frame_cycles,
+           (unsigned)best[b].init_cycles, (unsigned)best[b].ram_bytes,
+           best[b].selftest_ok ? "ok" : "FAIL");
+  }
+
+  // Any key and seed will do: the benchmark runs on a scratch counter
+  static const size_t lengths[] = { 8, HRMS_KEYSTREAM_MAX_DATA };
+  uint8_t key[HRMS_KEYSTREAM_KEY_SIZE];
+  uint8_t seed[HRMS_KEYSTREAM_SEED_SIZE];
+  hrms_keystream_t ks;
+  memset(key, 0xA5, sizeof(key));
+  memset(seed, 0x3C, sizeof(seed));
+  hrms_keystream_init(&ks, key, seed);
+
+  bool opened = true;
+  printf("\n%-10s %8s %8s %8s %8s %8s %s\n", "frame B", "seal", "cached", "open", "cached",
+         "refill", "ok");
+  for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+    opened = bench_keystream(&ks, lengths[i]) && opened;
+  }
+
+  for (size_t b = 0; b < count; b++) {
+    if (!best[b].selftest_ok) {
+      return 1;
+    }
+  }
+  return opened ? 0 : 1;
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2025 Masoud Bolhassani <masoud.bolhassani@gmail.com>
+ *
+ * This file is part of Hermes.
+ *
+ * Hermes is released under the GNU General Public License v3 (GPL-3.0).
+ * See LICENSE file for details.
+ */
+
+/**
+ * @file frag_bench.c
+ * @brief Fragmented message throughput on the host simulator (`make bench-sim-host`)
+ *
+ * Streams HRMS_FRAG_MAX_MESSAGE-byte messages through hrms_frag.c and the
+ * pipelined driver TX FIFO to a simulated peer, which reassembles them
+ * with the same module. Reports bytes/s of delivered messages in virtual
+ * time per data rate and ether loss, next to the module's own
+ * last_bytes_per_s. Exits non-zero if a message arrives corrupted.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "host_stubs.h"
+#include "host_sim.h"
+#include "hrms_frag.h"
+
+#define BENCH_MESSAGES    10
+#define BENCH_STEP_US     20
+#define BENCH_KIND        1
+
+static uint8_t message[HRMS_FRAG_MAX_MESSAGE];
+static uint32_t delivered;
+static uint32_t corrupted;
+
+static void on_message(uint8_t source_id, uint8_t kind, const uint8_t *data, size_t len) {
+  (void)source_id;
+  if (kind == BENCH_KIND && len == sizeof(message) && memcmp(data, message, len) == 0) {
+    delivered++;
+  } else {
+    corrupted++;
+  }
+}
+
+static bool enqueue(const uint8_t *frame, size_t len, uint8_t tag) {
+  return hrms_nrf24l01_enqueue(frame, (uint8_t)len, tag);
+}
+
+static uint32_t now_ms(void) {
+  return host_now_us() / 1000U;
+}
+
+// Peer side: every received frame goes to the reassembly pool
+static void peer_poll(void) {
+  uint8_t frame[NRF24L01_MAX_PAYLOAD_SIZE];
+  uint8_t len;
+  hrms_comm_packet_t packet;
+
+  while ((len = host_sim_peer_receive(frame)) > 0) {
+    if (hrms_packet_decode(frame, len, &packet) &&
+        packet.packet_type == HRMS_COMM_PACKET_FRAGMENT) {
+      hrms_frag_on_receive(&packet, now_ms());
+    }
+  }
+}
+
+static void bench(nrf24l01_datarate_t datarate, uint8_t rf_setup, const char *name,
+                  uint16_t loss_permille) {
+  hrms_frag_stats_t stats;
+  hrms_nrf24_sim_stats_t sim;
+
+  host_sim_start(loss_permille);
+  hrms_nrf24l01_set_rf(datarate, NRF24L01_POWER_0DBM);
+  host_sim_peer_prx(false);
+  hrms_nrf24_sim_command(HRMS_NRF24_SIM_PEER, NRF24L01_CMD_W_REGISTER | NRF24L01_REG_RF_SETUP,
+                         &rf_setup, NULL, 1);
+  hrms_frag_init(enqueue, on_message);
+  hrms_nrf24l01_set_tx_callback(hrms_frag_on_tx_done);
+  delivered = 0;
+
+  uint32_t start = host_now_us();
+  for (uint32_t n = 0; n < BENCH_MESSAGES; n++) {
+    if (!hrms_frag_send(BENCH_KIND, 0x02, message, sizeof(message), now_ms())) {
+      break;
+    }
+    while (hrms_frag_busy()) {
+      host_advance_us(BENCH_STEP_US);
+      hrms_nrf24l01_process_tx();
+      hrms_frag_poll(now_ms());
+      hrms_frag_pump(now_ms());
+      peer_poll();
+    }
+  }
+  uint32_t elapsed_us = host_now_us() - start;
+
+  hrms_frag_get_stats(&stats);
+  hrms_nrf24_sim_get_stats(&sim);
+  uint32_t bytes_per_s = (uint32_t)((uint64_t)delivered * sizeof(message) * 1000000ULL /
+                                    (elapsed_us ? elapsed_us : 1));
+
+  printf("%-8s %3u.%u%% %4u/%u %6u %6u %8u %8u %8u\n", name,
+         loss_permille / 10, loss_permille % 10, (unsigned)delivered, BENCH_MESSAGES,
+         (unsigned)stats.fragments_sent, (unsigned)stats.fragments_resent,
+         (unsigned)sim.frames_on_air, (unsigned)bytes_per_s, (unsigned)stats.last_bytes_per_s);
+}
+
+int main(void) {
+  static const uint16_t losses[] = {0, 50, 200};
+
+  for (size_t i = 0; i < sizeof(message); i++) {
+    message[i] = (uint8_t)(i * 7 + 3);
+  }
+
+  printf("%u x %u-byte messages, %u fragments each, %u retries\n", BENCH_MESSAGES,
+         (unsigned)sizeof(message), (unsigned)HRMS_FRAG_MAX_FRAGMENTS, host_sim_config.retries);
+  printf("%-8s %6s %6s %6s %6s %8s %8s %8s\n", "rate", "loss", "msgs", "frags", "resent",
+         "on_air", "B/s", "last_B/s");
+
+  for (size_t i = 0; i < sizeof(losses) / sizeof(losses[0]); i++) {
+    bench(NRF24L01_DATARATE_2MBPS, 0x0E, "2Mbps", losses[i]);
+    bench(NRF24L01_DATARATE_1MBPS, 0x06, "1Mbps", losses[i]);
+    bench(NRF24L01_DATARATE_250KBPS, 0x26, "250kbps", losses[i]);
+  }
+
+  if (corrupted) {
+    printf("%u messages corrupted\n", (unsigned)corrupted);
+    return 1;
+  }
+  return 0;
+}